@@ -1,6 +1,8 @@
 #ifndef GW_KANJIPADWINDOW_PRIVATE_INCLUDED
 #define GW_KANJIPADWINDOW_PRIVATE_INCLUDED
 
+#include <recognizer.h>
+
 G_BEGIN_DECLS
 
 struct _GwKanjipadWindowPrivate {
@@ -14,14 +16,12 @@ struct _GwKanjipadWindowPrivate {
   cairo_surface_t *ksurface;
   GList *curstroke;
   gboolean instroke;
-  char kselected[2];
-  char kanji_candidates[GW_KANJIPADWINDOW_MAX_GUESSES][2];
+  gunichar kselected;
+  gunichar kanji_candidates[GW_KANJIPADWINDOW_MAX_GUESSES];
   int kanji_candidate_index;
   int total_candidates;
-  GPid engine_pid;
-  GIOChannel *from_engine;
-  GIOChannel *to_engine;
-  guint iowatchid;
+  KpDatabase *database;  //!< Shared by every window of the process
+  guint lookup_id;       //!< Look ups that finish after the strokes changed are dropped
 };
 
 #define GW_KANJIPADWINDOW_GET_PRIVATE(object)(G_TYPE_INSTANCE_GET_PRIVATE ((object), GW_TYPE_KANJIPADWINDOW, GwKanjipadWindowPrivate))
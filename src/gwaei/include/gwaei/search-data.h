@@ -8,6 +8,7 @@ struct _GwSearchData {
   GwSearchWindow *window;
   LwResult *result;
   gint cursor_position;
+  guint watchid;
 };
 typedef struct _GwSearchData GwSearchData;
 
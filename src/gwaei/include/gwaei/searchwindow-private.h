@@ -4,9 +4,7 @@
 G_BEGIN_DECLS
 
 typedef enum {
-  GW_SEARCHWINDOW_TIMEOUTID_PROGRESS,
   GW_SEARCHWINDOW_TIMEOUTID_KEEP_SEARCHING,
-  GW_SEARCHWINDOW_TIMEOUTID_APPEND_RESULT,
   TOTAL_GW_SEARCHWINDOW_TIMEOUTIDS
 } GwSearchWindowTimeoutId;
 
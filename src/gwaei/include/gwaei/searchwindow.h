@@ -41,7 +41,9 @@ struct _GwSearchWindowClass {
 GtkWindow* gw_searchwindow_new (GtkApplication *application);
 GType gw_searchwindow_get_type (void) G_GNUC_CONST;
 
-gboolean gw_searchwindow_update_progress_feedback_timeout (GwSearchWindow*);
+void gw_searchwindow_update_progress_feedback (GwSearchWindow*);
+void gw_searchwindow_append_results (GwSearchWindow*);
+gboolean gw_searchwindow_search_watch_cb (LwSearch*, GwSearchWindow*);
 gboolean gw_searchwindow_update_icons_for_selection_timeout (GwSearchWindow*);
 gboolean gw_searchwindow_keep_searching_timeout (GwSearchWindow*);
 
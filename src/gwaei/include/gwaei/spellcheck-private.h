@@ -36,6 +36,9 @@ struct _GwSpellcheckPrivate {
   guint signalid[TOTAL_GW_SPELLCHECK_SIGNALIDS];
   guint timeoutid[TOTAL_GW_SPELLCHECK_TIMEOUTIDS];
   gint rk_conv_setting;
+
+  LwRomajiConverter romaji;  //Conversion of romaji_query, extended as the user types
+  gchar *romaji_query;
 };
 
 #define GW_SPELLCHECK_GET_PRIVATE(object)(G_TYPE_INSTANCE_GET_PRIVATE ((object), GW_TYPE_SPELLCHECK, GwSpellcheckPrivate))
@@ -102,26 +102,14 @@ static void _kanjipadwindow_get_candidate_character_size (GwKanjipadWindow *wind
 //!
 //! @brief To be written
 //!
-static gchar *_kanjipadwindow_utf8_for_char (char wide_character[])
+static gchar *_kanjipadwindow_utf8_for_char (gunichar character)
 {
     //Declarations
     gchar *string_utf;
-    GError *error;
-    gchar str[3];
 
     //Initializaitons
-    error = NULL;
-    str[0] = wide_character[0] + 0x80;
-    str[1] = wide_character[1] + 0x80;
-    str[2] = '\0';
-    string_utf = g_convert (str, -1, "UTF-8", "EUC-JP", NULL, NULL, &error);
-
-    if (error != NULL)
-    {
-      g_printerr ("Cannot convert string from EUC-JP to UTF-8: %s\n",
-      error->message);
-      exit (EXIT_FAILURE);
-    }
+    string_utf = g_new0 (gchar, 7);  //Room for the longest UTF-8 sequence and a nul
+    if (character != 0) g_unichar_to_utf8 (character, string_utf);
 
     return string_utf;
 }
@@ -236,7 +224,7 @@ void gw_kanjipadwindow_draw_candidates (GwKanjipadWindow *window)
 
     for (i = 0; i < priv->total_candidates; i++)
     {
-      if (strcmp (priv->kselected, priv->kanji_candidates[i]) == 0)
+      if (priv->kselected == priv->kanji_candidates[i])
         _kanjipadwindow_draw_candidate_character (window, i, 1);
       else
         _kanjipadwindow_draw_candidate_character (window, i, -1);
@@ -310,11 +298,11 @@ static int _kanjipadwindow_erase_candidate_selection (GwKanjipadWindow *window)
     //Initializations
     priv = window->priv;
 
-    if (priv->kselected[0] || priv->kselected[1])
+    if (priv->kselected != 0)
     {
       for (i = 0; i < priv->total_candidates; i++)
       {
-        if (strncmp (priv->kselected, priv->kanji_candidates[i], 2))
+        if (priv->kselected != priv->kanji_candidates[i])
         {
           _kanjipadwindow_draw_candidate_character (window, i, 0);
         }
@@ -341,8 +329,7 @@ static void _kanjipadwindow_primary_candidates_clear (GtkClipboard *clipboard, g
 
     _kanjipadwindow_erase_candidate_selection (window);
 
-    priv->kselected[0] = 0;
-    priv->kselected[1] = 0;
+    priv->kselected = 0;
 
     priv->kanji_candidate_index = -1;
 
@@ -362,7 +349,7 @@ static void _kanjipadwindow_primary_candidates_get (GtkClipboard *clipboard, Gtk
     window = GW_KANJIPADWINDOW (data);
     priv = window->priv;
 
-    if (priv->kselected[0] || priv->kselected[1])
+    if (priv->kselected != 0)
     {
       string_utf = _kanjipadwindow_utf8_for_char (priv->kselected);
       gtk_selection_data_set_text (selection_data, string_utf, -1);
@@ -406,7 +393,7 @@ G_MODULE_EXPORT gboolean gw_kanjipadwindow_candidatearea_button_press_event_cb (
     if (j < priv->total_candidates)
     {
       gw_kanjipadwindow_draw_candidates (window); 
-      strncpy(priv->kselected, priv->kanji_candidates[j], 2);
+      priv->kselected = priv->kanji_candidates[j];
       priv->kanji_candidate_index = j;
       if (priv->kanji_candidate_index > -1) _kanjipadwindow_draw_candidate_character (window, priv->kanji_candidate_index, 1);
       
@@ -416,8 +403,7 @@ G_MODULE_EXPORT gboolean gw_kanjipadwindow_candidatearea_button_press_event_cb (
     }
     else
     {
-      priv->kselected[0] = 0;
-      priv->kselected[1] = 0;
+      priv->kselected = 0;
       if (gtk_clipboard_get_owner (clipboard) == G_OBJECT (widget))
         gtk_clipboard_clear (clipboard);
       priv->kanji_candidate_index = -1;
@@ -438,6 +438,8 @@ gw_kanjipadwindow_clear_drawingarea (GwKanjipadWindow *window)
     }
     g_list_free (priv->strokes); priv->strokes = NULL;
     g_list_free (priv->curstroke); priv->curstroke = NULL;
+    //A look up that is still running was for the strokes that are gone
+    priv->lookup_id++;
 
     _kanjipadwindow_initialize_drawingarea (window);
 }
@@ -47,7 +47,87 @@
 
 
 //!
-//! @brief Does the needed calls to kpad to look up the kanji
+//! @brief The strokes of a look up and the candidates the recognizer found
+//!        for them.  Owned by the GTask that runs the recognizer.
+//!
+struct _GwKanjipadLookUp {
+  KpDatabase *database;
+  GArray *points;
+  KpStroke strokes[KP_MAX_STROKES];
+  gint total_strokes;
+  KpCandidate candidates[KP_MAX_CANDIDATES];
+  gint total_candidates;
+  guint id;  //!< The look up id of the window when it started
+};
+typedef struct _GwKanjipadLookUp GwKanjipadLookUp;
+
+
+static void
+_kanjipadwindow_look_up_free (GwKanjipadLookUp *lookup)
+{
+    if (lookup->points != NULL) g_array_free (lookup->points, TRUE); lookup->points = NULL;
+    g_free (lookup);
+}
+
+
+//!
+//! @brief Runs the recognizer on a worker thread so drawing stays smooth
+//!        while the larger stroke counts are scored
+//!
+static void
+_kanjipadwindow_look_up_thread (GTask        *task,
+                                gpointer      source_object,
+                                gpointer      task_data,
+                                GCancellable *cancellable)
+{
+    //Declarations
+    GwKanjipadLookUp *lookup;
+
+    //Initializations
+    lookup = task_data;
+
+    lookup->total_candidates = kp_database_recognize (lookup->database, lookup->strokes, lookup->total_strokes, lookup->candidates, KP_MAX_CANDIDATES);
+
+    g_task_return_boolean (task, TRUE);
+}
+
+
+//!
+//! @brief Shows the candidates of a look up back on the main thread unless
+//!        the strokes changed while it was running
+//!
+static void
+_kanjipadwindow_look_up_ready_cb (GObject      *source_object,
+                                  GAsyncResult *result,
+                                  gpointer      data)
+{
+    //Declarations
+    GwKanjipadWindow *window;
+    GwKanjipadWindowPrivate *priv;
+    GwKanjipadLookUp *lookup;
+    gint i;
+
+    //Initializations
+    window = GW_KANJIPADWINDOW (source_object);
+    priv = window->priv;
+    lookup = g_task_get_task_data (G_TASK (result));
+
+    if (!g_task_propagate_boolean (G_TASK (result), NULL)) return;
+    if (lookup->id != priv->lookup_id) return;
+
+    for (i = 0; i < lookup->total_candidates && i < GW_KANJIPADWINDOW_MAX_GUESSES; i++)
+    {
+      priv->kanji_candidates[i] = lookup->candidates[i].character;
+    }
+    priv->total_candidates = i;
+
+    gw_kanjipadwindow_draw_candidates (window);
+}
+
+
+//!
+//! @brief Starts recognizing the strokes drawn so far.  The candidates are
+//!        shown when the recognizer finishes.
 //! 
 G_MODULE_EXPORT gboolean 
 gw_kanjipadwindow_look_up_cb (GtkWidget *widget, GdkEventButton *event, gpointer data)
@@ -55,48 +135,49 @@ gw_kanjipadwindow_look_up_cb (GtkWidget *widget, GdkEventButton *event, gpointer
     //Declarations
     GwKanjipadWindow *window;
     GwKanjipadWindowPrivate *priv;
+    GwKanjipadLookUp *lookup;
+    GTask *task;
     GList *iter;
     GList *inner_iter;
-    GString *message;
-    GError *error;
-    gint16 x;
-    gint16 y;
+    KpPoint point;
+    gint i;
 
     //Initializations
     window = GW_KANJIPADWINDOW (gtk_widget_get_ancestor (GTK_WIDGET (data), GW_TYPE_KANJIPADWINDOW));
     g_return_val_if_fail (window != NULL, FALSE);
     priv = window->priv;
 
-    if (priv->to_engine == NULL)
+    if (priv->database == NULL)
       return FALSE;
-    message = g_string_new (NULL);
-    error = NULL;
-      
-    for (iter = priv->strokes; iter != NULL; iter = iter->next)
+    lookup = g_new0 (GwKanjipadLookUp, 1);
+    lookup->database = priv->database;
+    lookup->points = g_array_new (FALSE, FALSE, sizeof(KpPoint));
+    lookup->id = ++priv->lookup_id;
+
+    //Lay the points out first since the array may move while it grows
+    for (iter = priv->strokes; iter != NULL && lookup->total_strokes < KP_MAX_STROKES; iter = iter->next)
     {
+      lookup->strokes[lookup->total_strokes].length = 0;
       for (inner_iter = iter->data; inner_iter != NULL; inner_iter = inner_iter->next)
       {
-        x = ((GdkPoint*) inner_iter->data)->x;
-        y = ((GdkPoint*) inner_iter->data)->y;
-        g_string_append_printf (message, "%d %d ", x, y);
+        point.x = ((GdkPoint*) inner_iter->data)->x;
+        point.y = ((GdkPoint*) inner_iter->data)->y;
+        g_array_append_val (lookup->points, point);
+        lookup->strokes[lookup->total_strokes].length++;
       }
-      g_string_append (message, "\n");
-    }
-    g_string_append (message, "\n");
-
-    if (g_io_channel_write_chars (priv->to_engine, message->str, message->len, NULL, &error) != G_IO_STATUS_NORMAL)
-    {
-      fprintf (stderr, "Cannot write message to engine: %s\n", error->message);
-      exit (EXIT_FAILURE);
+      lookup->total_strokes++;
     }
 
-    if (g_io_channel_flush (priv->to_engine, &error) != G_IO_STATUS_NORMAL)
+    for (i = 0; i < lookup->total_strokes; i++)
     {
-      fprintf (stderr, "Error flushing message to engine: %s\n", error->message);
-      exit (EXIT_FAILURE);
+      lookup->strokes[i].points = (i == 0) ? (KpPoint*) lookup->points->data : lookup->strokes[i - 1].points + lookup->strokes[i - 1].length;
     }
 
-    g_string_free (message, TRUE);
+    //The task keeps the window alive until the candidates come back
+    task = g_task_new (window, NULL, _kanjipadwindow_look_up_ready_cb, NULL);
+    g_task_set_task_data (task, lookup, (GDestroyNotify) _kanjipadwindow_look_up_free);
+    g_task_run_in_thread (task, _kanjipadwindow_look_up_thread);
+    g_object_unref (task);
 
     return FALSE;
 }
@@ -31,12 +31,9 @@
 #include "config.h"
 #endif
 
-#include <ctype.h>
-#include <errno.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
-#include <unistd.h>
 
 #include <gtk/gtk.h>
 
@@ -46,11 +43,8 @@
 #include <gwaei/kanjipadwindow-private.h>
 #include <gwaei/kanjipadwindow-callbacks.h>
 
-#define BUFLEN 256
-
 
 static void _kanjipadwindow_initialize_engine (GwKanjipadWindow*);
-static gboolean _kanjipadwindow_engine_input_handler (GIOChannel*, GIOCondition, gpointer);
 
 G_DEFINE_TYPE (GwKanjipadWindow, gw_kanjipadwindow, GW_TYPE_WINDOW)
 
@@ -90,13 +84,10 @@ gw_kanjipadwindow_finalize (GObject *object)
 {
     GwKanjipadWindow *window;
     GwKanjipadWindowPrivate *priv;
-    GSource *source;
-    GError *error;
     GList *link;
 
     window = GW_KANJIPADWINDOW (object);
     priv = window->priv;
-    error = NULL;
 
     for (link = priv->strokes; link != NULL; link = link->next)
       gw_kanjipadwindow_free_drawingarea_stroke (link->data);
@@ -106,40 +97,8 @@ gw_kanjipadwindow_finalize (GObject *object)
     if (priv->ksurface != NULL) cairo_surface_destroy (priv->ksurface); priv->ksurface = NULL;
     if (priv->surface != NULL) cairo_surface_destroy (priv->surface); priv->surface = NULL;
 
-    if (g_main_current_source () != NULL &&
-        !g_source_is_destroyed (g_main_current_source ()) &&
-        priv->iowatchid > 0
-       )
-    {
-      source = g_main_context_find_source_by_id (NULL, priv->iowatchid);
-      if (source != NULL)
-      {
-        g_source_destroy (source);
-      }
-    }
-    priv->iowatchid = 0;
-
-    if (error == NULL) 
-    {
-      g_io_channel_shutdown (priv->from_engine, FALSE, &error);
-      g_io_channel_unref (priv->from_engine);
-      priv->from_engine = NULL;
-    }
-
-    if (error == NULL)
-    {
-      g_io_channel_shutdown (priv->to_engine, FALSE, &error);
-      g_io_channel_unref (priv->to_engine);
-      priv->to_engine = NULL;
-    }
-
-    g_spawn_close_pid (priv->engine_pid);
-
-    if (error != NULL)
-    {
-      fprintf(stderr, "Errored: %s\n", error->message);
-      exit(EXIT_FAILURE);
-    }
+    //The database is shared with the other windows and stays loaded
+    priv->database = NULL;
 
     G_OBJECT_CLASS (gw_kanjipadwindow_parent_class)->finalize (object);
 }
@@ -229,123 +188,25 @@ gw_kanjipadwindow_class_init (GwKanjipadWindowClass *klass)
 
 
 //!
-//! @brief Open the connection to the engine
+//! @brief Gets the stroke database the recognizer scores against.  It is
+//!        loaded the first time any kanjipad window opens and then shared.
 //!
 static void _kanjipadwindow_initialize_engine (GwKanjipadWindow *window)
 {
     //Declarations
     GwApplication *application;
     GwKanjipadWindowPrivate *priv;
-    char *path;
-    char *argv[2];
     GError *error;
-    int stdin_fd;
-    int stdout_fd;
 
     //Initializations
     application = gw_window_get_application (GW_WINDOW (window));
     priv = window->priv;
     error = NULL;
-#ifndef G_OS_WIN32
-    path = g_build_filename (LIBDIR, PACKAGE, "kpengine", NULL);
-#else
-    gchar *prefix;
-
-    prefix = g_win32_get_package_installation_directory_of_module (NULL);
-    path = g_build_filename (prefix, "lib", PACKAGE, "kpengine.exe", NULL);
-    g_free (prefix);
-#endif
-    argv[0] = path;
-    argv[1] = NULL;
 
-    if (!g_file_test(argv[0], G_FILE_TEST_EXISTS)) 
-    {
-      fprintf(stderr, "Error: Can't find kpengine at %s\n", argv[0]);
-      exit (EXIT_FAILURE);
-    }
+    priv->database = kp_database_get_default (&error);
 
-    if (!g_spawn_async_with_pipes (NULL, /* working directory */
-           argv, NULL,  /* argv, envp */
-           0,
-           NULL, NULL,  /* child_setup */
-           (gpointer)&priv->engine_pid,   /* child pid */
-           &stdin_fd, &stdout_fd, NULL,
-           &error))
+    if (error != NULL)
     {
       gw_application_handle_error (application, NULL, FALSE, &error);
-      exit (EXIT_FAILURE);
     }
-
-    if (!(priv->to_engine = g_io_channel_unix_new (stdin_fd)))
-      g_error ("Couldn't create pipe to child process: %s", g_strerror(errno));
-    if (!(priv->from_engine = g_io_channel_unix_new (stdout_fd)))
-      g_error ("Couldn't create pipe from child process: %s", g_strerror(errno));
-
-    priv->iowatchid = g_io_add_watch (priv->from_engine, G_IO_IN, _kanjipadwindow_engine_input_handler, window);
-
-    //Cleanup
-    g_free(path);
 }
-
-
-//!
-//! @brief To be written
-//!
-static gboolean _kanjipadwindow_engine_input_handler (GIOChannel *source, GIOCondition condition, gpointer data)
-{
-    GwKanjipadWindow *window;
-    GwKanjipadWindowPrivate *priv;
-    static gchar *p;
-    static gchar *line;
-    GError *error;
-    GIOStatus status;
-    int i;
-
-    window = GW_KANJIPADWINDOW (data);
-    priv = window->priv;
-    error = NULL;
-    status = g_io_channel_read_line (priv->from_engine, &line, NULL, NULL, &error);
-
-    switch (status)
-    {
-      case G_IO_STATUS_ERROR:
-        fprintf (stderr, "Error reading from engine: %s\n", error->message);
-        exit(EXIT_FAILURE);
-        break;
-      case G_IO_STATUS_NORMAL:
-        break;
-      case G_IO_STATUS_EOF:
-        fprintf (stderr, "Engine no longer exists");
-        exit (EXIT_FAILURE);
-        break;
-      case G_IO_STATUS_AGAIN:
-        g_assert_not_reached ();
-        break;
-    }
-
-    if (line[0] == 'K')
-    {
-      unsigned int t1, t2;
-      p = line + 1;
-      for (i = 0; i < GW_KANJIPADWINDOW_MAX_GUESSES; i++)
-      {
-        while (*p && isspace(*p)) p++;
-        if (!*p || sscanf(p, "%2x%2x", &t1, &t2) != 2)
-        {
-            i--;
-            break;
-        }
-        priv->kanji_candidates[i][0] = t1;
-        priv->kanji_candidates[i][1] = t2;
-        while (*p && !isspace(*p)) p++;
-      }
-      priv->total_candidates = i + 1;
-
-      gw_kanjipadwindow_draw_candidates (window);
-    }
-
-    g_free (line);
-
-    return TRUE;
-}
-
@@ -1037,6 +1037,7 @@ gw_searchwindow_search_cb (GtkWidget *widget, gpointer data)
 
     view = gw_searchwindow_get_current_textview (window);
     new_item = lw_search_new (dictionary, morphologyengine, query, flags);
+    if (new_item != NULL) lw_search_set_max_results (new_item, 0); //The window appends every result as it comes in
     sdata = gw_searchdata_new (view, window);
     lw_search_set_data (new_item, sdata, LW_SEARCH_DATA_FREE_FUNC (gw_searchdata_free));
 
@@ -1508,6 +1509,7 @@ if (search) printf("BREAK gw_searchwindow_switch_tab_cb %s\n", search->query);
     gw_searchwindow_set_title_by_searchresultiterator (window, iterator);
     gw_searchwindow_set_total_results_label_by_searchresultiterator (window, iterator);
     gw_searchwindow_set_search_progressbar_by_searchitem (window, search);
+    gw_searchwindow_append_results (window);
 
     gboolean enabled = (search != NULL);
     GActionMap *map = G_ACTION_MAP (window);
@@ -162,37 +162,32 @@ gw_add_match_highlights (gint      line,
     GwSearchData *sdata;
     GtkTextView *view;
     GtkTextBuffer *buffer;
-    gint match_start_byte_offset;
-    gint match_end_byte_offset;
-    gint match_character_offset;
+    LwHighlighter *highlighter;
+    LwHighlightSpan spans[LW_HIGHLIGHTER_MAX_SPANS];
+    gint total;
+    gint i;
     GtkTextIter start_iter;
     GtkTextIter end_iter;
     gchar *text;
-    GRegex *regex;
-    GMatchInfo *match_info = NULL;
 
     //Initializations
     sdata = GW_SEARCHDATA (lw_search_get_data (search));
     view = GTK_TEXT_VIEW (sdata->view);
     buffer = gtk_text_view_get_buffer (view);
+    highlighter = lw_search_get_highlighter (search);
     gtk_text_buffer_get_iter_at_line_offset (buffer, &start_iter, line, start_offset);
     gtk_text_buffer_get_iter_at_line_offset (buffer, &end_iter, line, end_offset);
     text = gtk_text_buffer_get_slice (buffer, &start_iter, &end_iter, FALSE);
 
-    regex = g_regex_new (search->query, 0, 0, NULL); 
-    if (regex != NULL && g_regex_match (regex, text, 0, &match_info))
-    { 
-      while (g_match_info_matches (match_info))
-      {
-        g_match_info_fetch_pos (match_info, 0, &match_start_byte_offset, &match_end_byte_offset);
-        match_character_offset = g_utf8_pointer_to_offset (text, text + match_start_byte_offset);
-        gtk_text_buffer_get_iter_at_line_offset (buffer, &start_iter, line, match_character_offset + start_offset);
-        match_character_offset = g_utf8_pointer_to_offset (text, text + match_end_byte_offset);
-        gtk_text_buffer_get_iter_at_line_offset (buffer, &end_iter, line, match_character_offset + start_offset);
-        gtk_text_buffer_apply_tag_by_name (buffer, "match", &start_iter, &end_iter);
-        g_match_info_next (match_info, NULL);
-      }
-      g_match_info_free (match_info); match_info = NULL;
+    //The spans come back in order, so their character offsets are counted in one walk
+    total = lw_highlighter_get_spans (highlighter, text, -1, spans, LW_HIGHLIGHTER_MAX_SPANS);
+    lw_highlighter_spans_to_characters (text, spans, total);
+
+    for (i = 0; i < total; i++)
+    {
+      gtk_text_buffer_get_iter_at_line_offset (buffer, &start_iter, line, spans[i].start_offset + start_offset);
+      gtk_text_buffer_get_iter_at_line_offset (buffer, &end_iter, line, spans[i].end_offset + start_offset);
+      gtk_text_buffer_apply_tag_by_name (buffer, "match", &start_iter, &end_iter);
     }
 
     //Cleanup
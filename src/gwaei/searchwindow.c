@@ -84,6 +84,37 @@ gw_searchwindow_init (GwSearchWindow *window)
 }
 
 
+//!
+//! @brief Frees every search of the window while it is being destroyed.  Their
+//!        watches point at the window and a search that is still streaming
+//!        would otherwise call them after it is gone.
+//!
+static void 
+gw_searchwindow_dispose (GObject *object)
+{
+    GwSearchWindow *window;
+    GwSearchWindowPrivate *priv;
+    GtkWidget *container;
+    gint i;
+
+    window = GW_SEARCHWINDOW (object);
+    priv = window->priv;
+
+    if (priv->notebook != NULL)
+    {
+      for (i = 0; i < gtk_notebook_get_n_pages (priv->notebook); i++)
+      {
+        container = gtk_notebook_get_nth_page (priv->notebook, i);
+        if (container != NULL) g_object_set_data (G_OBJECT (container), "searchresultiterator", NULL);
+      }
+    }
+    if (priv->mouseiterator != NULL) lw_searchresultiterator_free_full (priv->mouseiterator); priv->mouseiterator = NULL;
+    if (priv->history) g_object_unref (priv->history); priv->history = NULL;
+
+    G_OBJECT_CLASS (gw_searchwindow_parent_class)->dispose (object);
+}
+
+
 static void 
 gw_searchwindow_finalize (GObject *object)
 {
@@ -101,7 +132,6 @@ gw_searchwindow_finalize (GObject *object)
 #ifdef HAVE_HUNSPELL
     if (priv->spellcheck) g_object_unref (priv->spellcheck); priv->spellcheck = NULL;
 #endif
-    if (priv->history) g_object_unref (priv->history); priv->history = NULL;
     if (priv->keep_searching_query) g_free (priv->keep_searching_query); priv->keep_searching_query = NULL;
 
     gw_window_save_size (GW_WINDOW (window));
@@ -282,6 +312,7 @@ gw_searchwindow_class_init (GwSearchWindowClass *klass)
     object_class = G_OBJECT_CLASS (klass);
 
     object_class->constructed = gw_searchwindow_constructed;
+    object_class->dispose = gw_searchwindow_dispose;
     object_class->finalize = gw_searchwindow_finalize;
 
     g_type_class_add_private (object_class, sizeof (GwSearchWindowPrivate));
@@ -304,14 +335,13 @@ gw_searchwindow_class_init (GwSearchWindowClass *klass)
 
 //!
 //! @brief Updates the progress information based on the LwSearch info
-//! @param search A LwSearch pointer to gleam information from.
-//! @returns Currently always returns TRUE
+//! @param window The GwSearchWindow to update the current tab of
 //!
-gboolean 
-gw_searchwindow_update_progress_feedback_timeout (GwSearchWindow *window)
+void
+gw_searchwindow_update_progress_feedback (GwSearchWindow *window)
 {
     //Sanity checks
-    if (gtk_widget_get_visible (GTK_WIDGET (window)) == FALSE) return TRUE;
+    if (gtk_widget_get_visible (GTK_WIDGET (window)) == FALSE) return;
 
     //Declarations
     GwSearchWindowPrivate *priv = NULL;
@@ -343,17 +373,16 @@ gw_searchwindow_update_progress_feedback_timeout (GwSearchWindow *window)
         lw_progress_clear_changed (progress);
       }
     }
-
-    return TRUE;
 }
 
 
-gboolean 
-gw_searchwindow_append_result_timeout (GwSearchWindow *window)
+//!
+//! @brief Appends whatever results are ready for the current tab and the tooltip
+//! @param window The GwSearchWindow to append the results to
+//!
+void
+gw_searchwindow_append_results (GwSearchWindow *window)
 {
-    //Sanity check
-    if (gtk_widget_get_visible (GTK_WIDGET (window)) == FALSE) return TRUE;
-
     //Declarations
     GwSearchWindowPrivate *priv;
     LwSearchResultIterator *iterator;
@@ -366,22 +395,19 @@ gw_searchwindow_append_result_timeout (GwSearchWindow *window)
     priv = window->priv;
     index = gw_searchwindow_get_current_tab_index (window);
     iterator = gw_searchwindow_get_searchresultiterator_by_index (window, index);
-    if (iterator == NULL) return TRUE;
-    search = iterator->search;
+    search = (iterator == NULL) ? NULL : iterator->search;
 
-    if (lw_searchresultiterator_finished (iterator))
-    {
-      if (lw_searchresultiterator_empty (iterator))
-      {
-        gw_searchwindow_display_no_results_found_page (window, iterator);
-      }
-    }
-    else
+    if (iterator != NULL && !lw_searchresultiterator_finished (iterator))
     {
       while (lw_searchresultiterator_next (iterator))
       {
         gw_searchwindow_append_result (window, iterator);
       }
+
+      if (lw_searchresultiterator_finished (iterator) && lw_searchresultiterator_empty (iterator))
+      {
+        gw_searchwindow_display_no_results_found_page (window, iterator);
+      }
     }
 
     iterator = priv->mouseiterator;
@@ -395,6 +421,20 @@ gw_searchwindow_append_result_timeout (GwSearchWindow *window)
         }
       }
     }
+}
+
+
+//!
+//! @brief Search watch that refreshes the window whenever one of its searches
+//!        has something new.  Results for background tabs are appended when
+//!        their tab is switched to.
+//!
+gboolean
+gw_searchwindow_search_watch_cb (LwSearch       *search,
+                                 GwSearchWindow *window)
+{
+    gw_searchwindow_update_progress_feedback (window);
+    gw_searchwindow_append_results (window);
 
     return TRUE;
 }
@@ -1816,6 +1856,13 @@ gw_searchwindow_start_search (GwSearchWindow *window,
     if (view == NULL) goto errored;
     sdata = GW_SEARCHDATA (gw_searchdata_new (view, window));
     if (sdata == NULL) goto errored;
+
+    //Searches are restarted when moving through the history, so drop the watch from the last run
+    {
+      GwSearchData *previous = GW_SEARCHDATA (lw_search_get_data (search));
+      if (previous != NULL && previous->watchid != 0) lw_search_remove_watch (search, previous->watchid);
+    }
+
     lw_search_set_data (search, sdata, LW_SEARCH_DATA_FREE_FUNC (gw_searchdata_free));
 
     {
@@ -1829,10 +1876,11 @@ gw_searchwindow_start_search (GwSearchWindow *window,
       }
     }
 
-    LwSearchResultIterator *iterator = lw_searchresultiterator_new (search, "raw");
+    LwSearchResultIterator *iterator = lw_searchresultiterator_new (search);
     gw_searchwindow_set_searchresultiterator_by_index (window, index, iterator);
     gw_searchwindow_initialize_buffer_by_searchresultiterator (sdata->window, iterator);
 
+    sdata->watchid = lw_search_add_watch (search, NULL, (LwSearchWatchFunc) gw_searchwindow_search_watch_cb, window, NULL);
     lw_search_start (search, progress, TRUE);
 
     return;
@@ -1875,7 +1923,8 @@ gw_searchwindow_start_tooltip_search (GwSearchWindow *window,
 
     //Start the search
     if (priv->mouseiterator != NULL) lw_searchresultiterator_free_full (priv->mouseiterator); 
-    priv->mouseiterator = lw_searchresultiterator_new (search, "raw");
+    priv->mouseiterator = lw_searchresultiterator_new (search);
+    lw_search_add_watch (search, NULL, (LwSearchWatchFunc) gw_searchwindow_search_watch_cb, window, NULL);
     lw_search_start (search, progress, TRUE);
 
     priv->mouse_button_press_x = event->x;
@@ -2113,22 +2162,6 @@ gw_searchwindow_attach_signals (GwSearchWindow *window)
           window
     );
 
-    priv->timeoutid[GW_SEARCHWINDOW_TIMEOUTID_PROGRESS] = g_timeout_add_full (
-          G_PRIORITY_LOW, 
-          10, 
-          (GSourceFunc) gw_searchwindow_update_progress_feedback_timeout, 
-          window, 
-          NULL
-    );
-
-    priv->timeoutid[GW_SEARCHWINDOW_TIMEOUTID_APPEND_RESULT] = g_timeout_add_full (
-          G_PRIORITY_LOW, 
-          10, 
-          (GSourceFunc) gw_searchwindow_append_result_timeout, 
-          window, 
-          NULL
-    );
-
 
     g_signal_connect_swapped (G_OBJECT (priv->history), "changed", G_CALLBACK (gw_searchwindow_sync_history), window);
 }
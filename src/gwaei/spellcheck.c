@@ -104,6 +104,7 @@ gw_spellcheck_finalize (GObject *object)
     gw_spellcheck_clear (spellcheck);
 
     if (priv->entry != NULL) gtk_widget_queue_draw (GTK_WIDGET (priv->entry));
+    if (priv->romaji_query != NULL) g_free (priv->romaji_query); priv->romaji_query = NULL;
 
     G_OBJECT_CLASS (gw_spellcheck_parent_class)->finalize (object);
 }
@@ -418,20 +419,32 @@ gw_spellcheck_has_hiragana_conversion (GwSpellcheck *spellcheck)
 {
     //Declarations
     GwSpellcheckPrivate *priv;
-    const gint MAX = 300;
-    gchar kana[MAX];
+    LwRomajiConverter converter;
     const gchar *query;
-    gboolean has_hiragana_conversion;
+    gint length;
     gint rk_conv_setting;
     gboolean want_conv;
 
     priv = spellcheck->priv;
     rk_conv_setting = priv->rk_conv_setting;
     want_conv = (rk_conv_setting == 0 || (rk_conv_setting == 2 && !lw_util_is_japanese_locale()));
+    if (!want_conv) return FALSE;
     query = gtk_entry_get_text (priv->entry);
-    has_hiragana_conversion = (want_conv && lw_util_str_roma_to_hira (query, kana, MAX));
+
+    //Only convert what was typed since the last check when the query grew
+    length = (priv->romaji_query != NULL) ? strlen(priv->romaji_query) : 0;
+    if (priv->romaji_query == NULL || strncmp(query, priv->romaji_query, length) != 0)
+    {
+      lw_romaji_converter_init (&priv->romaji, 0, 0);
+      length = 0;
+    }
+    lw_romaji_converter_feed (&priv->romaji, query + length, -1);
+    if (priv->romaji_query != NULL) g_free (priv->romaji_query);
+    priv->romaji_query = g_strdup (query);
+
+    converter = priv->romaji;
   
-    return has_hiragana_conversion;
+    return lw_romaji_converter_finish (&converter);
 }
 
 
@@ -567,7 +580,7 @@ gw_spellcheck_update (GwSpellcheck *spellcheck)
           LwMorphologyList *morphologylist = lw_morphologyengine_analyze (morphologyengine, *iter, TRUE);
           if (morphologylist != NULL)
           {
-            LwMorphology *morphology = lw_morphologylist_read (morphologylist);
+            LwMorphology *morphology = lw_morphologylist_get_first (morphologylist);
             if (morphology != NULL && morphology->spellcheck != NULL)
               priv->misspelled = g_list_append (priv->misspelled, *iter);
             lw_morphologylist_free (morphologylist); morphologylist = NULL;
@@ -686,7 +699,7 @@ gw_spellcheck_populate_popup (GwSpellcheck *spellcheck,
     gchar **suggestions = NULL;
 
     morphologylist = lw_morphologyengine_analyze (morphologyengine, *iter, TRUE); if (morphologylist == NULL) goto errored;
-    morphology = lw_morphologylist_read (morphologylist); if (morphology == NULL) goto errored;
+    morphology = lw_morphologylist_get_first (morphologylist); if (morphology == NULL) goto errored;
 
     if (morphology->spellcheck != NULL)
     {
@@ -91,6 +91,7 @@ typedef struct StrokeScorer *StrokeScorerPtr;
 
 typedef struct StrokeScorerStruct {
 	CharPtr     m_cpStrokeDic;
+	CharPtr     m_cpStrokeDicEnd;	/* NULL to process up to the null byte */
 	RawStroke*  m_pRawStrokes;
 	UInt        m_iStrokeCnt;
 	ScoreItem*  m_pScores;
@@ -116,6 +117,20 @@ void          StrokeScorerDestroy  (StrokeScorer *pScorer);
  */
 Long          StrokeScorerProcess  (StrokeScorer *pScorer, Long iMaxCnt);
 
+/* Limit processing to the entries from cpStart up to cpEnd, so several
+ * scorers can work on parts of one stroke dic at the same time.  Both must
+ * be entry boundaries, and cpEnd may be NULL for the rest of the dic.
+ */
+void          StrokeScorerSetRange (StrokeScorer *pScorer,
+									CharPtr cpStart, CharPtr cpEnd);
+
+/* Fold the top picks of pSrc into those of pDest.  Ties are broken by
+ * position in the stroke dic so the result is the same as if one scorer
+ * had processed both ranges.
+ */
+void          StrokeScorerMerge    (StrokeScorer *pDest,
+									StrokeScorer *pSrc);
+
 /* Return best diMaxListCount candidates processed so far */
 ListMem*      StrokeScorerTopPicks (StrokeScorer *pScorer);
 
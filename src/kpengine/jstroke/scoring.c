@@ -43,6 +43,9 @@
 
 #define diPathBufLen        16
 
+void      StrokeScorerInsert(StrokeScorer *pScorer, ULong iScore,
+							 CharPtr cpEntry);
+
 CharPtr   StrokeScorerEvalItem(StrokeScorer *pScorer, CharPtr cpEntry,
 							   ULong* ipScore /*OUT*/);
 
@@ -99,6 +102,7 @@ StrokeScorer *StrokeScorerCreate  (CharPtr cpStrokeDic, RawStroke *rsp,
 	}
 
 	pScorer->m_cpStrokeDic = cpStrokeDic;
+	pScorer->m_cpStrokeDicEnd = NULL;
 	pScorer->m_pRawStrokes = rsp;
 	pScorer->m_iStrokeCnt = iStrokeCnt;
 	pScorer->m_iScoreLen = 0;
@@ -140,24 +144,23 @@ void StrokeScorerDestroy  (StrokeScorer *pScorer) {
    to facilitate a progressbar */
 
 Long     StrokeScorerProcess  (StrokeScorer *pScorer, Long iMaxCnt) {
-	CharPtr      cp, cpNext;
+	CharPtr      cp, cpNext, cpEnd;
 	ULong        iScore;
 	Long         iCnt;
-	ScoreItemPtr pScore, pScoreBase, pSrc;
 
 	if (!pScorer) {
 		ErrBox("StrokeScorerProcess: pScorer == NULL.");
 		return 0;
 	}
 
-	pScoreBase = pScorer->m_pScores;
+	cpEnd = pScorer->m_cpStrokeDicEnd;
 
 	/* Evaluate all the items in cpStrokeDic against Context,
 	 * and update ScoreItems list as we go.
 	 */
 
 	iCnt = 0;
-	for (cp = pScorer->m_cpStrokeDic; *cp; cp = cpNext) {
+	for (cp = pScorer->m_cpStrokeDic; *cp && cp != cpEnd; cp = cpNext) {
 
 		iCnt++;
 		if (iMaxCnt >= 0 && iCnt > iMaxCnt)
@@ -165,37 +168,83 @@ Long     StrokeScorerProcess  (StrokeScorer *pScorer, Long iMaxCnt) {
 
 		cpNext = StrokeScorerEvalItem(pScorer, cp, &iScore);
 
-		for (pScore = pScoreBase+pScorer->m_iScoreLen-1;
-			 pScore>=pScoreBase; pScore--) { 
-			if (iScore >= pScore->m_iScore)
-				break;
-		}
-		pScore++;
+		StrokeScorerInsert(pScorer, iScore, cp);
 
-		/* If we have a top score, lets register it. */
-		if (pScore < (pScoreBase + diMaxListCount)) {
+	} /* for each stroke description... */
 
-			/* Increase the score list length if it isn't full yet. */
-			if (pScorer->m_iScoreLen < diMaxListCount)
-				pScorer->m_iScoreLen++;
+	if (*cp && cp != cpEnd)
+		return 1;				/* should be count remaining */
+	else
+		return 0;
+}
 
-			/* Push down all lower scores in the list to make room. */
-			for (pSrc = pScoreBase+pScorer->m_iScoreLen-2; pSrc >= pScore; pSrc--) {
-				pSrc[1].m_iScore = pSrc->m_iScore;
-				pSrc[1].m_cp     = pSrc->m_cp;
-			}
+/* ----- StrokeScorerInsert -------------------------------------------------*/
+/* Register a score if it makes the list.  The list is kept sorted, best
+ * first, and only ever holds diMaxListCount items, so an entry that doesn't
+ * make it is turned away by a single compare against the last one.
+ */
+
+void StrokeScorerInsert(StrokeScorer *pScorer, ULong iScore,
+						CharPtr cpEntry) {
+	ScoreItemPtr pScore, pScoreBase, pSrc;
+
+	pScoreBase = pScorer->m_pScores;
+
+	/* Equal scores stay in stroke dic order. */
+	for (pScore = pScoreBase+pScorer->m_iScoreLen-1;
+		 pScore>=pScoreBase; pScore--) { 
+		if (iScore > pScore->m_iScore ||
+			(iScore == pScore->m_iScore && cpEntry > pScore->m_cp))
+			break;
+	}
+	pScore++;
+
+	/* If we have a top score, lets register it. */
+	if (pScore < (pScoreBase + diMaxListCount)) {
 
-			/* Actually store our info in the list. */
-			pScore->m_iScore = iScore;
-			pScore->m_cp = cp;
+		/* Increase the score list length if it isn't full yet. */
+		if (pScorer->m_iScoreLen < diMaxListCount)
+			pScorer->m_iScoreLen++;
+
+		/* Push down all lower scores in the list to make room. */
+		for (pSrc = pScoreBase+pScorer->m_iScoreLen-2; pSrc >= pScore; pSrc--) {
+			pSrc[1].m_iScore = pSrc->m_iScore;
+			pSrc[1].m_cp     = pSrc->m_cp;
 		}
 
-	} /* for each stroke description... */
+		/* Actually store our info in the list. */
+		pScore->m_iScore = iScore;
+		pScore->m_cp = cpEntry;
+	}
+}
 
-	if (cp)
-		return 1;				/* should be count remaining */
-	else
-		return 0;
+/* ----- StrokeScorerSetRange -----------------------------------------------*/
+
+void StrokeScorerSetRange (StrokeScorer *pScorer,
+						   CharPtr cpStart, CharPtr cpEnd) {
+	if (!pScorer) {
+		ErrBox("StrokeScorerSetRange: pScorer == NULL.");
+		return;
+	}
+
+	pScorer->m_cpStrokeDic = cpStart;
+	pScorer->m_cpStrokeDicEnd = cpEnd;
+}
+
+/* ----- StrokeScorerMerge --------------------------------------------------*/
+
+void StrokeScorerMerge (StrokeScorer *pDest, StrokeScorer *pSrc) {
+	ScoreItemPtr pScore;
+
+	if (!pDest || !pSrc) {
+		ErrBox("StrokeScorerMerge: pScorer == NULL.");
+		return;
+	}
+
+	for (pScore = pSrc->m_pScores;
+		 pScore < (pSrc->m_pScores+pSrc->m_iScoreLen); pScore++) {
+		StrokeScorerInsert(pDest, pScore->m_iScore, pScore->m_cp);
+	}
 }
 
 /* ----- StrokeScorerTopPicks -----------------------------------------------*/
@@ -15,115 +15,56 @@
  * along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+/* kpengine answers the line protocol gwaei used to spawn it for:
+ * strokes come in as lines of "x y x y ..." ended by a blank line,
+ * and the candidates go out as a "K" line of hex JIS codes.  The
+ * recognition itself lives in recognizer.c.
+ */
+
 #include <ctype.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <string.h>
 #include <errno.h>
 #include <glib.h>
-#include "jstroke/jstroke.h"
+#include "recognizer.h"
 
-#define MAX_STROKES 32
 #define BUFLEN 1024
 
-static char *stroke_dicts[MAX_STROKES];
 static char *progname;
 static char *data_file;
+static KpDatabase *database;
 
 void
 load_database()
 {
-  FILE *file;
-  int i;
+  GError *error = NULL;
 
   if (data_file)
-    {
-      file = fopen (data_file, "rb");
-    }
+    database = kp_database_new (data_file, &error);
   else
-    {
-#ifndef G_OS_WIN32
-      gchar *dir = g_strdup (KP_LIBDIR);
-#else
-      gchar *prefix = g_win32_get_package_installation_directory_of_module (NULL);
-      gchar *dir = g_build_filename (prefix, "..", "..", "share", "gwaei", NULL);
-      g_free (prefix);
-#endif
-      char *fname = g_build_filename (dir, "jdata.dat", NULL);
-      file = fopen (fname, "rb");
-      
-      g_free (fname);
-      g_free (dir);
-    }
+    database = kp_database_get_default (&error);
 
-  if (!file)
+  if (!database)
     {
-      fprintf(stderr,"%s: Can't open %s\n", progname,
-	      data_file ? data_file : "jdata.dat");
+      fprintf(stderr, "%s: %s\n", progname, error->message);
+      g_error_free (error);
       exit(1);
     }
-
-
-  for (i=0;i<MAX_STROKES;i++)
-    stroke_dicts[i] = NULL;
-
-  while (1)
-    {
-      int n_read;
-      unsigned int nstrokes;
-      unsigned int len;
-      int buf[2];
-
-      n_read = fread (buf, sizeof(int), 2, file);
-      
-      nstrokes = GUINT32_FROM_BE(buf[0]);
-      len = GUINT32_FROM_BE(buf[1]);
-
-      if ((n_read != 2) || (nstrokes > MAX_STROKES))
-	{
-	  fprintf(stderr, "%s: Corrupt stroke database\n", progname);
-	  exit(1);
-	}
-
-      if (nstrokes == 0)
-	break;
-
-      stroke_dicts[nstrokes] = malloc(len);
-      n_read = fread(stroke_dicts[nstrokes], 1, len, file);
-
-      if (n_read != len)
-	{
-	  fprintf(stderr, "%s: Corrupt stroke database", progname);
-	  exit(1);
-	}
-    }
-  
-  fclose (file);
-}
-
-/* From Ken Lunde's _Understanding Japanese Information Processing_
-   O'Reilly, 1993 */
-
-void 
-sjis2jis(unsigned char *p1, unsigned char *p2)
-{
-  unsigned char c1 = *p1;
-  unsigned char c2 = *p2;
-  int adjust = c2 < 159;
-  int rowOffset = c1 < 160 ? 112 : 176;
-  int cellOffset = adjust ? (c2 > 127 ? 32 : 31) : 126;
-  
-  *p1 = ((c1 - rowOffset) << 1) - adjust;
-  *p2 -= cellOffset;  
 }
 
 int
 process_strokes (FILE *file)
 {
-  RawStroke strokes[MAX_STROKES];
+  GArray *points[KP_MAX_STROKES];
+  KpStroke strokes[KP_MAX_STROKES];
+  KpCandidate candidates[KP_MAX_CANDIDATES];
   char *buffer = malloc(BUFLEN);
   int buflen = BUFLEN;
   int nstrokes = 0;
+  int ncandidates;
+  int finished = 0;
+  int i;
 
   /* Read in strokes from standard in, all points for each stroke
    *  strung together on one line, until we get a blank line
@@ -132,27 +73,35 @@ process_strokes (FILE *file)
   while (1)
     {
       char *p,*q;
-      int len;
+      KpPoint point;
 
       if (!fgets(buffer, buflen, file))
-	return 0;
+	{
+	  finished = 1;
+	  break;
+	}
 
       while ((strlen(buffer) == buflen - 1) && (buffer[buflen-2] != '\n'))
 	{
 	  buflen += BUFLEN;
 	  buffer = realloc(buffer, buflen);
 	  if (!fgets(buffer+buflen-BUFLEN-1, BUFLEN+1, file))
-	    return 0;
+	    {
+	      finished = 1;
+	      break;
+	    }
 	}
+      if (finished)
+	break;
       
-      len = 0;
+      points[nstrokes] = g_array_new (FALSE, FALSE, sizeof(KpPoint));
       p = buffer;
       
       while (1) {
 	while (isspace (*p)) p++;
 	if (*p == 0)
 	  break;
-	strokes[nstrokes].m_x[len] = strtol (p, &q, 0);
+	point.x = strtol (p, &q, 0);
 	if (p == q)
 	  break;
 	p = q;
@@ -160,54 +109,49 @@ process_strokes (FILE *file)
 	while (isspace (*p)) p++;
 	if (*p == 0)
 	  break;
-	strokes[nstrokes].m_y[len] = strtol (p, &q, 0);
+	point.y = strtol (p, &q, 0);
 	if (p == q)
 	  break;
 	p = q;
 	
-	len++;
+	g_array_append_val (points[nstrokes], point);
       }
       
-      if (len == 0)
-	break;
+      if (points[nstrokes]->len == 0)
+	{
+	  g_array_free (points[nstrokes], TRUE);
+	  break;
+	}
       
-      strokes[nstrokes].m_len = len;
+      strokes[nstrokes].points = (KpPoint*) points[nstrokes]->data;
+      strokes[nstrokes].length = points[nstrokes]->len;
       nstrokes++;
-      if (nstrokes == MAX_STROKES)
+      if (nstrokes == KP_MAX_STROKES)
 	break;
     }
   
-  if (nstrokes != 0 && stroke_dicts[nstrokes])
+  if (!finished && nstrokes != 0)
     {
-      int i;
-      ListMem *top_picks;
-      StrokeScorer *scorer = StrokeScorerCreate (stroke_dicts[nstrokes],
-						 strokes, nstrokes);
-      if (scorer)
+      ncandidates = kp_database_recognize (database, strokes, nstrokes,
+					   candidates, KP_MAX_CANDIDATES);
+
+      printf("K");
+      for (i=0;i<ncandidates;i++)
 	{
-	  StrokeScorerProcess(scorer, -1);
-	  top_picks = StrokeScorerTopPicks(scorer);
-	  StrokeScorerDestroy(scorer);
-	  
-	  printf("K");
-	  for (i=0;i<top_picks->m_argc;i++)
-	    {
-	      unsigned char c[2];
-	      if (i)
-		printf(" ");
-	      c[0] = top_picks->m_argv[i][0];
-	      c[1] = top_picks->m_argv[i][1];
-	      sjis2jis(&c[0],&c[1]);
-	      printf("%2x%2x",c[0],c[1]);
-	    }
-	  
-	  free(top_picks);
+	  if (i)
+	    printf(" ");
+	  printf("%2x%2x", candidates[i].jis >> 8, candidates[i].jis & 0xff);
 	}
       printf("\n");
 
       fflush(stdout);
     }
-  return 1;
+
+  for (i=0;i<nstrokes;i++)
+    g_array_free (points[i], TRUE);
+  free (buffer);
+
+  return !finished;
 }
 
 void
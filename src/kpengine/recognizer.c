@@ -0,0 +1,409 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file recognizer.c
+//!
+//! @brief Handwriting recognition with jstroke as a library
+//!
+//! The stroke database is loaded once per process and only read afterwards,
+//! so gwaei and the kpengine program both score strokes in process with as
+//! many lookups running at once as they like.  Candidates come back as
+//! Unicode characters with their scores instead of Shift-JIS text.
+//!
+//! Stroke counts with many characters are split into ranges that are
+//! scored on a thread pool, each keeping its own top candidates, and the
+//! lists are merged at the end.
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include "jstroke/jstroke.h"
+#include "recognizer.h"
+
+
+static GMutex _default_mutex;
+static KpDatabase *_default_database = NULL;
+
+
+//!
+//! @brief A part of a stroke count scored on the pool
+//!
+struct _KpRange {
+  StrokeScorer *scorer;
+  GMutex *mutex;
+  GCond *cond;
+  gint *remaining;       //!< Ranges of the lookup that are still being scored
+};
+typedef struct _KpRange KpRange;
+
+
+//!
+//! @brief Finds where each stroke description starts.  The two bytes of the
+//!        Shift-JIS character come first and the next description starts at
+//!        the following byte with its high bit set.
+//! @returns A new array of the starts followed by the end of the last one
+//!
+static gchar**
+_kp_database_index_strokedic (gchar *strokedic,
+                              gint  *total)
+{
+    //Declarations
+    GPtrArray *entries = NULL;
+    gchar *ptr = NULL;
+
+    //Initializations
+    entries = g_ptr_array_new ();
+    ptr = strokedic;
+
+    while (*ptr != '\0')
+    {
+      g_ptr_array_add (entries, ptr);
+      ptr++;
+      if (*ptr != '\0') ptr++;
+      while (*ptr != '\0' && !((guchar) *ptr & 0x80)) ptr++;
+    }
+
+    *total = entries->len;
+    g_ptr_array_add (entries, ptr);
+
+    return (gchar**) g_ptr_array_free (entries, FALSE);
+}
+
+
+static void
+_kp_range_score (KpRange  *range,
+                 gpointer  data)
+{
+    StrokeScorerProcess (range->scorer, -1);
+
+    g_mutex_lock (range->mutex);
+    (*range->remaining)--;
+    g_cond_signal (range->cond);
+    g_mutex_unlock (range->mutex);
+}
+
+
+//!
+//! @brief Loads a stroke database made by conv_jdata.pl
+//! @param PATH The path of the jdata.dat file
+//! @param error A GError to place errors into or NULL
+//! @returns A new KpDatabase that should be freed with kp_database_free() or NULL on error
+//!
+KpDatabase*
+kp_database_new (const gchar  *PATH,
+                 GError      **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (PATH != NULL, NULL);
+
+    //Declarations
+    KpDatabase *database = NULL;
+    gchar *ptr = NULL;
+    gchar *end = NULL;
+    gsize length = 0;
+    guint32 strokes = 0;
+    guint32 size = 0;
+    gboolean corrupt = FALSE;
+
+    //Initializations
+    database = g_new0 (KpDatabase, 1);
+    if (!g_file_get_contents (PATH, &database->contents, &length, error)) goto errored;
+    ptr = database->contents;
+    end = database->contents + length;
+
+    //Each stroke count is a big endian count and size followed by its null terminated descriptions
+    while (TRUE)
+    {
+      if (end - ptr < 8) { corrupt = TRUE; goto errored; }
+      memcpy (&strokes, ptr, 4); strokes = GUINT32_FROM_BE (strokes);
+      memcpy (&size, ptr + 4, 4); size = GUINT32_FROM_BE (size);
+      ptr += 8;
+
+      if (strokes == 0) break;
+      if (strokes > KP_MAX_STROKES || size == 0 || size > end - ptr || ptr[size - 1] != '\0') { corrupt = TRUE; goto errored; }
+
+      database->strokedics[strokes] = ptr;
+      database->entries[strokes] = _kp_database_index_strokedic (ptr, &database->total_entries[strokes]);
+      ptr += size;
+    }
+
+    database->total_threads = MAX (g_get_num_processors (), 1);
+    if (database->total_threads > 1)
+    {
+      database->pool = g_thread_pool_new ((GFunc) _kp_range_score, NULL, database->total_threads - 1, FALSE, error);
+      if (database->pool == NULL) goto errored;
+    }
+
+    return database;
+
+errored:
+
+    if (corrupt) g_set_error (error, g_quark_from_string (KP_DATABASE_ERROR), KP_DATABASE_CORRUPT_ERROR, "Corrupt stroke database %s", PATH);
+
+    kp_database_free (database);
+
+    return NULL;
+}
+
+
+void
+kp_database_free (KpDatabase *database)
+{
+    //Sanity checks
+    if (database == NULL) return;
+
+    //Declarations
+    gint i = 0;
+
+    if (database->pool != NULL) g_thread_pool_free (database->pool, FALSE, TRUE);
+    for (i = 0; i <= KP_MAX_STROKES; i++)
+    {
+      if (database->entries[i] != NULL) g_free (database->entries[i]);
+    }
+    if (database->contents != NULL) g_free (database->contents);
+
+    memset (database, 0, sizeof(KpDatabase));
+    g_free (database);
+}
+
+
+//!
+//! @returns Where jdata.dat is installed.  Free it with g_free().
+//!
+gchar*
+kp_database_get_default_path (void)
+{
+    //Declarations
+    gchar *directory = NULL;
+    gchar *path = NULL;
+
+#ifndef G_OS_WIN32
+    directory = g_strdup (KP_LIBDIR);
+#else
+    gchar *prefix = g_win32_get_package_installation_directory_of_module (NULL);
+    directory = g_build_filename (prefix, "..", "..", "share", "gwaei", NULL);
+    g_free (prefix);
+#endif
+    path = g_build_filename (directory, KP_DATABASE_FILENAME, NULL);
+
+    g_free (directory);
+
+    return path;
+}
+
+
+//!
+//! @brief Gets the installed stroke database, loading it the first time it is
+//!        asked for.  It stays loaded for the rest of the process.
+//! @param error A GError to place errors into or NULL
+//! @returns The shared KpDatabase, which must not be freed, or NULL on error
+//!
+KpDatabase*
+kp_database_get_default (GError **error)
+{
+    //Declarations
+    KpDatabase *database = NULL;
+    gchar *path = NULL;
+
+    g_mutex_lock (&_default_mutex);
+    if (_default_database == NULL)
+    {
+      path = kp_database_get_default_path ();
+      _default_database = kp_database_new (path, error);
+      g_free (path); path = NULL;
+    }
+    database = _default_database;
+    g_mutex_unlock (&_default_mutex);
+
+    return database;
+}
+
+
+//!
+//! @brief Converts a Shift-JIS character to JIS X 0208.  From Ken Lunde's
+//!        _Understanding Japanese Information Processing_, O'Reilly, 1993.
+//!
+static guint16
+_kp_sjis_to_jis (guchar c1,
+                 guchar c2)
+{
+    //Declarations
+    gint adjust = c2 < 159;
+    gint row_offset = c1 < 160 ? 112 : 176;
+    gint cell_offset = adjust ? (c2 > 127 ? 32 : 31) : 126;
+
+    return ((((c1 - row_offset) << 1) - adjust) << 8) | ((c2 - cell_offset) & 0xff);
+}
+
+
+static gunichar
+_kp_jis_to_unichar (guint16 jis)
+{
+    //Declarations
+    gchar euc[2];
+    gchar *utf8 = NULL;
+    gunichar c = 0;
+
+    //Initializations
+    euc[0] = (jis >> 8) | 0x80;
+    euc[1] = (jis & 0xff) | 0x80;
+
+    utf8 = g_convert (euc, 2, "UTF-8", "EUC-JP", NULL, NULL, NULL);
+    if (utf8 != NULL) c = g_utf8_get_char (utf8);
+
+    g_free (utf8);
+
+    return c;
+}
+
+
+//!
+//! @brief Copies a stroke into the fixed size jstroke format.  Coordinates are
+//!        clamped to a byte and long strokes are resampled evenly so both of
+//!        their ends are kept.  The old engine let coordinates wrap around
+//!        instead, which moved points drawn past an edge to the opposite side.
+//!
+static void
+_kp_rawstroke_set (RawStroke      *rawstroke,
+                   const KpStroke *STROKE)
+{
+    //Declarations
+    gint length = MIN (STROKE->length, diMaxXyPairs);
+    gint i = 0;
+    gint j = 0;
+
+    for (i = 0; i < length; i++)
+    {
+      j = (STROKE->length > diMaxXyPairs) ? (gint) (((gint64) i * (STROKE->length - 1)) / (diMaxXyPairs - 1)) : i;
+      rawstroke->m_x[i] = CLAMP (STROKE->points[j].x, 0, 255);
+      rawstroke->m_y[i] = CLAMP (STROKE->points[j].y, 0, 255);
+    }
+    rawstroke->m_len = length;
+}
+
+
+//!
+//! @brief Ranks the characters with the same number of strokes against the
+//!        drawn strokes.  Safe to call from many threads with the same database.
+//! @param database The KpDatabase to score against
+//! @param STROKES The strokes in the order they were drawn
+//! @param total_strokes The number of strokes
+//! @param candidates Receives the best candidates, best first
+//! @param max The number of candidates there is room for.  No more than
+//!            KP_MAX_CANDIDATES are ever found.
+//! @returns The number of candidates written
+//!
+gint
+kp_database_recognize (KpDatabase     *database,
+                       const KpStroke *STROKES,
+                       gint            total_strokes,
+                       KpCandidate    *candidates,
+                       gint            max)
+{
+    //Sanity checks
+    g_return_val_if_fail (database != NULL, 0);
+    g_return_val_if_fail (STROKES != NULL || total_strokes == 0, 0);
+    g_return_val_if_fail (candidates != NULL, 0);
+    if (total_strokes > KP_MAX_STROKES) total_strokes = KP_MAX_STROKES;
+    if (total_strokes <= 0 || database->strokedics[total_strokes] == NULL) return 0;
+
+    //Declarations
+    RawStroke *rawstrokes = NULL;
+    KpRange *ranges = NULL;
+    StrokeScorer *scorer = NULL;
+    ScoreItem *item = NULL;
+    gchar **entries = NULL;
+    GMutex mutex;
+    GCond cond;
+    guint16 jis = 0;
+    gunichar c = 0;
+    gint total_entries = 0;
+    gint total_ranges = 0;
+    gint remaining = 0;
+    gint total = 0;
+    gint i = 0;
+
+    //Initializations
+    entries = database->entries[total_strokes];
+    total_entries = database->total_entries[total_strokes];
+    total_ranges = (database->pool != NULL) ? CLAMP (total_entries / KP_ENTRIES_PER_RANGE, 1, database->total_threads) : 1;
+    rawstrokes = g_new (RawStroke, total_strokes);
+    for (i = 0; i < total_strokes; i++) _kp_rawstroke_set (&rawstrokes[i], &STROKES[i]);
+    ranges = g_new0 (KpRange, total_ranges);
+    g_mutex_init (&mutex);
+    g_cond_init (&cond);
+
+    //Every scorer is made before any range starts so a failure has nothing to wait for
+    for (i = 0; i < total_ranges; i++)
+    {
+      ranges[i].scorer = StrokeScorerCreate (database->strokedics[total_strokes], rawstrokes, total_strokes);
+      if (ranges[i].scorer == NULL) goto errored;
+      StrokeScorerSetRange (ranges[i].scorer, entries[total_entries * i / total_ranges], entries[total_entries * (i + 1) / total_ranges]);
+      ranges[i].mutex = &mutex;
+      ranges[i].cond = &cond;
+      ranges[i].remaining = &remaining;
+    }
+
+    //The calling thread scores the first range itself
+    remaining = total_ranges - 1;
+    for (i = 1; i < total_ranges; i++) g_thread_pool_push (database->pool, &ranges[i], NULL);
+    StrokeScorerProcess (ranges[0].scorer, -1);
+
+    g_mutex_lock (&mutex);
+    while (remaining > 0) g_cond_wait (&cond, &mutex);
+    g_mutex_unlock (&mutex);
+
+    scorer = ranges[0].scorer;
+    for (i = 1; i < total_ranges; i++) StrokeScorerMerge (scorer, ranges[i].scorer);
+
+    for (i = 0; i < scorer->m_iScoreLen && total < max; i++)
+    {
+      item = &scorer->m_pScores[i];
+      jis = _kp_sjis_to_jis ((guchar) item->m_cp[0], (guchar) item->m_cp[1]);
+      c = _kp_jis_to_unichar (jis); if (c == 0) continue;
+
+      candidates[total].character = c;
+      candidates[total].jis = jis;
+      candidates[total].score = item->m_iScore;
+      total++;
+    }
+
+errored:
+
+    for (i = 0; i < total_ranges; i++)
+    {
+      if (ranges[i].scorer != NULL) StrokeScorerDestroy (ranges[i].scorer); ranges[i].scorer = NULL;
+    }
+    g_mutex_clear (&mutex);
+    g_cond_clear (&cond);
+    if (ranges != NULL) g_free (ranges); ranges = NULL;
+    if (rawstrokes != NULL) g_free (rawstrokes); rawstrokes = NULL;
+
+    return total;
+}
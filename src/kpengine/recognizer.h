@@ -0,0 +1,69 @@
+#ifndef KP_RECOGNIZER_INCLUDED
+#define KP_RECOGNIZER_INCLUDED
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define KP_DATABASE_ERROR "kpengine database error"
+#define KP_DATABASE_FILENAME "jdata.dat"
+#define KP_MAX_STROKES 32     //!< Strokes past this many are ignored
+#define KP_MAX_CANDIDATES 5   //!< How many candidates jstroke keeps
+#define KP_ENTRIES_PER_RANGE 32  //!< The fewest characters worth handing to another thread
+
+typedef enum {
+  KP_DATABASE_CORRUPT_ERROR
+} KpDatabaseError;
+
+
+//!
+//! @brief A point of a stroke in pad coordinates, 0 to 255 with y going down
+//!
+struct _KpPoint {
+  gint x;
+  gint y;
+};
+typedef struct _KpPoint KpPoint;
+
+
+struct _KpStroke {
+  const KpPoint *points;
+  gint length;
+};
+typedef struct _KpStroke KpStroke;
+
+
+struct _KpCandidate {
+  gunichar character;
+  guint16 jis;           //!< The JIS X 0208 code the kpengine protocol reports
+  gulong score;          //!< Lower scores are closer matches
+};
+typedef struct _KpCandidate KpCandidate;
+
+
+//!
+//! @brief The jstroke stroke descriptions grouped by stroke count.  It is
+//!        only read after loading so any number of threads can share it.
+//!
+struct _KpDatabase {
+  gchar *contents;
+  gchar *strokedics[KP_MAX_STROKES + 1];  //!< Null terminated descriptions of the characters with that many strokes
+  gchar **entries[KP_MAX_STROKES + 1];    //!< Where each description starts followed by where the last one ends
+  gint total_entries[KP_MAX_STROKES + 1];
+  GThreadPool *pool;                      //!< Scores ranges of the large stroke counts.  NULL with one processor.
+  gint total_threads;                     //!< The pool threads and the calling thread
+};
+typedef struct _KpDatabase KpDatabase;
+
+
+KpDatabase* kp_database_new (const gchar *PATH, GError **error);
+void kp_database_free (KpDatabase *database);
+
+gchar* kp_database_get_default_path (void);
+KpDatabase* kp_database_get_default (GError **error);
+
+gint kp_database_recognize (KpDatabase *database, const KpStroke *STROKES, gint total_strokes, KpCandidate *candidates, gint max);
+
+G_END_DECLS
+
+#endif
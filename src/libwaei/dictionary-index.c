@@ -45,16 +45,246 @@
 #include <libwaei/dictionary-private.h>
 
 
-static gint _sort_func (gconstpointer a, gconstpointer b, GHashTable *weight_table);
+//!
+//! @brief The candidates of a search shared read-only between the scoring threads
+//!
+struct _LwDictionaryIndexScoreJob {
+  LwDictionary *dictionary;
+  LwMorphologyList *morphologylist;  //!< Its scorer is only read after it is built
+  const LwOffset *offsets;
+  const gint *costs;                 //!< Fuzzy cost of each candidate or NULL
+  gint length;
+  gint max;
+  gint next;                         //!< First candidate of the next unclaimed chunk
+  LwProgress *progress;
+  GMutex mutex;
+  GCond cond;
+  gint pending;                      //!< Tasks pushed to the pool that haven't finished
+};
+typedef struct _LwDictionaryIndexScoreJob LwDictionaryIndexScoreJob;
+
+//!
+//! @brief One share of a job run on the scoring pool
+//!
+struct _LwDictionaryIndexScoreTask {
+  LwDictionaryIndexScoreJob *job;
+  LwResultArray *resultarray;
+};
+typedef struct _LwDictionaryIndexScoreTask LwDictionaryIndexScoreTask;
+
+
+//!
+//! @brief Claims chunks of candidates until there are none left, keeping the
+//!        best max of the ones it scored in a sorted array of its own
+//!
+static LwResultArray*
+_lw_dictionary_index_score_share (LwDictionaryIndexScoreJob *job)
+{
+    //Declarations
+    LwResultArray *resultarray = NULL;
+    gint start = 0;
+    gint end = 0;
+    gint i = 0;
+
+    //Initializations
+    resultarray = (job->max > 0) ? lw_resultarray_new_bounded (job->max) : lw_resultarray_new (LW_DICTIONARY_INDEX_SCORE_CHUNK);
+    if (resultarray == NULL) goto errored;
+
+    while ((start = g_atomic_int_add (&job->next, LW_DICTIONARY_INDEX_SCORE_CHUNK)) < job->length)
+    {
+      if (job->progress != NULL && lw_progress_should_abort (job->progress)) break;
+
+      end = MIN (start + LW_DICTIONARY_INDEX_SCORE_CHUNK, job->length);
+      for (i = start; i < end; i++)
+      {
+        const gchar *HAYSTACK = lw_dictionary_get_string (job->dictionary, job->offsets[i]);
+        gint score = lw_morphologylist_get_score (job->morphologylist, HAYSTACK);
+        lw_resultarray_append (resultarray, job->offsets[i], score, (job->costs != NULL) ? job->costs[i] : 0);
+      }
+    }
+
+    lw_resultarray_sort (resultarray);
+
+errored:
+
+    return resultarray;
+}
+
+
+static void
+_lw_dictionary_index_score_task (LwDictionaryIndexScoreTask *task,
+                                 gpointer                    data)
+{
+    //Declarations
+    LwDictionaryIndexScoreJob *job = task->job;
+
+    task->resultarray = _lw_dictionary_index_score_share (job);
+
+    g_mutex_lock (&job->mutex);
+      job->pending--;
+      g_cond_signal (&job->cond);
+    g_mutex_unlock (&job->mutex);
+}
+
+
+static gsize
+_lw_dictionary_index_score_pool_new (void)
+{
+    //Declarations
+    gint total_threads = g_get_num_processors () - 1;
+
+    if (total_threads < 1) return 1;
+
+    return GPOINTER_TO_SIZE (g_thread_pool_new ((GFunc) _lw_dictionary_index_score_task, NULL, total_threads, FALSE, NULL));
+}
+
+
+//!
+//! @brief Returns the scoring threads shared by every search in the process.
+//!        Searches running at the same time share them instead of each
+//!        starting a thread per processor.
+//! @returns The pool or NULL if there is only one processor
+//!
+static GThreadPool*
+_lw_dictionary_index_get_score_pool (void)
+{
+    static gsize pool = 0;
+
+    if (g_once_init_enter (&pool))
+    {
+      g_once_init_leave (&pool, _lw_dictionary_index_score_pool_new ());
+    }
+
+    return (pool == 1) ? NULL : (GThreadPool*) GSIZE_TO_POINTER (pool);
+}
+
+
+//!
+//! @brief Scores the candidates on the calling thread and the shared scoring
+//!        pool and merges what each of them kept.  Small candidate sets are
+//!        scored on the calling thread alone since handing them off would
+//!        cost more.  The calling thread keeps claiming chunks, so a search
+//!        still finishes when the pool is busy with other searches.
+//! @param offsets The candidate lines
+//! @param costs The fuzzy cost of each candidate or NULL if they are exact matches
+//! @param length The number of candidates
+//! @param max The number of results kept or 0 for all of them
+//! @returns A sorted LwResultArray
+//!
+static LwResultArray*
+_lw_dictionary_index_score (LwDictionary     *dictionary,
+                            LwMorphologyList *morphologylist,
+                            const LwOffset   *offsets,
+                            const gint       *costs,
+                            gint              length,
+                            gint              max,
+                            LwProgress       *progress)
+{
+    //Declarations
+    LwDictionaryIndexScoreJob job;
+    LwDictionaryIndexScoreTask *tasks = NULL;
+    LwResultArray **resultarrays = NULL;
+    LwResultArray *resultarray = NULL;
+    GThreadPool *pool = NULL;
+    gint total_shares = 0;
+    gint i = 0;
+
+    //Initializations
+    job.dictionary = dictionary;
+    job.morphologylist = morphologylist;
+    job.offsets = offsets;
+    job.costs = costs;
+    job.length = length;
+    job.max = max;
+    job.next = 0;
+    job.progress = progress;
+    job.pending = 0;
+    pool = _lw_dictionary_index_get_score_pool ();
+    total_shares = (pool == NULL) ? 1 : MIN (g_thread_pool_get_max_threads (pool) + 1, (length + LW_DICTIONARY_INDEX_SCORE_CHUNK - 1) / LW_DICTIONARY_INDEX_SCORE_CHUNK);
+
+    if (total_shares <= 1) return _lw_dictionary_index_score_share (&job);
+
+    //Build the scorer up front so the threads don't wait on each other for it
+    lw_morphologylist_get_scorer (morphologylist);
+
+    g_mutex_init (&job.mutex);
+    g_cond_init (&job.cond);
+
+    tasks = g_new0 (LwDictionaryIndexScoreTask, total_shares); if (tasks == NULL) goto errored;
+    resultarrays = g_new0 (LwResultArray*, total_shares); if (resultarrays == NULL) goto errored;
+
+    //The calling thread takes the first share itself
+    for (i = 1; i < total_shares; i++)
+    {
+      tasks[i].job = &job;
+      g_mutex_lock (&job.mutex);
+        job.pending++;
+      g_mutex_unlock (&job.mutex);
+      g_thread_pool_push (pool, tasks + i, NULL);
+    }
+    resultarrays[0] = _lw_dictionary_index_score_share (&job);
+
+    g_mutex_lock (&job.mutex);
+      while (job.pending > 0) g_cond_wait (&job.cond, &job.mutex);
+    g_mutex_unlock (&job.mutex);
+
+    for (i = 1; i < total_shares; i++)
+    {
+      resultarrays[i] = tasks[i].resultarray; tasks[i].resultarray = NULL;
+    }
+
+    resultarray = lw_resultarray_merge_sorted (resultarrays, total_shares, max);
+
+errored:
+
+    if (resultarrays != NULL)
+    {
+      for (i = 0; i < total_shares; i++) lw_resultarray_free (resultarrays[i]);
+      g_free (resultarrays); resultarrays = NULL;
+    }
+    if (tasks != NULL) g_free (tasks); tasks = NULL;
+
+    g_mutex_clear (&job.mutex);
+    g_cond_clear (&job.cond);
+
+    return resultarray;
+}
+
+
+static LwIndexTableType
+_lw_dictionary_index_flag_to_table_type (LwIndexFlag flag)
+{
+    switch (flag) {
+      case LW_INDEX_FLAG_RAW:
+        return LW_INDEX_TABLE_RAW;
+      case LW_INDEX_FLAG_NORMALIZED:
+        return LW_INDEX_TABLE_NORMALIZED;
+      case LW_INDEX_FLAG_STEM_INSENSITIVE:
+        return LW_INDEX_TABLE_STEM;
+      case LW_INDEX_FLAG_CANONICAL:
+        return LW_INDEX_TABLE_CANONICAL;
+      default:
+        g_assert_not_reached ();
+        return LW_INDEX_TABLE_INVALID;
+    }
+}
 
 
 //Public methods/////////////////////////////////////////////////
 
 
+//!
+//! @brief Looks up the morphologies of a query in the index and ranks the lines
+//!        that contain them
+//! @param max The number of results kept per category or 0 for all of them.
+//!            Only the best ones are kept so broad queries cost O(n log max).
+//! @returns A category name to LwResultArray table or NULL
+//!
 GHashTable*
 lw_dictionary_index_search (LwDictionary     *dictionary, 
                             LwMorphologyList *morphologylist,
                             LwIndexFlag       flags,
+                            gint              max,
                             LwProgress       *progress)
 {
     //Sanity checks
@@ -75,50 +305,33 @@ lw_dictionary_index_search (LwDictionary     *dictionary,
     };
     gint i = 0;
     LwIndexTableType type = 0;
-    GHashTable *resulttable = g_hash_table_new_full (g_str_hash, g_str_equal, (GDestroyNotify) g_free, (GDestroyNotify) g_list_free); 
+    GHashTable *resulttable = g_hash_table_new_full (g_str_hash, g_str_equal, (GDestroyNotify) g_free, (GDestroyNotify) lw_resultarray_free); 
 
     for (i = 0; i < G_N_ELEMENTS(flag_list); i++)
     {
-      switch (flag_list[i]) {
-        case LW_INDEX_FLAG_RAW:
-          type = LW_INDEX_TABLE_RAW;
-          break;
-        case LW_INDEX_FLAG_NORMALIZED:
-          type = LW_INDEX_TABLE_NORMALIZED;
-          break;
-        case LW_INDEX_FLAG_STEM_INSENSITIVE:
-          type = LW_INDEX_TABLE_STEM;
-          break;
-        case LW_INDEX_FLAG_CANONICAL:
-          type = LW_INDEX_TABLE_CANONICAL;
-          break;
-        default:
-          g_assert_not_reached ();
-          type = LW_INDEX_TABLE_INVALID;
-          break;
-      }
+      type = _lw_dictionary_index_flag_to_table_type (flag_list[i]);
 
-      GHashTable *weight_table = g_hash_table_new (g_direct_hash, g_direct_equal);
       const gchar *CATEGORY = lw_index_table_type_to_string (type);
 
       //The raw index concat only occurs of the morphology of the query is different than the raw form
       if (flags & flag_list[i])
       {
         GList *matchlist = lw_index_get_matches_for_morphologylist (index, type, morphologylist);
+        gint length = g_list_length (matchlist);
+        LwOffset *offsets = g_new (LwOffset, MAX (length, 1));
         GList *link = NULL;
-        for (link = matchlist; link != NULL; link = link->next)
+        gint j = 0;
+        for (link = matchlist, j = 0; link != NULL; link = link->next, j++)
         {
-          LwOffset offset = GPOINTER_TO_OFFSET (link->data);
-          const gchar *HAYSTACK = lw_dictionary_get_string (dictionary, offset);
-          gint score = lw_morphologylist_get_score (morphologylist, HAYSTACK);
-          g_hash_table_insert (weight_table, LW_OFFSET_TO_POINTER (offset), GINT_TO_POINTER (score));
+          offsets[j] = GPOINTER_TO_OFFSET (link->data);
         }
-        matchlist = g_list_sort_with_data (matchlist, (GCompareDataFunc) _sort_func, weight_table);
-        
-        g_hash_table_insert (resulttable, g_strdup (CATEGORY), matchlist);
-      }
+        if (matchlist != NULL) g_list_free (matchlist); matchlist = NULL;
+
+        LwResultArray *resultarray = _lw_dictionary_index_score (dictionary, morphologylist, offsets, NULL, length, max, progress);
+        g_free (offsets); offsets = NULL;
 
-      if (weight_table != NULL) g_hash_table_unref (weight_table); weight_table = NULL;
+        if (resultarray != NULL) g_hash_table_insert (resulttable, g_strdup (CATEGORY), resultarray);
+      }
     }
 
     return resulttable;
@@ -131,6 +344,166 @@ errored:
 }
 
 
+//!
+//! @brief Answers a boolean query like "cats&dogs" or "cats|dogs" from the
+//!        postings of the index instead of scanning the dictionary with a regex
+//! @param indexquery The parsed query
+//! @param max The number of results kept per category or 0 for all of them
+//! @returns A category name to LwResultArray table or NULL
+//!
+GHashTable*
+lw_dictionary_index_query_search (LwDictionary *dictionary,
+                                  LwIndexQuery *indexquery,
+                                  LwIndexFlag   flags,
+                                  gint          max,
+                                  LwProgress   *progress)
+{
+    //Sanity checks
+    g_return_val_if_fail (dictionary != NULL, NULL);
+    g_return_val_if_fail (indexquery != NULL, NULL);
+    g_return_val_if_fail (lw_dictionary_index_is_loaded (dictionary), NULL);
+
+    lw_progress_set_object (progress, dictionary);
+
+    //Declarations
+    LwDictionaryPrivate *priv = dictionary->priv;
+    LwIndex *index = priv->index;
+    LwIndexFlag flag_list[] = {
+      LW_INDEX_FLAG_RAW,
+      LW_INDEX_FLAG_NORMALIZED,
+      LW_INDEX_FLAG_STEM_INSENSITIVE,
+      LW_INDEX_FLAG_CANONICAL
+    };
+    gint i = 0;
+    LwIndexTableType type = 0;
+    gchar *terms = NULL;
+    LwMorphologyList *morphologylist = NULL;
+    LwOffset *offsets = NULL;
+    gint length = 0;
+    LwResultArray *resultarray = NULL;
+    GHashTable *resulttable = NULL;
+
+    //Initializations
+    terms = lw_indexquery_get_terms (indexquery);
+    morphologylist = lw_morphologyengine_analyze (priv->morphologyengine, terms, TRUE); if (morphologylist == NULL) goto errored;
+    resulttable = g_hash_table_new_full (g_str_hash, g_str_equal, (GDestroyNotify) g_free, (GDestroyNotify) lw_resultarray_free); 
+
+    for (i = 0; i < G_N_ELEMENTS(flag_list); i++)
+    {
+      if (!(flags & flag_list[i])) continue;
+      if (progress != NULL && lw_progress_should_abort (progress)) break;
+
+      type = _lw_dictionary_index_flag_to_table_type (flag_list[i]);
+      offsets = lw_indexquery_get_matches (indexquery, index, type, &length);
+      resultarray = _lw_dictionary_index_score (dictionary, morphologylist, offsets, NULL, length, max, progress);
+      if (offsets != NULL) g_free (offsets); offsets = NULL;
+
+      if (resultarray != NULL) g_hash_table_insert (resulttable, g_strdup (lw_index_table_type_to_string (type)), resultarray);
+      resultarray = NULL;
+    }
+
+errored:
+
+    if (morphologylist != NULL) lw_morphologylist_unref (morphologylist); morphologylist = NULL;
+    if (terms != NULL) g_free (terms); terms = NULL;
+
+    return resulttable;
+}
+
+
+///!
+///! @brief Approximate version of lw_dictionary_index_search() used when an exact
+///!        lookup found nothing.  Each morphology may be misspelled by up to
+///!        LW_INDEX_FUZZY_MAX_DISTANCE edits.  Results are merged over the
+///!        enabled tables and ranked by edit distance and then by score.
+///! @param max The number of results kept or 0 for all of them
+///! @returns A result table with a single "raw" category or NULL
+///!
+GHashTable*
+lw_dictionary_index_fuzzy_search (LwDictionary     *dictionary, 
+                                  LwMorphologyList *morphologylist,
+                                  LwIndexFlag       flags,
+                                  gint              max,
+                                  LwProgress       *progress)
+{
+    //Sanity checks
+    g_return_val_if_fail (dictionary != NULL, NULL);
+    if (morphologylist == NULL) return NULL;
+    g_return_val_if_fail (lw_dictionary_index_is_loaded (dictionary), NULL);
+
+    lw_progress_set_object (progress, dictionary);
+
+    //Declarations
+    LwDictionaryPrivate *priv = dictionary->priv;
+    LwIndex *index = priv->index;
+    LwIndexFlag flag_list[] = {
+      LW_INDEX_FLAG_RAW,
+      LW_INDEX_FLAG_NORMALIZED,
+      LW_INDEX_FLAG_STEM_INSENSITIVE,
+      LW_INDEX_FLAG_CANONICAL
+    };
+    LwIndexTableType type_list[] = {
+      LW_INDEX_TABLE_RAW,
+      LW_INDEX_TABLE_NORMALIZED,
+      LW_INDEX_TABLE_STEM,
+      LW_INDEX_TABLE_CANONICAL
+    };
+    gint i = 0;
+    GHashTable *cost_table = g_hash_table_new (g_direct_hash, g_direct_equal);
+    GHashTable *resulttable = NULL;
+    LwResultArray *resultarray = NULL;
+    GHashTableIter iter;
+    gpointer key = NULL, value = NULL, previous = NULL;
+    LwOffset *offsets = NULL;
+    gint *costs = NULL;
+    gint length = 0;
+
+    //Merge the cheapest cost of every offset over the enabled tables
+    for (i = 0; i < G_N_ELEMENTS(flag_list); i++)
+    {
+      if (!(flags & flag_list[i])) continue;
+      if (lw_progress_should_abort (progress)) goto errored;
+
+      GHashTable *matches = lw_index_get_fuzzy_matches_for_morphologylist (index, type_list[i], morphologylist, LW_INDEX_FUZZY_MAX_DISTANCE);
+      if (matches == NULL) continue;
+
+      g_hash_table_iter_init (&iter, matches);
+      while (g_hash_table_iter_next (&iter, &key, &value))
+      {
+        if (g_hash_table_lookup_extended (cost_table, key, NULL, &previous) && GPOINTER_TO_INT (previous) <= GPOINTER_TO_INT (value)) continue;
+        g_hash_table_insert (cost_table, key, value);
+      }
+
+      g_hash_table_unref (matches); matches = NULL;
+    }
+
+    //Score the candidates
+    length = g_hash_table_size (cost_table);
+    offsets = g_new (LwOffset, MAX (length, 1));
+    costs = g_new (gint, MAX (length, 1));
+    g_hash_table_iter_init (&iter, cost_table);
+    for (i = 0; g_hash_table_iter_next (&iter, &key, &value); i++)
+    {
+      offsets[i] = GPOINTER_TO_OFFSET (key);
+      costs[i] = GPOINTER_TO_INT (value);
+    }
+    resultarray = _lw_dictionary_index_score (dictionary, morphologylist, offsets, costs, length, max, progress);
+    if (resultarray == NULL) goto errored;
+
+    resulttable = g_hash_table_new_full (g_str_hash, g_str_equal, (GDestroyNotify) g_free, (GDestroyNotify) lw_resultarray_free); 
+    g_hash_table_insert (resulttable, g_strdup (lw_index_table_type_to_string (LW_INDEX_TABLE_RAW)), resultarray); resultarray = NULL;
+
+errored:
+
+    if (resultarray != NULL) lw_resultarray_free (resultarray); resultarray = NULL;
+    if (offsets != NULL) g_free (offsets); offsets = NULL;
+    if (costs != NULL) g_free (costs); costs = NULL;
+    if (cost_table != NULL) g_hash_table_unref (cost_table); cost_table = NULL;
+
+    return resulttable;
+}
+
+
 gboolean
 lw_dictionary_index_is_valid (LwDictionary *dictionary)
 {
@@ -142,6 +515,7 @@ lw_dictionary_index_is_valid (LwDictionary *dictionary)
     LwDictionaryData *dictionarydata = priv->data;
 
     if (index == NULL || index->checksum == NULL) return FALSE;
+    if (index->version != LW_INDEX_FORMAT_VERSION) return FALSE;
     if (dictionarydata == NULL || dictionarydata->checksum == NULL) return FALSE;
 
     return (strcmp(index->checksum, dictionarydata->checksum) == 0);
@@ -297,6 +671,7 @@ lw_dictionary_index_load (LwDictionary *dictionary,
     if (lw_dictionary_index_is_loaded (dictionary) && !lw_dictionary_index_is_valid (dictionary))
     {
       lw_index_free (priv->index); priv->index = NULL;
+      lw_resultcache_clear (priv->resultcache);
     }
 
     //Try reading the index file
@@ -305,12 +680,14 @@ lw_dictionary_index_load (LwDictionary *dictionary,
       priv->index = lw_index_new (priv->morphologyengine);
       lw_index_read (priv->index, index_path, progress);
 //      lw_index_validate_offsetlists (priv->index, priv->data);
+      lw_resultcache_clear (priv->resultcache);
     }
 
     //Check if it is valid
     if (lw_dictionary_index_is_loaded (dictionary) && !lw_dictionary_index_is_valid (dictionary))
     {
       lw_index_free (priv->index); priv->index = NULL;
+      lw_resultcache_clear (priv->resultcache);
     }
 
 errored:
@@ -319,29 +696,3 @@ errored:
 
     return (priv->index != NULL);
 }
-
-
-//Private methods/////////////////////////////////////////////////
-
-
-static gint
-_sort_func (gconstpointer a, gconstpointer b, GHashTable *weight_table)
-{
-    //Declarations / Initializations
-    LwOffset offset_a = GPOINTER_TO_OFFSET (a);
-    gint weight_a = GPOINTER_TO_INT (g_hash_table_lookup (weight_table, a));
-    LwOffset offset_b = GPOINTER_TO_OFFSET (b);
-    gint weight_b = GPOINTER_TO_INT (g_hash_table_lookup (weight_table, b));
-
-    if (weight_a < weight_b) return 1;
-    else if (weight_a > weight_b) return -1;
-    else
-    {
-      if (offset_a <  offset_b) return 1;
-      if (offset_a >  offset_b) return -1;
-      else return 0;
-    }
-
-    g_assert_not_reached ();
-    return 0;
-}
@@ -45,10 +45,21 @@
 #include <libwaei/dictionary-private.h>
 
 
+//!
+//! @brief Scans the dictionary for lines matching PATTERN in the order they
+//!        appear in
+//! @param max Stop after this many matches or 0 to scan the whole dictionary
+//! @param resume Where to start the scan or NULL to start at the beginning.
+//!               Set to where the scan can continue when it stopped at max
+//!               or 0 when it reached the end.
+//! @returns A result table with a single "raw" category or NULL
+//!
 GHashTable*
 lw_dictionary_regex_search (LwDictionary  *dictionary,
                             const gchar   *PATTERN,
                             LwIndexFlag    flags,
+                            gint           max,
+                            LwOffset      *resume,
                             LwProgress    *progress)
 {
     //Sanity checks
@@ -59,7 +70,7 @@ lw_dictionary_regex_search (LwDictionary  *dictionary,
     //Declarations
     LwDictionaryData *dictionarydata = dictionary->priv->data;
     GHashTable *resulttable = NULL;
-    GList *matchlist = NULL;
+    LwResultArray *resultarray = NULL;
     GRegex *regex = NULL;
     const gchar *BUFFER = NULL;
     LwOffset offset = 0;
@@ -70,8 +81,12 @@ lw_dictionary_regex_search (LwDictionary  *dictionary,
     //Initializations
     regex = g_regex_new (PATTERN, G_REGEX_OPTIMIZE, 0, &progress->error); if (regex == NULL) goto errored;
     BUFFER = lw_dictionary_get_buffer (dictionary); if (BUFFER == NULL) goto errored;
-    length = lw_dictionarydata_get_length (dictionary->priv->data);
+    dictionarydata = dictionary->priv->data;
+    length = lw_dictionarydata_get_length (dictionarydata);
+    if (resume != NULL && *resume > 0) BUFFER = lw_dictionarydata_get_string (dictionarydata, *resume); if (BUFFER == NULL) goto errored;
+    if (resume != NULL) *resume = 0;
     DICTIONARY_NAME = lw_dictionary_get_name (dictionary);
+    resultarray = lw_resultarray_new (0);
 
     lw_progress_set_primary_message (progress, "Searching %d dictionary...", DICTIONARY_NAME);
 
@@ -79,10 +94,17 @@ lw_dictionary_regex_search (LwDictionary  *dictionary,
       offset = lw_dictionarydata_get_offset (dictionarydata, BUFFER);
       if (g_regex_match (regex, BUFFER, 0, NULL) == TRUE)
       {
-        matchlist = g_list_append (matchlist, LW_OFFSET_TO_POINTER (offset));
+        lw_resultarray_append (resultarray, offset, 0, 0);
       }
       lw_progress_set_fraction (progress, offset, length);
 
+      if (max > 0 && lw_resultarray_length (resultarray) >= max)
+      {
+        BUFFER = lw_dictionarydata_buffer_next (dictionarydata, BUFFER);
+        if (BUFFER != NULL && resume != NULL) *resume = lw_dictionarydata_get_offset (dictionarydata, BUFFER);
+        break;
+      }
+
 /* TODO
       if (chunk > LW_SEARCH_MAX_CHUNK) 
       {
@@ -95,14 +117,90 @@ lw_dictionary_regex_search (LwDictionary  *dictionary,
 */
     } while ((BUFFER = lw_dictionarydata_buffer_next (dictionarydata, BUFFER)) != NULL && !lw_progress_should_abort (progress));
 
-    resulttable = g_hash_table_new_full (g_str_hash, g_str_equal, (GDestroyNotify) g_free, (GDestroyNotify) g_list_free); 
+    resulttable = g_hash_table_new_full (g_str_hash, g_str_equal, (GDestroyNotify) g_free, (GDestroyNotify) lw_resultarray_free); 
     const gchar *CATEGORY = lw_index_table_type_to_string (LW_INDEX_TABLE_RAW);
-    g_hash_table_insert (resulttable, g_strdup (CATEGORY), matchlist);
+    g_hash_table_insert (resulttable, g_strdup (CATEGORY), resultarray); resultarray = NULL;
 
 errored:
 
+    if (resultarray != NULL) lw_resultarray_free (resultarray); resultarray = NULL;
     if (regex != NULL) g_regex_unref (regex); regex = NULL;
 
     return resulttable;
 }
 
+
+
+//!
+//! @brief Like lw_dictionary_regex_search() but only checks the lines in
+//!        candidates.  Used when the pattern is a refinement of a previous
+//!        search so the whole dictionary doesn't have to be scanned again.
+//! @param candidates A category name to LwResultArray table of an earlier search
+//! @returns A result table with the candidates that still match in their
+//!          original order or NULL
+//!
+GHashTable*
+lw_dictionary_regex_refine (LwDictionary  *dictionary,
+                            const gchar   *PATTERN,
+                            GHashTable    *candidates,
+                            LwIndexFlag    flags,
+                            LwProgress    *progress)
+{
+    //Sanity checks
+    g_return_val_if_fail (dictionary != NULL, NULL);
+    g_return_val_if_fail (PATTERN != NULL, NULL);
+    g_return_val_if_fail (candidates != NULL, NULL);
+    g_return_val_if_fail (progress != NULL, NULL);
+
+    //Declarations
+    GHashTable *resulttable = NULL;
+    LwResultArray *candidatearray = NULL;
+    LwResultArray *resultarray = NULL;
+    LwResultArrayEntry *entry = NULL;
+    GRegex *regex = NULL;
+    const gchar *TEXT = NULL;
+    GHashTableIter iter;
+    gpointer key = NULL, value = NULL;
+    gint current = 0;
+    gint total = 0;
+    gint i = 0;
+
+    //Initializations
+    regex = g_regex_new (PATTERN, G_REGEX_OPTIMIZE, 0, &progress->error); if (regex == NULL) goto errored;
+    if (lw_dictionary_get_buffer (dictionary) == NULL) goto errored;
+    resulttable = g_hash_table_new_full (g_str_hash, g_str_equal, (GDestroyNotify) g_free, (GDestroyNotify) lw_resultarray_free); 
+
+    g_hash_table_iter_init (&iter, candidates);
+    while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      total += lw_resultarray_length (LW_RESULTARRAY (value));
+    }
+
+    lw_progress_set_primary_message (progress, "Searching %s dictionary...", lw_dictionary_get_name (dictionary));
+
+    g_hash_table_iter_init (&iter, candidates);
+    while (g_hash_table_iter_next (&iter, &key, &value) && !lw_progress_should_abort (progress))
+    {
+      candidatearray = LW_RESULTARRAY (value);
+      resultarray = lw_resultarray_new (lw_resultarray_length (candidatearray));
+
+      for (i = 0; i < lw_resultarray_length (candidatearray) && !lw_progress_should_abort (progress); i++)
+      {
+        entry = lw_resultarray_index (candidatearray, i);
+        TEXT = lw_dictionary_get_string (dictionary, entry->offset);
+        if (TEXT != NULL && g_regex_match (regex, TEXT, 0, NULL) == TRUE)
+        {
+          lw_resultarray_append (resultarray, entry->offset, entry->score, entry->cost);
+        }
+        lw_progress_set_fraction (progress, ++current, total);
+      }
+
+      g_hash_table_insert (resulttable, g_strdup ((gchar*) key), resultarray); resultarray = NULL;
+    }
+
+errored:
+
+    if (regex != NULL) g_regex_unref (regex); regex = NULL;
+
+    return resulttable;
+}
@@ -156,6 +156,8 @@ lw_dictionary_init (LwDictionary *dictionary)
 {
     dictionary->priv = LW_DICTIONARY_GET_PRIVATE (dictionary);
     memset(dictionary->priv, 0, sizeof(LwDictionaryPrivate));
+
+    dictionary->priv->resultcache = lw_resultcache_new (LW_RESULTCACHE_DEFAULT_MAX_SIZE);
 }
 
 
@@ -177,6 +179,7 @@ lw_dictionary_finalize (GObject *object)
 
     if (priv->index != NULL) lw_index_free (priv->index); 
     if (priv->data != NULL) lw_dictionarydata_free (priv->data);
+    if (priv->resultcache != NULL) lw_resultcache_free (priv->resultcache);
 
     memset(dictionary->priv, 0, sizeof(LwDictionaryPrivate));
 
@@ -205,6 +208,7 @@ lw_dictionary_set_property (GObject      *object,
         if (priv->name != NULL) g_free (priv->name); priv->name = g_strdup (priv->filename);
         if (priv->index != NULL) lw_index_free (priv->index); priv->index = NULL;
         if (priv->data != NULL) lw_dictionarydata_free (priv->data); priv->data = NULL;
+        lw_resultcache_clear (priv->resultcache);
         break;
       case PROP_MORPHOLOGYENGINE:
         if (priv->morphologyengine != NULL) g_object_unref (priv->morphologyengine); 
@@ -793,3 +797,35 @@ lw_dictionary_get_string (LwDictionary *dictionary,
     return lw_dictionarydata_get_string (priv->data, offset);
 }
 
+
+//!
+//! @brief Gets the checksum of the loaded dictionary data that identifies
+//!        this version of the dictionary
+//! @returns The checksum or NULL if the data isn't loaded yet
+//!
+const gchar*
+lw_dictionary_get_checksum (LwDictionary *dictionary)
+{
+    //Sanity checks
+    g_return_val_if_fail (dictionary != NULL, NULL);
+
+    //Declarations
+    LwDictionaryPrivate *priv;
+
+    //Initializations
+    priv = dictionary->priv;
+    if (priv->data == NULL) return NULL;
+
+    return lw_dictionarydata_get_checksum (priv->data);
+}
+
+
+LwResultCache*
+lw_dictionary_get_resultcache (LwDictionary *dictionary)
+{
+    //Sanity checks
+    g_return_val_if_fail (dictionary != NULL, NULL);
+
+    return dictionary->priv->resultcache;
+}
+
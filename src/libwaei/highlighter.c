@@ -0,0 +1,244 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file highlighter.c
+//!
+//! @brief Marks up the parts of result fields that a query matched
+//!
+//! Plain queries reuse the Aho-Corasick automaton that scored the results, so
+//! a field is highlighted with one linear pass over it instead of compiling
+//! and running a regex for every field that is displayed.  Regex queries are
+//! compiled once per search.
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <libwaei/libwaei.h>
+#include <libwaei/gettext.h>
+
+
+//!
+//! @brief Compiles a query for highlighting
+//! @param engine The LwMorphologyEngine the query was analyzed with when it was searched
+//! @param QUERY The query text
+//! @returns A new LwHighlighter that should be freed with lw_highlighter_free()
+//!
+LwHighlighter*
+lw_highlighter_new (LwMorphologyEngine *engine,
+                    const gchar        *QUERY)
+{
+    //Sanity checks
+    g_return_val_if_fail (engine != NULL, NULL);
+    g_return_val_if_fail (QUERY != NULL, NULL);
+
+    //Declarations
+    LwHighlighter *highlighter = NULL;
+    gchar *pattern = NULL;
+
+    //Initializations
+    highlighter = g_new0 (LwHighlighter, 1); if (highlighter == NULL) goto errored;
+
+    //The analysis is usually still in the cache from when the query was searched
+    if (!lw_util_has_regex_char (QUERY) && strpbrk (QUERY, "\\+{}") == NULL)
+    {
+      highlighter->morphologylist = lw_morphologyengine_analyze (engine, QUERY, TRUE);
+      if (highlighter->morphologylist != NULL) highlighter->scorer = lw_morphologylist_get_scorer (highlighter->morphologylist);
+      if (highlighter->scorer != NULL && highlighter->scorer->total_patterns > 0) return highlighter;
+    }
+
+    //Regexes, and queries that didn't give any forms, are matched as they were typed
+    if (lw_util_is_regex_pattern (QUERY, NULL)) pattern = g_strdup (QUERY);
+    else pattern = g_regex_escape_string (QUERY, -1);
+    highlighter->regex = g_regex_new (pattern, G_REGEX_OPTIMIZE, 0, NULL);
+    g_free (pattern); pattern = NULL;
+
+    return highlighter;
+
+errored:
+
+    lw_highlighter_free (highlighter); highlighter = NULL;
+
+    return NULL;
+}
+
+
+void
+lw_highlighter_free (LwHighlighter *highlighter)
+{
+    //Sanity checks
+    if (highlighter == NULL) return;
+
+    if (highlighter->morphologylist != NULL) lw_morphologylist_unref (highlighter->morphologylist);
+    if (highlighter->regex != NULL) g_regex_unref (highlighter->regex);
+
+    memset (highlighter, 0, sizeof(LwHighlighter));
+    g_free (highlighter);
+}
+
+
+//!
+//! @brief Finds the matched parts of TEXT with a single pass over it
+//! @param highlighter The compiled query
+//! @param TEXT The text to search.  It does not have to be null terminated.
+//! @param length The length of TEXT in bytes or -1 if it is null terminated
+//! @param spans Receives the byte offsets of the matched parts sorted by position.
+//!              Touching matches are merged.
+//! @param max The number of spans there is room for
+//! @returns The number of spans written
+//!
+gint
+lw_highlighter_get_spans (LwHighlighter   *highlighter,
+                          const gchar     *TEXT,
+                          gint             length,
+                          LwHighlightSpan *spans,
+                          gint             max)
+{
+    //Sanity checks
+    g_return_val_if_fail (highlighter != NULL, 0);
+    g_return_val_if_fail (TEXT != NULL, 0);
+    g_return_val_if_fail (spans != NULL, 0);
+    if (length < 0) length = strlen(TEXT);
+
+    //Declarations
+    GMatchInfo *match_info = NULL;
+    gint start_offset = 0;
+    gint end_offset = 0;
+    gint total = 0;
+
+    if (highlighter->regex == NULL)
+    {
+      if (highlighter->scorer == NULL) return 0;
+      return lw_morphologyscorer_get_spans (highlighter->scorer, TEXT, length, spans, max);
+    }
+
+    g_regex_match_full (highlighter->regex, TEXT, length, 0, 0, &match_info, NULL);
+    while (g_match_info_matches (match_info) && total < max)
+    {
+      if (g_match_info_fetch_pos (match_info, 0, &start_offset, &end_offset) && end_offset > start_offset)
+      {
+        if (total > 0 && start_offset <= spans[total - 1].end_offset)
+        {
+          spans[total - 1].end_offset = end_offset;
+        }
+        else
+        {
+          spans[total].start_offset = start_offset;
+          spans[total].end_offset = end_offset;
+          total++;
+        }
+      }
+      g_match_info_next (match_info, NULL);
+    }
+    g_match_info_free (match_info); match_info = NULL;
+
+    return total;
+}
+
+
+//!
+//! @brief Converts the byte offsets of spans into character offsets for
+//!        interfaces like GtkTextBuffer.  TEXT is walked once for all of them.
+//! @param TEXT The text the spans were found in
+//! @param spans Spans sorted by position as lw_highlighter_get_spans() returns them
+//! @param total The number of spans
+//!
+void
+lw_highlighter_spans_to_characters (const gchar     *TEXT,
+                                    LwHighlightSpan *spans,
+                                    gint             total)
+{
+    //Sanity checks
+    g_return_if_fail (TEXT != NULL);
+    g_return_if_fail (spans != NULL || total == 0);
+
+    //Declarations
+    const gchar *ptr = TEXT;
+    gint characters = 0;
+    gint *offset = NULL;
+    gint i = 0;
+
+    for (i = 0; i < total * 2; i++)
+    {
+      offset = (i % 2 == 0) ? &spans[i / 2].start_offset : &spans[i / 2].end_offset;
+      while (ptr < TEXT + *offset)
+      {
+        ptr = g_utf8_next_char (ptr);
+        characters++;
+      }
+      *offset = characters;
+    }
+}
+
+
+//!
+//! @brief Copies TEXT with OPEN and CLOSE around the parts the query matched
+//! @param highlighter The compiled query
+//! @param TEXT The null terminated text to highlight
+//! @param OPEN Inserted before each match, such as a terminal color escape
+//! @param CLOSE Inserted after each match
+//! @returns A newly allocated string that should be freed with g_free()
+//!
+gchar*
+lw_highlighter_highlight (LwHighlighter *highlighter,
+                          const gchar   *TEXT,
+                          const gchar   *OPEN,
+                          const gchar   *CLOSE)
+{
+    //Sanity checks
+    g_return_val_if_fail (highlighter != NULL, NULL);
+    g_return_val_if_fail (TEXT != NULL, NULL);
+    g_return_val_if_fail (OPEN != NULL, NULL);
+    g_return_val_if_fail (CLOSE != NULL, NULL);
+
+    //Declarations
+    LwHighlightSpan spans[LW_HIGHLIGHTER_MAX_SPANS];
+    GString *output = NULL;
+    gint length = 0;
+    gint total = 0;
+    gint position = 0;
+    gint i = 0;
+
+    //Initializations
+    length = strlen(TEXT);
+    total = lw_highlighter_get_spans (highlighter, TEXT, length, spans, LW_HIGHLIGHTER_MAX_SPANS);
+    if (total == 0) return g_strdup (TEXT);
+    output = g_string_sized_new (length + total * (strlen(OPEN) + strlen(CLOSE)));
+
+    for (i = 0; i < total; i++)
+    {
+      g_string_append_len (output, TEXT + position, spans[i].start_offset - position);
+      g_string_append (output, OPEN);
+      g_string_append_len (output, TEXT + spans[i].start_offset, spans[i].end_offset - spans[i].start_offset);
+      g_string_append (output, CLOSE);
+      position = spans[i].end_offset;
+    }
+    g_string_append_len (output, TEXT + position, length - position);
+
+    return g_string_free (output, FALSE);
+}
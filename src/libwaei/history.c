@@ -334,6 +334,24 @@ lw_history_get_combined_list (LwHistory *history)
 }
 
 
+//!
+//! @brief Only the query of a search is needed while it is in the history.  The
+//!        results are dropped and come back from the result cache when the
+//!        search is started again.
+//!
+static void
+_lw_history_release_results (LwSearchResultIterator *iterator)
+{
+    if (iterator == NULL || iterator->search == NULL) return;
+
+    lw_search_cancel (iterator->search);
+    lw_search_clear_results (iterator->search);
+    iterator->array = NULL;
+    iterator->length = 0;
+    lw_searchresultiterator_rewind (iterator);
+}
+
+
 //!
 //! @brief Moves an search to the back history
 //!
@@ -350,6 +368,7 @@ lw_history_add_search (LwHistory              *history,
     priv = history->priv;
     klass = LW_HISTORY_CLASS (G_OBJECT_GET_CLASS (history));
     
+    _lw_history_release_results (iterator);
     priv->back = g_list_prepend (priv->back, iterator);
 
     //Make sure the history hasn't gotten too long
@@ -411,6 +430,7 @@ lw_history_go_back (LwHistory              *history,
 
     if (pushed != NULL)
     {
+      _lw_history_release_results (pushed);
       priv->forward = g_list_append (priv->forward, pushed);
     }
 
@@ -452,6 +472,7 @@ lw_history_go_forward (LwHistory *history, LwSearchResultIterator *pushed)
 
     if (pushed != NULL)
     {
+      _lw_history_release_results (pushed);
       priv->back = g_list_append (priv->back, pushed);
     }
 
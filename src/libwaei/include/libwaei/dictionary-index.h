@@ -3,8 +3,12 @@
 
 G_BEGIN_DECLS
 
+#define LW_DICTIONARY_INDEX_SCORE_CHUNK 512 //!< Candidates a scoring thread claims at a time
 
-GHashTable* lw_dictionary_index_search (LwDictionary *dictionary, LwMorphologyList *morphologylist, LwIndexFlag flags, LwProgress *progress);
+
+GHashTable* lw_dictionary_index_search (LwDictionary *dictionary, LwMorphologyList *morphologylist, LwIndexFlag flags, gint max, LwProgress *progress);
+GHashTable* lw_dictionary_index_query_search (LwDictionary *dictionary, LwIndexQuery *indexquery, LwIndexFlag flags, gint max, LwProgress *progress);
+GHashTable* lw_dictionary_index_fuzzy_search (LwDictionary *dictionary, LwMorphologyList *morphologylist, LwIndexFlag flags, gint max, LwProgress *progress);
 void lw_dictionary_index_create (LwDictionary *dictionary, LwProgress*progress);
 gboolean lw_dictionary_index_load (LwDictionary *dictionary, LwProgress*progress);
 
@@ -8,6 +8,7 @@ struct _LwDictionaryPrivate {
     gchar *filename;
     LwIndex *index;
     LwDictionaryData *data;
+    LwResultCache *resultcache;  //!< Results of recent searches, cleared whenever data or index change
     LwMorphologyEngine *morphologyengine;
     gdouble progress;
     size_t length;       //!< Length of the file
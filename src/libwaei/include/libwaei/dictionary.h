@@ -85,10 +85,13 @@ gchar* lw_dictionary_get_index_path (LwDictionary *dictionary);
 
 const gchar* lw_dictionary_get_buffer (LwDictionary *dictionary);
 const gchar* lw_dictionary_get_string (LwDictionary *dictionary, LwOffset offset);
+const gchar* lw_dictionary_get_checksum (LwDictionary *dictionary);
+LwResultCache* lw_dictionary_get_resultcache (LwDictionary *dictionary);
 
 gboolean lw_dictionary_index_is_valid (LwDictionary *dictionary);
 
-GHashTable* lw_dictionary_regex_search (LwDictionary *dictionary, const gchar *PATTERN, LwIndexFlag flags, LwProgress *progress);
+GHashTable* lw_dictionary_regex_search (LwDictionary *dictionary, const gchar *PATTERN, LwIndexFlag flags, gint max, LwOffset *resume, LwProgress *progress);
+GHashTable* lw_dictionary_regex_refine (LwDictionary *dictionary, const gchar *PATTERN, GHashTable *candidates, LwIndexFlag flags, LwProgress *progress);
 
 
 G_END_DECLS
@@ -0,0 +1,31 @@
+#ifndef LW_HIGHLIGHTER_INCLUDED
+#define LW_HIGHLIGHTER_INCLUDED 
+
+G_BEGIN_DECLS
+
+#define LW_HIGHLIGHTER_MAX_SPANS LW_MORPHOLOGYSCORER_MAX_MATCHES  //!< Matches past this many in one field aren't highlighted
+
+typedef LwMorphologyScorerSpan LwHighlightSpan;
+
+//!
+//! @brief Finds the parts of result fields that a query matched so the
+//!        interfaces can mark them up without compiling the query again
+//!
+struct _LwHighlighter {
+  LwMorphologyList *morphologylist;  //!< Shared with the analysis cache of the search
+  LwMorphologyScorer *scorer;        //!< The automaton the results were scored with
+  GRegex *regex;                     //!< Used instead of the scorer for regex queries
+};
+typedef struct _LwHighlighter LwHighlighter;
+
+
+LwHighlighter* lw_highlighter_new (LwMorphologyEngine *engine, const gchar *QUERY);
+void lw_highlighter_free (LwHighlighter *highlighter);
+
+gint lw_highlighter_get_spans (LwHighlighter *highlighter, const gchar *TEXT, gint length, LwHighlightSpan *spans, gint max);
+void lw_highlighter_spans_to_characters (const gchar *TEXT, LwHighlightSpan *spans, gint total);
+gchar* lw_highlighter_highlight (LwHighlighter *highlighter, const gchar *TEXT, const gchar *OPEN, const gchar *CLOSE);
+
+G_END_DECLS
+
+#endif
@@ -14,6 +14,8 @@ G_END_DECLS
 G_BEGIN_DECLS
 
 #define LW_INDEX_CHECKSUM_TYPE G_CHECKSUM_SHA256
+#define LW_INDEX_FORMAT_MAGIC "lwindex"
+#define LW_INDEX_FORMAT_VERSION 1  //!< Bump when the layout of the files or the normalization of the keys changes
 #define LW_OFFSET_FORMAT G_GUINT32_FORMAT
 #define GPOINTER_TO_OFFSET(x) GPOINTER_TO_UINT(x)
 #define LW_OFFSET_TO_POINTER(x) GUINT_TO_POINTER(x)
@@ -37,15 +39,48 @@ typedef enum {
   LW_INDEX_FLAG_CANONICAL = (LW_INDEX_FLAG_CASE_INSENSITIVE | LW_INDEX_FLAG_FURIGANA_INSENSITIVE | LW_INDEX_FLAG_STEM_INSENSITIVE)
 } LwIndexFlag;
 
+#define LW_INDEX_FUZZY_EDIT_COST 2  //!< Cost of a regular insertion, deletion, substitution or transposition
+#define LW_INDEX_FUZZY_MINOR_COST 1 //!< Cost of kana edits that are commonly mistyped (ー, っ, small kana)
+#define LW_INDEX_FUZZY_MAX_DISTANCE 2
+
+#define LW_INDEX_POSITION_SECTION_SHIFT 16
+#define LW_INDEX_POSITION_MAX_TOKEN ((1 << LW_INDEX_POSITION_SECTION_SHIFT) - 1)
+#define LW_INDEX_POSITION(section, token) (((section) << LW_INDEX_POSITION_SECTION_SHIFT) | MIN ((token), LW_INDEX_POSITION_MAX_TOKEN))
+
+//!
+//! @brief Where a key occurs in a line.  The position is the section of the
+//!        line in the high bits and the word in the section in the low ones
+//!        so words in different sections are never next to each other.
+//!
+struct _LwIndexPosition {
+  LwOffset offset;
+  guint32 position;
+};
+typedef struct _LwIndexPosition LwIndexPosition;
+
 struct _LwIndex {
   gchar *buffer[TOTAL_LW_INDEX_TABLES];
   const gchar *checksum;
+  gint version;  //!< The LW_INDEX_FORMAT_VERSION the index was created or read with
   GHashTable *table[TOTAL_LW_INDEX_TABLES];
+  gchar *positions_buffer[TOTAL_LW_INDEX_TABLES];
+  GHashTable *positions[TOTAL_LW_INDEX_TABLES];  //!< Key to a length prefixed array of offset and position pairs or NULL without the positional layer
+  const gchar **keys[TOTAL_LW_INDEX_TABLES]; //!< Lazily built sorted keys of each table used for fuzzy lookups
+  gint keys_length[TOTAL_LW_INDEX_TABLES];
   gchar *path;
   LwMorphologyEngine *morphologyengine;
 };
 typedef struct _LwIndex LwIndex;
 
+//!
+//! @brief A key of an index table that is within a certain edit distance of a query
+//!
+struct _LwIndexFuzzyMatch {
+  const gchar *KEY;  //!< Key owned by the LwIndex table
+  gint cost;         //!< Weighted edit distance where a full edit is LW_INDEX_FUZZY_EDIT_COST
+};
+typedef struct _LwIndexFuzzyMatch LwIndexFuzzyMatch;
+
 
 LwIndex* lw_index_new (LwMorphologyEngine *morphologyengine);
 void lw_index_free (LwIndex *index);
@@ -68,9 +103,19 @@ void lw_index_create (LwIndex *index, LwDictionaryData *dictionarydata, LwProgre
 gboolean lw_index_exists (const gchar *PATH);
 
 GList* lw_index_get_matches_for_morphologylist (LwIndex *index, LwIndexTableType type, LwMorphologyList *morphologylist);
+gint lw_index_count_offsets_for_morphology (LwIndex *index, LwIndexTableType type, LwMorphology *morphology);
+LwOffset* lw_index_get_sorted_offsets_for_morphology (LwIndex *index, LwIndexTableType type, LwMorphology *morphology, gint *length);
+gboolean lw_index_has_positions (LwIndex *index, LwIndexTableType type);
+LwIndexPosition* lw_index_get_sorted_positions_for_morphology (LwIndex *index, LwIndexTableType type, LwMorphology *morphology, gint *length);
 
 const gchar* lw_index_table_type_to_string (LwIndexTableType type);
 
+const gchar** lw_index_get_sorted_keys (LwIndex *index, LwIndexTableType type, gint *length);
+void lw_index_clear_sorted_keys (LwIndex *index);
+gint lw_index_fuzzy_get_max_distance (const gchar *KEY);
+GList* lw_index_get_fuzzy_keys (LwIndex *index, LwIndexTableType type, const gchar *KEY, gint max_distance);
+GHashTable* lw_index_get_fuzzy_matches_for_morphologylist (LwIndex *index, LwIndexTableType type, LwMorphologyList *morphologylist, gint max_distance);
+
 G_END_DECLS
 
 #endif
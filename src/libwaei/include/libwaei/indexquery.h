@@ -0,0 +1,41 @@
+#ifndef LW_INDEXQUERY_INCLUDED
+#define LW_INDEXQUERY_INCLUDED
+
+G_BEGIN_DECLS
+
+#define LW_INDEXQUERY(object) (LwIndexQuery*) object
+
+typedef enum {
+  LW_INDEXQUERY_TERM,    //!< Lines with every morphology of the text
+  LW_INDEXQUERY_PHRASE,  //!< A quoted TERM
+  LW_INDEXQUERY_AND,     //!< Lines matching every child.  NOT children are taken away.
+  LW_INDEXQUERY_OR,      //!< Lines matching any child
+  LW_INDEXQUERY_NOT      //!< Lines not matching the only child.  Only allowed in an AND.
+} LwIndexQueryType;
+
+
+//!
+//! @brief A boolean query like "cats&dogs", "cats|dogs", "cats&!dogs",
+//!        "\"take off\"" or "\"take off\"~3" parsed into a plan over the
+//!        postings of an LwIndex
+//!
+struct _LwIndexQuery {
+  LwIndexQueryType type;
+  gchar *text;                        //!< What a TERM or PHRASE looks for
+  GList *children;                    //!< The operands of an AND, OR or NOT
+  LwMorphologyList *morphologylist;   //!< Analysis of text made when it is first needed
+  gint distance;                      //!< Words a PHRASE may span after ~N or 0 when they must be adjacent and in order
+};
+typedef struct _LwIndexQuery LwIndexQuery;
+
+
+LwIndexQuery* lw_indexquery_new (const gchar *QUERY);
+void lw_indexquery_free (LwIndexQuery *query);
+
+gint lw_indexquery_estimate (LwIndexQuery *query, LwIndex *index, LwIndexTableType type);
+LwOffset* lw_indexquery_get_matches (LwIndexQuery *query, LwIndex *index, LwIndexTableType type, gint *length);
+gchar* lw_indexquery_get_terms (LwIndexQuery *query);
+
+G_END_DECLS
+
+#endif
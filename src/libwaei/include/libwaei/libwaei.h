@@ -6,8 +6,12 @@
 #include <libwaei/progress.h>
 #include <libwaei/io.h>
 #include <libwaei/utilities.h>
+#include <libwaei/romaji.h>
 #include <libwaei/morphology.h>
 #include <libwaei/index.h>
+#include <libwaei/indexquery.h>
+#include <libwaei/resultarray.h>
+#include <libwaei/resultcache.h>
 #include <libwaei/preferences.h>
 #include <libwaei/vocabulary.h>
 #include <libwaei/dictionary.h>
@@ -17,6 +21,7 @@
 #include <libwaei/unknowndictionary.h>
 #include <libwaei/dictionarylist.h>
 #include <libwaei/result.h>
+#include <libwaei/highlighter.h>
 #include <libwaei/search.h>
 #include <libwaei/searchresultiterator.h>
 #include <libwaei/history.h>
@@ -14,16 +14,24 @@ struct _LwMorphology {
   gchar *spellcheck;     //!< Spellchecking results delimeted by ;.  NULL if is Japanese or it seems correct.
   gchar *explanation;    //!< Free-form explanation of the morphological analysis. NULL if none.
   gint start_offset;     //!< Bytes from the beginning of the string for the original word
-  gint end_offset;       //!< Byte length of the original word
+  gint end_offset;       //!< Bytes from the beginning of the string to the end of the original word
   gchar *regex_pattern;
   GRegex *regex;
 };
 typedef struct _LwMorphology LwMorphology;
 #define LW_MORPHOLOGY(obj) (LwMorphology*)obj
 
+//!
+//! @brief Receives the morphologies of an analysis one at a time.  The morphology is
+//!        only valid during the call.  A string may be kept by setting its field to NULL.
+//!
+typedef void (*LwMorphologyFunc) (LwMorphology *morphology, gpointer data);
+
 //Methods
 LwMorphology* lw_morphology_new (gchar *word, gchar *normalized, gchar *stem, gchar *canonical, gchar *spellcheck, gchar *explanation, gint start_offset, gint end_offset);
 void lw_morphology_free (LwMorphology*);
+void lw_morphology_init (LwMorphology *morphology, gchar *word, gchar *normalized, gchar *stem, gchar *canonical, gchar *spellcheck, gchar *explanation, gint start_offset, gint end_offset);
+void lw_morphology_clear (LwMorphology *morphology);
 
 const gchar* lw_morphology_get_raw (LwMorphology *morphology);
 const gchar* lw_morphology_get_normalized (LwMorphology *morphology);
@@ -41,5 +49,6 @@ G_END_DECLS
 
 #endif
 
+#include "morphologyscorer.h"
 #include "morphologylist.h"
 #include "morphologyengine.h"
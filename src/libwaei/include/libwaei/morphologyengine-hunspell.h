@@ -1,8 +1,8 @@
 #ifndef LW_MORPHOLOGYENGINE_HUNSPELL_INCLUDED
 #define LW_MORPHOLOGYENGINE_HUNSPELL_INCLUDED 
 
-GList* lw_morphologyengine_hunspell_analyze (LwMorphologyEngine *engine, const gchar* TEXT, gboolean include_spellcheck);
-Hunhandle* lw_morphologyengine_hunspell_new (const gchar*);
+void lw_morphologyengine_hunspell_analyze (LwMorphologyEngineContext *context, const gchar* TEXT, gboolean include_spellcheck, LwMorphologyFunc func, gpointer data);
+gchar* lw_morphologyengine_hunspell_find_dictionary (const gchar *PREFERED_LOCALE);
+Hunhandle* lw_morphologyengine_hunspell_new (const gchar *PATH);
 
 #endif
-
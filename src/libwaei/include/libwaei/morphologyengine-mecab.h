@@ -1,7 +1,9 @@
 #ifndef LW_MORPHOLOGYENGINE_MECAB_INCLUDED
 #define LW_MORPHOLOGYENGINE_MECAB_INCLUDED 
 
-GList* lw_morphologyengine_mecab_analyze (LwMorphologyEngine*, const gchar*);
-mecab_t* lw_morphologyengine_mecab_new (void);
+void lw_morphologyengine_mecab_analyze (LwMorphologyEngineContext *context, const gchar *HAYSTACK, LwMorphologyFunc func, gpointer data);
+mecab_model_t* lw_morphologyengine_mecab_model_new (void);
+gboolean lw_morphologyengine_mecab_context_init (LwMorphologyEngineContext *context, mecab_model_t *model);
+void lw_morphologyengine_mecab_context_clear (LwMorphologyEngineContext *context);
 
 #endif
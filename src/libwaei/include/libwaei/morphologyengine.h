@@ -7,6 +7,7 @@
 #endif
 #ifdef HAVE_HUNSPELL
 #include <hunspell/hunspell.h>
+#include "stemtable.h"
 #endif
 
 #include "morphologyindex.h"
@@ -18,6 +19,7 @@ G_BEGIN_DECLS
 typedef struct _LwMorphologyEngine LwMorphologyEngine;
 typedef struct _LwMorphologyEngineClass LwMorphologyEngineClass;
 typedef struct _LwMorphologyEnginePrivate LwMorphologyEnginePrivate;
+typedef struct _LwMorphologyEngineContext LwMorphologyEngineContext;
 
 #define LW_TYPE_MORPHOLOGYENGINE              (lw_morphologyengine_get_type())
 #define LW_MORPHOLOGYENGINE(obj)              (G_TYPE_CHECK_INSTANCE_CAST((obj), LW_TYPE_MORPHOLOGYENGINE, LwMorphologyEngine))
@@ -27,18 +29,61 @@ typedef struct _LwMorphologyEnginePrivate LwMorphologyEnginePrivate;
 #define LW_MORPHOLOGYENGINE_GET_CLASS(obj)    (G_TYPE_INSTANCE_GET_CLASS((obj), LW_TYPE_MORPHOLOGYENGINE, LwMorphologyEngineClass))
 
 #define LW_MORPHOLOGY_SPELLCHECK_DELIMITOR ";"
+#define LW_MORPHOLOGYENGINE_CACHE_SIZE 256
+
+//!
+//! @brief Receives the morphologies of lw_morphologyengine_analyze_batch().  index is the
+//!        position of the analyzed string.  See LwMorphologyFunc for ownership.
+//!
+typedef void (*LwMorphologyEngineBatchFunc) (gint index, LwMorphology *morphology, gpointer data);
+
+
+//!
+//! @brief Bounded LRU cache of analysis results keyed by text and spellcheck flag
+//!
+struct _LwMorphologyEngineCache {
+  GHashTable *table;  //!< Key to GList link in the queue
+  GQueue queue;       //!< Most recently used first.  Links hold LwMorphologyEngineCacheEntry
+  gint max;
+  guint hits;
+  guint misses;
+};
+typedef struct _LwMorphologyEngineCache LwMorphologyEngineCache;
+
+
+//!
+//! @brief The mutable per-thread state of an analysis.  A context may only be
+//!        used by one thread at a time, but any number of them can analyze in
+//!        parallel without locking.
+//!
+struct _LwMorphologyEngineContext {
+#ifdef HAVE_MECAB
+  mecab_t *mecab;            //!< Tagger created from the engine's shared model
+  mecab_lattice_t *lattice;  //!< Reused for every parse of this context
+  gboolean utf8;             //!< The dictionary is UTF-8 so nodes can be read without conversion
+#endif
+#ifdef HAVE_HUNSPELL
+  Hunhandle *hunspell;
+  LwStemTable *stemtable;    //!< Borrowed from the engine
+#endif
+};
 
 
 struct _LwMorphologyEngine {
   GObject object;
   GMutex mutex;
 #ifdef HAVE_MECAB
-  mecab_t *mecab;
+  mecab_model_t *mecab_model;  //!< Read only dictionary shared by every context
 #endif
 #ifdef HAVE_HUNSPELL
-  Hunhandle *hunspell;
+  gchar *hunspell_path;        //!< Resolved dictionary path without the .aff/.dic extension
+  LwStemTable *stemtable;      //!< Memoized stems shared by every context
 #endif
   gchar *locale;
+  LwMorphologyEngineCache cache; //!< Protected by the mutex
+  GAsyncQueue *contextpool;      //!< Idle LwMorphologyEngineContexts
+  gint max_contexts;
+  gint total_contexts;           //!< Contexts made so far, idle or not.  Never more than max_contexts.
 };
 
 struct _LwMorphologyEngineClass {
@@ -51,6 +96,18 @@ GType lw_morphologyengine_get_type (void) G_GNUC_CONST;
 //Methods
 LwMorphologyEngine* lw_morphologyengine_new (const gchar*);
 LwMorphologyList* lw_morphologyengine_analyze (LwMorphologyEngine *engine, const gchar *TEXT, gboolean spellcheck);
+LwMorphologyList* lw_morphologyengine_analyze_uncached (LwMorphologyEngine *engine, const gchar *TEXT, gboolean spellcheck);
+
+LwMorphologyEngineContext* lw_morphologyengine_acquire_context (LwMorphologyEngine *engine);
+void lw_morphologyengine_release_context (LwMorphologyEngine *engine, LwMorphologyEngineContext *context);
+LwMorphologyList* lw_morphologyengine_context_analyze (LwMorphologyEngineContext *context, const gchar *TEXT, gboolean spellcheck);
+void lw_morphologyengine_context_analyze_foreach (LwMorphologyEngineContext *context, const gchar *TEXT, gboolean spellcheck, LwMorphologyFunc func, gpointer data);
+void lw_morphologyengine_analyze_batch (LwMorphologyEngine *engine, const gchar * const *TEXTS, gint length, gboolean spellcheck, LwMorphologyEngineBatchFunc func, gpointer data);
+
+void lw_morphologyengine_set_cache_size (LwMorphologyEngine *engine, gint max);
+void lw_morphologyengine_clear_cache (LwMorphologyEngine *engine);
+void lw_morphologyengine_get_cache_stats (LwMorphologyEngine *engine, guint *hits, guint *misses, gint *length);
+gdouble lw_morphologyengine_get_cache_hit_rate (LwMorphologyEngine *engine);
 
 #endif
 
@@ -7,16 +7,21 @@ G_BEGIN_DECLS
 
 struct _LwMorphologyList {
     GList *list;
-    GList *link;
+    GList *link;  //!< Read cursor.  Don't use it on lists shared through the analysis cache
+    gint refcount;
+    LwMorphologyScorer *scorer;  //!< Compiled lazily by lw_morphologylist_get_scorer()
 };
 typedef struct _LwMorphologyList LwMorphologyList;
 
 
 LwMorphologyList* lw_morphologylist_new_from_list (GList *list);
 void  lw_morphologylist_free (LwMorphologyList *morphologylist);
+LwMorphologyList* lw_morphologylist_ref (LwMorphologyList *morphologylist);
+void lw_morphologylist_unref (LwMorphologyList *morphologylist);
 
 void lw_morphologylist_rewind (LwMorphologyList *morphologylist);
 LwMorphology* lw_morphologylist_read (LwMorphologyList *morphologylist);
+LwMorphology* lw_morphologylist_get_first (LwMorphologyList *morphologylist);
 
 LwMorphology* lw_morphologylist_find (LwMorphologyList *morphologylist, const gchar* WORD);
 gchar* lw_morphologylist_to_string (LwMorphologyList *morphologylist);
@@ -29,6 +34,7 @@ gchar const** lw_morphologylist_get_canonical (LwMorphologyList *morphologylist)
 gint lw_morphologylist_length (LwMorphologyList *morphologylist);
 
 GList* lw_morphologylist_get_morphologyindexlist (LwMorphologyList *morphologylist, const gchar *HAYSTACK); 
+LwMorphologyScorer* lw_morphologylist_get_scorer (LwMorphologyList *morphologylist);
 gint lw_morphologylist_get_score (LwMorphologyList *morphologylist, const gchar *HAYSTACK);
 
 G_END_DECLS
@@ -0,0 +1,60 @@
+#ifndef LW_MORPHOLOGYSCORER_INCLUDED
+#define LW_MORPHOLOGYSCORER_INCLUDED 
+
+G_BEGIN_DECLS
+
+#define LW_MORPHOLOGYSCORER_MAX_MATCHES 128  //!< Matches past this many in one section are ignored
+#define LW_MORPHOLOGYSCORER_BUFFER_SIZE 1024 //!< Haystacks shorter than this are scored without allocating
+
+//!
+//! @brief A node of the Aho-Corasick automaton.  Children are kept as a sibling list
+//!        since queries only have a handful of forms.
+//!
+struct _LwMorphologyScorerNode {
+  gint first_child;
+  gint next_sibling;
+  gint fail;         //!< Longest proper suffix that is also a prefix of some form
+  gint output;       //!< Nearest node on the fail chain (excluding this one) that ends a form or -1
+  gint pattern;      //!< First form ending at this node or -1.  The rest are chained through pattern_next
+  guchar c;
+};
+typedef struct _LwMorphologyScorerNode LwMorphologyScorerNode;
+
+
+//!
+//! @brief Every form of every morphology of a query compiled into one automaton
+//!        so a haystack can be scored in a single pass
+//!
+struct _LwMorphologyScorer {
+  LwMorphologyScorerNode *nodes;
+  gint length;
+  gint *pattern_morphology;  //!< Morphology each form belongs to
+  gint *pattern_form;        //!< Priority of the form inside its morphology (raw, normalized, stem, canonical)
+  gint *pattern_length;      //!< Byte length of each form
+  gint *pattern_next;        //!< Next form ending at the same node or -1
+  gint total_patterns;
+  gint total_morphologies;
+};
+typedef struct _LwMorphologyScorer LwMorphologyScorer;
+
+
+//!
+//! @brief Byte offsets of a part of a haystack that the query matched
+//!
+struct _LwMorphologyScorerSpan {
+  gint start_offset;
+  gint end_offset;
+};
+typedef struct _LwMorphologyScorerSpan LwMorphologyScorerSpan;
+
+
+LwMorphologyScorer* lw_morphologyscorer_new (GList *morphologies);
+void lw_morphologyscorer_free (LwMorphologyScorer *scorer);
+
+gint lw_morphologyscorer_get_score (LwMorphologyScorer *scorer, const gchar *HAYSTACK);
+gint lw_morphologyscorer_get_section_score (LwMorphologyScorer *scorer, const gchar *SECTION, gint length);
+gint lw_morphologyscorer_get_spans (LwMorphologyScorer *scorer, const gchar *TEXT, gint length, LwMorphologyScorerSpan *spans, gint max);
+
+G_END_DECLS
+
+#endif
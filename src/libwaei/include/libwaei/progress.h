@@ -12,6 +12,7 @@ typedef struct _LwProgress LwProgress;
 
 //Callback prototype
 typedef gint (*LwProgressCallback) (gpointer object, LwProgress *progress, gpointer data);
+typedef void (*LwProgressNotifyFunc) (LwProgress *progress, gpointer data);
 
 //Class
 struct _LwProgress {
@@ -48,6 +49,9 @@ struct _LwProgress {
 
   gboolean finished;
   gboolean changed;
+
+  LwProgressNotifyFunc notify_func; //!< Called from the working thread when changed is set
+  gpointer notify_data;
 };
 
 //Methods
@@ -58,6 +62,7 @@ void lw_progress_set_fraction (LwProgress *progress, gdouble current_progress, g
 gdouble lw_progress_get_fraction (LwProgress *progress);
 
 gboolean lw_progress_changed (LwProgress *progress);
+void lw_progress_set_notify_func (LwProgress *progress, LwProgressNotifyFunc notify_func, gpointer notify_data);
 void lw_progress_clear_changed (LwProgress *progress);
 gboolean lw_progress_errored (LwProgress *progress);
 gboolean lw_progress_is_cancelled (LwProgress *progress);
@@ -25,6 +25,7 @@ typedef enum {
 } LwRegexDataIndex;
 
 gchar* lw_regex_remove_parenthesis (const gchar* TEXT);
+gchar* lw_regex_remove_parenthesis_with_offsets (const gchar *TEXT, gint **offsets);
 gchar* lw_regex_remove_kanji_dictionary_spacers (const gchar* TEXT);
 
 gboolean lw_regex_get_japanese_matches (const gchar *HAYSTACK, GMatchInfo **match_info);
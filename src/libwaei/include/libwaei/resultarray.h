@@ -0,0 +1,51 @@
+#ifndef LW_RESULTARRAY_INCLUDED
+#define LW_RESULTARRAY_INCLUDED 
+
+G_BEGIN_DECLS
+
+#define LW_RESULTARRAY(object) (LwResultArray*) object
+
+//!
+//! @brief A matched dictionary line and how well it matched
+//!
+struct _LwResultArrayEntry {
+  LwOffset offset;  //!< Offset of the line in the dictionary buffer
+  gint32 score;     //!< lw_morphologylist_get_score() of the line.  Higher is better
+  gint16 cost;      //!< Edit distance of fuzzy matches.  0 for exact ones
+  gint16 category;  //!< LwIndexTableType the entry matched best in.  Only set by lw_resultarray_merge()
+};
+typedef struct _LwResultArrayEntry LwResultArrayEntry;
+
+
+//!
+//! @brief The results of one category of a search stored contiguously so they
+//!        can be counted, sorted and paged through without walking a list
+//!
+struct _LwResultArray {
+  LwResultArrayEntry *entries;
+  gint length;
+  gint allocated;
+  gint max;     //!< Only the best max entries are kept or 0 to keep all of them
+  gint total;   //!< How many entries were appended including the dropped ones
+};
+typedef struct _LwResultArray LwResultArray;
+
+
+LwResultArray* lw_resultarray_new (gint reserve);
+LwResultArray* lw_resultarray_new_bounded (gint max);
+void lw_resultarray_free (LwResultArray *array);
+LwResultArray* lw_resultarray_copy (LwResultArray *array);
+LwResultArray* lw_resultarray_merge (LwResultArray *previous, LwResultArray **arrays, gint length);
+LwResultArray* lw_resultarray_merge_sorted (LwResultArray **arrays, gint length, gint max);
+
+void lw_resultarray_append (LwResultArray *array, LwOffset offset, gint score, gint cost);
+void lw_resultarray_sort (LwResultArray *array);
+void lw_resultarray_truncate (LwResultArray *array, gint length);
+
+gboolean lw_resultarray_is_truncated (LwResultArray *array);
+gint lw_resultarray_length (LwResultArray *array);
+LwResultArrayEntry* lw_resultarray_index (LwResultArray *array, gint index);
+
+G_END_DECLS
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef LW_RESULTCACHE_INCLUDED
+#define LW_RESULTCACHE_INCLUDED 
+
+G_BEGIN_DECLS
+
+#define LW_RESULTCACHE(object) (LwResultCache*) object
+#define LW_RESULTCACHE_DEFAULT_MAX_SIZE (4 * 1024 * 1024)
+
+//!
+//! @brief The ranked results of a finished search kept for repeat searches
+//!
+struct _LwResultCacheEntry {
+  gchar *key;
+  GHashTable *resulttable;  //!< Category name to a compacted LwResultArray
+  gsize size;               //!< Approximate bytes used by the entry
+};
+typedef struct _LwResultCacheEntry LwResultCacheEntry;
+
+
+//!
+//! @brief A least recently used cache of search results bounded by bytes
+//!
+struct _LwResultCache {
+  GMutex mutex;
+  GHashTable *table;        //!< Key to the GList link of its LwResultCacheEntry in queue
+  GQueue queue;             //!< Most recently used entries first
+  gsize size;
+  gsize max_size;
+};
+typedef struct _LwResultCache LwResultCache;
+
+
+LwResultCache* lw_resultcache_new (gsize max_size);
+void lw_resultcache_free (LwResultCache *cache);
+
+GHashTable* lw_resultcache_lookup (LwResultCache *cache, const gchar *KEY);
+GHashTable* lw_resultcache_lookup_refinable (LwResultCache *cache, const gchar *KEY, gsize query_offset);
+void lw_resultcache_insert (LwResultCache *cache, const gchar *KEY, GHashTable *resulttable);
+void lw_resultcache_clear (LwResultCache *cache);
+
+gsize lw_resultcache_get_size (LwResultCache *cache);
+
+G_END_DECLS
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef LW_ROMAJI_INCLUDED
+#define LW_ROMAJI_INCLUDED 
+
+G_BEGIN_DECLS
+
+#define LW_ROMAJI_PENDING_MAX 8     //!< Longest romaji spelling that can still be waiting for input
+#define LW_ROMAJI_BUFFER_SIZE 512   //!< Converted kana kept by an LwRomajiConverter
+#define LW_ROMAJI_MAX_READINGS 8
+
+typedef enum
+{
+  LW_ROMAJI_FLAG_KATAKANA = (1 << 0)
+} LwRomajiFlag;
+
+//!
+//! @brief Streaming romaji to kana conversion state.  The struct owns no memory, so
+//!        it can be copied by assignment to keep a snapshot of a prefix and extend
+//!        it later as more of the query is typed.
+//!
+struct _LwRomajiConverter {
+  gchar pending[LW_ROMAJI_PENDING_MAX];  //!< Romaji that can't be converted until more input comes
+  gint pending_length;
+  gchar kana[LW_ROMAJI_BUFFER_SIZE];     //!< Null terminated kana converted so far
+  gint length;
+  gint consumed;                         //!< Bytes of romaji fed so far
+  LwRomajiFlag flags;
+  guint32 split;                         //!< Ambiguous n's that should be read as ん instead of starting a syllable
+  gint ambiguities;                      //!< Ambiguous n's seen so far
+  gint ambiguity_offset;
+  gboolean failed;
+};
+typedef struct _LwRomajiConverter LwRomajiConverter;
+
+
+void lw_romaji_converter_init (LwRomajiConverter *converter, LwRomajiFlag flags, guint32 split);
+gboolean lw_romaji_converter_feed (LwRomajiConverter *converter, const gchar *TEXT, gint length);
+gboolean lw_romaji_converter_finish (LwRomajiConverter *converter);
+const gchar* lw_romaji_converter_get_kana (LwRomajiConverter *converter);
+const gchar* lw_romaji_converter_get_pending (LwRomajiConverter *converter);
+gint lw_romaji_converter_get_ambiguities (LwRomajiConverter *converter);
+
+gboolean lw_romaji_to_kana (const gchar *TEXT, LwRomajiFlag flags, gchar *output, gint max);
+gchar** lw_romaji_get_readings (const gchar *TEXT, LwRomajiFlag flags, gint max);
+
+G_END_DECLS
+
+#endif
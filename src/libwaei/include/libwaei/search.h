@@ -5,12 +5,14 @@
 
 #include <libwaei/result.h>
 #include <libwaei/dictionary.h>
+#include <libwaei/highlighter.h>
 
 G_BEGIN_DECLS
 
 #define LW_SEARCH(object) (LwSearch*) object
 #define LW_SEARCH_DATA_FREE_FUNC(object) (LwSearchDataFreeFunc)object
 #define LW_SEARCH_MAX_CHUNK 1000
+#define LW_SEARCH_DEFAULT_MAX_RESULTS 500
 
 //!
 //! @brief Search status types
@@ -32,10 +34,18 @@ typedef enum
   LW_SEARCH_FLAG_STEM_INSENSITIVE = (1 << 3),
   LW_SEARCH_FLAG_ROMAJI_TO_FURIGANA = (1 << 4),
   LW_SEARCH_FLAG_USE_INDEX = (1 << 5),
+  LW_SEARCH_FLAG_FUZZY = (1 << 6),
   LW_SEARCH_FLAG_INSENSITIVE = (LW_SEARCH_FLAG_FURIGANA_INSENSITIVE | LW_SEARCH_FLAG_CASE_INSENSITIVE | LW_SEARCH_FLAG_STEM_INSENSITIVE),
 } LwSearchFlag;
 
 typedef void(*LwSearchDataFreeFunc)(gpointer);
+typedef struct _LwSearch LwSearch;
+
+//!
+//! @brief Called in the watch's main context when new results or progress may be
+//!        available.  Returning FALSE removes the watch.
+//!
+typedef gboolean(*LwSearchWatchFunc)(LwSearch *search, gpointer data);
 
 //!
 //! @brief Primitive for storing search item information
@@ -45,25 +55,32 @@ struct _LwSearch {
     gchar *query;
     LwDictionary* dictionary;                 //!< Pointer to the dictionary used
 
-    GThread *thread;                        //!< Thread the search is processed in
+    GThread *thread;                        //!< Thread the search is processed in.  Kept after it finishes until it is joined.
     GMutex mutex;                          //!< Mutext to help ensure threadsafe operation
 
     LwSearchStatus status;                  //!< Used to test if a search is in progress.
     LwSearchFlag flags;
 
     LwMorphologyEngine *morphologyengine;
+    LwHighlighter *highlighter;             //!< Compiled lazily by lw_search_get_highlighter()
 
-    gint max;
+    gint max;                               //!< Results kept per category or 0 for all of them
+    gboolean continuing;                    //!< Set by lw_search_fetch_more() for the search thread
+    LwOffset resume_offset;                 //!< Where a regex search that stopped at max continues or 0
 
-    GHashTable *resulttable;
+    GHashTable *resulttable;                //!< Category name to LwResultArray
+    LwResultArray *resultview;              //!< The categories merged best first without repeats for iterators
+    GList *retiredviews;                    //!< Earlier resultviews that iterators may still be walking
 
     gpointer data;                 //!< Pointer to a buffer that stays constant unlike when the target attribute is used
 
     LwProgress *progress;
 
     LwSearchDataFreeFunc free_data_func;
+
+    GMutex watch_mutex;                    //!< Guards watchlist since it is woken from the search thread
+    GList *watchlist;                      //!< GSources attached with lw_search_add_watch
 };
-typedef struct _LwSearch LwSearch;
 
 //Methods
 LwSearch* lw_search_new (LwDictionary *dictionary, LwMorphologyEngine *morphologyengine, const gchar *QUERY, LwSearchFlag flags);
@@ -94,15 +111,23 @@ LwSearchStatus lw_search_get_status (LwSearch*);
 gboolean lw_search_read_line (LwSearch*);
 
 void lw_search_start (LwSearch*, LwProgress*, gboolean);
+void lw_search_set_max_results (LwSearch*, gint);
+gboolean lw_search_has_more (LwSearch*);
+gboolean lw_search_fetch_more (LwSearch*, gint, gboolean);
 
 gboolean lw_search_has_results (LwSearch *search);
 
 LwSearchFlag lw_search_get_flags_from_preferences (LwPreferences*);
 
 LwMorphologyList* lw_search_get_query_as_morphologylist (LwSearch* search);
+LwHighlighter* lw_search_get_highlighter (LwSearch *search);
 
 LwProgress* lw_search_get_progress (LwSearch *search);
 
+guint lw_search_add_watch (LwSearch *search, GMainContext *context, LwSearchWatchFunc func, gpointer data, GDestroyNotify notify);
+void lw_search_remove_watch (LwSearch *search, guint id);
+void lw_search_notify (LwSearch *search);
+
 G_END_DECLS
 
 #endif
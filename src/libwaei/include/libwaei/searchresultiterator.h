@@ -5,21 +5,25 @@ G_BEGIN_DECLS
 
 #define LW_SEARCHRESULTITERATOR(object) (LwSearchResultIterator*) object
 
+//!
+//! @brief Walks the merged resultview of a search.  The search is only locked
+//!        when the iterator runs out of the results it already knows about.
+//!
 struct _LwSearchResultIterator {
   LwSearch *search;
-  gchar *category;
-  GList *list;
-  GList *link;
+  LwResultArray *array;  //!< The search's resultview
+  gint length;           //!< How many results of array were published when it was last checked
+  gint index;            //!< Current position in array or -1 before the first result
   gint count;
-  GHashTable *historytable;
 };
 
 typedef struct _LwSearchResultIterator LwSearchResultIterator;
 
-LwSearchResultIterator* lw_searchresultiterator_new (LwSearch *search, const gchar *CATEGORY);
+LwSearchResultIterator* lw_searchresultiterator_new (LwSearch *search);
 LwResult* lw_searchresultiterator_get_result (LwSearchResultIterator* iterator);
 gboolean lw_searchresultiterator_next (LwSearchResultIterator* iterator);
 void lw_searchresultiterator_rewind (LwSearchResultIterator* iterator);
+gboolean lw_searchresultiterator_seek (LwSearchResultIterator *iterator, gint index);
 void lw_searchresultiterator_free (LwSearchResultIterator *iterator);
 void lw_searchresultiterator_free_full (LwSearchResultIterator *iterator);
 gint lw_searchresultiterator_length (LwSearchResultIterator *iterator);
@@ -0,0 +1,37 @@
+#ifndef LW_STEMTABLE_INCLUDED
+#define LW_STEMTABLE_INCLUDED 
+
+G_BEGIN_DECLS
+
+#define LW_STEMTABLE_MAGIC "LWSTEM1"
+
+//!
+//! @brief Memoized word to stem lookups for a Hunspell dictionary.  The table
+//!        saved on disk is memory mapped and read without locking.  Words
+//!        that miss are stemmed by Hunspell and kept in an overlay that is
+//!        merged into the file on the next save.
+//!
+struct _LwStemTable {
+  gchar *path;                //!< The cache file
+  gchar *fingerprint;         //!< Identifies the Hunspell dictionary files the table was built from
+  GMappedFile *mappedfile;
+  const guint32 *entries;     //!< Sorted offsets into the pool, one per word
+  guint32 length;
+  const gchar *pool;          //!< "word\0stem\0" pairs.  An empty stem means the word has none
+  GMutex mutex;
+  GHashTable *overlay;        //!< Words stemmed since the file was mapped.  Protected by the mutex
+  gboolean dirty;             //!< The overlay has words that haven't been saved
+};
+typedef struct _LwStemTable LwStemTable;
+
+LwStemTable* lw_stemtable_new (const gchar *DICTIONARY_PATH);
+void lw_stemtable_free (LwStemTable *stemtable);
+
+gboolean lw_stemtable_lookup (LwStemTable *stemtable, const gchar *WORD, const gchar **stem);
+void lw_stemtable_insert (LwStemTable *stemtable, const gchar *WORD, const gchar *STEM);
+gboolean lw_stemtable_is_dirty (LwStemTable *stemtable);
+gboolean lw_stemtable_save (LwStemTable *stemtable, GError **error);
+
+G_END_DECLS
+
+#endif
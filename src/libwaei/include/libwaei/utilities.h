@@ -34,8 +34,6 @@ const char* lw_util_get_compressionname (const LwCompression);
 const char* lw_util_get_encodingname (const LwEncoding);
 
 
-const char* lw_util_next_hira_char_from_roma (const char*);
-char* lw_util_roma_to_hira (const char*, char*);
 gboolean lw_util_str_roma_to_hira (const char*, char*, int);
 
 gboolean lw_util_is_hiragana_str (const char*);
@@ -52,12 +50,15 @@ void lw_util_str_shift_kata_to_hira (char*);
 void lw_util_str_shift_hira_to_kata (char*);
 
 gchar* lw_util_furiganafold (const gchar*);
+void lw_util_furiganafold_buffer (gchar *buffer);
 
 gboolean lw_util_all_chars_are_in_range (char*, int, int);
 
 void lw_util_sanitize_string (gchar *buffer);
 
 gchar* lw_util_normalize_string (const gchar *TEXT, gboolean make_case_insensitive, gboolean make_furigana_insensitive);
+gchar* lw_util_normalize_string_if_changed (const gchar *TEXT, gboolean make_case_insensitive, gboolean make_furigana_insensitive);
+gint lw_util_normalize_string_to_buffer (const gchar *TEXT, gboolean make_case_insensitive, gboolean make_furigana_insensitive, gchar *buffer, gint size);
 
 gboolean lw_util_contains_halfwidth_japanese (const gchar*);
 gchar* lw_util_enlarge_halfwidth_japanese (const gchar*);
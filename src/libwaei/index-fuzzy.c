@@ -0,0 +1,505 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file index-fuzzy.c
+//!
+//! @brief Approximate key lookups for an LwIndex.  The sorted keys of a table
+//!        are walked as an implicit trie while a Levenshtein automaton of the
+//!        query is simulated one row per character.  Whole subtrees of keys
+//!        are skipped as soon as no completion can be within range anymore.
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <libwaei/utilities.h>
+#include <libwaei/io.h>
+#include <libwaei/morphology.h>
+#include <libwaei/index.h>
+#include <libwaei/gettext.h>
+
+
+#define LW_INDEX_FUZZY_MAX_QUERY_LENGTH 64
+
+
+static gint
+_lw_index_fuzzy_compare_keys (gconstpointer a,
+                              gconstpointer b)
+{
+    const gchar *KEY_A = *((const gchar**) a);
+    const gchar *KEY_B = *((const gchar**) b);
+
+    return strcmp (KEY_A, KEY_B);
+}
+
+
+//!
+//! @brief Returns the keys of a table sorted bytewise.  Since UTF-8 sorts in
+//!        codepoint order, keys sharing a prefix are always contiguous.
+//!        The array is owned by the LwIndex.
+//!
+const gchar**
+lw_index_get_sorted_keys (LwIndex          *index,
+                          LwIndexTableType  type,
+                          gint             *length)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, NULL);
+    g_return_val_if_fail (type < TOTAL_LW_INDEX_TABLES, NULL);
+    if (index->table[type] == NULL) return NULL;
+
+    if (g_once_init_enter (&index->keys[type]))
+    {
+      //Declarations
+      GHashTableIter iter;
+      gpointer key = NULL;
+      gint total = g_hash_table_size (index->table[type]);
+      const gchar **keys = g_new (const gchar*, total + 1);
+      gint i = 0;
+
+      g_hash_table_iter_init (&iter, index->table[type]);
+      while (g_hash_table_iter_next (&iter, &key, NULL) && i < total)
+      {
+        keys[i++] = key;
+      }
+      keys[i] = NULL;
+
+      qsort (keys, i, sizeof(const gchar*), _lw_index_fuzzy_compare_keys);
+
+      index->keys_length[type] = i;
+      g_once_init_leave (&index->keys[type], keys);
+    }
+
+    if (length != NULL) *length = index->keys_length[type];
+
+    return index->keys[type];
+}
+
+
+//!
+//! @brief Frees the sorted key arrays.  Must be called whenever the tables change.
+//!
+void
+lw_index_clear_sorted_keys (LwIndex *index)
+{
+    //Sanity checks
+    g_return_if_fail (index != NULL);
+
+    //Declarations
+    LwIndexTableType type = 0;
+
+    for (type = 0; type < TOTAL_LW_INDEX_TABLES; type++)
+    {
+      if (index->keys[type] != NULL) g_free (index->keys[type]); index->keys[type] = NULL;
+      index->keys_length[type] = 0;
+    }
+}
+
+
+//!
+//! @brief Folds katakana to hiragana and small kana to their full size form
+//!
+static gunichar
+_lw_index_fuzzy_fold (gunichar c)
+{
+    if (c >= 0x30A1 && c <= 0x30F6) c -= 0x60; //ァ-ヶ → ぁ-ゖ
+
+    switch (c)
+    {
+      case 0x3041: case 0x3043: case 0x3045: case 0x3047: case 0x3049: //ぁぃぅぇぉ
+      case 0x3063: //っ
+      case 0x3083: case 0x3085: case 0x3087: //ゃゅょ
+      case 0x308E: //ゎ
+        return c + 1;
+      default:
+        return g_unichar_tolower (c);
+    }
+}
+
+
+static gboolean
+_lw_index_fuzzy_is_vowel (gunichar c)
+{
+    return (c == 0x3042 || c == 0x3044 || c == 0x3046 || c == 0x3048 || c == 0x304A);
+}
+
+
+//!
+//! @brief Characters that are often dropped or doubled when typing Japanese
+//!
+static gint
+_lw_index_fuzzy_get_indel_cost (gunichar c)
+{
+    if (c == 0x3063 || c == 0x30C3 || c == 0x30FC) return LW_INDEX_FUZZY_MINOR_COST; //っ ッ ー
+    return LW_INDEX_FUZZY_EDIT_COST;
+}
+
+
+static gint
+_lw_index_fuzzy_get_substitution_cost (gunichar a,
+                                       gunichar b)
+{
+    if (a == b) return 0;
+
+    //Declarations
+    gunichar folded_a = _lw_index_fuzzy_fold (a);
+    gunichar folded_b = _lw_index_fuzzy_fold (b);
+
+    if (folded_a == folded_b) return LW_INDEX_FUZZY_MINOR_COST;
+
+    //Long vowel mark written out as a vowel (こーひー vs こうひい)
+    if (a == 0x30FC && _lw_index_fuzzy_is_vowel (folded_b)) return LW_INDEX_FUZZY_MINOR_COST;
+    if (b == 0x30FC && _lw_index_fuzzy_is_vowel (folded_a)) return LW_INDEX_FUZZY_MINOR_COST;
+
+    return LW_INDEX_FUZZY_EDIT_COST;
+}
+
+
+//!
+//! @brief Returns a sensible edit distance for a key so short keys don't match everything
+//!
+gint
+lw_index_fuzzy_get_max_distance (const gchar *KEY)
+{
+    //Sanity checks
+    g_return_val_if_fail (KEY != NULL, 0);
+
+    //Declarations
+    glong length = g_utf8_strlen (KEY, -1);
+
+    if (length < 3) return 0;
+    if (length < 6) return 1;
+    return LW_INDEX_FUZZY_MAX_DISTANCE;
+}
+
+
+static gint
+_lw_index_fuzzy_sort_matches (gconstpointer a,
+                              gconstpointer b)
+{
+    const LwIndexFuzzyMatch *MATCH_A = a;
+    const LwIndexFuzzyMatch *MATCH_B = b;
+
+    if (MATCH_A->cost != MATCH_B->cost) return (MATCH_A->cost - MATCH_B->cost);
+    return strcmp (MATCH_A->KEY, MATCH_B->KEY);
+}
+
+
+//!
+//! @brief Skips past every key that starts with the first PREFIX_LENGTH bytes of keys[i]
+//! @returns The position of the last key sharing the prefix
+//!
+static gint
+_lw_index_fuzzy_skip_prefix (const gchar **keys,
+                             gint          length,
+                             gint          i,
+                             gsize         prefix_length)
+{
+    //Declarations
+    const gchar *PREFIX = keys[i];
+    gint low = i + 1;
+    gint high = length;
+
+    //Binary search for the first key not sharing the prefix
+    while (low < high)
+    {
+      gint middle = low + (high - low) / 2;
+      if (strncmp (keys[middle], PREFIX, prefix_length) == 0) low = middle + 1;
+      else high = middle;
+    }
+
+    return low - 1;
+}
+
+
+//!
+//! @brief Finds every key of a table within max_distance edits of KEY.
+//! @returns A GList of LwIndexFuzzyMatch sorted by cost.  Free with g_list_free_full (list, g_free)
+//!
+GList*
+lw_index_get_fuzzy_keys (LwIndex          *index,
+                         LwIndexTableType  type,
+                         const gchar      *KEY,
+                         gint              max_distance)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, NULL);
+    g_return_val_if_fail (KEY != NULL, NULL);
+    if (index->table[type] == NULL) return NULL;
+
+    //Declarations
+    const gchar **keys = NULL;
+    gint length = 0;
+    gunichar *query = NULL;
+    glong query_length = 0;
+    gint threshold = 0;
+    gint max_depth = 0;
+    gint *rows = NULL;
+    gunichar *chars = NULL;
+    gint *query_indel = NULL;
+    gint valid_depth = 0;
+    GList *matchlist = NULL;
+    gint i = 0, j = 0, d = 0;
+
+    //Initializations
+    keys = lw_index_get_sorted_keys (index, type, &length); if (keys == NULL || length == 0) goto errored;
+    query = g_utf8_to_ucs4_fast (KEY, -1, &query_length); if (query == NULL) goto errored;
+    if (query_length == 0 || query_length > LW_INDEX_FUZZY_MAX_QUERY_LENGTH) goto errored;
+    threshold = max_distance * LW_INDEX_FUZZY_EDIT_COST;
+    max_depth = query_length + threshold; //Every extra character costs at least LW_INDEX_FUZZY_MINOR_COST
+    rows = g_new (gint, (max_depth + 1) * (query_length + 1));
+    chars = g_new0 (gunichar, max_depth + 1);
+    query_indel = g_new (gint, query_length);
+
+#define ROW(depth) (rows + (depth) * (query_length + 1))
+
+    //The first row is the cost of building the query from nothing
+    for (j = 0; j < query_length; j++) query_indel[j] = _lw_index_fuzzy_get_indel_cost (query[j]);
+    ROW(0)[0] = 0;
+    for (j = 1; j <= query_length; j++) ROW(0)[j] = ROW(0)[j - 1] + query_indel[j - 1];
+
+    for (i = 0; i < length; i++)
+    {
+      const gchar *ptr = keys[i];
+      gint depth = 0;
+      gboolean pruned = FALSE;
+
+      //Rows of the prefix shared with the previous key are still valid
+      while (*ptr != '\0' && depth < valid_depth && g_utf8_get_char (ptr) == chars[depth])
+      {
+        ptr = g_utf8_next_char (ptr);
+        depth++;
+      }
+
+      for (d = depth + 1; *ptr != '\0'; d++)
+      {
+        if (d > max_depth)
+        {
+          pruned = TRUE;
+          break;
+        }
+
+        gunichar c = g_utf8_get_char (ptr);
+        gint indel = _lw_index_fuzzy_get_indel_cost (c);
+        gint *previous = ROW(d - 1);
+        gint *current = ROW(d);
+        gint minimum = 0;
+
+        chars[d - 1] = c;
+        current[0] = minimum = previous[0] + indel;
+
+        for (j = 1; j <= query_length; j++)
+        {
+          gint cost = previous[j] + indel;
+          gint insertion = current[j - 1] + query_indel[j - 1];
+          gint substitution = previous[j - 1] + _lw_index_fuzzy_get_substitution_cost (c, query[j - 1]);
+
+          if (insertion < cost) cost = insertion;
+          if (substitution < cost) cost = substitution;
+
+          //Transposition of two neighbouring characters
+          if (d > 1 && j > 1 && c == query[j - 2] && chars[d - 2] == query[j - 1] && c != chars[d - 2])
+          {
+            gint transposition = ROW(d - 2)[j - 2] + LW_INDEX_FUZZY_EDIT_COST;
+            if (transposition < cost) cost = transposition;
+          }
+
+          current[j] = cost;
+          if (cost < minimum) minimum = cost;
+        }
+
+        ptr = g_utf8_next_char (ptr);
+        valid_depth = d;
+
+        //Nothing starting with this prefix can be within range
+        if (minimum > threshold)
+        {
+          pruned = TRUE;
+          break;
+        }
+      }
+      if (!pruned) valid_depth = d - 1;
+
+      if (pruned)
+      {
+        i = _lw_index_fuzzy_skip_prefix (keys, length, i, ptr - keys[i]);
+      }
+      else if (ROW(valid_depth)[query_length] <= threshold)
+      {
+        LwIndexFuzzyMatch *match = g_new (LwIndexFuzzyMatch, 1);
+        match->KEY = keys[i];
+        match->cost = ROW(valid_depth)[query_length];
+        matchlist = g_list_prepend (matchlist, match);
+      }
+    }
+
+#undef ROW
+
+    matchlist = g_list_sort (matchlist, _lw_index_fuzzy_sort_matches);
+
+errored:
+
+    if (query != NULL) g_free (query); query = NULL;
+    if (rows != NULL) g_free (rows); rows = NULL;
+    if (chars != NULL) g_free (chars); chars = NULL;
+    if (query_indel != NULL) g_free (query_indel); query_indel = NULL;
+
+    return matchlist;
+}
+
+
+//!
+//! @brief Adds the postings of a key to a table of offsets, keeping the cheapest cost
+//!
+static void
+_lw_index_fuzzy_load_offsets (LwIndex          *index,
+                              LwIndexTableType  type,
+                              const gchar      *KEY,
+                              gint              cost,
+                              GHashTable       *table)
+{
+    //Declarations
+    LwOffset *offsets = g_hash_table_lookup (index->table[type], KEY); if (offsets == NULL) return;
+    LwOffset length = *offsets - 1; //The first item is always the length of the array
+    LwOffset i = 0;
+
+    for (i = 1; i <= length; i++)
+    {
+      gpointer key = LW_OFFSET_TO_POINTER (offsets[i]);
+      gpointer value = NULL;
+
+      if (g_hash_table_lookup_extended (table, key, NULL, &value) && GPOINTER_TO_INT (value) <= cost) continue;
+      g_hash_table_insert (table, key, GINT_TO_POINTER (cost));
+    }
+}
+
+
+//!
+//! @brief Returns a hash table of offsets with their cheapest cost for a single morphology
+//!
+static GHashTable*
+_lw_index_get_fuzzy_matches_for_morphology (LwIndex          *index,
+                                            LwIndexTableType  type,
+                                            LwMorphology     *morphology,
+                                            gint              max_distance)
+{
+    //Declarations
+    GHashTable *table = g_hash_table_new (g_direct_hash, g_direct_equal);
+    const gchar *keys[] = { NULL, NULL, NULL };
+    gint i = 0;
+
+    switch (type)
+    {
+      case LW_INDEX_TABLE_RAW:
+        keys[0] = lw_morphology_get_raw (morphology);
+        break;
+      case LW_INDEX_TABLE_NORMALIZED:
+        keys[0] = lw_morphology_get_normalized (morphology);
+        break;
+      case LW_INDEX_TABLE_STEM:
+        keys[0] = lw_morphology_get_stem (morphology);
+        break;
+      case LW_INDEX_TABLE_CANONICAL:
+        keys[0] = lw_morphology_get_canonical (morphology);
+        break;
+      default:
+        g_assert_not_reached ();
+        break;
+    }
+    if (type != LW_INDEX_TABLE_RAW) keys[1] = lw_morphology_get_raw (morphology);
+
+    for (i = 0; keys[i] != NULL; i++)
+    {
+      gint distance = MIN (max_distance, lw_index_fuzzy_get_max_distance (keys[i]));
+      GList *matchlist = lw_index_get_fuzzy_keys (index, type, keys[i], distance);
+      GList *link = NULL;
+
+      for (link = matchlist; link != NULL; link = link->next)
+      {
+        LwIndexFuzzyMatch *match = link->data;
+        _lw_index_fuzzy_load_offsets (index, type, match->KEY, match->cost, table);
+      }
+
+      g_list_free_full (matchlist, g_free); matchlist = NULL;
+    }
+
+    return table;
+}
+
+
+//!
+//! @brief Like lw_index_get_matches_for_morphologylist() but each morphology may
+//!        be misspelled by up to max_distance edits.  Every morphology must match.
+//! @returns A GHashTable of offsets to their summed edit cost.  Free with g_hash_table_unref()
+//!
+GHashTable*
+lw_index_get_fuzzy_matches_for_morphologylist (LwIndex          *index,
+                                               LwIndexTableType  type,
+                                               LwMorphologyList *morphologylist,
+                                               gint              max_distance)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, NULL);
+    g_return_val_if_fail (morphologylist != NULL, NULL);
+    if (lw_morphologylist_length (morphologylist) == 0) return NULL;
+
+    //Declarations
+    GHashTable *table = NULL;
+    GList *link = NULL;
+
+    for (link = morphologylist->list; link != NULL; link = link->next)
+    {
+      LwMorphology *morphology = link->data; if (morphology == NULL) continue;
+      GHashTable *matches = _lw_index_get_fuzzy_matches_for_morphology (index, type, morphology, max_distance);
+
+      if (table == NULL)
+      {
+        table = matches; matches = NULL;
+      }
+      else
+      {
+        //Keep only the offsets matched by each morphology, summing their costs
+        GHashTableIter iter;
+        gpointer key = NULL, value = NULL, other = NULL;
+
+        g_hash_table_iter_init (&iter, table);
+        while (g_hash_table_iter_next (&iter, &key, &value))
+        {
+          if (g_hash_table_lookup_extended (matches, key, NULL, &other))
+            g_hash_table_iter_replace (&iter, GINT_TO_POINTER (GPOINTER_TO_INT (value) + GPOINTER_TO_INT (other)));
+          else
+            g_hash_table_iter_remove (&iter);
+        }
+      }
+
+      if (matches != NULL) g_hash_table_unref (matches); matches = NULL;
+    }
+
+    return table;
+}
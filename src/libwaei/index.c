@@ -158,54 +158,182 @@ _lw_index_get_data_offsets_length (LwIndex          *index,
 }
 
 
+//!
+//! @brief Position arrays grow by doubling so the room they have is worked out
+//!        from their length
+//!
+static LwOffset
+_lw_index_positions_get_allocated (LwOffset length)
+{
+    //Declarations
+    LwOffset allocated = 4;
+
+    while (allocated < length) allocated *= 2;
+
+    return allocated;
+}
+
+
 ///!
-///! @brief Only to be used when creating the index
+///! @brief Only to be used when creating an LwIndex.  Records where KEY is in
+///!        the line at offset for phrase and proximity queries.
 ///!
 static void
-_lw_index_create_add_string (LwIndex     *index, 
-                             const gchar *TEXT, 
-                             LwOffset     offset)
+_lw_index_create_append_position (LwIndex          *index, 
+                                  LwIndexTableType  type, 
+                                  const gchar      *KEY, 
+                                  LwOffset          offset,
+                                  guint32           position)
 {
     //Sanity checks
-    g_return_if_fail (index != NULL);
-    g_return_if_fail (TEXT != NULL);
-    g_return_if_fail (index->morphologyengine != NULL);
-    g_return_if_fail (index->checksum == NULL); //You cannot add a string if the checksum has already been created
+    if (index->positions[type] == NULL) return;
+    g_return_if_fail (KEY != NULL);
 
     //Declarations
-    LwMorphology *morphology = NULL;
-    LwMorphologyList *list = NULL;
-    gchar *key = NULL;
-    
-    list = lw_morphologyengine_analyze (index->morphologyengine, TEXT, FALSE);
-    while ((morphology = lw_morphologylist_read (list)) != NULL)
+    GHashTable *table = NULL;
+    LwOffset *data = NULL;
+    LwOffset *new_data = NULL;
+    LwOffset length = 0;
+
+    //Initializations
+    table = index->positions[type];
+    data = g_hash_table_lookup (table, KEY);
+    length = (data != NULL) ? *data : 1; //The first value is the length of the array
+
+    //The same word can be analyzed more than once
+    if (length >= 3 && data[length - 2] == offset && data[length - 1] == position) return;
+
+    if (data == NULL || _lw_index_positions_get_allocated (length + 2) > _lw_index_positions_get_allocated (length))
     {
-      if (morphology->word != NULL && strlen(morphology->word) > 2) 
-      {
-        key = morphology->word; //Steals key
-        _lw_index_create_append_data_offset (index, LW_INDEX_TABLE_RAW, key, offset);
-        morphology->word = NULL;
-      }
-      if (morphology->normalized != NULL && strlen(morphology->normalized) > 2)
-      {
-        key = morphology->normalized; //Steals key
-        _lw_index_create_append_data_offset (index, LW_INDEX_TABLE_NORMALIZED, key, offset);
-        morphology->normalized = NULL;
-      }
-      if (morphology->stem != NULL && strlen(morphology->stem) > 2)
-      {
-        key = morphology->stem; //Steals key
-        _lw_index_create_append_data_offset (index, LW_INDEX_TABLE_STEM, key, offset);
-        morphology->stem = NULL;
-      }
-      if (morphology->canonical != NULL && strlen(morphology->canonical) > 2)
+      new_data = g_new (LwOffset, _lw_index_positions_get_allocated (length + 2));
+      if (data != NULL) memcpy (new_data, data, length * sizeof(LwOffset));
+      g_hash_table_replace (table, g_strdup (KEY), new_data);
+      data = new_data;
+    }
+
+    data[length] = offset;
+    data[length + 1] = position;
+    data[0] = length + 2;
+}
+
+
+#define LW_INDEX_SECTION_DELIMITERS "{}()\n\t/「」[].'" //!< The characters lw_regex_get_sections() splits on
+
+static gboolean
+_lw_index_has_section_delimiter (const gchar *TEXT,
+                                 gint         length)
+{
+    //Declarations
+    const gchar *ptr = TEXT;
+
+    while (ptr - TEXT < length && *ptr != '\0')
+    {
+      if (g_utf8_strchr (LW_INDEX_SECTION_DELIMITERS, -1, g_utf8_get_char (ptr)) != NULL) return TRUE;
+      ptr = g_utf8_next_char (ptr);
+    }
+
+    return FALSE;
+}
+
+
+#define LW_INDEX_CREATE_BATCH_SIZE 512
+
+//!
+//! @brief Lines waiting to be analyzed together while creating the index
+//!
+struct _LwIndexCreateBatch {
+  LwIndex *index;
+  const gchar *texts[LW_INDEX_CREATE_BATCH_SIZE + 1];
+  LwOffset offsets[LW_INDEX_CREATE_BATCH_SIZE];
+  gint length;
+  gint line;          //!< Line of texts the position fields below are for or -1
+  guint32 section;    //!< Section of the line the last morphology was in
+  guint32 token;      //!< Word of the section the last morphology was
+  gint start_offset;  //!< Where the last morphology started or -1
+  gint end_offset;    //!< Where the last morphology ended
+};
+typedef struct _LwIndexCreateBatch LwIndexCreateBatch;
+
+
+///!
+///! @brief Only to be used when creating the index.  Receives the morphologies of a batch.
+///!
+static void
+_lw_index_create_add_morphology (gint                i,
+                                 LwMorphology       *morphology, 
+                                 LwIndexCreateBatch *batch)
+{
+    //Declarations
+    LwIndex *index = batch->index;
+    LwOffset offset = batch->offsets[i];
+    guint32 position = 0;
+
+    //Work out which word of which section of the line the morphology is.  Morphologies of the same word share a position.
+    //Each engine goes through the line from the start, so one going back to an earlier word starts over too
+    if (batch->line != i || morphology->start_offset < batch->start_offset)
+    {
+      batch->line = i;
+      batch->section = 0;
+      batch->token = 0;
+      batch->start_offset = -1;
+      batch->end_offset = 0;
+    }
+    if (morphology->start_offset != batch->start_offset)
+    {
+      if (batch->start_offset != -1) batch->token++;
+      if (_lw_index_has_section_delimiter (batch->texts[i] + batch->end_offset, morphology->start_offset - batch->end_offset))
       {
-        key = morphology->canonical; //Steals key
-        _lw_index_create_append_data_offset (index, LW_INDEX_TABLE_CANONICAL, key, offset);
-        morphology->canonical = NULL;
+        batch->section++;
+        batch->token = 0;
       }
+      batch->start_offset = morphology->start_offset;
+      batch->end_offset = MAX (morphology->end_offset, morphology->start_offset);
     }
-    lw_morphologylist_free (list); list = NULL;
+    position = LW_INDEX_POSITION (batch->section, batch->token);
+
+    if (morphology->word != NULL && strlen(morphology->word) > 2) 
+    {
+      _lw_index_create_append_data_offset (index, LW_INDEX_TABLE_RAW, morphology->word, offset);
+      _lw_index_create_append_position (index, LW_INDEX_TABLE_RAW, morphology->word, offset, position);
+    }
+    if (morphology->normalized != NULL && strlen(morphology->normalized) > 2)
+    {
+      _lw_index_create_append_data_offset (index, LW_INDEX_TABLE_NORMALIZED, morphology->normalized, offset);
+      _lw_index_create_append_position (index, LW_INDEX_TABLE_NORMALIZED, morphology->normalized, offset, position);
+    }
+    if (morphology->stem != NULL && strlen(morphology->stem) > 2)
+    {
+      _lw_index_create_append_data_offset (index, LW_INDEX_TABLE_STEM, morphology->stem, offset);
+      _lw_index_create_append_position (index, LW_INDEX_TABLE_STEM, morphology->stem, offset, position);
+    }
+    if (morphology->canonical != NULL && strlen(morphology->canonical) > 2)
+    {
+      _lw_index_create_append_data_offset (index, LW_INDEX_TABLE_CANONICAL, morphology->canonical, offset);
+      _lw_index_create_append_position (index, LW_INDEX_TABLE_CANONICAL, morphology->canonical, offset, position);
+    }
+}
+
+
+///!
+///! @brief Only to be used when creating the index
+///!
+static void
+_lw_index_create_flush_batch (LwIndexCreateBatch *batch)
+{
+    //Sanity checks
+    g_return_if_fail (batch != NULL);
+    g_return_if_fail (batch->index->checksum == NULL); //You cannot add a string if the checksum has already been created
+    if (batch->length == 0) return;
+
+    batch->texts[batch->length] = NULL;
+    lw_morphologyengine_analyze_batch (batch->index->morphologyengine, 
+                                       batch->texts, 
+                                       batch->length, 
+                                       FALSE, 
+                                       (LwMorphologyEngineBatchFunc) _lw_index_create_add_morphology, 
+                                       batch);
+    batch->length = 0;
+    batch->line = -1;
 }
 
 
@@ -246,7 +374,10 @@ lw_index_free (LwIndex *index)
     {
       if (index->table[i] != NULL) g_hash_table_unref (index->table[i]);
       if (index->buffer[i] != NULL) g_free (index->buffer[i]);
+      if (index->positions[i] != NULL) g_hash_table_unref (index->positions[i]);
+      if (index->positions_buffer[i] != NULL) g_free (index->positions_buffer[i]);
     }
+    lw_index_clear_sorted_keys (index);
     if (index->morphologyengine != NULL) g_object_unref (index->morphologyengine);
     if (index->path != NULL) g_free (index->path);
 
@@ -260,7 +391,6 @@ _lw_index_deep_index (LwIndex          *index,
                       LwDictionaryData *dictionarydata,
                       LwProgress       *progress)
 {
-printf("BREAK _lw_index_deep_index\n");
     //Sanity checks
     g_return_if_fail (index != NULL);
     g_return_if_fail (dictionarydata != NULL);
@@ -319,7 +449,6 @@ lw_index_create (LwIndex          *index,
                  LwDictionaryData *dictionarydata,
                  LwProgress       *progress)
 {
-printf("BREAK lw_index_create\n");
     //Sanity checks
     g_return_if_fail (index != NULL);
     g_return_if_fail (index->morphologyengine != NULL);
@@ -332,12 +461,17 @@ printf("BREAK lw_index_create\n");
     glong length = lw_dictionarydata_get_length (dictionarydata);
     gdouble fraction = 0.0;
     LwIndexTableType type = 0;
+
+    lw_index_clear_sorted_keys (index);
  
     //Clear the index tables
     for (type = 0; type < TOTAL_LW_INDEX_TABLES; type++)
     {
       if (index->table[type] != NULL) g_hash_table_unref (index->table[type]); index->table[type] = NULL;
       index->table[type] = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free); 
+      if (index->positions[type] != NULL) g_hash_table_unref (index->positions[type]); index->positions[type] = NULL;
+      if (index->positions_buffer[type] != NULL) g_free (index->positions_buffer[type]); index->positions_buffer[type] = NULL;
+      index->positions[type] = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free); 
     }
 
     //Clear the checksums
@@ -347,19 +481,33 @@ printf("BREAK lw_index_create\n");
     }
     if (index->checksum != NULL) g_free ((gchar*)index->checksum); index->checksum = NULL;
 
-    //Parse the data
+    //Parse the data in batches so the morphology engine can reuse its context
     const gchar *BUFFER = lw_dictionarydata_get_buffer (dictionarydata);
+    LwIndexCreateBatch *batch = g_new0 (LwIndexCreateBatch, 1);
+    batch->index = index;
+    batch->line = -1;
     do {
       LwOffset offset = lw_dictionarydata_get_offset (dictionarydata, BUFFER);
 
-      _lw_index_create_add_string (index, BUFFER, offset);
+      batch->texts[batch->length] = BUFFER;
+      batch->offsets[batch->length] = offset;
+      batch->length++;
 
-      lw_progress_set_fraction (progress, offset, length);
-      lw_progress_run_callback (progress);
+      if (batch->length == LW_INDEX_CREATE_BATCH_SIZE)
+      {
+        _lw_index_create_flush_batch (batch);
 
-      if (lw_progress_should_abort (progress)) goto errored;
+        lw_progress_set_fraction (progress, offset, length);
+        lw_progress_run_callback (progress);
+      }
+
+      if (lw_progress_should_abort (progress)) break;
 
     } while ((BUFFER = lw_dictionarydata_buffer_next (dictionarydata, BUFFER)) != NULL) ;
+    if (!lw_progress_should_abort (progress)) _lw_index_create_flush_batch (batch);
+    g_free (batch); batch = NULL;
+
+    if (lw_progress_should_abort (progress)) goto errored;
 
     //_lw_index_deep_index (index, dictionarydata, progress);
 
@@ -371,6 +519,7 @@ printf("BREAK lw_index_create\n");
       index->buffer[type] = g_strdup (lw_dictionarydata_get_checksum (dictionarydata));
     }
     index->checksum = g_strdup (lw_dictionarydata_get_checksum (dictionarydata));
+    index->version = LW_INDEX_FORMAT_VERSION;
 
     return;
 
@@ -380,6 +529,7 @@ errored:
     {
       if (index->table[type] != NULL) g_hash_table_unref (index->table[type]); index->table[type] = NULL;
       index->table[type] = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free); 
+      if (index->positions[type] != NULL) g_hash_table_unref (index->positions[type]); index->positions[type] = NULL;
     }
 }
 
@@ -591,6 +741,238 @@ errored:
 }
 
 
+//!
+//! @brief Fills keys with the forms of morphology that are looked up in a table
+//!        of type.  keys must have room for 3 and ends at the first NULL.
+//!
+static void
+_lw_index_get_keys_for_morphology (LwIndexTableType   type,
+                                   LwMorphology      *morphology,
+                                   const gchar      **keys)
+{
+    //Declarations
+    const gchar *form = NULL;
+    const gchar *RAW = lw_morphology_get_raw (morphology);
+    gint i = 0;
+
+    switch (type)
+    {
+      case LW_INDEX_TABLE_RAW:
+        form = NULL;
+        break;
+      case LW_INDEX_TABLE_NORMALIZED:
+        form = lw_morphology_get_normalized (morphology);
+        break;
+      case LW_INDEX_TABLE_STEM:
+        form = lw_morphology_get_stem (morphology);
+        break;
+      case LW_INDEX_TABLE_CANONICAL:
+        form = lw_morphology_get_canonical (morphology);
+        break;
+      default:
+        g_assert_not_reached ();
+        break;
+    }
+
+    if (form != NULL) keys[i++] = form;
+    if (RAW != NULL && g_strcmp0 (form, RAW) != 0) keys[i++] = RAW;
+    keys[i] = NULL;
+}
+
+
+static int
+_lw_index_compare_offsets (const void *a, const void *b)
+{
+    //Declarations
+    LwOffset offset_a = *((const LwOffset*) a);
+    LwOffset offset_b = *((const LwOffset*) b);
+
+    if (offset_a < offset_b) return -1;
+    if (offset_a > offset_b) return 1;
+
+    return 0;
+}
+
+
+//!
+//! @brief Counts the postings of the forms of a morphology without loading
+//!        them.  Lines with several of the forms are counted more than once
+//!        so it is an upper bound that is used to plan queries.
+//!
+gint
+lw_index_count_offsets_for_morphology (LwIndex          *index,
+                                       LwIndexTableType  type,
+                                       LwMorphology     *morphology)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, 0);
+    g_return_val_if_fail (morphology != NULL, 0);
+
+    //Declarations
+    const gchar *keys[] = { NULL, NULL, NULL };
+    gint count = 0;
+    gint i = 0;
+
+    //Initializations
+    _lw_index_get_keys_for_morphology (type, morphology, keys);
+
+    for (i = 0; keys[i] != NULL; i++)
+    {
+      count += _lw_index_get_data_offsets_length (index, type, keys[i]);
+    }
+
+    return count;
+}
+
+
+//!
+//! @brief Gets the lines that contain a morphology as a sorted posting list
+//!        that can be intersected and merged with others
+//! @param length Set to the number of offsets returned
+//! @returns A sorted array without repeats that should be freed with g_free()
+//!
+LwOffset*
+lw_index_get_sorted_offsets_for_morphology (LwIndex          *index,
+                                            LwIndexTableType  type,
+                                            LwMorphology     *morphology,
+                                            gint             *length)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, NULL);
+    g_return_val_if_fail (morphology != NULL, NULL);
+    g_return_val_if_fail (length != NULL, NULL);
+
+    //Declarations
+    const gchar *keys[] = { NULL, NULL, NULL };
+    LwOffset *offsets = NULL;
+    LwOffsets *postings = NULL;
+    gint postings_length = 0;
+    gint total = 0;
+    gint i = 0;
+    gint j = 0;
+
+    //Initializations
+    _lw_index_get_keys_for_morphology (type, morphology, keys);
+    total = lw_index_count_offsets_for_morphology (index, type, morphology);
+    offsets = g_new (LwOffset, MAX (total, 1));
+    *length = 0;
+
+    for (i = 0; keys[i] != NULL; i++)
+    {
+      postings = _lw_index_get_data_offsets (index, type, keys[i]); if (postings == NULL) continue;
+      postings_length = _lw_index_get_data_offsets_length (index, type, keys[i]);
+      memcpy (offsets + *length, postings, sizeof(LwOffset) * postings_length);
+      *length += postings_length;
+    }
+
+    if (*length > 1)
+    {
+      qsort (offsets, *length, sizeof(LwOffset), _lw_index_compare_offsets);
+      for (i = 1, j = 1; i < *length; i++)
+      {
+        if (offsets[i] != offsets[j - 1]) offsets[j++] = offsets[i];
+      }
+      *length = j;
+    }
+
+    return offsets;
+}
+
+
+//!
+//! @brief Checks if the table of type has the positional layer needed for
+//!        phrase and proximity queries
+//!
+gboolean
+lw_index_has_positions (LwIndex          *index,
+                        LwIndexTableType  type)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, FALSE);
+
+    return (index->positions[type] != NULL);
+}
+
+
+static int
+_lw_index_compare_positions (const void *a, const void *b)
+{
+    //Declarations
+    const LwIndexPosition *position_a = a;
+    const LwIndexPosition *position_b = b;
+
+    if (position_a->offset < position_b->offset) return -1;
+    if (position_a->offset > position_b->offset) return 1;
+    if (position_a->position < position_b->position) return -1;
+    if (position_a->position > position_b->position) return 1;
+
+    return 0;
+}
+
+
+//!
+//! @brief Gets everywhere the forms of a morphology occur ordered by line and
+//!        then by position in the line
+//! @param length Set to the number of positions returned
+//! @returns A sorted array without repeats that should be freed with g_free()
+//!          or NULL if the table has no positional layer
+//!
+LwIndexPosition*
+lw_index_get_sorted_positions_for_morphology (LwIndex          *index,
+                                              LwIndexTableType  type,
+                                              LwMorphology     *morphology,
+                                              gint             *length)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, NULL);
+    g_return_val_if_fail (morphology != NULL, NULL);
+    g_return_val_if_fail (length != NULL, NULL);
+
+    *length = 0;
+    if (index->positions[type] == NULL) return NULL;
+
+    //Declarations
+    const gchar *keys[] = { NULL, NULL, NULL };
+    LwOffset *data[] = { NULL, NULL };
+    LwIndexPosition *positions = NULL;
+    gint total = 0;
+    gint i = 0;
+    gint j = 0;
+
+    //Initializations
+    _lw_index_get_keys_for_morphology (type, morphology, keys);
+    for (i = 0; keys[i] != NULL; i++)
+    {
+      data[i] = g_hash_table_lookup (index->positions[type], keys[i]);
+      if (data[i] != NULL) total += (*data[i] - 1) / 2;
+    }
+    positions = g_new (LwIndexPosition, MAX (total, 1));
+
+    for (i = 0; keys[i] != NULL; i++)
+    {
+      if (data[i] == NULL) continue;
+      for (j = 1; j + 1 < *data[i]; j += 2)
+      {
+        positions[*length].offset = data[i][j];
+        positions[*length].position = data[i][j + 1];
+        (*length)++;
+      }
+    }
+
+    if (*length > 1)
+    {
+      qsort (positions, *length, sizeof(LwIndexPosition), _lw_index_compare_positions);
+      for (i = 1, j = 1; i < *length; i++)
+      {
+        if (_lw_index_compare_positions (positions + i, positions + j - 1) != 0) positions[j++] = positions[i];
+      }
+      *length = j;
+    }
+
+    return positions;
+}
+
+
 ///!
 ///! @brief Returns a hash table of results based on a morphology query from a specific LwIndexTableType
 ///!
@@ -611,28 +993,7 @@ _lw_index_get_matches_for_morphology (LwIndex          *index,
     const gchar *keys[] = { NULL, NULL, NULL };
 
     //Initializations
-    switch (type)
-    {
-      case LW_INDEX_TABLE_RAW:
-        keys[0] = lw_morphology_get_raw (morphology);
-        break;
-      case LW_INDEX_TABLE_NORMALIZED:
-        keys[0] = lw_morphology_get_normalized (morphology);
-        keys[1] = lw_morphology_get_raw (morphology);
-        break;
-      case LW_INDEX_TABLE_STEM:
-        keys[0] = lw_morphology_get_stem (morphology);
-        keys[1] = lw_morphology_get_raw (morphology);
-        break;
-      case LW_INDEX_TABLE_CANONICAL:
-        keys[0] = lw_morphology_get_canonical (morphology);
-        keys[1] = lw_morphology_get_raw (morphology);
-        break;
-      default:
-        g_assert_not_reached ();
-        goto errored;
-        break;
-    }
+    _lw_index_get_keys_for_morphology (type, morphology, keys);
 
     //Hash all of the offsets, keeping count
     for (i = 0; keys[i] != NULL; i++)
@@ -810,7 +1171,8 @@ _lw_index_write_by_type (LwIndex          *index,
     size = g_hash_table_size (index->table[type]);
     i = 0;
 
-    //Write the checksum with terminating null character
+    //Write the format version and the checksum with terminating null characters
+    fprintf (fd, "%s %d%c", LW_INDEX_FORMAT_MAGIC, LW_INDEX_FORMAT_VERSION, '\0');
     fwrite (index->checksum, sizeof(gchar), strlen(index->checksum) + 1, fd);
 
     //Write the key/values
@@ -840,6 +1202,51 @@ errored:
 }
 
 
+//!
+//! @brief Writes the positional layer of a table next to its index file.  It
+//!        has the same layout of a format version and a checksum followed by
+//!        keys and arrays.
+//!
+static void
+_lw_index_write_positions_by_type (LwIndex          *index, 
+                                   LwIndexTableType  type,
+                                   const gchar*      PATH)
+{
+    //Sanity checks
+    g_return_if_fail (index != NULL);
+    g_return_if_fail (index->checksum != NULL);
+    g_return_if_fail (PATH != NULL);
+    if (index->positions[type] == NULL) return;
+
+    //Declarations
+    FILE *fd = NULL;
+    GHashTableIter iter;
+    gchar *key = NULL;
+    LwOffset *data = NULL;
+    const gchar *SUFFIX = _lw_index_table_type_to_string (type);
+    gchar *path = NULL;
+
+    //Initializations
+    path = g_strjoin (".", PATH, SUFFIX, "positions", NULL); if (path == NULL) goto errored;
+    fd = g_fopen (path, "wb"); if (fd == NULL) goto errored;
+
+    fprintf (fd, "%s %d%c", LW_INDEX_FORMAT_MAGIC, LW_INDEX_FORMAT_VERSION, '\0');
+    fwrite (index->checksum, sizeof(gchar), strlen(index->checksum) + 1, fd);
+
+    g_hash_table_iter_init (&iter, index->positions[type]);
+    while (g_hash_table_iter_next (&iter, (gpointer*) &key, (gpointer*) &data))
+    {
+      fwrite (key, sizeof(gchar), strlen(key) + 1, fd);
+      fwrite (data, sizeof(LwOffset), *data, fd);
+    }
+
+errored:
+
+    if (path != NULL) g_free (path); path = NULL;
+    if (fd != NULL) fclose(fd); fd = NULL;
+}
+
+
 ///!
 ///! @brief Writes the all hashes used for the index to respecitive files
 ///!
@@ -869,6 +1276,7 @@ lw_index_write (LwIndex     *index,
     for (type = 0; type < TOTAL_LW_INDEX_TABLES; type++)
     {
       current_progress = _lw_index_write_by_type (index, type, current_progress, total_progress, PATH, progress);
+      _lw_index_write_positions_by_type (index, type, PATH);
     }
 }
 
@@ -930,6 +1338,7 @@ _lw_index_read_by_type (LwIndex          *index,
     gchar *buffer = NULL;
     gchar *ptr = NULL;
     const gchar *checksum = NULL;
+    gint version = 0;
     gsize length = 0;
     gdouble fraction;
     const gchar *SUFFIX = _lw_index_table_type_to_string (type);
@@ -941,6 +1350,11 @@ _lw_index_read_by_type (LwIndex          *index,
     if (!g_file_get_contents (path, &buffer, &length, NULL)) goto errored;
     ptr = buffer;
 
+    //Files of older formats are rebuilt instead of being read with the wrong keys
+    if (sscanf (ptr, LW_INDEX_FORMAT_MAGIC " %d", &version) != 1 || version != LW_INDEX_FORMAT_VERSION) goto errored;
+    while (*ptr != '\0' && ptr - buffer < length) ptr++; ptr++;
+    if (ptr - buffer >= length) goto errored;
+
     //Get the checksum
     checksum = ptr;
 
@@ -979,6 +1393,7 @@ _lw_index_read_by_type (LwIndex          *index,
     index->path = g_strdup (PATH); 
 
     index->checksum = checksum;
+    index->version = version;
 
     if (path != NULL) g_free (path); path = NULL;
 
@@ -996,6 +1411,71 @@ errored:
 }
 
 
+//!
+//! @brief Loads the positional layer of a table if it was written for the same
+//!        dictionary.  Indexes without one still work but phrases are only
+//!        checked for containing all of their words.
+//!
+static void
+_lw_index_read_positions_by_type (LwIndex          *index, 
+                                  LwIndexTableType  type,
+                                  const gchar      *PATH)
+{
+    //Sanity checks
+    g_return_if_fail (index != NULL);
+    g_return_if_fail (PATH != NULL);
+    if (index->checksum == NULL) return;
+    if (index->positions_buffer[type] != NULL) return;
+
+    //Declarations
+    GHashTable *table = NULL;
+    gchar *buffer = NULL;
+    gchar *ptr = NULL;
+    gchar *key = NULL;
+    LwOffset *data = NULL;
+    gint version = 0;
+    gsize length = 0;
+    const gchar *SUFFIX = _lw_index_table_type_to_string (type);
+    gchar *path = NULL;
+
+    //Initializations
+    path = g_strjoin (".", PATH, SUFFIX, "positions", NULL); if (path == NULL) goto errored;
+    if (!g_file_get_contents (path, &buffer, &length, NULL)) goto errored;
+    ptr = buffer;
+
+    //Stale or foreign files would be read as offsets.  lw_index_exists() has them rebuilt.
+    if (sscanf (ptr, LW_INDEX_FORMAT_MAGIC " %d", &version) != 1 || version != LW_INDEX_FORMAT_VERSION) goto errored;
+    while (*ptr != '\0' && ptr - buffer < length) ptr++; ptr++;
+    if (ptr - buffer + strlen (index->checksum) >= length || strcmp (ptr, index->checksum) != 0) goto errored;
+    table = g_hash_table_new (g_str_hash, g_str_equal); if (table == NULL) goto errored;
+    ptr += strlen (index->checksum) + 1;
+
+    while (ptr - buffer < length)
+    {
+      key = ptr;
+      while (*ptr != '\0' && ptr - buffer < length) ptr++; ptr++;
+      if (ptr - buffer + sizeof(LwOffset) > length) goto errored;
+
+      data = (LwOffset*) ptr;
+      ptr += (*data * sizeof(LwOffset));
+      if (*data < 1 || ptr - buffer > length) goto errored; 
+
+      g_hash_table_insert (table, key, data);
+    }
+
+    if (index->positions[type] != NULL) g_hash_table_unref (index->positions[type]);
+    index->positions[type] = table; table = NULL;
+    if (index->positions_buffer[type] != NULL) g_free (index->positions_buffer[type]);
+    index->positions_buffer[type] = buffer; buffer = NULL;
+
+errored:
+
+    if (path != NULL) g_free (path); path = NULL;
+    if (buffer != NULL) g_free (buffer); buffer = NULL;
+    if (table != NULL) g_hash_table_unref (table); table = NULL;
+}
+
+
 ///!
 ///! @brief Loads the supported index files into the LwIndex
 ///! 
@@ -1013,9 +1493,12 @@ lw_index_read (LwIndex     *index,
     gsize current_progress = 0;
     gsize total_progress = lw_index_get_length (index, PATH);
 
+    lw_index_clear_sorted_keys (index);
+
     for (type = 0; type < TOTAL_LW_INDEX_TABLES; type++)
     {
       current_progress = _lw_index_read_by_type (index, type, current_progress, total_progress, PATH, progress);
+      _lw_index_read_positions_by_type (index, type, PATH);
     }
 }
 
@@ -1046,6 +1529,31 @@ lw_index_are_equal (LwIndex *index1,
 }
 
 
+//!
+//! @brief Reads just the start of an index file to check its format version
+//!
+static gboolean
+_lw_index_file_is_current (const gchar *PATH)
+{
+    //Declarations
+    FILE *fd = NULL;
+    gchar header[32];
+    gsize length = 0;
+    gint version = 0;
+
+    fd = g_fopen (PATH, "rb"); if (fd == NULL) return FALSE;
+    length = fread (header, sizeof(gchar), sizeof(header) - 1, fd);
+    header[length] = '\0';
+    fclose (fd); fd = NULL;
+
+    return (sscanf (header, LW_INDEX_FORMAT_MAGIC " %d", &version) == 1 && version == LW_INDEX_FORMAT_VERSION);
+}
+
+
+//!
+//! @returns TRUE if every table of the index was written in the current
+//!          format.  Indexes of older formats have to be created again.
+//!
 gboolean
 lw_index_exists (const gchar *PATH)
 {
@@ -1065,6 +1573,15 @@ lw_index_exists (const gchar *PATH)
       if (path != NULL)
       {
         if (g_file_test (path, G_FILE_TEST_IS_REGULAR) == FALSE) all_exist = FALSE;
+        else if (!_lw_index_file_is_current (path)) all_exist = FALSE;
+        g_free (path); path = NULL;
+      }
+
+      //The positional layers are optional but one of another format means the index is stale
+      path = g_strjoin (".", PATH, SUFFIX, "positions", NULL);
+      if (path != NULL)
+      {
+        if (g_file_test (path, G_FILE_TEST_IS_REGULAR) && !_lw_index_file_is_current (path)) all_exist = FALSE;
         g_free (path); path = NULL;
       }
     }
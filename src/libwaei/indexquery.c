@@ -0,0 +1,837 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file indexquery.c
+//!
+//! @brief Parses boolean queries and answers them with intersections, unions
+//!        and differences of sorted index postings instead of regex scans
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <libwaei/libwaei.h>
+#include <libwaei/gettext.h>
+
+
+#define LW_INDEXQUERY_OPERATORS "&|!\"()"
+#define LW_INDEXQUERY_GALLOP_RATIO 8 //!< Binary search the longer list once it is this many times longer
+
+
+static LwIndexQuery* _lw_indexquery_parse_or (const gchar **ptr);
+
+
+static LwIndexQuery*
+_lw_indexquery_new_node (LwIndexQueryType  type,
+                         gchar            *text)
+{
+    //Declarations
+    LwIndexQuery *query = NULL;
+
+    //Initializations
+    query = g_new0 (LwIndexQuery, 1); if (query == NULL) goto errored;
+    query->type = type;
+    query->text = text;
+
+errored:
+
+    return query;
+}
+
+
+void
+lw_indexquery_free (LwIndexQuery *query)
+{
+    //Sanity checks
+    if (query == NULL) return;
+
+    g_list_free_full (query->children, (GDestroyNotify) lw_indexquery_free); query->children = NULL;
+    if (query->morphologylist != NULL) lw_morphologylist_unref (query->morphologylist); query->morphologylist = NULL;
+    if (query->text != NULL) g_free (query->text); query->text = NULL;
+
+    memset(query, 0, sizeof(LwIndexQuery));
+    g_free (query);
+}
+
+
+//Parsing/////////////////////////////////////////////////////////
+
+
+static void
+_lw_indexquery_skip_spaces (const gchar **ptr)
+{
+    while (g_ascii_isspace (**ptr)) (*ptr)++;
+}
+
+
+//!
+//! @brief Reads a parenthesized expression, a quoted phrase or a plain term.
+//!        Terms with regex characters are rejected since they are real patterns.
+//!        A phrase followed by ~N only needs its words within N words of each other.
+//!
+static LwIndexQuery*
+_lw_indexquery_parse_primary (const gchar **ptr)
+{
+    //Declarations
+    LwIndexQuery *query = NULL;
+    LwIndexQueryType type = LW_INDEXQUERY_TERM;
+    const gchar *start = NULL;
+    const gchar *end = NULL;
+    gchar *text = NULL;
+    gint distance = 0;
+
+    _lw_indexquery_skip_spaces (ptr);
+
+    if (**ptr == '(')
+    {
+      (*ptr)++;
+      query = _lw_indexquery_parse_or (ptr); if (query == NULL) goto errored;
+      _lw_indexquery_skip_spaces (ptr);
+      if (**ptr != ')') goto errored;
+      (*ptr)++;
+    }
+    else
+    {
+      if (**ptr == '"')
+      {
+        type = LW_INDEXQUERY_PHRASE;
+        start = *ptr + 1;
+        end = strchr (start, '"'); if (end == NULL) goto errored;
+        *ptr = end + 1;
+        if (**ptr == '~')
+        {
+          (*ptr)++;
+          if (!g_ascii_isdigit (**ptr)) goto errored;
+          distance = (gint) MIN (g_ascii_strtoull (*ptr, (gchar**) ptr, 10), G_MAXINT);
+        }
+      }
+      else
+      {
+        start = *ptr;
+        end = start + strcspn (start, LW_INDEXQUERY_OPERATORS);
+        if (*end == '!') goto errored;
+        *ptr = end;
+      }
+
+      text = g_strstrip (g_strndup (start, end - start));
+      if (*text == '\0' || lw_util_has_regex_char (text)) goto errored;
+      query = _lw_indexquery_new_node (type, text); text = NULL;
+      query->distance = distance;
+    }
+
+    _lw_indexquery_skip_spaces (ptr);
+
+    return query;
+
+errored:
+
+    if (text != NULL) g_free (text); text = NULL;
+    if (query != NULL) lw_indexquery_free (query); query = NULL;
+
+    return NULL;
+}
+
+
+static LwIndexQuery*
+_lw_indexquery_parse_unary (const gchar **ptr)
+{
+    //Declarations
+    LwIndexQuery *query = NULL;
+    LwIndexQuery *child = NULL;
+
+    _lw_indexquery_skip_spaces (ptr);
+
+    if (**ptr != '!') return _lw_indexquery_parse_primary (ptr);
+
+    (*ptr)++;
+    child = _lw_indexquery_parse_primary (ptr); if (child == NULL) return NULL;
+    query = _lw_indexquery_new_node (LW_INDEXQUERY_NOT, NULL);
+    query->children = g_list_append (query->children, child);
+
+    return query;
+}
+
+
+//!
+//! @brief Reads operands separated by operator, flattening them into one node
+//!
+static LwIndexQuery*
+_lw_indexquery_parse_operands (const gchar       **ptr,
+                               gchar               operator,
+                               LwIndexQueryType    type,
+                               LwIndexQuery*     (*parse_operand)(const gchar**))
+{
+    //Declarations
+    LwIndexQuery *query = NULL;
+    LwIndexQuery *operand = NULL;
+
+    //Initializations
+    operand = parse_operand (ptr); if (operand == NULL) goto errored;
+    if (**ptr != operator) return operand;
+
+    query = _lw_indexquery_new_node (type, NULL);
+    query->children = g_list_append (query->children, operand); operand = NULL;
+
+    while (**ptr == operator)
+    {
+      (*ptr)++;
+      operand = parse_operand (ptr); if (operand == NULL) goto errored;
+      query->children = g_list_append (query->children, operand); operand = NULL;
+    }
+
+    return query;
+
+errored:
+
+    if (query != NULL) lw_indexquery_free (query); query = NULL;
+
+    return NULL;
+}
+
+
+static LwIndexQuery*
+_lw_indexquery_parse_and (const gchar **ptr)
+{
+    return _lw_indexquery_parse_operands (ptr, '&', LW_INDEXQUERY_AND, _lw_indexquery_parse_unary);
+}
+
+
+static LwIndexQuery*
+_lw_indexquery_parse_or (const gchar **ptr)
+{
+    return _lw_indexquery_parse_operands (ptr, '|', LW_INDEXQUERY_OR, _lw_indexquery_parse_and);
+}
+
+
+//!
+//! @brief Checks that the lines matching query can be listed from postings.
+//!        A NOT can only take lines away from the other operands of an AND.
+//!
+static gboolean
+_lw_indexquery_is_enumerable (LwIndexQuery *query)
+{
+    //Declarations
+    GList *link = NULL;
+    LwIndexQuery *child = NULL;
+    gboolean has_positive = FALSE;
+
+    switch (query->type)
+    {
+      case LW_INDEXQUERY_TERM:
+      case LW_INDEXQUERY_PHRASE:
+        return TRUE;
+      case LW_INDEXQUERY_OR:
+        for (link = query->children; link != NULL; link = link->next)
+        {
+          if (!_lw_indexquery_is_enumerable (LW_INDEXQUERY (link->data))) return FALSE;
+        }
+        return TRUE;
+      case LW_INDEXQUERY_AND:
+        for (link = query->children; link != NULL; link = link->next)
+        {
+          child = LW_INDEXQUERY (link->data);
+          if (child->type == LW_INDEXQUERY_NOT) child = LW_INDEXQUERY (child->children->data);
+          else has_positive = TRUE;
+          if (!_lw_indexquery_is_enumerable (child)) return FALSE;
+        }
+        return has_positive;
+      default:
+        return FALSE;
+    }
+}
+
+
+//!
+//! @brief Parses a boolean query.  & binds tighter than |, ! negates the
+//!        operand after it, parentheses group and double quotes make a phrase
+//!        that can be loosened to a proximity query with ~N.
+//! @param QUERY The text the user searched for
+//! @returns A new LwIndexQuery or NULL if QUERY is a plain query that the
+//!          regular index search handles, a regex pattern, or malformed
+//!
+LwIndexQuery*
+lw_indexquery_new (const gchar *QUERY)
+{
+    //Sanity checks
+    g_return_val_if_fail (QUERY != NULL, NULL);
+    if (strpbrk (QUERY, LW_INDEXQUERY_OPERATORS) == NULL) return NULL;
+
+    //Declarations
+    LwIndexQuery *query = NULL;
+    const gchar *ptr = QUERY;
+
+    //Initializations
+    query = _lw_indexquery_parse_or (&ptr); if (query == NULL) goto errored;
+    if (*ptr != '\0') goto errored;
+    if (query->type == LW_INDEXQUERY_TERM) goto errored;
+    if (!_lw_indexquery_is_enumerable (query)) goto errored;
+
+    return query;
+
+errored:
+
+    if (query != NULL) lw_indexquery_free (query); query = NULL;
+
+    return NULL;
+}
+
+
+//!
+//! @returns The text of the terms and phrases that lines have to match
+//!          separated by spaces so the results can be scored against them
+//!
+gchar*
+lw_indexquery_get_terms (LwIndexQuery *query)
+{
+    //Sanity checks
+    g_return_val_if_fail (query != NULL, NULL);
+
+    //Declarations
+    GString *terms = NULL;
+    GList *link = NULL;
+    gchar *child_terms = NULL;
+
+    //Initializations
+    terms = g_string_new (query->text);
+
+    if (query->type == LW_INDEXQUERY_AND || query->type == LW_INDEXQUERY_OR)
+    {
+      for (link = query->children; link != NULL; link = link->next)
+      {
+        if (LW_INDEXQUERY (link->data)->type == LW_INDEXQUERY_NOT) continue;
+        child_terms = lw_indexquery_get_terms (LW_INDEXQUERY (link->data));
+        if (terms->len > 0 && *child_terms != '\0') g_string_append_c (terms, ' ');
+        g_string_append (terms, child_terms);
+        g_free (child_terms); child_terms = NULL;
+      }
+    }
+
+    return g_string_free (terms, FALSE);
+}
+
+
+//Planning and execution//////////////////////////////////////////
+
+
+static LwMorphologyList*
+_lw_indexquery_get_morphologylist (LwIndexQuery *query,
+                                   LwIndex      *index)
+{
+    if (query->morphologylist == NULL)
+    {
+      query->morphologylist = lw_morphologyengine_analyze (index->morphologyengine, query->text, TRUE);
+    }
+
+    return query->morphologylist;
+}
+
+
+//!
+//! @brief Guesses how many lines query matches from the lengths of its
+//!        postings without loading them so the cheapest operands go first
+//!
+gint
+lw_indexquery_estimate (LwIndexQuery     *query,
+                        LwIndex          *index,
+                        LwIndexTableType  type)
+{
+    //Sanity checks
+    g_return_val_if_fail (query != NULL, 0);
+    g_return_val_if_fail (index != NULL, 0);
+
+    //Declarations
+    LwMorphologyList *morphologylist = NULL;
+    GList *link = NULL;
+    LwIndexQuery *child = NULL;
+    gint64 estimate = 0;
+    gint64 count = 0;
+    gboolean first = TRUE;
+
+    switch (query->type)
+    {
+      case LW_INDEXQUERY_TERM:
+      case LW_INDEXQUERY_PHRASE:
+        morphologylist = _lw_indexquery_get_morphologylist (query, index); if (morphologylist == NULL) break;
+        for (link = morphologylist->list; link != NULL; link = link->next)
+        {
+          count = lw_index_count_offsets_for_morphology (index, type, link->data);
+          if (first || count < estimate) estimate = count;
+          first = FALSE;
+        }
+        break;
+      case LW_INDEXQUERY_AND:
+        for (link = query->children; link != NULL; link = link->next)
+        {
+          child = LW_INDEXQUERY (link->data);
+          if (child->type == LW_INDEXQUERY_NOT) continue;
+          count = lw_indexquery_estimate (child, index, type);
+          if (first || count < estimate) estimate = count;
+          first = FALSE;
+        }
+        break;
+      case LW_INDEXQUERY_OR:
+        for (link = query->children; link != NULL; link = link->next)
+        {
+          estimate += lw_indexquery_estimate (LW_INDEXQUERY (link->data), index, type);
+        }
+        break;
+      default:
+        estimate = G_MAXINT;
+        break;
+    }
+
+    return (gint) MIN (estimate, G_MAXINT);
+}
+
+
+//!
+//! @brief Keeps the offsets of a that are also in b.  Both are sorted.  When b
+//!        is much longer it is binary searched instead of walked.
+//! @returns The new length of a
+//!
+static gint
+_lw_indexquery_intersect (LwOffset       *a,
+                          gint            a_length,
+                          const LwOffset *b,
+                          gint            b_length)
+{
+    //Declarations
+    gint i = 0;
+    gint j = 0;
+    gint length = 0;
+    gint low = 0;
+    gint high = 0;
+    gint middle = 0;
+
+    if ((gint64) a_length * LW_INDEXQUERY_GALLOP_RATIO < b_length)
+    {
+      for (i = 0; i < a_length; i++)
+      {
+        low = j;
+        high = b_length;
+        while (low < high)
+        {
+          middle = low + (high - low) / 2;
+          if (b[middle] < a[i]) low = middle + 1;
+          else high = middle;
+        }
+        j = low;
+        if (j < b_length && b[j] == a[i]) a[length++] = a[i];
+      }
+    }
+    else
+    {
+      while (i < a_length && j < b_length)
+      {
+        if (a[i] < b[j]) i++;
+        else if (a[i] > b[j]) j++;
+        else { a[length++] = a[i]; i++; j++; }
+      }
+    }
+
+    return length;
+}
+
+
+//!
+//! @brief Drops the offsets of a that are in b.  Both are sorted.
+//! @returns The new length of a
+//!
+static gint
+_lw_indexquery_subtract (LwOffset       *a,
+                         gint            a_length,
+                         const LwOffset *b,
+                         gint            b_length)
+{
+    //Declarations
+    gint i = 0;
+    gint j = 0;
+    gint length = 0;
+
+    for (i = 0; i < a_length; i++)
+    {
+      while (j < b_length && b[j] < a[i]) j++;
+      if (j < b_length && b[j] == a[i]) continue;
+      a[length++] = a[i];
+    }
+
+    return length;
+}
+
+
+//!
+//! @returns The sorted offsets that are in a or b without repeats
+//!
+static LwOffset*
+_lw_indexquery_union (const LwOffset *a,
+                      gint            a_length,
+                      const LwOffset *b,
+                      gint            b_length,
+                      gint           *length)
+{
+    //Declarations
+    LwOffset *offsets = g_new (LwOffset, MAX (a_length + b_length, 1));
+    gint i = 0;
+    gint j = 0;
+
+    *length = 0;
+
+    while (i < a_length || j < b_length)
+    {
+      if (j >= b_length || (i < a_length && a[i] < b[j])) offsets[(*length)++] = a[i++];
+      else if (i >= a_length || b[j] < a[i]) offsets[(*length)++] = b[j++];
+      else { offsets[(*length)++] = a[i]; i++; j++; }
+    }
+
+    return offsets;
+}
+
+
+//!
+//! @brief An operand of an AND along with how many lines it is guessed to match
+//!
+struct _LwIndexQueryOperand {
+  gpointer operand;  //!< An LwIndexQuery or an LwMorphology
+  gint estimate;
+};
+typedef struct _LwIndexQueryOperand LwIndexQueryOperand;
+
+
+static int
+_lw_indexquery_compare_operands (const void *a, const void *b)
+{
+    //Declarations
+    const LwIndexQueryOperand *operand_a = a;
+    const LwIndexQueryOperand *operand_b = b;
+
+    if (operand_a->estimate < operand_b->estimate) return -1;
+    if (operand_a->estimate > operand_b->estimate) return 1;
+
+    return 0;
+}
+
+
+static LwOffset*
+_lw_indexquery_get_term_matches (LwIndexQuery     *query,
+                                 LwIndex          *index,
+                                 LwIndexTableType  type,
+                                 gint             *length)
+{
+    //Declarations
+    LwMorphologyList *morphologylist = NULL;
+    LwIndexQueryOperand *operands = NULL;
+    LwOffset *offsets = NULL;
+    LwOffset *other = NULL;
+    gint other_length = 0;
+    gint total = 0;
+    gint i = 0;
+    GList *link = NULL;
+
+    //Initializations
+    *length = 0;
+    morphologylist = _lw_indexquery_get_morphologylist (query, index); if (morphologylist == NULL) goto errored;
+    total = lw_morphologylist_length (morphologylist); if (total == 0) goto errored;
+    operands = g_new (LwIndexQueryOperand, total);
+
+    for (link = morphologylist->list, i = 0; link != NULL; link = link->next, i++)
+    {
+      operands[i].operand = link->data;
+      operands[i].estimate = lw_index_count_offsets_for_morphology (index, type, link->data);
+    }
+    qsort (operands, total, sizeof(LwIndexQueryOperand), _lw_indexquery_compare_operands);
+
+    //Every morphology has to be there, starting from the rarest
+    offsets = lw_index_get_sorted_offsets_for_morphology (index, type, operands[0].operand, length);
+    for (i = 1; i < total && *length > 0; i++)
+    {
+      other = lw_index_get_sorted_offsets_for_morphology (index, type, operands[i].operand, &other_length);
+      *length = _lw_indexquery_intersect (offsets, *length, other, other_length);
+      g_free (other); other = NULL;
+    }
+
+errored:
+
+    if (operands != NULL) g_free (operands); operands = NULL;
+
+    return offsets;
+}
+
+
+//!
+//! @brief Checks the positions of one line for the words of a phrase.  With a
+//!        distance of 0 they have to follow each other in order, otherwise they
+//!        only need to fit in a window spanning that many words.
+//! @param slices The positions of each word on the line in phrase order
+//! @param starts Where each slice starts and is used as a cursor
+//! @param ends Where each slice ends
+//!
+static gboolean
+_lw_indexquery_positions_match (LwIndexPosition **slices,
+                                gint             *starts,
+                                const gint       *ends,
+                                gint              total,
+                                gint              distance)
+{
+    //Declarations
+    gint i = 0;
+    gint k = 0;
+    gint smallest = 0;
+    guint32 position = 0;
+    guint32 low = 0;
+    guint32 high = 0;
+    gboolean found = FALSE;
+
+    if (distance == 0)
+    {
+      for (i = starts[0]; i < ends[0]; i++)
+      {
+        position = slices[0][i].position;
+        for (k = 1; k < total; k++)
+        {
+          while (starts[k] < ends[k] && slices[k][starts[k]].position < position + k) starts[k]++;
+          if (starts[k] == ends[k]) return FALSE;
+          if (slices[k][starts[k]].position != position + k) break;
+        }
+        if (k == total) return TRUE;
+      }
+      return FALSE;
+    }
+
+    //Slide the smallest position forward until every word fits in the window
+    while (TRUE)
+    {
+      low = G_MAXUINT32;
+      high = 0;
+      for (k = 0; k < total; k++)
+      {
+        position = slices[k][starts[k]].position;
+        if (position < low) { low = position; smallest = k; }
+        if (position > high) high = position;
+      }
+      found = (high - low <= (guint32) distance);
+      if (found || ++starts[smallest] == ends[smallest]) break;
+    }
+
+    return found;
+}
+
+
+//!
+//! @brief Keeps the offsets where the words of a phrase are next to each other
+//!        using the positional layer of the index.  Indexes made before it
+//!        existed keep every line with all of the words.
+//! @returns The new length of offsets
+//!
+static gint
+_lw_indexquery_filter_phrase (LwIndexQuery     *query,
+                              LwIndex          *index,
+                              LwIndexTableType  type,
+                              LwOffset         *offsets,
+                              gint              length)
+{
+    //Declarations
+    LwIndexPosition **positions = NULL;
+    gint *lengths = NULL;
+    gint *cursors = NULL;
+    gint *starts = NULL;
+    gint *ends = NULL;
+    gint total = 0;
+    gint filtered = 0;
+    gint i = 0;
+    gint k = 0;
+    GList *link = NULL;
+
+    //Initializations
+    if (!lw_index_has_positions (index, type)) goto errored;
+    if (query->morphologylist == NULL) goto errored;
+    total = lw_morphologylist_length (query->morphologylist); if (total < 2) goto errored;
+    positions = g_new0 (LwIndexPosition*, total);
+    lengths = g_new0 (gint, total);
+    cursors = g_new0 (gint, total);
+    starts = g_new0 (gint, total);
+    ends = g_new0 (gint, total);
+
+    for (link = query->morphologylist->list, k = 0; link != NULL; link = link->next, k++)
+    {
+      positions[k] = lw_index_get_sorted_positions_for_morphology (index, type, link->data, &lengths[k]);
+    }
+
+    for (i = 0; i < length; i++)
+    {
+      for (k = 0; k < total; k++)
+      {
+        while (cursors[k] < lengths[k] && positions[k][cursors[k]].offset < offsets[i]) cursors[k]++;
+        starts[k] = cursors[k];
+        while (cursors[k] < lengths[k] && positions[k][cursors[k]].offset == offsets[i]) cursors[k]++;
+        ends[k] = cursors[k];
+        if (starts[k] == ends[k]) break;
+      }
+      if (k < total) continue;
+      if (_lw_indexquery_positions_match (positions, starts, ends, total, query->distance)) offsets[filtered++] = offsets[i];
+    }
+    length = filtered;
+
+errored:
+
+    if (positions != NULL)
+    {
+      for (k = 0; k < total; k++) g_free (positions[k]);
+      g_free (positions); positions = NULL;
+    }
+    if (lengths != NULL) g_free (lengths); lengths = NULL;
+    if (cursors != NULL) g_free (cursors); cursors = NULL;
+    if (starts != NULL) g_free (starts); starts = NULL;
+    if (ends != NULL) g_free (ends); ends = NULL;
+
+    return length;
+}
+
+
+static LwOffset*
+_lw_indexquery_get_and_matches (LwIndexQuery     *query,
+                                LwIndex          *index,
+                                LwIndexTableType  type,
+                                gint             *length)
+{
+    //Declarations
+    LwIndexQueryOperand *operands = NULL;
+    LwIndexQuery *child = NULL;
+    LwOffset *offsets = NULL;
+    LwOffset *other = NULL;
+    gint other_length = 0;
+    gint total = 0;
+    gint i = 0;
+    GList *link = NULL;
+
+    //Initializations
+    *length = 0;
+    operands = g_new (LwIndexQueryOperand, g_list_length (query->children));
+
+    for (link = query->children; link != NULL; link = link->next)
+    {
+      child = LW_INDEXQUERY (link->data);
+      if (child->type == LW_INDEXQUERY_NOT) continue;
+      operands[total].operand = child;
+      operands[total].estimate = lw_indexquery_estimate (child, index, type);
+      total++;
+    }
+    if (total == 0) goto errored;
+    qsort (operands, total, sizeof(LwIndexQueryOperand), _lw_indexquery_compare_operands);
+
+    //The cheapest operand bounds the result so the others are only intersected while something is left
+    offsets = lw_indexquery_get_matches (operands[0].operand, index, type, length);
+    for (i = 1; i < total && *length > 0; i++)
+    {
+      other = lw_indexquery_get_matches (operands[i].operand, index, type, &other_length);
+      *length = _lw_indexquery_intersect (offsets, *length, other, other_length);
+      g_free (other); other = NULL;
+    }
+
+    for (link = query->children; link != NULL && *length > 0; link = link->next)
+    {
+      child = LW_INDEXQUERY (link->data);
+      if (child->type != LW_INDEXQUERY_NOT) continue;
+      other = lw_indexquery_get_matches (LW_INDEXQUERY (child->children->data), index, type, &other_length);
+      *length = _lw_indexquery_subtract (offsets, *length, other, other_length);
+      g_free (other); other = NULL;
+    }
+
+errored:
+
+    if (operands != NULL) g_free (operands); operands = NULL;
+
+    return offsets;
+}
+
+
+static LwOffset*
+_lw_indexquery_get_or_matches (LwIndexQuery     *query,
+                               LwIndex          *index,
+                               LwIndexTableType  type,
+                               gint             *length)
+{
+    //Declarations
+    LwOffset *offsets = NULL;
+    LwOffset *other = NULL;
+    LwOffset *merged = NULL;
+    gint other_length = 0;
+    GList *link = NULL;
+
+    //Initializations
+    *length = 0;
+
+    for (link = query->children; link != NULL; link = link->next)
+    {
+      other = lw_indexquery_get_matches (LW_INDEXQUERY (link->data), index, type, &other_length);
+      merged = _lw_indexquery_union (offsets, *length, other, other_length, length);
+      g_free (other); other = NULL;
+      g_free (offsets); offsets = merged; merged = NULL;
+    }
+
+    return offsets;
+}
+
+
+//!
+//! @brief Answers query from the postings of one table of the index
+//! @param length Set to the number of offsets returned
+//! @returns The sorted offsets of the matching lines that should be freed with
+//!          g_free() or NULL if nothing matched
+//!
+LwOffset*
+lw_indexquery_get_matches (LwIndexQuery     *query,
+                           LwIndex          *index,
+                           LwIndexTableType  type,
+                           gint             *length)
+{
+    //Sanity checks
+    g_return_val_if_fail (query != NULL, NULL);
+    g_return_val_if_fail (index != NULL, NULL);
+    g_return_val_if_fail (length != NULL, NULL);
+
+    //Declarations
+    LwOffset *offsets = NULL;
+
+    *length = 0;
+
+    switch (query->type)
+    {
+      case LW_INDEXQUERY_TERM:
+        return _lw_indexquery_get_term_matches (query, index, type, length);
+      case LW_INDEXQUERY_PHRASE:
+        offsets = _lw_indexquery_get_term_matches (query, index, type, length);
+        if (*length > 0) *length = _lw_indexquery_filter_phrase (query, index, type, offsets, *length);
+        return offsets;
+      case LW_INDEXQUERY_AND:
+        return _lw_indexquery_get_and_matches (query, index, type, length);
+      case LW_INDEXQUERY_OR:
+        return _lw_indexquery_get_or_matches (query, index, type, length);
+      default:
+        g_return_val_if_reached (NULL);
+    }
+}
@@ -38,20 +38,21 @@
 
 
 //!
-//! @brief Allocates a new empty LwMorphology object.
+//! @brief Initializes a LwMorphology in place, taking ownership of the strings.
+//!        Used to pass stack allocated morphologies to a LwMorphologyFunc.
 //!
-LwMorphology*
-lw_morphology_new (gchar *word,
-                   gchar *normalized,
-                   gchar *stem,
-                   gchar *canonical,
-                   gchar *spellcheck,
-                   gchar *explanation,
-                   gint start_offset,
-                   gint end_offset)
+void
+lw_morphology_init (LwMorphology *morphology,
+                    gchar *word,
+                    gchar *normalized,
+                    gchar *stem,
+                    gchar *canonical,
+                    gchar *spellcheck,
+                    gchar *explanation,
+                    gint start_offset,
+                    gint end_offset)
 {
-    LwMorphology *morphology;
-    morphology = g_new0 (LwMorphology, 1);
+    memset(morphology, 0, sizeof(LwMorphology));
 
     morphology->word = word;
     morphology->normalized = normalized;
@@ -72,15 +73,14 @@ lw_morphology_new (gchar *word,
         g_free (morphology->stem); morphology->stem = NULL;
       }
     }
-
-    return morphology;
 }
 
+
 //!
-//! @brief Frees an allocated LwMorphology object.
+//! @brief Frees the contents of a LwMorphology without freeing the struct itself
 //!
-void 
-lw_morphology_free (LwMorphology *morphology)
+void
+lw_morphology_clear (LwMorphology *morphology)
 {
     if (morphology->word != NULL) g_free (morphology->word); 
     if (morphology->normalized != NULL) g_free (morphology->normalized); 
@@ -88,9 +88,41 @@ lw_morphology_free (LwMorphology *morphology)
     if (morphology->canonical != NULL) g_free (morphology->canonical); 
     if (morphology->explanation != NULL) g_free (morphology->explanation); 
     if (morphology->spellcheck != NULL) g_free (morphology->spellcheck); 
+    if (morphology->regex_pattern != NULL) g_free (morphology->regex_pattern); 
     if (morphology->regex != NULL) g_regex_unref (morphology->regex);
 
     memset(morphology, 0, sizeof(LwMorphology));
+}
+
+
+//!
+//! @brief Allocates a new empty LwMorphology object.
+//!
+LwMorphology*
+lw_morphology_new (gchar *word,
+                   gchar *normalized,
+                   gchar *stem,
+                   gchar *canonical,
+                   gchar *spellcheck,
+                   gchar *explanation,
+                   gint start_offset,
+                   gint end_offset)
+{
+    LwMorphology *morphology;
+    morphology = g_new0 (LwMorphology, 1);
+
+    lw_morphology_init (morphology, word, normalized, stem, canonical, spellcheck, explanation, start_offset, end_offset);
+
+    return morphology;
+}
+
+//!
+//! @brief Frees an allocated LwMorphology object.
+//!
+void 
+lw_morphology_free (LwMorphology *morphology)
+{
+    lw_morphology_clear (morphology);
 
     free(morphology);
 }
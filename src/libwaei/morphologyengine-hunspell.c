@@ -128,16 +128,16 @@ lw_morphologyengine_hunspell_build_noramalized_locale (const gchar *NAME)
 }
 
 
-static Hunhandle*
-lw_morphologyengine_hunspell_new_by_locale (const gchar *LOCALE)
+static gchar*
+lw_morphologyengine_hunspell_find_by_locale (const gchar *LOCALE)
 {
     gchar **pathlist;
     gchar *path, *dpath, *affpath;
     gchar *locale;
     gint i;
-    Hunhandle *handle;
+    gchar *found;
 
-    handle = NULL;
+    found = NULL;
 
     locale = lw_morphologyengine_hunspell_build_noramalized_locale (LOCALE);
     if (locale != NULL)
@@ -145,14 +145,16 @@ lw_morphologyengine_hunspell_new_by_locale (const gchar *LOCALE)
       pathlist = lw_morphologyengine_hunspell_get_dictionary_paths ();
       if (pathlist != NULL)
       {
-        for (i = 0; handle == NULL && pathlist[i] != NULL; i++)
+        for (i = 0; found == NULL && pathlist[i] != NULL; i++)
         {
           path = g_build_filename (pathlist[i], locale, NULL);
           dpath = g_strjoin (".", path, "dic", NULL);
           affpath = g_strjoin (".", path, "aff", NULL);
           if (g_file_test (affpath, G_FILE_TEST_IS_REGULAR) && 
               g_file_test (dpath, G_FILE_TEST_IS_REGULAR))
-            handle = Hunspell_create (affpath, dpath);
+          {
+            found = path; path = NULL;
+          }
           if (path != NULL) g_free (path); path = NULL;
           if (dpath != NULL) g_free (dpath); dpath = NULL;
           if (affpath != NULL) g_free (affpath); affpath = NULL;
@@ -162,52 +164,86 @@ lw_morphologyengine_hunspell_new_by_locale (const gchar *LOCALE)
       g_free (locale); locale = NULL;
     }
     
-    return handle;
+    return found;
 }
 
 
-Hunhandle*
-lw_morphologyengine_hunspell_new (const gchar *PREFERED_LOCALE)
+//!
+//! @brief Resolves the dictionary to use for a locale once so that every
+//!        LwMorphologyEngineContext can load it without searching again.
+//! @returns The path of the dictionary without the .aff/.dic extension or NULL
+//!
+gchar*
+lw_morphologyengine_hunspell_find_dictionary (const gchar *PREFERED_LOCALE)
 {
     //Declarations
     const gchar *locale = setlocale(LC_ALL, NULL);
-    Hunhandle *handle = NULL;
+    gchar *path = NULL;
 
     //See if we should try setting the prefered handle
-    if (handle == NULL && PREFERED_LOCALE != NULL && strncmp("auto", PREFERED_LOCALE, 4) != 0)
-      handle = lw_morphologyengine_hunspell_new_by_locale (PREFERED_LOCALE);
+    if (path == NULL && PREFERED_LOCALE != NULL && strncmp("auto", PREFERED_LOCALE, 4) != 0)
+      path = lw_morphologyengine_hunspell_find_by_locale (PREFERED_LOCALE);
 
     //Load from environment locale if it starts with en
-    if (handle == NULL && strncmp("en", locale, strlen("en")) == 0)
-      handle = lw_morphologyengine_hunspell_new_by_locale (locale);
+    if (path == NULL && locale != NULL && strncmp("en", locale, strlen("en")) == 0)
+      path = lw_morphologyengine_hunspell_find_by_locale (locale);
 
     //Load from en_US
-    if (handle == NULL)
-      handle = lw_morphologyengine_hunspell_new_by_locale ("en_US");
+    if (path == NULL)
+      path = lw_morphologyengine_hunspell_find_by_locale ("en_US");
 
     //Load from en
-    if (handle == NULL)
-      handle = lw_morphologyengine_hunspell_new_by_locale ("en");
+    if (path == NULL)
+      path = lw_morphologyengine_hunspell_find_by_locale ("en");
+
+    return path;
+}
+
+
+//!
+//! @brief Hunhandles aren't thread safe and the C api has no way to share
+//!        a loaded dictionary, so every context gets its own handle.
+//!
+Hunhandle*
+lw_morphologyengine_hunspell_new (const gchar *PATH)
+{
+    //Sanity checks
+    if (PATH == NULL) return NULL;
+
+    //Declarations
+    gchar *dpath = g_strjoin (".", PATH, "dic", NULL);
+    gchar *affpath = g_strjoin (".", PATH, "aff", NULL);
+    Hunhandle *handle = Hunspell_create (affpath, dpath);
+
+    if (dpath != NULL) g_free (dpath); dpath = NULL;
+    if (affpath != NULL) g_free (affpath); affpath = NULL;
 
     return handle;
 }
 
 
 static gchar*
-lw_morphologyengine_hunspell_stem (LwMorphologyEngine *engine, 
-                                   const gchar        *WORD)
+lw_morphologyengine_hunspell_stem (LwMorphologyEngineContext *context, 
+                                   const gchar               *WORD)
 {
     //Sanity checks
-    if (engine == NULL) return NULL;
-    if (engine->hunspell == NULL) return NULL;
+    if (context == NULL) return NULL;
+    if (context->hunspell == NULL) return NULL;
     if (WORD == NULL) return NULL;
     
     gchar **suggestions;
     gint total;
     gchar *output;
+    const gchar *STEM;
     gint i;
 
-    total = Hunspell_stem (engine->hunspell, &suggestions, WORD); 
+    //Most words have been seen before
+    if (context->stemtable != NULL && lw_stemtable_lookup (context->stemtable, WORD, &STEM))
+    {
+      return (STEM != NULL) ? g_strdup (STEM) : NULL;
+    }
+
+    total = Hunspell_stem (context->hunspell, &suggestions, WORD); 
     output = NULL;
 
     if (suggestions != NULL)
@@ -217,23 +253,25 @@ lw_morphologyengine_hunspell_stem (LwMorphologyEngine *engine,
         if (g_ascii_strcasecmp (WORD, suggestions[i]) != 0)  //Make sure we aren't just getting the lower case form of the word
           output = g_strdup (suggestions[i]);
       }
-      Hunspell_free_list (engine->hunspell, &suggestions, total); suggestions = NULL;
+      Hunspell_free_list (context->hunspell, &suggestions, total); suggestions = NULL;
     }
 
+    if (context->stemtable != NULL) lw_stemtable_insert (context->stemtable, WORD, output);
+
     return output;
 }
 
 
 static gchar*
-lw_morphologyengine_hunspell_spellcheck (LwMorphologyEngine *engine,
-                                         const gchar        *WORD)
+lw_morphologyengine_hunspell_spellcheck (LwMorphologyEngineContext *context,
+                                         const gchar               *WORD)
 {
     //Sanity checks
-    if (engine == NULL) return NULL;
-    if (engine->hunspell == NULL) return NULL;
+    if (context == NULL) return NULL;
+    if (context->hunspell == NULL) return NULL;
     if (WORD == NULL) return NULL;
 
-    if (Hunspell_spell (engine->hunspell, WORD) != 0) return NULL;
+    if (Hunspell_spell (context->hunspell, WORD) != 0) return NULL;
 
     //Delarations
     gchar **suggestions = NULL;
@@ -242,7 +280,7 @@ lw_morphologyengine_hunspell_spellcheck (LwMorphologyEngine *engine,
     gint total = 0;
 
     //Initializations
-    total = Hunspell_suggest (engine->hunspell, &suggestions, WORD);
+    total = Hunspell_suggest (context->hunspell, &suggestions, WORD);
     output = g_string_new ("");
 
     if (suggestions != NULL)
@@ -252,7 +290,7 @@ lw_morphologyengine_hunspell_spellcheck (LwMorphologyEngine *engine,
         if (*output->str == '\0') g_string_assign (output, suggestions[i]);
         else g_string_append_printf (output, LW_MORPHOLOGY_SPELLCHECK_DELIMITOR "%s", suggestions[i]);
       }
-      Hunspell_free_list (engine->hunspell, &suggestions, total); suggestions = NULL;
+      Hunspell_free_list (context->hunspell, &suggestions, total); suggestions = NULL;
     }
 
     return g_string_free (output, total < 1);
@@ -260,27 +298,31 @@ lw_morphologyengine_hunspell_spellcheck (LwMorphologyEngine *engine,
 
 
 //!
-//! @brief Analyzes a sentence for misspellings, positions, and stem forms of words
+//! @brief Analyzes a sentence for misspellings, positions, and stem forms of words, passing each word to func
 //!
-GList*
-lw_morphologyengine_hunspell_analyze (LwMorphologyEngine *engine, 
-                                      const gchar        *TEXT, 
-                                      gboolean            include_spellcheck)
+void
+lw_morphologyengine_hunspell_analyze (LwMorphologyEngineContext *context, 
+                                      const gchar               *TEXT, 
+                                      gboolean                   include_spellcheck,
+                                      LwMorphologyFunc           func,
+                                      gpointer                   data)
 {
     //Sanity checks
-    if (engine == NULL) return NULL;
-    if (engine->hunspell == NULL) return NULL;
-    if (TEXT == NULL) return NULL;
+    if (context == NULL) return;
+    if (context->hunspell == NULL) return;
+    if (TEXT == NULL) return;
+    g_return_if_fail (func != NULL);
 
     //Declations
     gint start_offset = 0, end_offset = 0;
     GMatchInfo *match_info = NULL;
-    GList *list = NULL;
     gchar *word = NULL;
-    LwMorphology *morphology = NULL;
+    LwMorphology morphology;
+    gint *offsets = NULL;
 
     //Initializations
-    gchar *shortened = lw_regex_remove_parenthesis (TEXT);
+    gchar *shortened = lw_regex_remove_parenthesis_with_offsets (TEXT, &offsets);
+    if (shortened == NULL) goto errored;
 
     //Body
     lw_regex_get_contiguous (shortened, &match_info);
@@ -290,28 +332,28 @@ lw_morphologyengine_hunspell_analyze (LwMorphologyEngine *engine,
         word = g_match_info_fetch (match_info, 0);
         if (word != NULL && !g_unichar_ispunct (g_utf8_get_char (word)) && !lw_util_string_has_japanese (word))
         {
+          //Report where the word is in TEXT rather than in the shortened copy
           g_match_info_fetch_pos (match_info, 0, &start_offset, &end_offset);
+          end_offset = offsets[end_offset - 1] + 1;
+          start_offset = offsets[start_offset];
 
           gchar *normalized = NULL, *stem = NULL, *canonical = NULL, *spellcheck = NULL;
 
           //Generate the forms
-          normalized = lw_util_normalize_string (word, TRUE, FALSE);    
-          stem = lw_morphologyengine_hunspell_stem (engine, word);
-          if (stem != NULL) canonical = lw_util_normalize_string (stem, TRUE, FALSE); //You don't want to case fold before hunspell works
-          if (include_spellcheck) spellcheck = lw_morphologyengine_hunspell_spellcheck (engine, word);
+          normalized = lw_util_normalize_string_if_changed (word, TRUE, FALSE);    
+          stem = lw_morphologyengine_hunspell_stem (context, word);
+          if (stem != NULL) canonical = lw_util_normalize_string_if_changed (stem, TRUE, FALSE); //You don't want to case fold before hunspell works
+          if (include_spellcheck) spellcheck = lw_morphologyengine_hunspell_spellcheck (context, word);
 
           //Cleanup identicals
-          if (normalized != NULL)
-          {
-            if (strcmp(normalized, word) == 0) { g_free (normalized); normalized = NULL; }
-          }
           if (stem != NULL)
           {
             if (strcmp(stem, word) == 0) { g_free (stem); stem = NULL; }
             if (canonical != NULL && strcmp(stem, canonical) == 0) { g_free (canonical); canonical = NULL; } //Canonical is built on stem
           }
 
-          morphology = lw_morphology_new (
+          lw_morphology_init (
+            &morphology,
             word,
             normalized,
             stem,
@@ -321,12 +363,11 @@ lw_morphologyengine_hunspell_analyze (LwMorphologyEngine *engine,
             start_offset,
             end_offset
           );
-          if (morphology != NULL)
-          {
-            list = g_list_append (list, morphology);
-            morphology = NULL;
-          }
           word = NULL;
+
+          func (&morphology, data);
+
+          lw_morphology_clear (&morphology);
         }
         else if (word != NULL)
         {
@@ -339,9 +380,7 @@ errored:
 
     if (match_info != NULL) g_match_info_free (match_info); match_info = NULL;
     if (shortened != NULL) g_free(shortened); shortened = NULL;
-    if (morphology != NULL) lw_morphology_free (morphology); morphology = NULL;
+    if (offsets != NULL) g_free (offsets); offsets = NULL;
     if (word != NULL) g_free (word); word = NULL;
-
-    return list;
 }
 
@@ -56,11 +56,11 @@
 //! @brief Convert string from UTF-8 to Mecab's charset.
 //!
 static gchar*
-_lw_morphologyengine_mecab_encode (LwMorphologyEngine *engine, 
-                                  const gchar        *WORD, 
-                                  gint                nbytes)
+_lw_morphologyengine_mecab_encode (LwMorphologyEngineContext *context, 
+                                   const gchar               *WORD, 
+                                   gint                       nbytes)
 {
-    const mecab_dictionary_info_t *info = mecab_dictionary_info (engine->mecab);
+    const mecab_dictionary_info_t *info = mecab_dictionary_info (context->mecab);
     gsize bytes_read, bytes_written;
     return g_convert (WORD, nbytes, info->charset, "UTF-8", &bytes_read, &bytes_written, NULL);
 }
@@ -69,11 +69,11 @@ _lw_morphologyengine_mecab_encode (LwMorphologyEngine *engine,
 //! @brief Convert string from Mecab's charset to UTF-8.
 //!
 static gchar*
-_lw_morphologyengine_mecab_decode (LwMorphologyEngine *engine, 
-                                  const gchar        *WORD,
-                                  gint                nbytes)
+_lw_morphologyengine_mecab_decode (LwMorphologyEngineContext *context, 
+                                   const gchar               *WORD,
+                                   gint                       nbytes)
 {
-    const mecab_dictionary_info_t *info = mecab_dictionary_info (engine->mecab);
+    const mecab_dictionary_info_t *info = mecab_dictionary_info (context->mecab);
     gsize bytes_read, bytes_written;
     return g_convert (WORD, nbytes, "UTF-8", info->charset, &bytes_read, &bytes_written, NULL);
 }
@@ -81,30 +81,77 @@ _lw_morphologyengine_mecab_decode (LwMorphologyEngine *engine,
 
 
 
-gboolean
-_is_primary_part_of_speech (gchar **fields)
+#define LW_MECAB_FEATURE_POS         0
+#define LW_MECAB_FEATURE_POS_DETAIL  1
+#define LW_MECAB_FEATURE_BASE_FORM   6
+#define LW_MECAB_TOTAL_FEATURES      7
+
+//!
+//! @brief Splits a MeCab feature CSV in place without copying it
+//! @param fields Set to the start of each field
+//! @param lengths Set to the byte length of each field
+//! @returns The number of fields found up to max
+//!
+static gint
+_lw_morphologyengine_mecab_get_features (const gchar  *FEATURE,
+                                         const gchar **fields,
+                                         gsize        *lengths,
+                                         gint          max)
+{
+    //Declarations
+    const gchar *ptr = FEATURE;
+    gint total = 0;
+
+    while (ptr != NULL && total < max)
+    {
+      const gchar *delimiter = strchr (ptr, ',');
+      fields[total] = ptr;
+      lengths[total] = (delimiter != NULL) ? (delimiter - ptr) : strlen (ptr);
+      total++;
+      ptr = (delimiter != NULL) ? delimiter + 1 : NULL;
+    }
+
+    return total;
+}
+
+
+static gboolean
+_lw_morphologyengine_mecab_field_equals (const gchar *FIELD,
+                                         gsize        length,
+                                         const gchar *VALUE)
+{
+    return (strlen(VALUE) == length && strncmp(FIELD, VALUE, length) == 0);
+}
+
+
+static gboolean
+_is_primary_part_of_speech (const gchar **fields, gsize *lengths)
 {
-    return (strcmp("助詞", fields[0]) != 0 && strcmp("助動詞", fields[0]) != 0 && strcmp("接尾", fields[1]) != 0);
+    return (!_lw_morphologyengine_mecab_field_equals (fields[LW_MECAB_FEATURE_POS], lengths[LW_MECAB_FEATURE_POS], ID_POSTPOSITION) && 
+            !_lw_morphologyengine_mecab_field_equals (fields[LW_MECAB_FEATURE_POS], lengths[LW_MECAB_FEATURE_POS], ID_AUX_VERB) && 
+            !_lw_morphologyengine_mecab_field_equals (fields[LW_MECAB_FEATURE_POS_DETAIL], lengths[LW_MECAB_FEATURE_POS_DETAIL], "接尾"));
 }
 
 
-static GList*
-_lw_morphologyengine_append_morphology (GList *list, gchar *WORD, gchar *STEM, gint start_offset, gint end_offset)
+//!
+//! @brief Passes a word to the callback using a stack allocated LwMorphology.  Takes ownership of WORD and STEM.
+//!
+static void
+_lw_morphologyengine_emit_morphology (gchar *WORD, gchar *STEM, gint start_offset, gint end_offset, LwMorphologyFunc func, gpointer data)
 {
-    if (WORD == NULL) return list;
+    if (WORD == NULL) return;
 
     //printf("BREAK primary: %s %s %d %d\n", WORD, STEM, start_offset, end_offset);
 
     gchar *normalized = NULL;
     gchar *canonical = NULL;
 
-    if (WORD != NULL) normalized = lw_util_normalize_string (WORD, FALSE, TRUE);
-    if (STEM != NULL) canonical =  lw_util_normalize_string (STEM, FALSE, TRUE);
-
-    if (normalized != NULL && strcmp(WORD, normalized) == 0) { g_free (normalized); normalized = NULL; }
-    if (STEM != NULL && canonical != NULL && strcmp(STEM, canonical) == 0) { g_free (canonical); canonical = NULL; }
+    if (WORD != NULL) normalized = lw_util_normalize_string_if_changed (WORD, FALSE, TRUE);
+    if (STEM != NULL) canonical =  lw_util_normalize_string_if_changed (STEM, FALSE, TRUE);
 
-    LwMorphology* morphology = lw_morphology_new (
+    LwMorphology morphology;
+    lw_morphology_init (
+      &morphology,
       WORD, 
       normalized, 
       STEM, 
@@ -115,50 +162,90 @@ _lw_morphologyengine_append_morphology (GList *list, gchar *WORD, gchar *STEM, g
       end_offset
     );
 
-    return g_list_append (list, morphology);
+    func (&morphology, data);
+
+    lw_morphology_clear (&morphology);
 }
 
 
-GList*
-lw_morphologyengine_mecab_kanji_ish_analyze (LwMorphologyEngine *engine, 
-                                             const gchar        *INPUT_RAW)
+//!
+//! @brief Groups the MeCab nodes of INPUT_RAW into words starting at each primary part of speech.
+//!        With a UTF-8 dictionary the nodes point straight into INPUT_RAW, so nothing is
+//!        converted or copied except the strings that end up in the LwMorphology.
+//! @param offset Where INPUT_RAW starts in the text being analyzed.  It is added to the offsets passed to func.
+//!
+static void
+lw_morphologyengine_mecab_kanji_ish_analyze (LwMorphologyEngineContext *context, 
+                                             const gchar               *INPUT_RAW,
+                                             gint                       offset,
+                                             LwMorphologyFunc           func,
+                                             gpointer                   data)
 {
     //Sanity checks
-    if (engine == NULL) return NULL;
-    if (engine->mecab == NULL) return NULL;
-    g_return_val_if_fail (INPUT_RAW != NULL, NULL);
+    if (context == NULL) return;
+    if (context->mecab == NULL || context->lattice == NULL) return;
+    g_return_if_fail (INPUT_RAW != NULL);
 
     //Declarations
     const mecab_node_t *node = NULL;
-    gchar *query = NULL;
+    const gchar *query = NULL;
+    gchar *encoded = NULL;
     gchar *result = NULL;
-    gchar **fields = NULL;
-    gchar *surface = NULL;
+    gchar *chunk = NULL;
+    const gchar *fields[LW_MECAB_TOTAL_FEATURES];
+    gsize lengths[LW_MECAB_TOTAL_FEATURES];
+    gint total_fields = 0;
+    const gchar *FEATURE = NULL;
+    gint encoded_position = 0;
+    gint decoded_position = 0;
+    gint input_length = 0;
 
     gchar *word = NULL;
     gchar *stem = NULL;
 
     gint start_offset = 0, end_offset = 0;
 
-    GList *list = NULL;
-
     //printf("BREAK query: %s\n", INPUT_RAW);
 
     //Initializations
-    query = _lw_morphologyengine_mecab_encode (engine, INPUT_RAW, -1);
+    input_length = strlen(INPUT_RAW);
+    if (context->utf8)
+    {
+      query = INPUT_RAW;
+    }
+    else
+    {
+      encoded = _lw_morphologyengine_mecab_encode (context, INPUT_RAW, -1); if (encoded == NULL) return;
+      query = encoded;
+    }
+    mecab_lattice_set_sentence (context->lattice, query);
+    if (!mecab_parse_lattice (context->mecab, context->lattice)) goto finished;
     
     //Analysis
-    for (node = mecab_sparse_tonode (engine->mecab, query); node != NULL; node = node->next)
+    for (node = mecab_lattice_get_bos_node (context->lattice); node != NULL; node = node->next)
     {
       if (node->stat != MECAB_NOR_NODE) continue;
 
-      result = _lw_morphologyengine_mecab_decode (engine, node->feature, -1); if (result == NULL) goto errored;
-      surface = _lw_morphologyengine_mecab_decode (engine, node->surface, -1); if (result == NULL) goto errored;
-      fields = g_strsplit (result, ",", -1); if (fields == NULL) goto errored;
-      end_offset = strlen(INPUT_RAW) - strlen(surface);
-  //    printf("BREAK surface: %s %d %d\n", surface, start_offset, end_offset);
+      if (context->utf8)
+      {
+        FEATURE = node->feature;
+        end_offset = node->surface - query;
+      }
+      else
+      {
+        //Only convert the text since the last node so the offsets stay linear in the input length
+        result = _lw_morphologyengine_mecab_decode (context, node->feature, -1); if (result == NULL) goto errored;
+        chunk = _lw_morphologyengine_mecab_decode (context, query + encoded_position, (node->surface - query) - encoded_position); if (chunk == NULL) goto errored;
+        encoded_position = node->surface - query;
+        decoded_position += strlen(chunk);
+        FEATURE = result;
+        end_offset = decoded_position;
+      }
+  //    printf("BREAK surface: %d %d\n", start_offset, end_offset);
+
+      total_fields = _lw_morphologyengine_mecab_get_features (FEATURE, fields, lengths, LW_MECAB_TOTAL_FEATURES);
 
-      if (g_strv_length (fields) >= 7 && _is_primary_part_of_speech (fields))
+      if (total_fields >= LW_MECAB_TOTAL_FEATURES && _is_primary_part_of_speech (fields, lengths))
       {
         if (end_offset > start_offset)
         {
@@ -170,11 +257,11 @@ lw_morphologyengine_mecab_kanji_ish_analyze (LwMorphologyEngine *engine,
         if (word != NULL)
         {
     //      printf("BREAK primary: %s %s %d %d\n", word, stem, start_offset, end_offset);
-          list = _lw_morphologyengine_append_morphology (list, word, stem, start_offset, end_offset);
+          _lw_morphologyengine_emit_morphology (word, stem, offset + start_offset, offset + end_offset, func, data);
           word = stem = NULL;
         }
 
-        if (stem != NULL) g_free (stem); stem = g_strdup (fields[6]);
+        if (stem != NULL) g_free (stem); stem = g_strndup (fields[LW_MECAB_FEATURE_BASE_FORM], lengths[LW_MECAB_FEATURE_BASE_FORM]);
 
         start_offset = end_offset;
       }
@@ -182,12 +269,16 @@ lw_morphologyengine_mecab_kanji_ish_analyze (LwMorphologyEngine *engine,
 errored:
 
       if (result != NULL) g_free (result); result = NULL;
-      if (surface != NULL) g_free (surface); surface = NULL;
-      if (fields != NULL) g_strfreev (fields); fields = NULL;
+      if (chunk != NULL) g_free (chunk); chunk = NULL;
     }
 
+finished:
+
+    mecab_lattice_clear (context->lattice);
+    if (encoded != NULL) g_free (encoded); encoded = NULL;
+
     //Grab the final morphology
-    end_offset = strlen(INPUT_RAW);
+    end_offset = input_length;
 
     if (end_offset > start_offset)
     {
@@ -199,22 +290,74 @@ errored:
     if (word != NULL)
     {
       //printf("BREAK primary: %s %s %d %d\n", word, stem, start_offset, end_offset);
-      list = _lw_morphologyengine_append_morphology (list, word, stem, start_offset, end_offset);
+      _lw_morphologyengine_emit_morphology (word, stem, offset + start_offset, offset + end_offset, func, data);
       word = stem = NULL;
     }
 
-    return list;
+    if (stem != NULL) g_free (stem); stem = NULL;
 }
 
 
-mecab_t*
-lw_morphologyengine_mecab_new ()
+//!
+//! @brief Dictionaries in UTF-8 can be parsed without any charset conversion
+//!
+static gboolean
+_lw_morphologyengine_mecab_is_utf8 (LwMorphologyEngineContext *context)
 {
-    mecab_t *mecab = mecab_new2(""); if (mecab == NULL) goto errored;
+    //Declarations
+    const mecab_dictionary_info_t *info = mecab_dictionary_info (context->mecab);
+
+    if (info == NULL || info->charset == NULL) return FALSE;
+
+    return (g_ascii_strcasecmp (info->charset, "UTF-8") == 0 || g_ascii_strcasecmp (info->charset, "UTF8") == 0);
+}
+
+
+//!
+//! @brief Loads the MeCab dictionary.  The model is read only and is shared
+//!        by the taggers and lattices of every LwMorphologyEngineContext.
+//!
+mecab_model_t*
+lw_morphologyengine_mecab_model_new ()
+{
+    mecab_model_t *model = mecab_model_new2(""); if (model == NULL) goto errored;
 
 errored:
 
-    return mecab;
+    return model;
+}
+
+
+gboolean
+lw_morphologyengine_mecab_context_init (LwMorphologyEngineContext *context,
+                                        mecab_model_t             *model)
+{
+    //Sanity checks
+    g_return_val_if_fail (context != NULL, FALSE);
+    if (model == NULL) return FALSE;
+
+    context->mecab = mecab_model_new_tagger (model); if (context->mecab == NULL) goto errored;
+    context->lattice = mecab_model_new_lattice (model); if (context->lattice == NULL) goto errored;
+    context->utf8 = _lw_morphologyengine_mecab_is_utf8 (context);
+
+    return TRUE;
+
+errored:
+
+    lw_morphologyengine_mecab_context_clear (context);
+
+    return FALSE;
+}
+
+
+void
+lw_morphologyengine_mecab_context_clear (LwMorphologyEngineContext *context)
+{
+    //Sanity checks
+    g_return_if_fail (context != NULL);
+
+    if (context->lattice != NULL) mecab_lattice_destroy (context->lattice); context->lattice = NULL;
+    if (context->mecab != NULL) mecab_destroy (context->mecab); context->mecab = NULL;
 }
 
 
@@ -243,17 +386,22 @@ _has_kanji (const gchar* TEXT)
 }
 
 
-GList*
-lw_morphologyengine_mecab_analyze (LwMorphologyEngine *engine,
-                                   const gchar        *HAYSTACK)
+//!
+//! @brief Analyzes the Japanese runs of HAYSTACK, passing each word to func
+//!
+void
+lw_morphologyengine_mecab_analyze (LwMorphologyEngineContext *context,
+                                   const gchar               *HAYSTACK,
+                                   LwMorphologyFunc           func,
+                                   gpointer                   data)
 {
     //Sanity checks
-    g_return_val_if_fail (engine != NULL, NULL);
-    if (engine->mecab == NULL) return NULL;
-    g_return_val_if_fail (HAYSTACK != NULL, NULL);
+    g_return_if_fail (context != NULL);
+    if (context->mecab == NULL) return;
+    g_return_if_fail (HAYSTACK != NULL);
+    g_return_if_fail (func != NULL);
 
     //Declarations
-    GList *list = NULL;
     gint start_offset = 0, end_offset = 0;
     GMatchInfo *match_info = NULL;
     gchar *word = NULL;
@@ -270,11 +418,16 @@ lw_morphologyengine_mecab_analyze (LwMorphologyEngine *engine,
 
           //Generate the forms
           if (_has_kanji (word))
-            list = g_list_concat (list, lw_morphologyengine_mecab_kanji_ish_analyze (engine, word)); //mecab is horrible with sentences without kanji
+          {
+            lw_morphologyengine_mecab_kanji_ish_analyze (context, word, start_offset, func, data); //mecab is horrible with sentences without kanji
+            g_free (word);
+          }
           else
-            list = _lw_morphologyengine_append_morphology (list, word, NULL, 0, 0);
+          {
+            _lw_morphologyengine_emit_morphology (word, NULL, start_offset, end_offset, func, data);
+          }
 
-          word = NULL; //These functions steal word
+          word = NULL; //Freed or stolen above
         }
         else if (word != NULL)
         {
@@ -286,6 +439,4 @@ lw_morphologyengine_mecab_analyze (LwMorphologyEngine *engine,
 errored:
 
     if (match_info != NULL) g_match_info_free (match_info); match_info = NULL;
-
-    return list;
 }
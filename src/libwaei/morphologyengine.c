@@ -52,6 +52,17 @@ typedef enum
 } LwMorphologyEngineProps;
 
 
+struct _LwMorphologyEngineCacheEntry {
+  gchar *key;
+  LwMorphologyList *morphologylist;
+};
+typedef struct _LwMorphologyEngineCacheEntry LwMorphologyEngineCacheEntry;
+
+static void _lw_morphologyengine_cache_entry_free (LwMorphologyEngineCacheEntry *entry);
+static LwMorphologyEngineContext* _lw_morphologyengine_context_new (LwMorphologyEngine *engine);
+static void _lw_morphologyengine_context_free (LwMorphologyEngineContext *context);
+
+
 LwMorphologyEngine* lw_morphologyengine_new (const gchar *HUNSPELL_PREFERED_LOCALE)
 {
     //Declarations
@@ -116,6 +127,11 @@ lw_morphologyengine_get_property (GObject      *object,
 static void 
 lw_morphologyengine_init (LwMorphologyEngine *engine)
 {
+    engine->cache.table = g_hash_table_new (g_str_hash, g_str_equal);
+    g_queue_init (&engine->cache.queue);
+    engine->cache.max = LW_MORPHOLOGYENGINE_CACHE_SIZE;
+    engine->contextpool = g_async_queue_new_full ((GDestroyNotify) _lw_morphologyengine_context_free);
+    engine->max_contexts = g_get_num_processors () + 1; //The main thread spellchecks while searches run
 }
 
 
@@ -131,24 +147,33 @@ lw_morphologyengine_constructed (GObject *object)
 
     engine = LW_MORPHOLOGYENGINE (object);
 
+    LwMorphologyEngineContext *context = NULL;
+
 #ifdef HAVE_MECAB
-    engine->mecab = lw_morphologyengine_mecab_new ();
+    engine->mecab_model = lw_morphologyengine_mecab_model_new ();
 #endif
 #ifdef HAVE_HUNSPELL
-    engine->hunspell = lw_morphologyengine_hunspell_new (engine->locale);
+    engine->hunspell_path = lw_morphologyengine_hunspell_find_dictionary (engine->locale);
+    engine->stemtable = lw_stemtable_new (engine->hunspell_path);
 #endif
     g_mutex_init (&engine->mutex);
 
+    //The first context is created eagerly so loading errors are reported right away
+    context = _lw_morphologyengine_context_new (engine);
+    g_atomic_int_inc (&engine->total_contexts);
+
 #ifdef HAVE_MECAB
-    if (engine->mecab == NULL) 
+    if (context->mecab == NULL) 
         g_message (gettext("Mecab had errors loading.  You may need to install mecab-ipadic. "
                            "Until then, libwaei will not try to conjugate words to their root form for Japanese."));
 #endif
 #ifdef HAVE_HUNSPELL
-    if (engine->hunspell == NULL)
+    if (context->hunspell == NULL)
         g_message (gettext("Hunspell had errors loading.  You may need to install some hunspell/myspell dictionaries. "
                            "Until then, libwaei will not try to conjugate words to their root form for english or spellcheck."));
 #endif
+
+    lw_morphologyengine_release_context (engine, context); context = NULL;
 }
 
 
@@ -161,12 +186,20 @@ lw_morphologyengine_finalize (GObject *object)
 
     engine = LW_MORPHOLOGYENGINE (object);
 
+    if (engine->contextpool != NULL) g_async_queue_unref (engine->contextpool); 
 #ifdef HAVE_MECAB
-    if (engine->mecab != NULL) mecab_destroy (engine->mecab); 
+    if (engine->mecab_model != NULL) mecab_model_destroy (engine->mecab_model); 
 #endif
 #ifdef HAVE_HUNSPELL
-    if (engine->hunspell != NULL) Hunspell_destroy (engine->hunspell); 
+    if (engine->hunspell_path != NULL) g_free (engine->hunspell_path); 
+    if (engine->stemtable != NULL) 
+    {
+      lw_stemtable_save (engine->stemtable, NULL);
+      lw_stemtable_free (engine->stemtable);
+    }
 #endif
+    lw_morphologyengine_clear_cache (engine);
+    if (engine->cache.table != NULL) g_hash_table_unref (engine->cache.table); 
     g_mutex_clear (&engine->mutex);
     if (engine->locale != NULL) g_free (engine->locale); 
 
@@ -199,28 +232,388 @@ lw_morphologyengine_class_init (LwMorphologyEngineClass *klass)
 }
 
 
+static LwMorphologyEngineContext*
+_lw_morphologyengine_context_new (LwMorphologyEngine *engine)
+{
+    //Declarations
+    LwMorphologyEngineContext *context = g_new0 (LwMorphologyEngineContext, 1);
+
+#ifdef HAVE_MECAB
+    lw_morphologyengine_mecab_context_init (context, engine->mecab_model);
+#endif
+#ifdef HAVE_HUNSPELL
+    context->hunspell = lw_morphologyengine_hunspell_new (engine->hunspell_path);
+    context->stemtable = engine->stemtable;
+#endif
+
+    return context;
+}
+
+
+static void
+_lw_morphologyengine_context_free (LwMorphologyEngineContext *context)
+{
+    if (context == NULL) return;
+
+#ifdef HAVE_MECAB
+    lw_morphologyengine_mecab_context_clear (context);
+#endif
+#ifdef HAVE_HUNSPELL
+    if (context->hunspell != NULL) Hunspell_destroy (context->hunspell); 
+#endif
+
+    memset(context, 0, sizeof(LwMorphologyEngineContext));
+    g_free (context);
+}
+
+
 //!
-//! @brief Will analyze the sentence and return an array of non-trivial root form words
+//! @brief Takes an idle analysis context from the pool, creating one if none
+//!        is available.  Each context loads its own dictionaries, so once
+//!        max_contexts exist this waits for one to be released instead.  Long
+//!        running workers such as index builds can hold onto a context for
+//!        their whole lifetime but shouldn't acquire a second one while they
+//!        do.  Return it with lw_morphologyengine_release_context().
 //!
-LwMorphologyList*
-lw_morphologyengine_analyze (LwMorphologyEngine *engine, const gchar *TEXT, gboolean spellcheck)
+LwMorphologyEngineContext*
+lw_morphologyengine_acquire_context (LwMorphologyEngine *engine)
 {
     //Sanity checks
     g_return_val_if_fail (engine != NULL, NULL);
-    if (TEXT == NULL) return NULL;
 
-    //Declarations and initializations
-    GList *list= NULL;
+    //Declarations
+    LwMorphologyEngineContext *context = g_async_queue_try_pop (engine->contextpool);
+
+    if (context != NULL) return context;
+
+    if (g_atomic_int_add (&engine->total_contexts, 1) < engine->max_contexts)
+    {
+      context = _lw_morphologyengine_context_new (engine);
+    }
+    else
+    {
+      g_atomic_int_add (&engine->total_contexts, -1);
+      context = g_async_queue_pop (engine->contextpool);
+    }
+
+    return context;
+}
+
+
+void
+lw_morphologyengine_release_context (LwMorphologyEngine        *engine,
+                                     LwMorphologyEngineContext *context)
+{
+    //Sanity checks
+    g_return_if_fail (engine != NULL);
+    if (context == NULL) return;
+
+    //No more than max_contexts are ever made so the pool stays bounded
+    g_async_queue_push (engine->contextpool, context);
+}
+
+
+//!
+//! @brief Analyzes the text with a context the caller owns, passing each
+//!        morphology to func as it is found.  No locks are taken and no
+//!        intermediate lists are built.
+//!
+void
+lw_morphologyengine_context_analyze_foreach (LwMorphologyEngineContext *context, 
+                                             const gchar               *TEXT, 
+                                             gboolean                   spellcheck,
+                                             LwMorphologyFunc           func,
+                                             gpointer                   data)
+{
+    //Sanity checks
+    g_return_if_fail (context != NULL);
+    g_return_if_fail (func != NULL);
+    if (TEXT == NULL) return;
 
 #ifdef HAVE_MECAB
-    if (engine->mecab != NULL) list = g_list_concat (list, lw_morphologyengine_mecab_analyze (engine, TEXT));
+    if (context->mecab != NULL) lw_morphologyengine_mecab_analyze (context, TEXT, func, data);
 #endif
 #ifdef HAVE_HUNSPELL
-    if (engine->hunspell != NULL) list = g_list_concat (list, lw_morphologyengine_hunspell_analyze (engine, TEXT, spellcheck));
+    if (context->hunspell != NULL) lw_morphologyengine_hunspell_analyze (context, TEXT, spellcheck, func, data);
 #endif
+}
+
+
+static void
+_lw_morphologyengine_collect (LwMorphology *morphology, 
+                              GList       **list)
+{
+    //Declarations
+    LwMorphology *copy = g_new (LwMorphology, 1);
+
+    //Steal everything
+    *copy = *morphology;
+    memset(morphology, 0, sizeof(LwMorphology));
+
+    *list = g_list_prepend (*list, copy);
+}
+
+
+//!
+//! @brief Analyzes the text with a context the caller owns.  No locks are taken.
+//!
+LwMorphologyList*
+lw_morphologyengine_context_analyze (LwMorphologyEngineContext *context, const gchar *TEXT, gboolean spellcheck)
+{
+    //Sanity checks
+    g_return_val_if_fail (context != NULL, NULL);
+    if (TEXT == NULL) return NULL;
+
+    //Declarations and initializations
+    GList *list= NULL;
+
+    lw_morphologyengine_context_analyze_foreach (context, TEXT, spellcheck, (LwMorphologyFunc) _lw_morphologyengine_collect, &list);
+
+    return lw_morphologylist_new_from_list (g_list_reverse (list));
+}
+
+
+struct _LwMorphologyEngineBatchData {
+  LwMorphologyEngineBatchFunc func;
+  gpointer data;
+  gint index;
+};
+typedef struct _LwMorphologyEngineBatchData LwMorphologyEngineBatchData;
+
+
+static void
+_lw_morphologyengine_batch_forward (LwMorphology                *morphology, 
+                                    LwMorphologyEngineBatchData *batchdata)
+{
+    batchdata->func (batchdata->index, morphology, batchdata->data);
+}
+
+
+//!
+//! @brief Analyzes many strings with a single context, calling func for each
+//!        morphology with the position of its string in TEXTS.  Meant for
+//!        building indexes where creating a LwMorphologyList per string
+//!        would cost more than the analysis itself.
+//! @param TEXTS The strings to analyze
+//! @param length The number of strings in TEXTS or -1 if it is NULL terminated
+//!
+void
+lw_morphologyengine_analyze_batch (LwMorphologyEngine           *engine, 
+                                   const gchar * const          *TEXTS, 
+                                   gint                          length,
+                                   gboolean                      spellcheck,
+                                   LwMorphologyEngineBatchFunc   func,
+                                   gpointer                      data)
+{
+    //Sanity checks
+    g_return_if_fail (engine != NULL);
+    g_return_if_fail (func != NULL);
+    if (TEXTS == NULL) return;
 
-    return lw_morphologylist_new_from_list (list);
+    //Declarations
+    LwMorphologyEngineContext *context = NULL;
+    LwMorphologyEngineBatchData batchdata;
+    gint i = 0;
+
+    //Initializations
+    context = lw_morphologyengine_acquire_context (engine);
+    batchdata.func = func;
+    batchdata.data = data;
+
+    for (i = 0; (length < 0 || i < length) && TEXTS[i] != NULL; i++)
+    {
+      batchdata.index = i;
+      lw_morphologyengine_context_analyze_foreach (context, TEXTS[i], spellcheck, (LwMorphologyFunc) _lw_morphologyengine_batch_forward, &batchdata);
+    }
+
+    lw_morphologyengine_release_context (engine, context); context = NULL;
+}
+
+
+//!
+//! @brief Will analyze the sentence and return an array of non-trivial root form words.
+//!        The result is always freshly allocated so the caller may modify it.
+//!
+LwMorphologyList*
+lw_morphologyengine_analyze_uncached (LwMorphologyEngine *engine, const gchar *TEXT, gboolean spellcheck)
+{
+    //Sanity checks
+    g_return_val_if_fail (engine != NULL, NULL);
+    if (TEXT == NULL) return NULL;
+
+    //Declarations
+    LwMorphologyEngineContext *context = NULL;
+    LwMorphologyList *morphologylist = NULL;
+
+    context = lw_morphologyengine_acquire_context (engine);
+    morphologylist = lw_morphologyengine_context_analyze (context, TEXT, spellcheck);
+    lw_morphologyengine_release_context (engine, context); context = NULL;
+
+    return morphologylist;
+}
+
+
+//!
+//! @brief Same as lw_morphologyengine_analyze_uncached() but repeated analyses of
+//!        the same text are served from a bounded LRU cache.  The returned list
+//!        is shared, so it must not be modified.  Release it with lw_morphologylist_unref().
+//!
+LwMorphologyList*
+lw_morphologyengine_analyze (LwMorphologyEngine *engine, const gchar *TEXT, gboolean spellcheck)
+{
+    //Sanity checks
+    g_return_val_if_fail (engine != NULL, NULL);
+    if (TEXT == NULL) return NULL;
+
+    //Declarations
+    LwMorphologyEngineCache *cache = &engine->cache;
+    gchar *key = NULL;
+    GList *link = NULL;
+    LwMorphologyEngineCacheEntry *entry = NULL;
+    LwMorphologyList *morphologylist = NULL;
+
+    //Initializations
+    key = g_strconcat ((spellcheck) ? "1" : "0", TEXT, NULL);
+
+    g_mutex_lock (&engine->mutex);
+    link = g_hash_table_lookup (cache->table, key);
+    if (link != NULL)
+    {
+      g_queue_unlink (&cache->queue, link);
+      g_queue_push_head_link (&cache->queue, link);
+      entry = link->data;
+      morphologylist = lw_morphologylist_ref (entry->morphologylist);
+      cache->hits++;
+    }
+    else
+    {
+      cache->misses++;
+    }
+    g_mutex_unlock (&engine->mutex);
+
+    if (morphologylist != NULL) goto errored;
+
+    //Analyze outside of the lock.  Compile the scorer now so it is ready before the list is shared
+    morphologylist = lw_morphologyengine_analyze_uncached (engine, TEXT, spellcheck); if (morphologylist == NULL) goto errored;
+    lw_morphologylist_get_scorer (morphologylist);
+
+    g_mutex_lock (&engine->mutex);
+    if (cache->max > 0 && g_hash_table_lookup (cache->table, key) == NULL)
+    {
+      entry = g_new0 (LwMorphologyEngineCacheEntry, 1);
+      entry->key = key; key = NULL;
+      entry->morphologylist = lw_morphologylist_ref (morphologylist);
+      g_queue_push_head (&cache->queue, entry);
+      g_hash_table_insert (cache->table, entry->key, cache->queue.head);
+
+      while (cache->queue.length > cache->max)
+      {
+        entry = g_queue_pop_tail (&cache->queue);
+        g_hash_table_remove (cache->table, entry->key);
+        _lw_morphologyengine_cache_entry_free (entry);
+      }
+    }
+    g_mutex_unlock (&engine->mutex);
+
+errored:
+
+    if (key != NULL) g_free (key); key = NULL;
+
+    return morphologylist;
+}
+
+
+//!
+//! @brief Sets the maximum number of cached analyses.  0 disables the cache.
+//!
+void
+lw_morphologyengine_set_cache_size (LwMorphologyEngine *engine, gint max)
+{
+    //Sanity checks
+    g_return_if_fail (engine != NULL);
+    g_return_if_fail (max >= 0);
+
+    //Declarations
+    LwMorphologyEngineCache *cache = &engine->cache;
+    LwMorphologyEngineCacheEntry *entry = NULL;
+
+    g_mutex_lock (&engine->mutex);
+    cache->max = max;
+    while (cache->queue.length > cache->max)
+    {
+      entry = g_queue_pop_tail (&cache->queue);
+      g_hash_table_remove (cache->table, entry->key);
+      _lw_morphologyengine_cache_entry_free (entry);
+    }
+    g_mutex_unlock (&engine->mutex);
+}
+
+
+void
+lw_morphologyengine_clear_cache (LwMorphologyEngine *engine)
+{
+    //Sanity checks
+    g_return_if_fail (engine != NULL);
+
+    //Declarations
+    LwMorphologyEngineCache *cache = &engine->cache;
+    LwMorphologyEngineCacheEntry *entry = NULL;
+
+    g_mutex_lock (&engine->mutex);
+    if (cache->table != NULL) g_hash_table_remove_all (cache->table);
+    while ((entry = g_queue_pop_head (&cache->queue)) != NULL)
+    {
+      _lw_morphologyengine_cache_entry_free (entry);
+    }
+    cache->hits = cache->misses = 0;
+    g_mutex_unlock (&engine->mutex);
+}
+
+
+//!
+//! @brief Gets the cache counters for tuning LW_MORPHOLOGYENGINE_CACHE_SIZE.  Any parameter may be NULL.
+//!
+void
+lw_morphologyengine_get_cache_stats (LwMorphologyEngine *engine, 
+                                     guint              *hits, 
+                                     guint              *misses, 
+                                     gint               *length)
+{
+    //Sanity checks
+    g_return_if_fail (engine != NULL);
+
+    g_mutex_lock (&engine->mutex);
+    if (hits != NULL) *hits = engine->cache.hits;
+    if (misses != NULL) *misses = engine->cache.misses;
+    if (length != NULL) *length = engine->cache.queue.length;
+    g_mutex_unlock (&engine->mutex);
 }
 
 
+gdouble
+lw_morphologyengine_get_cache_hit_rate (LwMorphologyEngine *engine)
+{
+    //Sanity checks
+    g_return_val_if_fail (engine != NULL, 0.0);
 
+    //Declarations
+    guint hits = 0;
+    guint misses = 0;
+
+    lw_morphologyengine_get_cache_stats (engine, &hits, &misses, NULL);
+    if (hits + misses == 0) return 0.0;
+
+    return ((gdouble) hits / (gdouble) (hits + misses));
+}
+
+
+static void
+_lw_morphologyengine_cache_entry_free (LwMorphologyEngineCacheEntry *entry)
+{
+    if (entry == NULL) return;
+
+    if (entry->key != NULL) g_free (entry->key); entry->key = NULL;
+    if (entry->morphologylist != NULL) lw_morphologylist_unref (entry->morphologylist); entry->morphologylist = NULL;
+
+    g_free (entry);
+}
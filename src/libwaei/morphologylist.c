@@ -45,6 +45,7 @@ lw_morphologylist_new_from_list (GList *list)
     if (temp == NULL) goto errored;
   
     temp->list = temp->link = list;
+    temp->refcount = 1;
 
 errored:
 
@@ -80,20 +81,60 @@ lw_morphologylist_read (LwMorphologyList *morphologylist)
 }
 
 
+LwMorphology*
+lw_morphologylist_get_first (LwMorphologyList *morphologylist)
+{
+    //Sanity checks
+    g_return_val_if_fail (morphologylist != NULL, NULL);
+
+    if (morphologylist->list == NULL) return NULL;
+    return LW_MORPHOLOGY (morphologylist->list->data);
+}
+
+
 //!
-//! @brief Convenience function to free a GList of LwMorphology
-//! @param morphology The object to free
+//! @brief Adds a reference to a LwMorphologyList.  Lists returned by the
+//!        analysis cache are shared, so treat them as read only.
 //!
-void 
-lw_morphologylist_free (LwMorphologyList *morphologylist)
+LwMorphologyList*
+lw_morphologylist_ref (LwMorphologyList *morphologylist)
+{
+    //Sanity checks
+    g_return_val_if_fail (morphologylist != NULL, NULL);
+
+    g_atomic_int_inc (&morphologylist->refcount);
+
+    return morphologylist;
+}
+
+
+//!
+//! @brief Releases a reference, freeing the GList of LwMorphology with the last one
+//!
+void
+lw_morphologylist_unref (LwMorphologyList *morphologylist)
 {
     if (morphologylist == NULL) return;
+    if (!g_atomic_int_dec_and_test (&morphologylist->refcount)) return;
+
     if (morphologylist->list != NULL) g_list_free_full (morphologylist->list, (GDestroyNotify)lw_morphology_free);
+    if (morphologylist->scorer != NULL) lw_morphologyscorer_free (morphologylist->scorer);
     memset(morphologylist, 0, sizeof(LwMorphologyList));
     g_free (morphologylist);
 }
 
 
+//!
+//! @brief Convenience function to release a LwMorphologyList.  Same as lw_morphologylist_unref()
+//! @param morphology The object to free
+//!
+void 
+lw_morphologylist_free (LwMorphologyList *morphologylist)
+{
+    lw_morphologylist_unref (morphologylist);
+}
+
+
 LwMorphology*
 lw_morphologylist_find (LwMorphologyList *morphologylist,
                         const gchar      *WORD)
@@ -125,12 +166,11 @@ lw_morphologylist_to_string (LwMorphologyList *morphologylist)
 
     GString *output = g_string_new ("LwMorphologyList {\n");
     LwMorphology *morphology;
-    GList *position = morphologylist->link;
+    GList *link = NULL;
 
-    lw_morphologylist_rewind (morphologylist);
-
-    while ((morphology = lw_morphologylist_read (morphologylist)) != NULL)
+    for (link = morphologylist->list; link != NULL; link = link->next)
     {
+      morphology = LW_MORPHOLOGY (link->data);
       gchar *morphology_string = lw_morphology_to_string (morphology);
       if (morphology_string != NULL)
       {
@@ -141,8 +181,6 @@ lw_morphologylist_to_string (LwMorphologyList *morphologylist)
 
     g_string_append (output, " }");
 
-    morphologylist->link = position;
-
     return g_string_free (output, FALSE);
 }
 
@@ -159,19 +197,16 @@ lw_morphologylist_get_words (LwMorphologyList *morphologylist)
     if (length == 0) return NULL;
     gchar const ** words = g_new0 (const gchar*, length + 1); if (words == NULL) return NULL;
     LwMorphology *morphology = NULL;
-    GList *position = morphologylist->link;
+    GList *link = NULL;
     gint i = 0;
 
-    lw_morphologylist_rewind (morphologylist);
-
-    while ((morphology = lw_morphologylist_read (morphologylist)) != NULL && i < length)
+    for (link = morphologylist->list; link != NULL && i < length; link = link->next)
     {
+      morphology = LW_MORPHOLOGY (link->data);
       words[i++] = lw_morphology_get_raw (morphology);
     }
     words[i] = NULL;
 
-    morphologylist->link = position;
-
     if (i == 0)
     {
       g_free (words); words = NULL;
@@ -193,19 +228,16 @@ lw_morphologylist_get_stems (LwMorphologyList *morphologylist)
     if (length == 0) return NULL;
     gchar const ** stems = g_new0 (const gchar*, length + 1); if (stems == NULL) return NULL;
     LwMorphology *morphology = NULL;
-    GList *position = morphologylist->link;
+    GList *link = NULL;
     int i = 0;
 
-    lw_morphologylist_rewind (morphologylist);
-
-    while ((morphology = lw_morphologylist_read (morphologylist)) != NULL && i < length)
+    for (link = morphologylist->list; link != NULL && i < length; link = link->next)
     {
+      morphology = LW_MORPHOLOGY (link->data);
       stems[i++] = lw_morphology_get_stem (morphology);
     }
     stems[i] = NULL;
 
-    morphologylist->link = position;
-
     if (i == 0)
     {
       g_free (stems); stems = NULL;
@@ -226,19 +258,16 @@ lw_morphologylist_get_normalized (LwMorphologyList *morphologylist)
     gint length = g_list_length (morphologylist->list);
     gchar const ** normalized = g_new0 (const gchar*, length + 1); if (normalized == NULL) return NULL;
     LwMorphology *morphology = NULL;
-    GList *position = morphologylist->link;
+    GList *link = NULL;
     int i = 0;
 
-    lw_morphologylist_rewind (morphologylist);
-
-    while ((morphology = lw_morphologylist_read (morphologylist)) != NULL && i < length)
+    for (link = morphologylist->list; link != NULL && i < length; link = link->next)
     {
+      morphology = LW_MORPHOLOGY (link->data);
       normalized[i++] = lw_morphology_get_normalized (morphology);
     }
     normalized[i] = NULL;
 
-    morphologylist->link = position;
-
     if (i == 0)
     {
       g_free (normalized); normalized = NULL;
@@ -260,19 +289,16 @@ lw_morphologylist_get_canonical (LwMorphologyList *morphologylist)
     if (length == 0) return NULL;
     gchar const ** canonical = g_new0 (const gchar*, length + 1); if (canonical == NULL) return NULL;
     LwMorphology *morphology = NULL;
-    GList *position = morphologylist->link;
+    GList *link = NULL;
     int i = 0;
 
-    lw_morphologylist_rewind (morphologylist);
-
-    while ((morphology = lw_morphologylist_read (morphologylist)) != NULL && i < length)
+    for (link = morphologylist->list; link != NULL && i < length; link = link->next)
     {
+      morphology = LW_MORPHOLOGY (link->data);
       canonical[i++] = lw_morphology_get_canonical (morphology);
     }
     canonical[i] = NULL;
 
-    morphologylist->link = position;
-
     if (i == 0)
     {
       g_free (canonical); canonical = NULL;
@@ -292,204 +318,42 @@ lw_morphologylist_length (LwMorphologyList *morphologylist)
 }
 
 
-static gint
-_sort (gconstpointer a, gconstpointer b)
-{
-    const LwMorphologyIndex *ia = a;
-    const LwMorphologyIndex *ib = b;
-
-    if (ia->start_offset < ib->start_offset) return -1;
-    if (ia->start_offset > ib->start_offset) return 1;
-    if (ia->start_offset == ib->start_offset) 
-    {
-      if (ia->end_offset < ib->end_offset) return -1;
-      if (ia->end_offset > ib->end_offset) return 1;
-      if (ia->end_offset == ib->end_offset) return 0;
-    }
-
-    g_assert_not_reached ();
-    return 0;
-}
-
-
-static gint
-_lw_morphologylist_get_section_score (LwMorphologyList  *morphologylist, 
-                                      const gchar       *HAYSTACK)
+//!
+//! @brief Returns the automaton used to score result lines against this list.  It is
+//!        compiled the first time it is needed and shared by every holder of the list.
+//!
+LwMorphologyScorer*
+lw_morphologylist_get_scorer (LwMorphologyList *morphologylist)
 {
     //Sanity checks
     g_return_val_if_fail (morphologylist != NULL, NULL);
-    g_return_val_if_fail (HAYSTACK != NULL, NULL);
-    if (strlen(HAYSTACK) == 0) return G_MININT;
-
-    //Declarations
-    GList *link = morphologylist->list;
-    GList *resultlist = NULL;
-    gint index = 0;
-    gint score = 0;
-    const gint DIFFERENCE_SCORE_WEIGHT = 1;
-    const gint CONTIGUOUS_SCORE_WEIGHT = 10;
-    const gint IN_ORDER_SCORE_WEIGHT = 5;
-    const gint STARTS_WITH_SCORE_WEIGHT = 5;
-
-    //Calculate the LwMorphologyIndex
-    for (link = morphologylist->list; link != NULL; link = link->next)
-    {
-      LwMorphology *morphology = LW_MORPHOLOGY (link->data);
-      GMatchInfo *match_info = NULL;
-
-      if (lw_morphology_regex_search (morphology, HAYSTACK, &match_info))
-      {
-        while (g_match_info_matches (match_info))
-        {
-          gint start_offset = 0;
-          gint end_offset = 0;
-          if (g_match_info_fetch_pos (match_info, 0, &start_offset, &end_offset))
-          {
-            LwMorphologyIndex *morphologyindex = lw_morphologyindex_new (index, HAYSTACK, start_offset, end_offset);
-            resultlist = g_list_append (resultlist, morphologyindex);
-            index++;
-          }
-
-          g_match_info_next (match_info, NULL);
-        }
-       
-        if (match_info != NULL) g_match_info_free (match_info); match_info = NULL;
-      }
-    }
-    resultlist = g_list_sort (resultlist, _sort);
-
-    if (resultlist == NULL) return G_MININT;
-
 
-    gint starts_with_score = 0;
+    if (g_once_init_enter (&morphologylist->scorer))
     {
-      //Get the ratio of correct charaters to incorrect
-      link = resultlist;
-      if (link != NULL)
-      {
-        LwMorphologyIndex *morphologyindex = link->data;
-        if (morphologyindex->start_offset == 0)
-        {
-          starts_with_score += 10;
-        }
-      }
+      g_once_init_leave (&morphologylist->scorer, lw_morphologyscorer_new (morphologylist->list));
     }
-    score += starts_with_score * STARTS_WITH_SCORE_WEIGHT;
 
-
-    gint difference_score = 0;
-    {
-      //Get the ratio of correct charaters to incorrect
-      difference_score = -g_utf8_strlen (HAYSTACK, -1);
-      for (link = resultlist; link != NULL; link = link->next)
-      {
-        LwMorphologyIndex *morphologyindex = link->data;
-        const gchar *SUB_INDEX = HAYSTACK + morphologyindex->start_offset;
-        gint length = morphologyindex->end_offset - morphologyindex->start_offset;
-        difference_score += g_utf8_strlen (SUB_INDEX, length);
-      }
-    }
-    score += difference_score * DIFFERENCE_SCORE_WEIGHT;
-
-
-    gint contiguous_score = 0;
-    {
-      //Figure out of the tokens are in order and/or contiguous
-      GHashTable *table = g_hash_table_new (g_direct_hash, g_direct_equal);
-
-      //Generate the index
-      for (link = resultlist; link != NULL; link = link->next)
-      {
-        LwMorphologyIndex *morphologyindex = link->data;
-
-        g_hash_table_insert (table, 
-                             GINT_TO_POINTER (morphologyindex->start_offset), 
-                             morphologyindex);
-        g_hash_table_insert (table, 
-                             GINT_TO_POINTER (morphologyindex->end_offset), 
-                             morphologyindex);
-      }
-
-      //Calculate the contiguous score
-      for (link = resultlist; link != NULL; link = link->next)
-      {
-        LwMorphologyIndex *primaryindex = link->data;
-        gint index = primaryindex->index;
-        gint offset = primaryindex->end_offset;
-
-        while (*(HAYSTACK + offset) == ' ' || *(HAYSTACK + offset) == '-') offset++;
-        LwMorphologyIndex *otherindex = g_hash_table_lookup (table, GINT_TO_POINTER (offset));
-        
-        if (otherindex != NULL && otherindex->index == index + 1) contiguous_score++;
-      }
-
-      g_hash_table_unref (table); table = NULL;
-    }
-    score += contiguous_score * CONTIGUOUS_SCORE_WEIGHT;
-
-
-    gint in_order_score = 0;
-    {
-      for (link = resultlist; link != NULL && link->next != NULL; link = link->next)
-      {
-        LwMorphologyIndex *primaryindex = link->data;
-        LwMorphologyIndex *otherindex = link->next->data;
-        if (primaryindex->index == otherindex->index) ;
-        else if (primaryindex->index + 1 == otherindex->index) in_order_score++;
-        else in_order_score--;
-      }
-    }
-    score += in_order_score * IN_ORDER_SCORE_WEIGHT;
-    //fprintf(stderr, "BREAK %s %d\n", HAYSTACK, difference);
-
-errored:
-
-    if (resultlist != NULL) g_list_free_full (resultlist, (GDestroyNotify) lw_morphologyindex_free); resultlist = NULL;
-
-    return score;
+    return morphologylist->scorer;
 }
 
 
 ///!
-///! @brief returns an unsorted morphologyindexlist, used for findings postions of matches and their order
+///! @brief Scores a result line against the query.  Higher is better and G_MININT means no match.
 ///!
 gint
 lw_morphologylist_get_score (LwMorphologyList *morphologylist, 
                              const gchar      *HAYSTACK)
 {
     //Sanity checks
-    g_return_val_if_fail (morphologylist != NULL, NULL);
-    g_return_val_if_fail (HAYSTACK != NULL, NULL);
+    g_return_val_if_fail (morphologylist != NULL, G_MININT);
+    g_return_val_if_fail (HAYSTACK != NULL, G_MININT);
 
     //Declarations
-    gint i = 0;
-    gint score = G_MININT;
-    gchar *cleaned = NULL;
-    GMatchInfo *match_info = NULL;
+    LwMorphologyScorer *scorer = NULL;
 
     //Initializations
-    cleaned = lw_regex_remove_parenthesis (HAYSTACK); if (cleaned == NULL) goto errored;
-    lw_regex_get_sections (cleaned, &match_info); 
-
-    while (g_match_info_matches (match_info))
-    {
-      gchar *mini_haystack = g_match_info_fetch (match_info, 0);
-      gint section_score = _lw_morphologylist_get_section_score (morphologylist, mini_haystack);
-//      printf("BREAK mini %d %s\n", section_score, mini_haystack);
-
-      if (section_score > score) score = section_score;
-
-      if (mini_haystack != NULL) g_free (mini_haystack); mini_haystack = NULL;
-
-      g_match_info_next (match_info, NULL);
-    }
-//    printf("BREAK %d %s\n", score, HAYSTACK);
-     
-errored:
-
-    if (match_info != NULL) g_match_info_free (match_info); match_info = NULL;
-    if (cleaned != NULL) g_free (cleaned); cleaned = NULL;
+    scorer = lw_morphologylist_get_scorer (morphologylist); if (scorer == NULL) return G_MININT;
 
-    return score;
+    return lw_morphologyscorer_get_score (scorer, HAYSTACK);
 }
 
@@ -0,0 +1,607 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file morphologyscorer.c
+//!
+//! @brief Scores result lines against every form of a query in one pass
+//!
+//! All of the forms of all of the morphologies are compiled into a single
+//! Aho-Corasick automaton when the query is analyzed.  Each section of a
+//! result line is then walked once, and the matches are ranked on stack
+//! buffers using the same weights the per-morphology regexes used to.
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <libwaei/libwaei.h>
+#include <libwaei/gettext.h>
+
+
+#define LW_MORPHOLOGYSCORER_FORMS 4
+
+struct _LwMorphologyScorerMatch {
+  gint morphology;
+  gint form;
+  gint start_offset;
+  gint end_offset;
+  gint index;
+};
+typedef struct _LwMorphologyScorerMatch LwMorphologyScorerMatch;
+
+
+static gint
+_lw_morphologyscorer_get_child (LwMorphologyScorer *scorer,
+                                gint                node,
+                                guchar              c)
+{
+    gint child = scorer->nodes[node].first_child;
+
+    while (child != -1 && scorer->nodes[child].c != c)
+    {
+      child = scorer->nodes[child].next_sibling;
+    }
+
+    return child;
+}
+
+
+static gint
+_lw_morphologyscorer_add_node (LwMorphologyScorer *scorer,
+                               gint               *allocated,
+                               gint                parent,
+                               guchar              c)
+{
+    //Declarations
+    LwMorphologyScorerNode *node = NULL;
+    gint i = 0;
+
+    if (scorer->length >= *allocated)
+    {
+      *allocated *= 2;
+      scorer->nodes = g_renew (LwMorphologyScorerNode, scorer->nodes, *allocated);
+    }
+
+    i = scorer->length++;
+    node = scorer->nodes + i;
+    node->first_child = -1;
+    node->fail = 0;
+    node->output = -1;
+    node->pattern = -1;
+    node->c = c;
+
+    if (parent != -1)
+    {
+      node->next_sibling = scorer->nodes[parent].first_child;
+      scorer->nodes[parent].first_child = i;
+    }
+    else
+    {
+      node->next_sibling = -1;
+    }
+
+    return i;
+}
+
+
+static void
+_lw_morphologyscorer_add_pattern (LwMorphologyScorer *scorer,
+                                  gint               *allocated,
+                                  const gchar        *PATTERN,
+                                  gint                morphology,
+                                  gint                form)
+{
+    //Declarations
+    const guchar *c = (const guchar*) PATTERN;
+    gint node = 0;
+    gint child = 0;
+    gint i = 0;
+
+    for (c = (const guchar*) PATTERN; *c != '\0'; c++)
+    {
+      child = _lw_morphologyscorer_get_child (scorer, node, *c);
+      if (child == -1) child = _lw_morphologyscorer_add_node (scorer, allocated, node, *c);
+      node = child;
+    }
+
+    i = scorer->total_patterns++;
+    scorer->pattern_morphology[i] = morphology;
+    scorer->pattern_form[i] = form;
+    scorer->pattern_length[i] = c - (const guchar*) PATTERN;
+    scorer->pattern_next[i] = scorer->nodes[node].pattern;
+    scorer->nodes[node].pattern = i;
+}
+
+
+//!
+//! @brief Fills in the fail and output links breadth first
+//!
+static void
+_lw_morphologyscorer_link (LwMorphologyScorer *scorer)
+{
+    //Declarations
+    gint *queue = NULL;
+    gint head = 0;
+    gint tail = 0;
+    gint node = 0;
+    gint child = 0;
+    gint fail = 0;
+    gint next = 0;
+
+    //Initializations
+    queue = g_new (gint, scorer->length);
+
+    for (child = scorer->nodes[0].first_child; child != -1; child = scorer->nodes[child].next_sibling)
+    {
+      scorer->nodes[child].fail = 0;
+      queue[tail++] = child;
+    }
+
+    while (head < tail)
+    {
+      node = queue[head++];
+
+      for (child = scorer->nodes[node].first_child; child != -1; child = scorer->nodes[child].next_sibling)
+      {
+        fail = scorer->nodes[node].fail;
+        next = _lw_morphologyscorer_get_child (scorer, fail, scorer->nodes[child].c);
+        while (next == -1 && fail != 0)
+        {
+          fail = scorer->nodes[fail].fail;
+          next = _lw_morphologyscorer_get_child (scorer, fail, scorer->nodes[child].c);
+        }
+        if (next == -1 || next == child) next = 0;
+
+        scorer->nodes[child].fail = next;
+        scorer->nodes[child].output = (scorer->nodes[next].pattern != -1) ? next : scorer->nodes[next].output;
+        queue[tail++] = child;
+      }
+    }
+
+    g_free (queue); queue = NULL;
+}
+
+
+//!
+//! @brief Compiles the raw, normalized, stem and canonical forms of each morphology
+//!        into one automaton.  The forms are matched literally.
+//! @param morphologies A GList of LwMorphology
+//! @returns A new LwMorphologyScorer that should be freed with lw_morphologyscorer_free()
+//!
+LwMorphologyScorer*
+lw_morphologyscorer_new (GList *morphologies)
+{
+    //Declarations
+    LwMorphologyScorer *scorer = NULL;
+    LwMorphology *morphology = NULL;
+    GList *link = NULL;
+    const gchar *forms[LW_MORPHOLOGYSCORER_FORMS];
+    gint allocated = 0;
+    gint total_patterns = 0;
+    gint i = 0;
+    gint j = 0;
+
+    //Initializations
+    scorer = g_new0 (LwMorphologyScorer, 1); if (scorer == NULL) goto errored;
+    scorer->total_morphologies = g_list_length (morphologies);
+    total_patterns = scorer->total_morphologies * LW_MORPHOLOGYSCORER_FORMS;
+    scorer->pattern_morphology = g_new (gint, total_patterns + 1);
+    scorer->pattern_form = g_new (gint, total_patterns + 1);
+    scorer->pattern_length = g_new (gint, total_patterns + 1);
+    scorer->pattern_next = g_new (gint, total_patterns + 1);
+    allocated = 64;
+    scorer->nodes = g_new (LwMorphologyScorerNode, allocated);
+    _lw_morphologyscorer_add_node (scorer, &allocated, -1, '\0');
+
+    for (link = morphologies, i = 0; link != NULL; link = link->next, i++)
+    {
+      morphology = LW_MORPHOLOGY (link->data);
+      forms[0] = morphology->word;
+      forms[1] = morphology->normalized;
+      forms[2] = morphology->stem;
+      forms[3] = morphology->canonical;
+
+      for (j = 0; j < LW_MORPHOLOGYSCORER_FORMS; j++)
+      {
+        if (forms[j] == NULL || *forms[j] == '\0') continue;
+        _lw_morphologyscorer_add_pattern (scorer, &allocated, forms[j], i, j);
+      }
+    }
+
+    _lw_morphologyscorer_link (scorer);
+
+errored:
+
+    return scorer;
+}
+
+
+void
+lw_morphologyscorer_free (LwMorphologyScorer *scorer)
+{
+    //Sanity checks
+    if (scorer == NULL) return;
+
+    g_free (scorer->nodes);
+    g_free (scorer->pattern_morphology);
+    g_free (scorer->pattern_form);
+    g_free (scorer->pattern_length);
+    g_free (scorer->pattern_next);
+
+    memset(scorer, 0, sizeof(LwMorphologyScorer));
+    g_free (scorer);
+}
+
+
+//!
+//! @brief Walks the section once, collecting every occurrence of every form
+//! @returns The number of occurrences written to matches
+//!
+static gint
+_lw_morphologyscorer_find (LwMorphologyScorer      *scorer,
+                           const gchar             *SECTION,
+                           gint                     length,
+                           LwMorphologyScorerMatch *matches)
+{
+    //Declarations
+    const guchar *c = (const guchar*) SECTION;
+    gint state = 0;
+    gint next = 0;
+    gint node = 0;
+    gint pattern = 0;
+    gint total = 0;
+    gint i = 0;
+
+    for (i = 0; i < length; i++)
+    {
+      next = _lw_morphologyscorer_get_child (scorer, state, c[i]);
+      while (next == -1 && state != 0)
+      {
+        state = scorer->nodes[state].fail;
+        next = _lw_morphologyscorer_get_child (scorer, state, c[i]);
+      }
+      state = (next == -1) ? 0 : next;
+
+      for (node = state; node != -1; node = scorer->nodes[node].output)
+      {
+        for (pattern = scorer->nodes[node].pattern; pattern != -1; pattern = scorer->pattern_next[pattern])
+        {
+          if (total >= LW_MORPHOLOGYSCORER_MAX_MATCHES) return total;
+          matches[total].morphology = scorer->pattern_morphology[pattern];
+          matches[total].form = scorer->pattern_form[pattern];
+          matches[total].start_offset = i + 1 - scorer->pattern_length[pattern];
+          matches[total].end_offset = i + 1;
+          matches[total].index = -1;
+          total++;
+        }
+      }
+    }
+
+    return total;
+}
+
+
+//!
+//! @brief Finds what the query matches in TEXT with the same single pass over the
+//!        automaton that scoring makes, so highlighting doesn't have to match again.
+//!        Occurrences come out ordered by where they end, so overlapping and
+//!        touching ones are merged into the last spans as they are found.
+//! @param scorer The compiled query
+//! @param TEXT The text to search.  It does not have to be null terminated.
+//! @param length The length of TEXT in bytes or -1 if it is null terminated
+//! @param spans Receives the matched parts sorted by position
+//! @param max The number of spans there is room for
+//! @returns The number of spans written
+//!
+gint
+lw_morphologyscorer_get_spans (LwMorphologyScorer     *scorer,
+                               const gchar            *TEXT,
+                               gint                    length,
+                               LwMorphologyScorerSpan *spans,
+                               gint                    max)
+{
+    //Sanity checks
+    g_return_val_if_fail (scorer != NULL, 0);
+    g_return_val_if_fail (TEXT != NULL, 0);
+    g_return_val_if_fail (spans != NULL, 0);
+    if (length < 0) length = strlen(TEXT);
+
+    //Declarations
+    const guchar *c = (const guchar*) TEXT;
+    gint state = 0;
+    gint next = 0;
+    gint node = 0;
+    gint pattern = 0;
+    gint start_offset = 0;
+    gint end_offset = 0;
+    gint total = 0;
+    gint i = 0;
+
+    for (i = 0; i < length; i++)
+    {
+      next = _lw_morphologyscorer_get_child (scorer, state, c[i]);
+      while (next == -1 && state != 0)
+      {
+        state = scorer->nodes[state].fail;
+        next = _lw_morphologyscorer_get_child (scorer, state, c[i]);
+      }
+      state = (next == -1) ? 0 : next;
+
+      for (node = state; node != -1; node = scorer->nodes[node].output)
+      {
+        for (pattern = scorer->nodes[node].pattern; pattern != -1; pattern = scorer->pattern_next[pattern])
+        {
+          start_offset = i + 1 - scorer->pattern_length[pattern];
+          end_offset = i + 1;
+
+          //A longer form can reach back over spans that were already found
+          while (total > 0 && start_offset <= spans[total - 1].end_offset)
+          {
+            total--;
+            start_offset = MIN (start_offset, spans[total].start_offset);
+          }
+
+          if (total >= max) return total;
+          spans[total].start_offset = start_offset;
+          spans[total].end_offset = end_offset;
+          total++;
+        }
+      }
+    }
+
+    return total;
+}
+
+
+//!
+//! @brief Keeps the leftmost non-overlapping occurrences of each morphology, preferring
+//!        the earlier form when two start at the same place.  This is what searching
+//!        with a word|normalized|stem|canonical alternation used to return.
+//!        Indexes are numbered by morphology, then by position.
+//! @returns The number of selected matches moved to the front of matches, sorted by position
+//!
+static gint
+_lw_morphologyscorer_select (LwMorphologyScorer      *scorer,
+                             LwMorphologyScorerMatch *matches,
+                             gint                     total)
+{
+    //Declarations
+    LwMorphologyScorerMatch selected[LW_MORPHOLOGYSCORER_MAX_MATCHES];
+    LwMorphologyScorerMatch temp;
+    gint length = 0;
+    gint morphology = 0;
+    gint position = 0;
+    gint best = 0;
+    gint index = 0;
+    gint i = 0;
+    gint j = 0;
+
+    for (morphology = 0; morphology < scorer->total_morphologies; morphology++)
+    {
+      position = 0;
+      while (TRUE)
+      {
+        best = -1;
+        for (i = 0; i < total; i++)
+        {
+          if (matches[i].morphology != morphology) continue;
+          if (matches[i].start_offset < position) continue;
+          if (best == -1 ||
+              matches[i].start_offset < matches[best].start_offset ||
+              (matches[i].start_offset == matches[best].start_offset && matches[i].form < matches[best].form))
+          {
+            best = i;
+          }
+        }
+        if (best == -1) break;
+
+        selected[length] = matches[best];
+        selected[length].index = index++;
+        position = matches[best].end_offset;
+
+        //Stable insertion by (start, end) so equal spans stay in index order
+        for (j = length; j > 0; j--)
+        {
+          if (selected[j - 1].start_offset < selected[j].start_offset) break;
+          if (selected[j - 1].start_offset == selected[j].start_offset && selected[j - 1].end_offset <= selected[j].end_offset) break;
+          temp = selected[j - 1]; selected[j - 1] = selected[j]; selected[j] = temp;
+        }
+        length++;
+      }
+    }
+
+    memcpy(matches, selected, sizeof(LwMorphologyScorerMatch) * length);
+
+    return length;
+}
+
+
+//!
+//! @brief Scores a single section of a result line
+//! @param scorer The compiled query
+//! @param SECTION The text to score.  It does not have to be null terminated.
+//! @param length The length of the section in bytes
+//! @returns The score or G_MININT if nothing in the query matched
+//!
+gint
+lw_morphologyscorer_get_section_score (LwMorphologyScorer *scorer,
+                                       const gchar        *SECTION,
+                                       gint                length)
+{
+    //Sanity checks
+    g_return_val_if_fail (scorer != NULL, G_MININT);
+    g_return_val_if_fail (SECTION != NULL, G_MININT);
+    if (length < 0) length = strlen(SECTION);
+    if (length == 0) return G_MININT;
+
+    //Declarations
+    LwMorphologyScorerMatch matches[LW_MORPHOLOGYSCORER_MAX_MATCHES];
+    gint total = 0;
+    gint score = 0;
+    gint i = 0;
+    gint j = 0;
+    const gint DIFFERENCE_SCORE_WEIGHT = 1;
+    const gint CONTIGUOUS_SCORE_WEIGHT = 10;
+    const gint IN_ORDER_SCORE_WEIGHT = 5;
+    const gint STARTS_WITH_SCORE_WEIGHT = 5;
+
+    total = _lw_morphologyscorer_find (scorer, SECTION, length, matches);
+    total = _lw_morphologyscorer_select (scorer, matches, total);
+    if (total == 0) return G_MININT;
+
+    gint starts_with_score = 0;
+    {
+      if (matches[0].start_offset == 0) starts_with_score += 10;
+    }
+    score += starts_with_score * STARTS_WITH_SCORE_WEIGHT;
+
+    gint difference_score = 0;
+    {
+      //Get the ratio of correct charaters to incorrect
+      difference_score = -g_utf8_strlen (SECTION, length);
+      for (i = 0; i < total; i++)
+      {
+        difference_score += g_utf8_strlen (SECTION + matches[i].start_offset, matches[i].end_offset - matches[i].start_offset);
+      }
+    }
+    score += difference_score * DIFFERENCE_SCORE_WEIGHT;
+
+    gint contiguous_score = 0;
+    {
+      //A match is contiguous when the one after it starts (or ends) past the spacers
+      for (i = 0; i < total; i++)
+      {
+        gint offset = matches[i].end_offset;
+        gint other = -1;
+
+        while (offset < length && (SECTION[offset] == ' ' || SECTION[offset] == '-')) offset++;
+        for (j = 0; j < total; j++)
+        {
+          if (matches[j].start_offset == offset) other = j;
+          if (matches[j].end_offset == offset) other = j;
+        }
+
+        if (other != -1 && matches[other].index == matches[i].index + 1) contiguous_score++;
+      }
+    }
+    score += contiguous_score * CONTIGUOUS_SCORE_WEIGHT;
+
+    gint in_order_score = 0;
+    {
+      for (i = 0; i + 1 < total; i++)
+      {
+        if (matches[i].index == matches[i + 1].index) ;
+        else if (matches[i].index + 1 == matches[i + 1].index) in_order_score++;
+        else in_order_score--;
+      }
+    }
+    score += in_order_score * IN_ORDER_SCORE_WEIGHT;
+
+    return score;
+}
+
+
+//!
+//! @brief Copies TEXT without the parenthesized notes, like lw_regex_remove_parenthesis()
+//! @returns The length of the output written
+//!
+static gint
+_lw_morphologyscorer_remove_parenthesis (const gchar *TEXT,
+                                         gchar       *output)
+{
+    //Declarations
+    const gchar *c = TEXT;
+    const gchar *end = NULL;
+    gchar *o = output;
+
+    while (*c != '\0')
+    {
+      if (*c == '(' && (end = strchr(c + 1, ')')) != NULL)
+      {
+        c = end + 1;
+        continue;
+      }
+      *(o++) = *(c++);
+    }
+    *o = '\0';
+
+    return o - output;
+}
+
+
+//!
+//! @brief Scores a result line against the query.  Parenthesized notes are ignored
+//!        and the best scoring section wins.
+//! @param scorer The compiled query
+//! @param HAYSTACK The line to score
+//! @returns The score or G_MININT if nothing in the query matched
+//!
+gint
+lw_morphologyscorer_get_score (LwMorphologyScorer *scorer,
+                               const gchar        *HAYSTACK)
+{
+    //Sanity checks
+    g_return_val_if_fail (scorer != NULL, G_MININT);
+    g_return_val_if_fail (HAYSTACK != NULL, G_MININT);
+
+    //Declarations
+    gchar buffer[LW_MORPHOLOGYSCORER_BUFFER_SIZE];
+    gchar *cleaned = NULL;
+    gint length = 0;
+    gint score = G_MININT;
+    gint section_score = 0;
+    GMatchInfo *match_info = NULL;
+    gint start_offset = 0;
+    gint end_offset = 0;
+
+    //Initializations
+    length = strlen(HAYSTACK);
+    if (scorer->total_patterns == 0 || length == 0) goto errored;
+    cleaned = (length < LW_MORPHOLOGYSCORER_BUFFER_SIZE) ? buffer : g_malloc (length + 1);
+    _lw_morphologyscorer_remove_parenthesis (HAYSTACK, cleaned);
+    lw_regex_get_sections (cleaned, &match_info);
+
+    while (g_match_info_matches (match_info))
+    {
+      if (g_match_info_fetch_pos (match_info, 0, &start_offset, &end_offset))
+      {
+        section_score = lw_morphologyscorer_get_section_score (scorer, cleaned + start_offset, end_offset - start_offset);
+        if (section_score > score) score = section_score;
+      }
+
+      g_match_info_next (match_info, NULL);
+    }
+
+errored:
+
+    if (match_info != NULL) g_match_info_free (match_info); match_info = NULL;
+    if (cleaned != NULL && cleaned != buffer) g_free (cleaned); cleaned = NULL;
+
+    return score;
+}
+
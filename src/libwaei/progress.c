@@ -107,6 +107,56 @@ lw_progress_free (LwProgress *progress)
 }
 
 
+//!
+//! @brief Calls the notify function if the progress has changed enough to
+//!        be worth redrawing.  Must be called with the progress unlocked.
+//!
+static void
+_lw_progress_notify (LwProgress *progress)
+{
+    //Declarations
+    LwProgressNotifyFunc notify_func = NULL;
+    gpointer notify_data = NULL;
+
+    g_mutex_lock (&progress->mutex);
+
+    if (progress->changed && progress->reached_ratio_delta)
+    {
+      notify_func = progress->notify_func;
+      notify_data = progress->notify_data;
+    }
+
+    g_mutex_unlock (&progress->mutex);
+
+    if (notify_func != NULL) notify_func (progress, notify_data);
+}
+
+
+//!
+//! @brief Sets a function to be called from the working thread whenever the
+//!        progress changes.  It should only wake whoever displays the
+//!        progress, never do the drawing itself.
+//! @param progress The LwProgress to set the notify function on
+//! @param notify_func The function to call or NULL to unset it
+//! @param notify_data The data passed to the notify function
+//!
+void
+lw_progress_set_notify_func (LwProgress           *progress,
+                             LwProgressNotifyFunc  notify_func,
+                             gpointer              notify_data)
+{
+    //Sanity checks
+    g_return_if_fail (progress != NULL);
+
+    g_mutex_lock (&progress->mutex);
+
+    progress->notify_func = notify_func;
+    progress->notify_data = notify_data;
+
+    g_mutex_unlock (&progress->mutex);
+}
+
+
 void
 lw_progress_set_fraction (LwProgress *progress,
                           gdouble     current_progress,
@@ -115,6 +165,10 @@ lw_progress_set_fraction (LwProgress *progress,
     //Sanity checks
     g_return_if_fail (progress != NULL);
 
+    //Declarations
+    LwProgressNotifyFunc notify_func = NULL;
+    gpointer notify_data = NULL;
+
     g_mutex_lock (&progress->mutex);
 
     if (progress->current_progress != current_progress ||
@@ -126,9 +180,16 @@ lw_progress_set_fraction (LwProgress *progress,
       progress->ratio_delta = fabs((progress->previous_progress / progress->total_progress) - (progress->current_progress / progress->total_progress));
       progress->reached_ratio_delta = (progress->current_progress == 0 || (progress->current_progress / progress->total_progress == 1.0) || progress->ratio_delta > progress->required_ratio_delta);
       progress->changed = TRUE;
+      if (progress->reached_ratio_delta)
+      {
+        notify_func = progress->notify_func;
+        notify_data = progress->notify_data;
+      }
     }
 
     g_mutex_unlock (&progress->mutex);
+
+    if (notify_func != NULL) notify_func (progress, notify_data);
 }
 
 
@@ -156,6 +217,8 @@ lw_progress_set_object (LwProgress *progress,
     progress->object = object;
 
     g_mutex_unlock (&progress->mutex);
+
+    _lw_progress_notify (progress);
 }
 
 
@@ -241,6 +304,8 @@ lw_progress_set_finished (LwProgress *progress,
     }
 
     g_mutex_unlock (&progress->mutex);
+
+    _lw_progress_notify (progress);
 }
 
 
@@ -349,6 +414,8 @@ errored:
     if (message != NULL) g_free (message); message = NULL;
 
     g_mutex_unlock (&progress->mutex);
+
+    _lw_progress_notify (progress);
 }
 
 
@@ -398,6 +465,8 @@ errored:
     if (message != NULL) g_free (message); message = NULL;
 
     g_mutex_unlock (&progress->mutex);
+
+    _lw_progress_notify (progress);
 }
 
 
@@ -445,6 +514,8 @@ errored:
     if (message != NULL) g_free (message); message = NULL;
 
     g_mutex_unlock (&progress->mutex);
+
+    _lw_progress_notify (progress);
 }
 
 
@@ -124,6 +124,59 @@ errored:
 }
 
 
+//!
+//! @brief Like lw_regex_remove_parenthesis() but also says where each byte of
+//!        the output came from so offsets into it can be mapped back to TEXT
+//! @param offsets Set to an array with the offset in TEXT of each byte of the
+//!                output and of its null terminator.  Free it with g_free().
+//!
+gchar*
+lw_regex_remove_parenthesis_with_offsets (const gchar  *TEXT,
+                                          gint        **offsets)
+{
+    //Sanity checks
+    g_return_val_if_fail (TEXT != NULL, NULL);
+    g_return_val_if_fail (offsets != NULL, NULL);
+    g_return_val_if_fail (_cached_regexes[LW_RE_PARENTHESES] != NULL, NULL);
+
+    //Declarations
+    GRegex *regex = NULL;
+    GMatchInfo *match_info = NULL;
+    GString *output = NULL;
+    gint *map = NULL;
+    gint length = 0;
+    gint copied = 0;
+    gint start = 0;
+    gint end = 0;
+    gint i = 0;
+
+    //Initializations
+    regex = _cached_regexes[LW_RE_PARENTHESES];
+    length = strlen(TEXT);
+    output = g_string_sized_new (length);
+    map = g_new (gint, length + 1);
+
+    g_regex_match (regex, TEXT, 0, &match_info);
+    while (g_match_info_matches (match_info))
+    {
+      g_match_info_fetch_pos (match_info, 0, &start, &end);
+      for (i = copied; i < start; i++) map[output->len + i - copied] = i;
+      g_string_append_len (output, TEXT + copied, start - copied);
+      copied = end;
+      g_match_info_next (match_info, NULL);
+    }
+    g_match_info_free (match_info); match_info = NULL;
+
+    for (i = copied; i < length; i++) map[output->len + i - copied] = i;
+    g_string_append_len (output, TEXT + copied, length - copied);
+    map[output->len] = length;
+
+    *offsets = map;
+
+    return g_string_free (output, FALSE);
+}
+
+
 gchar*
 lw_regex_remove_kanji_dictionary_spacers (const gchar *TEXT)
 {
@@ -0,0 +1,431 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file resultarray.c
+//!
+//! @brief Packed (offset, score) arrays that make up the categories of a search
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <libwaei/libwaei.h>
+#include <libwaei/gettext.h>
+
+
+//!
+//! @brief Creates an empty result array
+//! @param reserve How many entries to make room for up front
+//!
+LwResultArray*
+lw_resultarray_new (gint reserve)
+{
+    //Declarations
+    LwResultArray *array = NULL;
+
+    //Initializations
+    array = g_new0 (LwResultArray, 1); if (array == NULL) goto errored;
+    array->allocated = MAX (reserve, 16);
+    array->entries = g_new (LwResultArrayEntry, array->allocated);
+
+errored:
+
+    return array;
+}
+
+
+//!
+//! @brief Creates a result array that only keeps the best max entries appended
+//!        to it.  The kept entries are a heap until lw_resultarray_sort() is
+//!        called so appending n entries costs O(n log max) and O(max) memory.
+//! @param max The number of entries to keep or 0 to keep all of them
+//!
+LwResultArray*
+lw_resultarray_new_bounded (gint max)
+{
+    //Sanity checks
+    g_return_val_if_fail (max >= 0, NULL);
+
+    //Declarations
+    LwResultArray *array = NULL;
+
+    //Initializations
+    array = lw_resultarray_new (max); if (array == NULL) goto errored;
+    array->max = max;
+
+errored:
+
+    return array;
+}
+
+
+void
+lw_resultarray_free (LwResultArray *array)
+{
+    //Sanity checks
+    if (array == NULL) return;
+
+    g_free (array->entries);
+
+    memset(array, 0, sizeof(LwResultArray));
+    g_free (array);
+}
+
+
+//!
+//! @brief Creates a copy of array that is sized to its length with no room to spare
+//!
+LwResultArray*
+lw_resultarray_copy (LwResultArray *array)
+{
+    //Sanity checks
+    g_return_val_if_fail (array != NULL, NULL);
+
+    //Declarations
+    LwResultArray *copy = NULL;
+
+    //Initializations
+    copy = g_new0 (LwResultArray, 1); if (copy == NULL) goto errored;
+    copy->length = array->length;
+    copy->max = array->max;
+    copy->total = array->total;
+    copy->allocated = MAX (array->length, 1);
+    copy->entries = g_new (LwResultArrayEntry, copy->allocated);
+    if (array->length > 0) memcpy (copy->entries, array->entries, sizeof(LwResultArrayEntry) * array->length);
+
+errored:
+
+    return copy;
+}
+
+
+static int
+_lw_resultarray_compare (const void *a, const void *b)
+{
+    //Declarations
+    const LwResultArrayEntry *entry_a = a;
+    const LwResultArrayEntry *entry_b = b;
+
+    if (entry_a->cost < entry_b->cost) return -1;
+    if (entry_a->cost > entry_b->cost) return 1;
+    if (entry_a->score < entry_b->score) return 1;
+    if (entry_a->score > entry_b->score) return -1;
+    if (entry_a->offset < entry_b->offset) return -1;
+    if (entry_a->offset > entry_b->offset) return 1;
+
+    return 0;
+}
+
+
+//!
+//! @returns The index of the array whose next entry at heads is the best or -1
+//!          if all of them are used up.  Earlier arrays win ties.
+//!
+static gint
+_lw_resultarray_best_head (LwResultArray **arrays,
+                           const gint     *heads,
+                           gint            length)
+{
+    //Declarations
+    gint best = -1;
+    gint i = 0;
+
+    for (i = 0; i < length; i++)
+    {
+      if (heads[i] >= lw_resultarray_length (arrays[i])) continue;
+      if (best == -1 || _lw_resultarray_compare (arrays[i]->entries + heads[i], arrays[best]->entries + heads[best]) < 0) best = i;
+    }
+
+    return best;
+}
+
+
+//!
+//! @brief Merges the sorted arrays of the categories of a search into one array
+//!        without repeats.  The heads of the arrays are compared so it is a
+//!        single pass and an entry that is in several of them is kept where
+//!        it scored best, with the earlier array winning ties.
+//! @param previous An earlier merge whose entries are kept first in the same
+//!                 order so iterators over it can carry on, or NULL
+//! @param arrays The arrays indexed by LwIndexTableType.  Any of them can be NULL.
+//! @param length The number of arrays
+//! @returns A new array where the category of each entry is its index in arrays
+//!
+LwResultArray*
+lw_resultarray_merge (LwResultArray  *previous,
+                      LwResultArray **arrays,
+                      gint            length)
+{
+    //Sanity checks
+    g_return_val_if_fail (arrays != NULL, NULL);
+
+    //Declarations
+    LwResultArray *merged = NULL;
+    GHashTable *seen = NULL;
+    gint *heads = NULL;
+    gint total = 0;
+    gint best = 0;
+    gint i = 0;
+    LwResultArrayEntry *entry = NULL;
+    gpointer key = NULL;
+
+    //Initializations
+    heads = g_new0 (gint, length); if (heads == NULL) goto errored;
+    total = lw_resultarray_length (previous);
+    for (i = 0; i < length; i++) total += lw_resultarray_length (arrays[i]);
+    merged = lw_resultarray_new (total); if (merged == NULL) goto errored;
+    seen = g_hash_table_new (g_direct_hash, g_direct_equal); if (seen == NULL) goto errored;
+
+    for (i = 0; i < lw_resultarray_length (previous); i++)
+    {
+      entry = previous->entries + i;
+      g_hash_table_add (seen, LW_OFFSET_TO_POINTER (entry->offset));
+      merged->entries[merged->length++] = *entry;
+    }
+
+    while ((best = _lw_resultarray_best_head (arrays, heads, length)) != -1)
+    {
+      entry = arrays[best]->entries + heads[best]++;
+      key = LW_OFFSET_TO_POINTER (entry->offset);
+      if (g_hash_table_contains (seen, key)) continue;
+      g_hash_table_add (seen, key);
+
+      merged->entries[merged->length] = *entry;
+      merged->entries[merged->length].category = best;
+      merged->length++;
+    }
+
+    merged->total = merged->length;
+
+errored:
+
+    if (seen != NULL) g_hash_table_unref (seen); seen = NULL;
+    if (heads != NULL) g_free (heads); heads = NULL;
+
+    return merged;
+}
+
+
+//!
+//! @brief Merges sorted arrays that were filled in parallel into one sorted
+//!        array.  Unlike lw_resultarray_merge() the entries are assumed to be
+//!        distinct and their categories are left alone.
+//! @param arrays The sorted arrays.  Any of them can be NULL.
+//! @param length The number of arrays
+//! @param max The number of entries to keep or 0 to keep all of them
+//! @returns A new sorted array that counts the entries of all of the arrays
+//!          in its total so lw_resultarray_is_truncated() still works
+//!
+LwResultArray*
+lw_resultarray_merge_sorted (LwResultArray **arrays,
+                             gint            length,
+                             gint            max)
+{
+    //Sanity checks
+    g_return_val_if_fail (arrays != NULL, NULL);
+    g_return_val_if_fail (max >= 0, NULL);
+
+    //Declarations
+    LwResultArray *merged = NULL;
+    gint *heads = NULL;
+    gint available = 0;
+    gint total = 0;
+    gint best = 0;
+    gint i = 0;
+
+    //Initializations
+    heads = g_new0 (gint, length); if (heads == NULL) goto errored;
+    for (i = 0; i < length; i++)
+    {
+      available += lw_resultarray_length (arrays[i]);
+      if (arrays[i] != NULL) total += arrays[i]->total;
+    }
+    if (max > 0 && available > max) available = max;
+    merged = lw_resultarray_new (available); if (merged == NULL) goto errored;
+
+    while (merged->length < available && (best = _lw_resultarray_best_head (arrays, heads, length)) != -1)
+    {
+      merged->entries[merged->length++] = arrays[best]->entries[heads[best]++];
+    }
+
+    merged->max = max;
+    merged->total = total;
+
+errored:
+
+    if (heads != NULL) g_free (heads); heads = NULL;
+
+    return merged;
+}
+
+
+//!
+//! @brief Restores the heap of a bounded array after its root was replaced.
+//!        The root is always the worst entry that is kept.
+//!
+static void
+_lw_resultarray_sift_down (LwResultArray *array)
+{
+    //Declarations
+    LwResultArrayEntry *entries = array->entries;
+    LwResultArrayEntry entry = entries[0];
+    gint parent = 0;
+    gint child = 0;
+
+    while ((child = parent * 2 + 1) < array->length)
+    {
+      if (child + 1 < array->length && _lw_resultarray_compare (entries + child + 1, entries + child) > 0) child++;
+      if (_lw_resultarray_compare (entries + child, &entry) <= 0) break;
+      entries[parent] = entries[child];
+      parent = child;
+    }
+
+    entries[parent] = entry;
+}
+
+
+static void
+_lw_resultarray_sift_up (LwResultArray *array)
+{
+    //Declarations
+    LwResultArrayEntry *entries = array->entries;
+    gint child = array->length - 1;
+    LwResultArrayEntry entry = entries[child];
+    gint parent = 0;
+
+    while (child > 0)
+    {
+      parent = (child - 1) / 2;
+      if (_lw_resultarray_compare (entries + parent, &entry) >= 0) break;
+      entries[child] = entries[parent];
+      child = parent;
+    }
+
+    entries[child] = entry;
+}
+
+
+void
+lw_resultarray_append (LwResultArray *array,
+                       LwOffset       offset,
+                       gint           score,
+                       gint           cost)
+{
+    //Sanity checks
+    g_return_if_fail (array != NULL);
+
+    //Declarations
+    LwResultArrayEntry entry = { offset, score, cost };
+
+    array->total++;
+
+    //A full bounded array only takes entries that are better than its worst one
+    if (array->max > 0 && array->length == array->max)
+    {
+      if (_lw_resultarray_compare (&entry, array->entries) >= 0) return;
+      array->entries[0] = entry;
+      _lw_resultarray_sift_down (array);
+      return;
+    }
+
+    if (array->length == array->allocated)
+    {
+      array->allocated *= 2;
+      array->entries = g_renew (LwResultArrayEntry, array->entries, array->allocated);
+    }
+
+    array->entries[array->length++] = entry;
+
+    if (array->max > 0) _lw_resultarray_sift_up (array);
+}
+
+
+//!
+//! @brief Orders the results from the closest fuzzy cost and then the highest score.
+//!        A bounded array must not be appended to after it is sorted.
+//!
+void
+lw_resultarray_sort (LwResultArray *array)
+{
+    //Sanity checks
+    g_return_if_fail (array != NULL);
+
+    if (array->length < 2) return;
+
+    qsort (array->entries, array->length, sizeof(LwResultArrayEntry), _lw_resultarray_compare);
+}
+
+
+//!
+//! @brief Drops the entries past length
+//!
+void
+lw_resultarray_truncate (LwResultArray *array,
+                         gint           length)
+{
+    //Sanity checks
+    g_return_if_fail (array != NULL);
+    g_return_if_fail (length >= 0);
+
+    if (length < array->length) array->length = length;
+}
+
+
+//!
+//! @brief Checks if a bounded array had to drop some of the entries appended to it
+//!
+gboolean
+lw_resultarray_is_truncated (LwResultArray *array)
+{
+    if (array == NULL) return FALSE;
+
+    return (array->total > array->length);
+}
+
+
+gint
+lw_resultarray_length (LwResultArray *array)
+{
+    if (array == NULL) return 0;
+
+    return array->length;
+}
+
+
+//!
+//! @returns The entry at index or NULL if it is out of range
+//!
+LwResultArrayEntry*
+lw_resultarray_index (LwResultArray *array,
+                      gint           index)
+{
+    if (array == NULL || index < 0 || index >= array->length) return NULL;
+
+    return array->entries + index;
+}
+
@@ -0,0 +1,319 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file resultcache.c
+//!
+//! @brief Keeps the results of recent searches so going back in the history,
+//!        retyping a word or flipping between dictionaries doesn't search again
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <libwaei/libwaei.h>
+#include <libwaei/gettext.h>
+
+
+//!
+//! @brief Copies a result table compacting each of its arrays
+//!
+static GHashTable*
+_lw_resultcache_copy_resulttable (GHashTable *resulttable,
+                                  gsize      *size)
+{
+    //Declarations
+    GHashTable *copy = NULL;
+    GHashTableIter iter;
+    gpointer key = NULL, value = NULL;
+    LwResultArray *array = NULL;
+
+    //Initializations
+    copy = g_hash_table_new_full (g_str_hash, g_str_equal, (GDestroyNotify) g_free, (GDestroyNotify) lw_resultarray_free);
+
+    g_hash_table_iter_init (&iter, resulttable);
+    while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      array = lw_resultarray_copy (LW_RESULTARRAY (value)); if (array == NULL) continue;
+      g_hash_table_insert (copy, g_strdup ((gchar*) key), array);
+      if (size != NULL) *size += sizeof(LwResultArray) + sizeof(LwResultArrayEntry) * array->allocated + strlen ((gchar*) key) + 1;
+    }
+
+    return copy;
+}
+
+
+static void
+_lw_resultcache_entry_free (LwResultCacheEntry *entry)
+{
+    if (entry == NULL) return;
+
+    if (entry->key != NULL) g_free (entry->key);
+    if (entry->resulttable != NULL) g_hash_table_unref (entry->resulttable);
+
+    memset(entry, 0, sizeof(LwResultCacheEntry));
+    g_free (entry);
+}
+
+
+//!
+//! @brief Creates an empty result cache
+//! @param max_size The number of bytes the cached results may use before the
+//!                 least recently used ones are dropped
+//!
+LwResultCache*
+lw_resultcache_new (gsize max_size)
+{
+    //Declarations
+    LwResultCache *cache = NULL;
+
+    //Initializations
+    cache = g_new0 (LwResultCache, 1); if (cache == NULL) goto errored;
+    g_mutex_init (&cache->mutex);
+    g_queue_init (&cache->queue);
+    cache->table = g_hash_table_new (g_str_hash, g_str_equal);
+    cache->max_size = max_size;
+
+errored:
+
+    return cache;
+}
+
+
+void
+lw_resultcache_free (LwResultCache *cache)
+{
+    //Sanity checks
+    if (cache == NULL) return;
+
+    lw_resultcache_clear (cache);
+    g_hash_table_unref (cache->table);
+    g_mutex_clear (&cache->mutex);
+
+    memset(cache, 0, sizeof(LwResultCache));
+    g_free (cache);
+}
+
+
+//!
+//! @brief Looks up the results of a previous search
+//! @param cache The LwResultCache to look in
+//! @param KEY The key the results were inserted with
+//! @returns A copy of the cached result table that the caller owns or NULL
+//!
+GHashTable*
+lw_resultcache_lookup (LwResultCache *cache,
+                       const gchar   *KEY)
+{
+    //Sanity checks
+    g_return_val_if_fail (cache != NULL, NULL);
+    if (KEY == NULL) return NULL;
+
+    //Declarations
+    GList *link = NULL;
+    GHashTable *resulttable = NULL;
+
+    g_mutex_lock (&cache->mutex);
+
+    link = g_hash_table_lookup (cache->table, KEY);
+    if (link != NULL)
+    {
+      g_queue_unlink (&cache->queue, link);
+      g_queue_push_head_link (&cache->queue, link);
+      resulttable = _lw_resultcache_copy_resulttable (((LwResultCacheEntry*) link->data)->resulttable, NULL);
+    }
+
+    g_mutex_unlock (&cache->mutex);
+
+    return resulttable;
+}
+
+
+//!
+//! @brief Looks for the results of a shorter query that the query of KEY grew
+//!        from, such as "tabe" for "taberu".  The caller has to make sure the
+//!        results of a query are always a subset of the results of its substrings.
+//! @param cache The LwResultCache to look in
+//! @param KEY The key of the new search
+//! @param query_offset Where the query starts in KEY.  Everything before it has
+//!                     to be the same in the cached key.
+//! @returns A copy of the results of the longest such query or NULL
+//!
+GHashTable*
+lw_resultcache_lookup_refinable (LwResultCache *cache,
+                                 const gchar   *KEY,
+                                 gsize          query_offset)
+{
+    //Sanity checks
+    g_return_val_if_fail (cache != NULL, NULL);
+    if (KEY == NULL) return NULL;
+
+    //Declarations
+    const gchar *QUERY = NULL;
+    const gchar *CACHED_QUERY = NULL;
+    LwResultCacheEntry *entry = NULL;
+    GList *link = NULL;
+    GList *best = NULL;
+    gsize length = 0;
+    gsize best_length = 0;
+    GHashTable *resulttable = NULL;
+
+    //Initializations
+    QUERY = KEY + query_offset;
+
+    g_mutex_lock (&cache->mutex);
+
+    for (link = cache->queue.head; link != NULL; link = link->next)
+    {
+      entry = link->data;
+      if (strncmp (entry->key, KEY, query_offset) != 0) continue;
+
+      CACHED_QUERY = entry->key + query_offset;
+      length = strlen (CACHED_QUERY);
+      if (length == 0 || length <= best_length) continue;
+      if (strcmp (CACHED_QUERY, QUERY) == 0 || strstr (QUERY, CACHED_QUERY) == NULL) continue;
+
+      best = link;
+      best_length = length;
+    }
+
+    if (best != NULL)
+    {
+      g_queue_unlink (&cache->queue, best);
+      g_queue_push_head_link (&cache->queue, best);
+      resulttable = _lw_resultcache_copy_resulttable (((LwResultCacheEntry*) best->data)->resulttable, NULL);
+    }
+
+    g_mutex_unlock (&cache->mutex);
+
+    return resulttable;
+}
+
+
+static void
+_lw_resultcache_remove_link (LwResultCache *cache,
+                             GList         *link)
+{
+    //Declarations
+    LwResultCacheEntry *entry = NULL;
+
+    //Initializations
+    entry = link->data;
+
+    g_hash_table_remove (cache->table, entry->key);
+    g_queue_delete_link (&cache->queue, link);
+    cache->size -= entry->size;
+
+    _lw_resultcache_entry_free (entry);
+}
+
+
+//!
+//! @brief Stores a copy of the results of a finished search.  Results that are
+//!        bigger than the whole cache are not stored.
+//! @param cache The LwResultCache to insert into
+//! @param KEY A key describing everything the results depend on
+//! @param resulttable A category name to LwResultArray table
+//!
+void
+lw_resultcache_insert (LwResultCache *cache,
+                       const gchar   *KEY,
+                       GHashTable    *resulttable)
+{
+    //Sanity checks
+    g_return_if_fail (cache != NULL);
+    if (KEY == NULL || resulttable == NULL) return;
+
+    //Declarations
+    LwResultCacheEntry *entry = NULL;
+    GList *link = NULL;
+
+    //Initializations
+    entry = g_new0 (LwResultCacheEntry, 1); if (entry == NULL) goto errored;
+    entry->key = g_strdup (KEY);
+    entry->size = sizeof(LwResultCacheEntry) + strlen (KEY) + 1;
+    entry->resulttable = _lw_resultcache_copy_resulttable (resulttable, &entry->size);
+    if (entry->size > cache->max_size) goto errored;
+
+    g_mutex_lock (&cache->mutex);
+
+    link = g_hash_table_lookup (cache->table, KEY);
+    if (link != NULL) _lw_resultcache_remove_link (cache, link);
+
+    while (cache->size + entry->size > cache->max_size && cache->queue.tail != NULL)
+    {
+      _lw_resultcache_remove_link (cache, cache->queue.tail);
+    }
+
+    g_queue_push_head (&cache->queue, entry);
+    g_hash_table_insert (cache->table, entry->key, cache->queue.head);
+    cache->size += entry->size;
+    entry = NULL;
+
+    g_mutex_unlock (&cache->mutex);
+
+errored:
+
+    if (entry != NULL) _lw_resultcache_entry_free (entry); entry = NULL;
+}
+
+
+//!
+//! @brief Drops everything in the cache.  Used when the dictionary or its index changes.
+//!
+void
+lw_resultcache_clear (LwResultCache *cache)
+{
+    //Sanity checks
+    g_return_if_fail (cache != NULL);
+
+    g_mutex_lock (&cache->mutex);
+
+    while (cache->queue.tail != NULL)
+    {
+      _lw_resultcache_remove_link (cache, cache->queue.tail);
+    }
+
+    g_mutex_unlock (&cache->mutex);
+}
+
+
+gsize
+lw_resultcache_get_size (LwResultCache *cache)
+{
+    //Sanity checks
+    g_return_val_if_fail (cache != NULL, 0);
+
+    //Declarations
+    gsize size = 0;
+
+    g_mutex_lock (&cache->mutex);
+    size = cache->size;
+    g_mutex_unlock (&cache->mutex);
+
+    return size;
+}
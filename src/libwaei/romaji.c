@@ -0,0 +1,539 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file romaji.c
+//!
+//! @brief Romaji to kana transliteration
+//!
+//! The spellings in the table below are compiled once into a dense transition
+//! table.  Input is converted in a single pass, keeping only the few bytes of a
+//! syllable that hasn't been finished yet, so a converter can be fed as the
+//! user types.  Doubled consonants and ん are handled before the table lookup.
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <libwaei/libwaei.h>
+#include <libwaei/gettext.h>
+
+
+#define LW_ROMAJI_SYMBOLS 27
+#define LW_ROMAJI_MAX_NODES 512
+
+struct _LwRomajiNode {
+  guint16 next[LW_ROMAJI_SYMBOLS];
+  const gchar *kana;
+};
+typedef struct _LwRomajiNode LwRomajiNode;
+
+static const gchar *_lw_romaji_table[] = {
+  "a", "あ",   "i", "い",   "u", "う",   "e", "え",   "o", "お",
+
+  "ka", "か",  "ki", "き",  "ku", "く",  "ke", "け",  "ko", "こ",
+  "ca", "か",  "ci", "き",  "cu", "く",  "ce", "け",  "co", "こ",
+  "kya", "きゃ",  "kyu", "きゅ",  "kyo", "きょ",
+  "cya", "きゃ",  "cyu", "きゅ",  "cyo", "きょ",
+  "ga", "が",  "gi", "ぎ",  "gu", "ぐ",  "ge", "げ",  "go", "ご",
+  "gya", "ぎゃ",  "gyu", "ぎゅ",  "gyo", "ぎょ",
+
+  "sa", "さ",  "si", "し",  "shi", "し",  "su", "す",  "se", "せ",  "so", "そ",
+  "sya", "しゃ",  "syu", "しゅ",  "syo", "しょ",
+  "sha", "しゃ",  "shu", "しゅ",  "sho", "しょ",  "she", "しぇ",
+  "za", "ざ",  "zi", "じ",  "ji", "じ",  "zu", "ず",  "ze", "ぜ",  "zo", "ぞ",
+  "zya", "じゃ",  "zyu", "じゅ",  "zyo", "じょ",
+  "jya", "じゃ",  "jyu", "じゅ",  "jyo", "じょ",
+  "ja", "じゃ",  "ju", "じゅ",  "jo", "じょ",  "je", "じぇ",
+
+  "ta", "た",  "ti", "ち",  "chi", "ち",  "tu", "つ",  "tsu", "つ",  "te", "て",  "to", "と",
+  "tya", "ちゃ",  "tyu", "ちゅ",  "tyo", "ちょ",
+  "cha", "ちゃ",  "chu", "ちゅ",  "cho", "ちょ",  "che", "ちぇ",
+  "da", "だ",  "di", "ぢ",  "du", "づ",  "dsu", "づ",  "de", "で",  "do", "ど",
+  "dya", "ぢゃ",  "dyu", "ぢゅ",  "dyo", "ぢょ",
+
+  "na", "な",  "ni", "に",  "nu", "ぬ",  "ne", "ね",  "no", "の",
+  "nya", "にゃ",  "nyu", "にゅ",  "nyo", "にょ",
+
+  "ha", "は",  "hi", "ひ",  "hu", "ふ",  "fu", "ふ",  "he", "へ",  "ho", "ほ",
+  "hya", "ひゃ",  "hyu", "ひゅ",  "hyo", "ひょ",
+  "ba", "ば",  "bi", "び",  "bu", "ぶ",  "be", "べ",  "bo", "ぼ",
+  "bya", "びゃ",  "byu", "びゅ",  "byo", "びょ",
+  "pa", "ぱ",  "pi", "ぴ",  "pu", "ぷ",  "pe", "ぺ",  "po", "ぽ",
+  "pya", "ぴゃ",  "pyu", "ぴゅ",  "pyo", "ぴょ",
+  "fa", "ふぁ",  "fi", "ふぃ",  "fe", "ふぇ",  "fo", "ふぉ",
+
+  "ma", "ま",  "mi", "み",  "mu", "む",  "me", "め",  "mo", "も",
+  "mya", "みゃ",  "myu", "みゅ",  "myo", "みょ",
+
+  "ya", "や",  "yu", "ゆ",  "yo", "よ",
+
+  "ra", "ら",  "ri", "り",  "ru", "る",  "re", "れ",  "ro", "ろ",
+  "la", "ら",  "li", "り",  "lu", "る",  "le", "れ",  "lo", "ろ",
+  "rya", "りゃ",  "ryu", "りゅ",  "ryo", "りょ",
+  "lya", "りゃ",  "lyu", "りゅ",  "lyo", "りょ",
+
+  "wa", "わ",  "wi", "うぃ",  "we", "うぇ",  "wo", "を",
+
+  "va", "ゔぁ",  "vi", "ゔぃ",  "vu", "ゔ",  "ve", "ゔぇ",  "vo", "ゔぉ",
+
+  "xa", "ぁ",  "xi", "ぃ",  "xu", "ぅ",  "xe", "ぇ",  "xo", "ぉ",
+  "xya", "ゃ",  "xyu", "ゅ",  "xyo", "ょ",  "xtu", "っ",  "xtsu", "っ",
+
+  "-", "ー",
+
+  NULL
+};
+
+static LwRomajiNode _lw_romaji_nodes[LW_ROMAJI_MAX_NODES];
+
+
+static inline gint
+_lw_romaji_get_symbol (gchar c)
+{
+    if (c >= 'a' && c <= 'z') return c - 'a';
+    if (c == '-') return 26;
+    return -1;
+}
+
+
+static inline gboolean
+_lw_romaji_is_vowel (gchar c)
+{
+    return (c == 'a' || c == 'i' || c == 'u' || c == 'e' || c == 'o');
+}
+
+
+static gsize
+_lw_romaji_compile (void)
+{
+    //Declarations
+    const gchar **ptr = NULL;
+    const gchar *c = NULL;
+    gint length = 1;
+    gint node = 0;
+    gint symbol = 0;
+
+    for (ptr = _lw_romaji_table; *ptr != NULL && *(ptr + 1) != NULL; ptr += 2)
+    {
+      node = 0;
+      for (c = *ptr; *c != '\0'; c++)
+      {
+        symbol = _lw_romaji_get_symbol (*c);
+        g_assert (symbol != -1);
+        if (_lw_romaji_nodes[node].next[symbol] == 0)
+        {
+          g_assert (length < LW_ROMAJI_MAX_NODES);
+          _lw_romaji_nodes[node].next[symbol] = length++;
+        }
+        node = _lw_romaji_nodes[node].next[symbol];
+      }
+      _lw_romaji_nodes[node].kana = *(ptr + 1);
+    }
+
+    return 1;
+}
+
+
+static void
+_lw_romaji_ensure_compiled (void)
+{
+    static gsize compiled = 0;
+
+    if (g_once_init_enter (&compiled))
+    {
+      g_once_init_leave (&compiled, _lw_romaji_compile ());
+    }
+}
+
+
+//!
+//! @brief Appends KANA to the output, shifting hiragana to katakana if asked to
+//!
+static gboolean
+_lw_romaji_converter_emit (LwRomajiConverter *converter,
+                           const gchar       *KANA)
+{
+    //Declarations
+    gint length = strlen(KANA);
+    gchar *ptr = converter->kana + converter->length;
+    gunichar c = 0;
+
+    if (converter->length + length >= LW_ROMAJI_BUFFER_SIZE) return FALSE;
+
+    memcpy(ptr, KANA, length + 1);
+    converter->length += length;
+
+    if (converter->flags & LW_ROMAJI_FLAG_KATAKANA)
+    {
+      for (; *ptr != '\0'; ptr += 3)
+      {
+        c = g_utf8_get_char (ptr);
+        if ((c >= 0x3041 && c <= 0x3096) || c == 0x309D || c == 0x309E) g_unichar_to_utf8 (c + 0x60, ptr);
+      }
+    }
+
+    return TRUE;
+}
+
+
+static inline void
+_lw_romaji_converter_drop (LwRomajiConverter *converter,
+                           gint               length)
+{
+    converter->pending_length -= length;
+    memmove(converter->pending, converter->pending + length, converter->pending_length);
+}
+
+
+static gboolean
+_lw_romaji_converter_can_split (LwRomajiConverter *converter)
+{
+    const gchar *LAST = converter->kana + converter->length - 3;
+
+    if (converter->length < 3) return FALSE;
+    return (strcmp(LAST, "ん") != 0 && strcmp(LAST, "ン") != 0);
+}
+
+
+//!
+//! @brief Converts as much of the pending romaji as can be decided
+//! @param final There is no more input, so nothing can wait
+//! @returns FALSE if the pending romaji isn't a valid spelling
+//!
+static gboolean
+_lw_romaji_converter_resolve (LwRomajiConverter *converter,
+                              gboolean           final)
+{
+    //Declarations
+    const gchar *p = converter->pending;
+    gint node = 0;
+    gint match = 0;
+    const gchar *kana = NULL;
+    gboolean split = FALSE;
+    gint offset = 0;
+    gint i = 0;
+
+    while (converter->pending_length > 0)
+    {
+      offset = converter->consumed - converter->pending_length;
+
+      if (p[0] == '\'')
+      {
+        _lw_romaji_converter_drop (converter, 1);
+        continue;
+      }
+
+      if (p[0] == 'n')
+      {
+        if (converter->pending_length < 2)
+        {
+          if (!final) break;
+          if (!_lw_romaji_converter_emit (converter, "ん")) return FALSE;
+          _lw_romaji_converter_drop (converter, 1);
+          continue;
+        }
+        if (p[1] == '\'')
+        {
+          if (!_lw_romaji_converter_emit (converter, "ん")) return FALSE;
+          _lw_romaji_converter_drop (converter, 2);
+          continue;
+        }
+        if (p[1] == 'n')
+        {
+          //"nna" reads as んな, "nnk" as んk
+          if (converter->pending_length < 3 && !final) break;
+          if (!_lw_romaji_converter_emit (converter, "ん")) return FALSE;
+          if (converter->pending_length > 2 && (_lw_romaji_is_vowel (p[2]) || p[2] == 'y'))
+            _lw_romaji_converter_drop (converter, 1);
+          else
+            _lw_romaji_converter_drop (converter, 2);
+          continue;
+        }
+        if (_lw_romaji_is_vowel (p[1]) || p[1] == 'y')
+        {
+          //"na" could also be a missing apostrophe for "n'a", unless nothing or ん comes before it
+          if (!_lw_romaji_converter_can_split (converter)) ;
+          else if (converter->ambiguity_offset != offset)
+          {
+            converter->ambiguity_offset = offset;
+            converter->ambiguities++;
+          }
+          split = (converter->ambiguity_offset == offset && converter->ambiguities <= 32 && (converter->split & (1U << (converter->ambiguities - 1))));
+          if (split)
+          {
+            if (!_lw_romaji_converter_emit (converter, "ん")) return FALSE;
+            _lw_romaji_converter_drop (converter, 1);
+            continue;
+          }
+        }
+        else
+        {
+          if (!_lw_romaji_converter_emit (converter, "ん")) return FALSE;
+          _lw_romaji_converter_drop (converter, 1);
+          continue;
+        }
+      }
+      else if (!_lw_romaji_is_vowel (p[0]) && p[0] != '-' && converter->pending_length > 1 &&
+               (p[1] == p[0] || (p[0] == 't' && p[1] == 'c')))
+      {
+        if (!_lw_romaji_converter_emit (converter, "っ")) return FALSE;
+        _lw_romaji_converter_drop (converter, 1);
+        continue;
+      }
+
+      //Longest spelling in the table
+      node = 0;
+      match = 0;
+      kana = NULL;
+      for (i = 0; i < converter->pending_length; i++)
+      {
+        gint symbol = _lw_romaji_get_symbol (p[i]);
+        if (symbol == -1) break;
+        node = _lw_romaji_nodes[node].next[symbol];
+        if (node == 0) break;
+        if (_lw_romaji_nodes[node].kana != NULL)
+        {
+          match = i + 1;
+          kana = _lw_romaji_nodes[node].kana;
+        }
+      }
+
+      //Ran out of input in the middle of a spelling
+      if (i == converter->pending_length && node != 0 && !final)
+      {
+        gint symbol = 0;
+        for (symbol = 0; symbol < LW_ROMAJI_SYMBOLS; symbol++)
+        {
+          if (_lw_romaji_nodes[node].next[symbol] != 0) break;
+        }
+        if (symbol < LW_ROMAJI_SYMBOLS) break;
+      }
+
+      if (kana == NULL) return FALSE;
+      if (!_lw_romaji_converter_emit (converter, kana)) return FALSE;
+      _lw_romaji_converter_drop (converter, match);
+    }
+
+    return TRUE;
+}
+
+
+//!
+//! @brief Prepares a converter
+//! @param converter The converter to initialize
+//! @param flags LW_ROMAJI_FLAG_KATAKANA to output katakana
+//! @param split A bitmask of the ambiguous n's (in the order they appear) to read as ん
+//!
+void
+lw_romaji_converter_init (LwRomajiConverter *converter,
+                          LwRomajiFlag       flags,
+                          guint32            split)
+{
+    //Sanity checks
+    g_return_if_fail (converter != NULL);
+
+    _lw_romaji_ensure_compiled ();
+
+    memset(converter, 0, sizeof(LwRomajiConverter));
+    converter->flags = flags;
+    converter->split = split;
+    converter->ambiguity_offset = -1;
+}
+
+
+//!
+//! @brief Converts more romaji.  A syllable that is cut off at the end of TEXT is
+//!        kept pending until the next feed or lw_romaji_converter_finish().
+//! @param length The length of TEXT or -1 if it is null terminated
+//! @returns FALSE once the input stops being valid romaji
+//!
+gboolean
+lw_romaji_converter_feed (LwRomajiConverter *converter,
+                          const gchar       *TEXT,
+                          gint               length)
+{
+    //Sanity checks
+    g_return_val_if_fail (converter != NULL, FALSE);
+    g_return_val_if_fail (TEXT != NULL, FALSE);
+    if (converter->failed) return FALSE;
+
+    //Declarations
+    gint i = 0;
+
+    if (length < 0) length = strlen(TEXT);
+
+    for (i = 0; i < length; i++)
+    {
+      if (converter->pending_length >= LW_ROMAJI_PENDING_MAX) goto errored;
+      converter->pending[converter->pending_length++] = g_ascii_tolower (TEXT[i]);
+      converter->consumed++;
+      if (!_lw_romaji_converter_resolve (converter, FALSE)) goto errored;
+    }
+
+    return TRUE;
+
+errored:
+
+    converter->failed = TRUE;
+
+    return FALSE;
+}
+
+
+//!
+//! @brief Converts whatever romaji is still pending.  Finish a copy of the converter
+//!        to keep feeding the original.
+//! @returns TRUE if all of the input was valid romaji
+//!
+gboolean
+lw_romaji_converter_finish (LwRomajiConverter *converter)
+{
+    //Sanity checks
+    g_return_val_if_fail (converter != NULL, FALSE);
+    if (converter->failed) return FALSE;
+
+    if (!_lw_romaji_converter_resolve (converter, TRUE) || converter->pending_length > 0)
+    {
+      converter->failed = TRUE;
+    }
+
+    return !converter->failed;
+}
+
+
+const gchar*
+lw_romaji_converter_get_kana (LwRomajiConverter *converter)
+{
+    //Sanity checks
+    g_return_val_if_fail (converter != NULL, NULL);
+
+    return converter->kana;
+}
+
+
+//!
+//! @brief Returns the romaji that hasn't been converted yet.  It is not null terminated.
+//!
+const gchar*
+lw_romaji_converter_get_pending (LwRomajiConverter *converter)
+{
+    //Sanity checks
+    g_return_val_if_fail (converter != NULL, NULL);
+
+    return converter->pending;
+}
+
+
+gint
+lw_romaji_converter_get_ambiguities (LwRomajiConverter *converter)
+{
+    //Sanity checks
+    g_return_val_if_fail (converter != NULL, 0);
+
+    return converter->ambiguities;
+}
+
+
+//!
+//! @brief Converts a romaji string to kana in one pass
+//! @param TEXT The romaji to convert
+//! @param flags LW_ROMAJI_FLAG_KATAKANA to output katakana
+//! @param output Where to write the kana
+//! @param max The size of output
+//! @returns TRUE if all of TEXT was valid romaji and the kana fit in output
+//!
+gboolean
+lw_romaji_to_kana (const gchar  *TEXT,
+                   LwRomajiFlag  flags,
+                   gchar        *output,
+                   gint          max)
+{
+    //Sanity checks
+    g_return_val_if_fail (TEXT != NULL, FALSE);
+    g_return_val_if_fail (output != NULL, FALSE);
+    g_return_val_if_fail (max > 0, FALSE);
+
+    //Declarations
+    LwRomajiConverter converter;
+    gboolean converted = FALSE;
+
+    //Initializations
+    lw_romaji_converter_init (&converter, flags, 0);
+    converted = (lw_romaji_converter_feed (&converter, TEXT, -1) && lw_romaji_converter_finish (&converter));
+
+    g_strlcpy (output, converter.kana, max);
+
+    return (converted && converter.length < max);
+}
+
+
+//!
+//! @brief Returns the possible readings of TEXT.  The first is the usual IME reading,
+//!        followed by the readings where one of the ambiguous n's is taken as ん
+//!        (such as "kinen" as きんえん as well as きねん).
+//! @param max The most readings to return
+//! @returns A null terminated array to free with g_strfreev() or NULL if TEXT isn't romaji
+//!
+gchar**
+lw_romaji_get_readings (const gchar  *TEXT,
+                        LwRomajiFlag  flags,
+                        gint          max)
+{
+    //Sanity checks
+    g_return_val_if_fail (TEXT != NULL, NULL);
+    if (max < 1) return NULL;
+
+    //Declarations
+    LwRomajiConverter converter;
+    gchar **readings = NULL;
+    gint length = 0;
+    gint ambiguities = 0;
+    gint i = 0;
+    gint j = 0;
+
+    //Initializations
+    lw_romaji_converter_init (&converter, flags, 0);
+    if (!lw_romaji_converter_feed (&converter, TEXT, -1) || !lw_romaji_converter_finish (&converter)) goto errored;
+    ambiguities = MIN (converter.ambiguities, 32);
+    readings = g_new0 (gchar*, MIN (max, ambiguities + 1) + 1);
+    readings[length++] = g_strdup (converter.kana);
+
+    for (i = 0; i < ambiguities && length < max; i++)
+    {
+      lw_romaji_converter_init (&converter, flags, 1U << i);
+      if (!lw_romaji_converter_feed (&converter, TEXT, -1) || !lw_romaji_converter_finish (&converter)) continue;
+
+      for (j = 0; j < length && strcmp(readings[j], converter.kana) != 0; j++);
+      if (j == length) readings[length++] = g_strdup (converter.kana);
+    }
+
+errored:
+
+    return readings;
+}
+
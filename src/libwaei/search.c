@@ -37,6 +37,202 @@
 #include <libwaei/gettext.h>
 
 
+//!
+//! @brief A GSource that is made ready from the search thread so consumers only
+//!        wake up when there is actually something new to show
+//!
+struct _LwSearchWatch {
+  GSource source;
+  LwSearch *search;
+  gint pending;                          //!< Set while a wake up is queued so repeated notifies stay cheap
+};
+typedef struct _LwSearchWatch LwSearchWatch;
+
+
+static gboolean
+_lw_search_watch_dispatch (GSource     *source,
+                           GSourceFunc  callback,
+                           gpointer     data)
+{
+    //Declarations
+    LwSearchWatch *watch = NULL;
+    LwSearchWatchFunc func = NULL;
+
+    //Initializations
+    watch = (LwSearchWatch*) source;
+    func = (LwSearchWatchFunc) callback;
+
+    //Rearm before running the callback so nothing notified during it is lost
+    g_source_set_ready_time (source, -1);
+    g_atomic_int_set (&watch->pending, 0);
+
+    if (func == NULL) return FALSE;
+
+    return func (watch->search, data);
+}
+
+
+static GSourceFuncs _lw_search_watch_funcs = {
+  NULL,
+  NULL,
+  _lw_search_watch_dispatch,
+  NULL
+};
+
+
+//!
+//! @brief Calls a function in a main context whenever the search has new results
+//!        or progress to show.  The function is called once right away so
+//!        anything that is already available gets delivered.
+//! @param search The LwSearch to watch
+//! @param context The GMainContext to dispatch in or NULL for the default one
+//! @param func The function to call
+//! @param data Data to pass to func
+//! @param notify Called on data when the watch is removed or NULL
+//! @returns The id of the attached GSource
+//!
+guint
+lw_search_add_watch (LwSearch          *search,
+                     GMainContext      *context,
+                     LwSearchWatchFunc  func,
+                     gpointer           data,
+                     GDestroyNotify     notify)
+{
+    //Sanity checks
+    g_return_val_if_fail (search != NULL, 0);
+    g_return_val_if_fail (func != NULL, 0);
+
+    //Declarations
+    GSource *source = NULL;
+    LwSearchWatch *watch = NULL;
+    guint id = 0;
+
+    //Initializations
+    source = g_source_new (&_lw_search_watch_funcs, sizeof(LwSearchWatch));
+    watch = (LwSearchWatch*) source;
+    watch->search = search;
+    watch->pending = 1;
+
+    g_source_set_name (source, "libwaei-search-watch");
+    g_source_set_priority (source, G_PRIORITY_LOW);
+    g_source_set_callback (source, (GSourceFunc) func, data, notify);
+    g_source_set_ready_time (source, 0);
+    id = g_source_attach (source, context);
+
+    g_mutex_lock (&search->watch_mutex);
+      search->watchlist = g_list_prepend (search->watchlist, source);
+    g_mutex_unlock (&search->watch_mutex);
+
+    return id;
+}
+
+
+//!
+//! @brief Removes a watch added with lw_search_add_watch
+//! @param search The LwSearch the watch was added to
+//! @param id The id returned by lw_search_add_watch
+//!
+void
+lw_search_remove_watch (LwSearch *search,
+                        guint     id)
+{
+    //Sanity checks
+    g_return_if_fail (search != NULL);
+
+    //Declarations
+    GList *link = NULL;
+    GSource *source = NULL;
+
+    g_mutex_lock (&search->watch_mutex);
+
+    for (link = search->watchlist; link != NULL; link = link->next)
+    {
+      if (g_source_get_id ((GSource*) link->data) == id)
+      {
+        source = (GSource*) link->data;
+        search->watchlist = g_list_delete_link (search->watchlist, link);
+        break;
+      }
+    }
+
+    g_mutex_unlock (&search->watch_mutex);
+
+    if (source != NULL)
+    {
+      g_source_destroy (source);
+      g_source_unref (source);
+    }
+}
+
+
+static void
+_lw_search_remove_watches (LwSearch *search)
+{
+    //Declarations
+    GList *watchlist = NULL;
+    GList *link = NULL;
+
+    g_mutex_lock (&search->watch_mutex);
+      watchlist = search->watchlist;
+      search->watchlist = NULL;
+    g_mutex_unlock (&search->watch_mutex);
+
+    for (link = watchlist; link != NULL; link = link->next)
+    {
+      g_source_destroy ((GSource*) link->data);
+      g_source_unref ((GSource*) link->data);
+    }
+
+    g_list_free (watchlist); watchlist = NULL;
+}
+
+
+//!
+//! @brief Wakes up every watch on the search.  Safe to call from any thread.
+//! @param search The LwSearch whose watches should be dispatched
+//!
+void
+lw_search_notify (LwSearch *search)
+{
+    //Sanity checks
+    g_return_if_fail (search != NULL);
+
+    //Declarations
+    GList *link = NULL;
+    LwSearchWatch *watch = NULL;
+
+    g_mutex_lock (&search->watch_mutex);
+
+    for (link = search->watchlist; link != NULL; link = link->next)
+    {
+      watch = (LwSearchWatch*) link->data;
+      if (g_source_is_destroyed ((GSource*) watch)) continue;
+      if (g_atomic_int_compare_and_exchange (&watch->pending, 0, 1))
+      {
+        g_source_set_ready_time ((GSource*) watch, 0);
+      }
+    }
+
+    g_mutex_unlock (&search->watch_mutex);
+}
+
+
+static void
+_lw_search_progress_notify_cb (LwProgress *progress,
+                               LwSearch   *search)
+{
+    lw_search_notify (search);
+}
+
+
+static void
+_lw_search_free_resultviews (LwSearch *search)
+{
+    if (search->resultview != NULL) lw_resultarray_free (search->resultview); search->resultview = NULL;
+    g_list_free_full (search->retiredviews, (GDestroyNotify) lw_resultarray_free); search->retiredviews = NULL;
+}
+
+
 //!
 //! @brief Creates a new LwSearch object. 
 //! @param query The text to be search for
@@ -60,13 +256,14 @@ lw_search_new (LwDictionary       *dictionary,
     if (temp != NULL)
     {
       g_mutex_init (&temp->mutex);
+      g_mutex_init (&temp->watch_mutex);
       temp->status = LW_SEARCHSTATUS_IDLE;
       temp->dictionary = dictionary;
       temp->query = g_strdup(QUERY);
       temp->morphologyengine = morphologyengine;
       temp->flags = flags;
-      temp->max = 500;
-      temp->resulttable = g_hash_table_new_full (g_str_hash, g_str_equal, (GDestroyNotify) g_free, (GDestroyNotify) g_list_free); 
+      temp->max = LW_SEARCH_DEFAULT_MAX_RESULTS;
+      temp->resulttable = g_hash_table_new_full (g_str_hash, g_str_equal, (GDestroyNotify) g_free, (GDestroyNotify) lw_resultarray_free); 
       if (temp->resulttable == NULL) goto errored;
 
       g_object_ref (morphologyengine);
@@ -97,12 +294,17 @@ lw_search_free (LwSearch* search)
     if (search == NULL) return;
 
     lw_search_cancel (search);
+    _lw_search_remove_watches (search);
+    if (search->progress != NULL) lw_progress_set_notify_func (search->progress, NULL, NULL);
     if (search->query != NULL) g_free (search->query);
     if (lw_search_has_data (search)) lw_search_free_data (search);
+    if (search->highlighter != NULL) lw_highlighter_free (search->highlighter);
     if (search->morphologyengine != NULL) g_object_unref (search->morphologyengine);
     if (search->resulttable != NULL) g_hash_table_unref (search->resulttable);
+    _lw_search_free_resultviews (search);
 
     g_mutex_clear (&search->mutex);
+    g_mutex_clear (&search->watch_mutex);
 
     memset (search, 0, sizeof(LwSearch));
 
@@ -110,10 +312,19 @@ lw_search_free (LwSearch* search)
 }
 
 
+//!
+//! @brief Sets how many results of each category a search keeps.  Only the
+//!        best ones are kept and lw_search_fetch_more() gets the rest.
+//! @param search The LwSearch to set the maximum of
+//! @param max The number of results or 0 for no limit
+//!
 void
 lw_search_set_max_results (LwSearch *search, gint max)
 {
-    search->max = max;
+    //Sanity checks
+    g_return_if_fail (search != NULL);
+
+    search->max = MAX (max, 0);
 }
 
 
@@ -280,6 +491,177 @@ _lw_search_get_index_flags (LwSearch *search)
 }
 
 
+//!
+//! @brief Builds the key of the search in the dictionary's result cache.  It
+//!        covers everything besides the dictionary that the results depend on.
+//! @param search The LwSearch to build the key for
+//! @param indexed Whether the results come from the index or a regex search
+//! @param query_offset Set to where the query starts in the key or NULL
+//! @returns An allocated key or NULL if the dictionary data isn't loaded yet
+//!
+static gchar*
+_lw_search_build_cache_key (LwSearch *search,
+                            gboolean  indexed,
+                            gsize    *query_offset)
+{
+    //Declarations
+    const gchar *CHECKSUM = NULL;
+    gchar *prefix = NULL;
+    gchar *query = NULL;
+    gchar *key = NULL;
+
+    //Initializations
+    CHECKSUM = lw_dictionary_get_checksum (search->dictionary); if (CHECKSUM == NULL) goto errored;
+    prefix = g_strdup_printf ("%s\n%c\n%x\n%d\n", CHECKSUM, (indexed) ? 'i' : 'r', (guint) search->flags, search->max);
+    query = g_strdup (search->query);
+
+    //Surrounding whitespace doesn't change how the index tokenizes a query but a regex matches it as is
+    if (indexed) g_strstrip (query);
+
+    key = g_strconcat (prefix, query, NULL);
+    if (query_offset != NULL) *query_offset = strlen (prefix);
+
+errored:
+
+    if (prefix != NULL) g_free (prefix); prefix = NULL;
+    if (query != NULL) g_free (query); query = NULL;
+
+    return key;
+}
+
+
+//!
+//! @brief Checks if the query matches itself literally when used as a regex.
+//!        Only then are its results a subset of the results of its substrings.
+//!
+static gboolean
+_lw_search_query_is_literal (const gchar *QUERY)
+{
+    return (!lw_util_has_regex_char (QUERY) && strpbrk (QUERY, "\\+{}") == NULL);
+}
+
+
+//!
+//! @returns TRUE if any of the categories of resulttable has a result
+//!
+static gboolean
+_lw_search_has_results (GHashTable *resulttable)
+{
+    //Declarations
+    GHashTableIter iter;
+    gpointer value = NULL;
+
+    if (resulttable == NULL) return FALSE;
+
+    g_hash_table_iter_init (&iter, resulttable);
+    while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      if (lw_resultarray_length (LW_RESULTARRAY (value)) > 0) return TRUE;
+    }
+
+    return FALSE;
+}
+
+
+//!
+//! @brief Replaces the results of the search with resulttable.  When more
+//!        results are being fetched the new ones are merged into the arrays
+//!        that are already there instead.
+//! @param search The LwSearch to set the results of
+//! @param resulttable The new results which are taken over by the search
+//! @param continuing Whether this continues a search with lw_search_fetch_more()
+//! @param append Whether the new results follow the old ones instead of
+//!               replacing them
+//!
+static void
+_lw_search_set_resulttable (LwSearch   *search,
+                            GHashTable *resulttable,
+                            gboolean    continuing,
+                            gboolean    append)
+{
+    //Declarations
+    GHashTableIter iter;
+    gpointer key = NULL, value = NULL;
+    LwResultArray *array = NULL;
+    LwResultArray *previous = NULL;
+    LwResultArray swap;
+    gint i = 0;
+
+    if (!continuing || search->resulttable == NULL)
+    {
+      if (search->resulttable != NULL) g_hash_table_unref (search->resulttable);
+      search->resulttable = resulttable;
+      return;
+    }
+
+    if (resulttable == NULL) return;
+
+    g_hash_table_iter_init (&iter, resulttable);
+    while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      array = LW_RESULTARRAY (value);
+      previous = LW_RESULTARRAY (g_hash_table_lookup (search->resulttable, key));
+
+      if (previous == NULL)
+      {
+        g_hash_table_iter_steal (&iter);
+        g_hash_table_insert (search->resulttable, key, array);
+      }
+      else if (append)
+      {
+        for (i = 0; i < array->length; i++)
+        {
+          lw_resultarray_append (previous, array->entries[i].offset, array->entries[i].score, array->entries[i].cost);
+        }
+      }
+      else
+      {
+        swap = *previous; *previous = *array; *array = swap;
+      }
+    }
+
+    g_hash_table_unref (resulttable);
+}
+
+
+//!
+//! @brief Merges the categories of the results once so iterators can walk them
+//!        in order without checking for repeats.  When more results were
+//!        fetched the new ones are put after the old ones and the old view is
+//!        kept alive for the iterators that are still on it.
+//! @param search The LwSearch to update the resultview of
+//! @param continuing Whether this continues a search with lw_search_fetch_more()
+//!
+static void
+_lw_search_update_resultview (LwSearch *search,
+                              gboolean  continuing)
+{
+    //Declarations
+    LwResultArray *arrays[TOTAL_LW_INDEX_TABLES];
+    LwResultArray *previous = NULL;
+    LwIndexTableType type = 0;
+
+    //Initializations
+    previous = (continuing) ? search->resultview : NULL;
+
+    for (type = 0; type < TOTAL_LW_INDEX_TABLES; type++)
+    {
+      arrays[type] = (search->resulttable != NULL) ? g_hash_table_lookup (search->resulttable, lw_index_table_type_to_string (type)) : NULL;
+    }
+
+    if (continuing)
+    {
+      if (previous != NULL) search->retiredviews = g_list_prepend (search->retiredviews, previous);
+    }
+    else
+    {
+      _lw_search_free_resultviews (search);
+    }
+
+    search->resultview = lw_resultarray_merge (previous, arrays, TOTAL_LW_INDEX_TABLES);
+}
+
+
 //!
 //! @brief Preforms the brute work of the search
 //!
@@ -293,12 +675,23 @@ _lw_search_get_index_flags (LwSearch *search)
 static gpointer 
 lw_search_stream_results_thread (gpointer data)
 {
-printf("BREAK lw_search_stream_results_thread\n");
     //Declarations
     LwSearch *search = NULL;
     LwProgress *progress = NULL;
     LwDictionary *dictionary = NULL;
     LwSearchFlag flags = 0;
+    LwResultCache *resultcache = NULL;
+    GHashTable *cached = NULL;
+    GHashTable *candidates = NULL;
+    GHashTable *resulttable = NULL;
+    LwIndexQuery *indexquery = NULL;
+    gchar *key = NULL;
+    gsize query_offset = 0;
+    gboolean indexed = FALSE;
+    gboolean continuing = FALSE;
+    gboolean append = FALSE;
+    LwOffset resume = 0;
+    gint max = 0;
 
     //Initializations
     search = LW_SEARCH (data);
@@ -310,7 +703,6 @@ printf("BREAK lw_search_stream_results_thread\n");
     //Index the dictionary if it isn't already
     if (flags & LW_SEARCH_FLAG_USE_INDEX)
     {
-printf("BREAK lw_search_stream_results_thread trying to load index\n");
       if (!lw_dictionary_index_exists (dictionary)) lw_dictionary_index_create (dictionary, progress);
       if (lw_progress_should_abort (progress)) goto errored;
       lw_dictionary_index_load (dictionary, progress);
@@ -319,57 +711,120 @@ printf("BREAK lw_search_stream_results_thread trying to load index\n");
 
     lw_search_lock (search);
 
+    continuing = search->continuing;
+    search->continuing = FALSE;
+
+    indexed = (lw_dictionary_index_is_loaded (dictionary) && flags & LW_SEARCH_FLAG_USE_INDEX);
+    if (indexed) indexquery = lw_indexquery_new (search->query);
+    if (indexed && indexquery == NULL) indexed = !lw_util_is_regex_pattern (search->query, NULL);
+    resultcache = lw_dictionary_get_resultcache (dictionary);
+    key = _lw_search_build_cache_key (search, indexed, &query_offset);
+    cached = lw_resultcache_lookup (resultcache, key);
+    if (cached == NULL && !indexed && _lw_search_query_is_literal (search->query))
+    {
+      candidates = lw_resultcache_lookup_refinable (resultcache, key, query_offset);
+    }
+
+    //Repeated search
+    if (cached != NULL)
+    {
+      resulttable = cached;
+      search->resume_offset = 0;
+    }
+
+    //The query grew from one that was searched recently so only its results need checking
+    else if (candidates != NULL)
+    {
+      resulttable = lw_dictionary_regex_refine (dictionary, search->query, candidates, flags, progress);
+      g_hash_table_unref (candidates); candidates = NULL;
+      search->resume_offset = 0;
+    }
+
+    //Boolean search answered from the postings of the index
+    else if (indexquery != NULL)
+    {
+      resulttable = lw_dictionary_index_query_search (dictionary, indexquery, flags, search->max, progress);
+    }
+
     //Indexed search
-    if (lw_dictionary_index_is_loaded (dictionary) && flags & LW_SEARCH_FLAG_USE_INDEX && !lw_util_is_regex_pattern (search->query, NULL))
+    else if (indexed)
     {
-printf("BREAK lw_search_stream_results_thread index is loaded\n");
       LwMorphologyList *morphologylist = lw_search_get_query_as_morphologylist (search);
 
-      if (search->resulttable != NULL) g_hash_table_unref (search->resulttable); search->resulttable = NULL;
-      search->resulttable = lw_dictionary_index_search (dictionary, morphologylist, flags, progress);
+      resulttable = lw_dictionary_index_search (dictionary, morphologylist, flags, search->max, progress);
+
+      //Nothing matched exactly so try again allowing for typos
+      if (flags & LW_SEARCH_FLAG_FUZZY && !lw_progress_should_abort (progress) && !_lw_search_has_results (resulttable))
+      {
+        if (resulttable != NULL) g_hash_table_unref (resulttable); resulttable = NULL;
+        resulttable = lw_dictionary_index_fuzzy_search (dictionary, morphologylist, flags, search->max, progress);
+      }
 
       lw_morphologylist_free (morphologylist); morphologylist = NULL;
     }
 
-    //Regex search
+    //Regex search, which continues scanning from where it stopped when fetching more
     else
     {
-      if (search->resulttable != NULL) g_hash_table_unref (search->resulttable);
-      search->resulttable = lw_dictionary_regex_search (dictionary, search->query, flags, progress);
+      resume = (continuing) ? search->resume_offset : 0;
+      max = search->max;
+      if (continuing && max > 0) max -= lw_resultarray_length (g_hash_table_lookup (search->resulttable, lw_index_table_type_to_string (LW_INDEX_TABLE_RAW)));
+      append = (continuing && resume != 0);
+
+      resulttable = lw_dictionary_regex_search (dictionary, search->query, flags, MAX (max, 0), &resume, progress);
+      search->resume_offset = resume;
+    }
+
+    _lw_search_set_resulttable (search, resulttable, continuing, append); resulttable = NULL;
+    _lw_search_update_resultview (search, continuing);
+
+    //Remember complete results for the next time.  Regex searches that stopped early can't be continued from the cache.
+    if (cached == NULL && search->resulttable != NULL && search->resume_offset == 0 && !lw_progress_should_abort (progress))
+    {
+      if (key == NULL) key = _lw_search_build_cache_key (search, indexed, NULL);
+      lw_resultcache_insert (resultcache, key, search->resulttable);
     }
 
 errored:
 
+    if (key != NULL) g_free (key); key = NULL;
+    if (indexquery != NULL) lw_indexquery_free (indexquery); indexquery = NULL;
+
+    //search->thread is left for whoever joins it.  A watch can free the search as soon
+    //as it sees it finishing and lw_search_cancel() has to wait for this notify first.
     search->status = LW_SEARCHSTATUS_FINISHING;
-    search->thread = NULL;
 
     lw_search_unlock (search);
 
+    lw_search_notify (search);
+
     return NULL;
 }
 
 
 //!
-//! @brief Start a dictionary search
-//! @param search a LwSearch argument to calculate results
-//! @param create_thread Whether the search should run in a new thread.
-//! @param exact Whether to show only exact matches for this search
+//! @brief Waits for the thread of the last run of the search to return
 //!
-void 
-lw_search_start (LwSearch   *search, 
-                 LwProgress *progress,
-                 gboolean    create_thread)
+static void
+_lw_search_join_thread (LwSearch *search)
 {
-    //Sanity checks
-    g_return_if_fail (search != NULL);
-    g_return_if_fail (progress != NULL);
+    if (search->thread != NULL)
+    {
+      g_thread_join (search->thread);
+      search->thread = NULL;
+    }
+}
 
-    //Initializations
-    search->thread = NULL;
-    search->status = LW_SEARCHSTATUS_SEARCHING;
 
-    if (search->progress != NULL) lw_progress_free (search->progress);
-    search->progress = progress;
+static void
+_lw_search_run (LwSearch *search,
+                gboolean  create_thread)
+{
+    //Declarations
+    LwProgress *progress = search->progress;
+
+    //A finished run keeps its thread until it is joined
+    _lw_search_join_thread (search);
 
     if (create_thread)
     {
@@ -393,6 +848,102 @@ lw_search_start (LwSearch   *search,
 }
 
 
+//!
+//! @brief Start a dictionary search
+//! @param search a LwSearch argument to calculate results
+//! @param create_thread Whether the search should run in a new thread.
+//! @param exact Whether to show only exact matches for this search
+//!
+void 
+lw_search_start (LwSearch   *search, 
+                 LwProgress *progress,
+                 gboolean    create_thread)
+{
+    //Sanity checks
+    g_return_if_fail (search != NULL);
+    g_return_if_fail (progress != NULL);
+
+    //Initializations
+    search->status = LW_SEARCHSTATUS_SEARCHING;
+
+    search->continuing = FALSE;
+    search->resume_offset = 0;
+
+    if (search->progress != NULL) lw_progress_free (search->progress);
+    search->progress = progress;
+    lw_progress_set_notify_func (progress, (LwProgressNotifyFunc) _lw_search_progress_notify_cb, search);
+
+    _lw_search_run (search, create_thread);
+}
+
+
+//!
+//! @brief Checks if the search stopped at its maximum number of results
+//!        before it found all of them
+//!
+gboolean
+lw_search_has_more (LwSearch *search)
+{
+    //Sanity checks
+    g_return_val_if_fail (search != NULL, FALSE);
+
+    //Declarations
+    GHashTableIter iter;
+    gpointer value = NULL;
+    gboolean has_more = FALSE;
+
+    lw_search_lock (search);
+
+    has_more = (search->resume_offset != 0);
+
+    if (!has_more && search->resulttable != NULL)
+    {
+      g_hash_table_iter_init (&iter, search->resulttable);
+      while (!has_more && g_hash_table_iter_next (&iter, NULL, &value))
+      {
+        has_more = lw_resultarray_is_truncated (LW_RESULTARRAY (value));
+      }
+    }
+
+    lw_search_unlock (search);
+
+    return has_more;
+}
+
+
+//!
+//! @brief Continues a finished search that stopped at its maximum number of
+//!        results.  The results that were already found stay where they are
+//!        and the next ones come after them.
+//! @param search A finished LwSearch
+//! @param more How many more results to allow
+//! @param create_thread Whether the search should run in a new thread
+//! @returns FALSE if there was nothing more to fetch
+//!
+gboolean
+lw_search_fetch_more (LwSearch *search,
+                      gint      more,
+                      gboolean  create_thread)
+{
+    //Sanity checks
+    g_return_val_if_fail (search != NULL, FALSE);
+    g_return_val_if_fail (search->progress != NULL, FALSE);
+    g_return_val_if_fail (more > 0, FALSE);
+    if (lw_search_get_status (search) == LW_SEARCHSTATUS_SEARCHING) return FALSE;
+    if (!lw_search_has_more (search)) return FALSE;
+
+    lw_search_lock (search);
+      search->max += more;
+      search->continuing = TRUE;
+      search->status = LW_SEARCHSTATUS_SEARCHING;
+    lw_search_unlock (search);
+
+    _lw_search_run (search, create_thread);
+
+    return TRUE;
+}
+
+
 LwProgress*
 lw_search_get_progress (LwSearch *search)
 {
@@ -416,11 +967,7 @@ lw_search_cancel (LwSearch *search)
     if (search->progress != NULL) lw_progress_cancel (search->progress);
     lw_search_set_status (search, LW_SEARCHSTATUS_CANCELING);
 
-    if (search->thread != NULL)
-    {
-      g_thread_join (search->thread);
-      search->thread = NULL;
-    }
+    _lw_search_join_thread (search);
 
     lw_search_set_status (search, LW_SEARCHSTATUS_IDLE);
 }
@@ -464,7 +1011,7 @@ lw_search_get_flags_from_preferences (LwPreferences *preferences)
     if (case_insensitive) flags |= LW_SEARCH_FLAG_CASE_INSENSITIVE;
     if (stem_insensitive) flags |= LW_SEARCH_FLAG_STEM_INSENSITIVE;
     if (want_romaji_to_furigana_conv) flags |= LW_SEARCH_FLAG_ROMAJI_TO_FURIGANA;
-    if (index_results) flags |= LW_SEARCH_FLAG_USE_INDEX;
+    if (index_results) flags |= (LW_SEARCH_FLAG_USE_INDEX | LW_SEARCH_FLAG_FUZZY);
 
     return flags;
 }
@@ -487,6 +1034,45 @@ lw_search_get_query_as_morphologylist (LwSearch* search)
 }
 
 
+//!
+//! @brief Gets the compiled query the interfaces highlight results with.  It is
+//!        built once per search from the same analysis the results were scored with.
+//! @param search The LwSearch to get the highlighter of
+//! @returns The LwHighlighter owned by the search
+//!
+LwHighlighter*
+lw_search_get_highlighter (LwSearch *search)
+{
+    //Sanity checks
+    g_return_val_if_fail (search != NULL, NULL);
+
+    if (g_once_init_enter (&search->highlighter))
+    {
+      g_once_init_leave (&search->highlighter, lw_highlighter_new (search->morphologyengine, search->query));
+    }
+
+    return search->highlighter;
+}
+
+
+//!
+//! @brief Drops the results of a search that is no longer being displayed.
+//!        Starting it again gets them back from the dictionary's result cache.
+//! @param search The LwSearch to clear the results of
+//!
+void
+lw_search_clear_results (LwSearch *search)
+{
+    //Sanity checks
+    g_return_if_fail (search != NULL);
+
+    lw_search_lock (search);
+      if (search->resulttable != NULL) g_hash_table_remove_all (search->resulttable);
+      _lw_search_free_resultviews (search);
+    lw_search_unlock (search);
+}
+
+
 gboolean
 lw_search_has_results (LwSearch *search)
 {
@@ -496,7 +1082,7 @@ lw_search_has_results (LwSearch *search)
     g_hash_table_iter_init (&iter, search->resulttable);
     while (g_hash_table_iter_next (&iter, &key, &value))
     {
-      if (value != NULL) return TRUE;
+      if (lw_resultarray_length (LW_RESULTARRAY (value)) > 0) return TRUE;
     }
 
     return FALSE;
@@ -38,12 +38,10 @@
 
 
 LwSearchResultIterator*
-lw_searchresultiterator_new (LwSearch    *search, 
-                             const gchar *CATEGORY)
+lw_searchresultiterator_new (LwSearch *search)
 {
     //Sanity checks
     g_return_val_if_fail (search != NULL, NULL);
-    g_return_val_if_fail (CATEGORY != NULL, NULL);
 
     //Declarations
     LwSearchResultIterator *iterator = NULL;
@@ -51,19 +49,12 @@ lw_searchresultiterator_new (LwSearch    *search,
     //Initializations
     iterator = g_new0 (LwSearchResultIterator, 1); if (iterator == NULL) goto errored;
     iterator->search = search;
-    iterator->category = g_strdup (CATEGORY);
     iterator->count = 0;
-    iterator->historytable = g_hash_table_new (g_direct_hash, g_direct_equal);
-
-    return iterator;
+    iterator->index = -1;
 
 errored:
 
-    if (iterator != NULL) lw_searchresultiterator_free (iterator);
-
-    lw_search_unlock (search);
-
-    return NULL;
+    return iterator;
 }
 
 
@@ -72,14 +63,13 @@ lw_searchresultiterator_get_result (LwSearchResultIterator* iterator)
 {
     //Sanity checks
     g_return_val_if_fail (iterator != NULL, NULL);
-    if (iterator->link == NULL) return NULL;
 
     //Declarations
+    LwResultArrayEntry *entry = lw_resultarray_index (iterator->array, iterator->index); if (entry == NULL) return NULL;
     LwResult *result = NULL;
-    LwOffset offset = GPOINTER_TO_OFFSET (iterator->link->data);
     LwSearch *search = iterator->search;
     LwDictionary *dictionary = search->dictionary;
-    const gchar *TEXT = lw_dictionary_get_string (dictionary, offset); if (TEXT == NULL) goto errored;
+    const gchar *TEXT = lw_dictionary_get_string (dictionary, entry->offset); if (TEXT == NULL) goto errored;
 
     //Initializtions
     result = lw_result_new (); if (result == NULL) goto errored;
@@ -92,74 +82,83 @@ errored:
 }
 
 
+//!
+//! @brief Moves to the next result.  Results that were already published are
+//!        walked without locking the search.
+//! @returns FALSE if there are no more results yet
+//!
 gboolean
 lw_searchresultiterator_next (LwSearchResultIterator* iterator)
 {
-    gboolean can_have_more_results = FALSE;
+    //Sanity checks
+    g_return_val_if_fail (iterator != NULL, FALSE);
+
+    //Declarations
     LwSearch *search = iterator->search;
+    LwSearchStatus status = LW_SEARCHSTATUS_IDLE;
     gboolean moved = FALSE;
 
-    lw_search_lock (search);
+    if (iterator->index + 1 >= iterator->length)
+    {
+      lw_search_lock (search);
 
-    LwSearchStatus status = search->status;
-    gboolean exists = FALSE;
+      status = search->status;
 
-    do {
-      //Initialize the iterator
-      if (iterator->list == NULL && status != LW_SEARCHSTATUS_IDLE)
-      {
-        iterator->list = g_hash_table_lookup (search->resulttable, iterator->category); 
-        iterator->link = iterator->list;
-        if (iterator->link != NULL)
-        {
-          iterator->count++;
-          moved = TRUE;
-        }
-        else
-        {
-          if (status == LW_SEARCHSTATUS_FINISHING) search->status = LW_SEARCHSTATUS_IDLE;
-        }
-      }
-      //Get the next link if it exists
-      else if (iterator->link != NULL && iterator->link->next != NULL && status != LW_SEARCHSTATUS_IDLE)
+      //Pick up the results that were published since the last check
+      if (status != LW_SEARCHSTATUS_IDLE)
       {
-        iterator->link = iterator->link->next;
-        moved = TRUE;
-        iterator->count++;
+        iterator->array = search->resultview;
+        iterator->length = lw_resultarray_length (iterator->array);
       }
+
       //Cleanup if we are finished
-      else if (status == LW_SEARCHSTATUS_FINISHING || LW_SEARCHSTATUS_CANCELING)
+      if (iterator->index + 1 >= iterator->length && (status == LW_SEARCHSTATUS_FINISHING || status == LW_SEARCHSTATUS_CANCELING))
       {
         search->status = LW_SEARCHSTATUS_IDLE;
       }
 
-      //Record the offset so we have no repeats
-      if (iterator->link != NULL && iterator->link->data != NULL)
-      {
-        LwOffset offset = GPOINTER_TO_OFFSET (iterator->link->data);
-        gpointer key = LW_OFFSET_TO_POINTER (offset);
-        exists = g_hash_table_contains (iterator->historytable, key);
-
-        if (!exists) g_hash_table_add (iterator->historytable, key);
-      }
-
-    } while (exists && iterator->link != NULL && iterator->link->next != NULL);
+      lw_search_unlock (search);
+    }
 
-    lw_search_unlock (search);
+    if (iterator->index + 1 < iterator->length)
+    {
+      iterator->index++;
+      iterator->count++;
+      moved = TRUE;
+    }
      
     return moved;
 }
 
 
+//!
+//! @brief Moves the iterator so the next call to lw_searchresultiterator_next() returns
+//!        the result at index.  Used for paging through large result sets.
+//! @returns FALSE if index is out of range
+//!
+gboolean
+lw_searchresultiterator_seek (LwSearchResultIterator *iterator,
+                              gint                    index)
+{
+    //Sanity checks
+    g_return_val_if_fail (iterator != NULL, FALSE);
+    if (index < 0 || index >= iterator->length) return FALSE;
+
+    iterator->index = index - 1;
+    iterator->count = index;
+
+    return TRUE;
+}
+
+
 void
 lw_searchresultiterator_rewind (LwSearchResultIterator* iterator)
 {
     //Sanity checks
     g_return_if_fail (iterator != NULL);
 
-    iterator->link = iterator->list;
+    iterator->index = -1;
     iterator->count = 0;
-    g_hash_table_remove_all (iterator->historytable);
 }
 
 
@@ -178,7 +177,6 @@ void
 lw_searchresultiterator_free (LwSearchResultIterator *iterator)
 {
     if (iterator == NULL) return;
-    g_hash_table_unref (iterator->historytable);
 
     memset (iterator, 0, sizeof(LwSearchResultIterator));
 
@@ -201,15 +199,7 @@ lw_searchresultiterator_length (LwSearchResultIterator *iterator)
     //Sanity checks
     g_return_val_if_fail (iterator != NULL, 0);
 
-    LwSearch *search = iterator->search;
-
-    lw_search_lock (search);
-
-    gint total = g_list_length (iterator->list);
-
-    lw_search_unlock (search);
-
-    return total;
+    return iterator->length;
 }
 
 
@@ -223,13 +213,13 @@ lw_searchresultiterator_finished (LwSearchResultIterator *iterator)
     LwSearch *search = iterator->search;
     LwSearchStatus status = lw_search_get_status (search);
 
-    return (status == LW_SEARCHSTATUS_IDLE && (iterator->list == NULL || iterator->link->next == NULL));
+    return (status == LW_SEARCHSTATUS_IDLE && iterator->index + 1 >= iterator->length);
 }
 
 
 gboolean
 lw_searchresultiterator_empty (LwSearchResultIterator *iterator)
 {
-    return (iterator->list == NULL);
+    return (iterator->length == 0);
 }
 
@@ -0,0 +1,440 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file stemtable.c
+//!
+//! @brief Hunspell stemming is by far the most expensive part of analyzing
+//!        English, but dictionaries use the same few thousand words over and
+//!        over.  The stems are memoized per Hunspell dictionary and saved in
+//!        the cache folder so later runs can memory map them.
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <libwaei/libwaei.h>
+#include <libwaei/gettext.h>
+
+#include <libwaei/stemtable.h>
+
+
+struct _LwStemTableHeader {
+  gchar magic[8];
+  guint32 fingerprint_length;  //!< Including padding to a multiple of 4 bytes
+  guint32 length;
+};
+typedef struct _LwStemTableHeader LwStemTableHeader;
+
+
+struct _LwStemTablePair {
+  const gchar *WORD;
+  const gchar *STEM;
+};
+typedef struct _LwStemTablePair LwStemTablePair;
+
+
+//!
+//! @brief Describes the dictionary files so a table is rebuilt when they change
+//!
+static gchar*
+_lw_stemtable_build_fingerprint (const gchar *DICTIONARY_PATH)
+{
+    //Declarations
+    gchar *dpath = g_strjoin (".", DICTIONARY_PATH, "dic", NULL);
+    gchar *affpath = g_strjoin (".", DICTIONARY_PATH, "aff", NULL);
+    GStatBuf dstat, affstat;
+    gchar *fingerprint = NULL;
+
+    memset(&dstat, 0, sizeof(GStatBuf));
+    memset(&affstat, 0, sizeof(GStatBuf));
+
+    if (g_stat (dpath, &dstat) != 0) goto errored;
+    if (g_stat (affpath, &affstat) != 0) goto errored;
+
+    fingerprint = g_strdup_printf ("%s:%" G_GINT64_FORMAT ":%" G_GINT64_FORMAT ":%" G_GINT64_FORMAT ":%" G_GINT64_FORMAT,
+      DICTIONARY_PATH,
+      (gint64) dstat.st_size, (gint64) dstat.st_mtime,
+      (gint64) affstat.st_size, (gint64) affstat.st_mtime
+    );
+
+errored:
+
+    if (dpath != NULL) g_free (dpath); dpath = NULL;
+    if (affpath != NULL) g_free (affpath); affpath = NULL;
+
+    return fingerprint;
+}
+
+
+//!
+//! @brief Checks that every entry of a mapped table points at a word and a
+//!        stem inside of the pool and that the words are sorted, so lookups
+//!        never read past the end of the file
+//!
+static gboolean
+_lw_stemtable_entries_are_valid (const guint32 *ENTRIES,
+                                 guint32        length,
+                                 const gchar   *POOL,
+                                 gsize          pool_length)
+{
+    //Declarations
+    const gchar *WORD = NULL;
+    const gchar *PREVIOUS = NULL;
+    const gchar *STEM = NULL;
+    const gchar *END = POOL + pool_length;
+    guint32 i = 0;
+
+    for (i = 0; i < length; i++)
+    {
+      if (ENTRIES[i] >= pool_length) return FALSE;
+      WORD = POOL + ENTRIES[i];
+      STEM = memchr (WORD, '\0', END - WORD); if (STEM == NULL) return FALSE;
+      STEM++;
+      if (STEM >= END || memchr (STEM, '\0', END - STEM) == NULL) return FALSE;
+      if (PREVIOUS != NULL && strcmp (PREVIOUS, WORD) >= 0) return FALSE;
+      PREVIOUS = WORD;
+    }
+
+    return TRUE;
+}
+
+
+//!
+//! @brief Maps the cache file if it was built from the same dictionary files.
+//!        A file that is truncated or corrupt is left unmapped and marked to be
+//!        rewritten on the next save.
+//!
+static void
+_lw_stemtable_map (LwStemTable *stemtable)
+{
+    //Declarations
+    GMappedFile *mappedfile = NULL;
+    const gchar *contents = NULL;
+    gsize size = 0;
+    const LwStemTableHeader *header = NULL;
+    gsize fingerprint_length = 0;
+    gsize entries_offset = 0;
+    gsize pool_offset = 0;
+
+    mappedfile = g_mapped_file_new (stemtable->path, FALSE, NULL); if (mappedfile == NULL) goto errored;
+    contents = g_mapped_file_get_contents (mappedfile);
+    size = g_mapped_file_get_length (mappedfile);
+
+    //Validate everything before trusting any offset
+    if (contents == NULL || size < sizeof(LwStemTableHeader)) goto corrupt;
+    header = (const LwStemTableHeader*) contents;
+    if (strncmp(header->magic, LW_STEMTABLE_MAGIC, sizeof(header->magic)) != 0) goto corrupt;
+
+    fingerprint_length = strlen(stemtable->fingerprint) + 1;
+    if (header->fingerprint_length % 4 != 0 || header->fingerprint_length > size - sizeof(LwStemTableHeader)) goto corrupt;
+    if (header->fingerprint_length < fingerprint_length) goto errored;
+    entries_offset = sizeof(LwStemTableHeader) + header->fingerprint_length;
+    if (header->length > (size - entries_offset) / sizeof(guint32)) goto corrupt;
+    pool_offset = entries_offset + (gsize) header->length * sizeof(guint32);
+    if (memcmp(contents + sizeof(LwStemTableHeader), stemtable->fingerprint, fingerprint_length) != 0) goto errored;
+    if (header->length > 0 && (pool_offset == size || contents[size - 1] != '\0')) goto corrupt;
+    if (!_lw_stemtable_entries_are_valid ((const guint32*) (contents + entries_offset), header->length, contents + pool_offset, size - pool_offset)) goto corrupt;
+
+    stemtable->mappedfile = mappedfile; mappedfile = NULL;
+    stemtable->entries = (const guint32*) (contents + entries_offset);
+    stemtable->length = header->length;
+    stemtable->pool = contents + pool_offset;
+
+    return;
+
+corrupt:
+
+    stemtable->dirty = TRUE;
+
+errored:
+
+    if (mappedfile != NULL) g_mapped_file_unref (mappedfile); mappedfile = NULL;
+}
+
+
+//!
+//! @brief Opens the stem table of a Hunspell dictionary
+//! @param DICTIONARY_PATH The dictionary path without the .aff/.dic extension
+//! @returns A new LwStemTable or NULL if the dictionary doesn't exist
+//!
+LwStemTable*
+lw_stemtable_new (const gchar *DICTIONARY_PATH)
+{
+    //Sanity checks
+    if (DICTIONARY_PATH == NULL) return NULL;
+
+    //Declarations
+    LwStemTable *stemtable = NULL;
+    gchar *basename = NULL;
+    gchar *filename = NULL;
+
+    stemtable = g_new0 (LwStemTable, 1);
+    stemtable->fingerprint = _lw_stemtable_build_fingerprint (DICTIONARY_PATH); if (stemtable->fingerprint == NULL) goto errored;
+    basename = g_path_get_basename (DICTIONARY_PATH);
+    filename = g_strjoin (".", basename, "stems", NULL);
+    stemtable->path = lw_util_build_filename (LW_PATH_CACHE, filename);
+    stemtable->overlay = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+    g_mutex_init (&stemtable->mutex);
+
+    _lw_stemtable_map (stemtable);
+
+    if (basename != NULL) g_free (basename); basename = NULL;
+    if (filename != NULL) g_free (filename); filename = NULL;
+
+    return stemtable;
+
+errored:
+
+    if (stemtable != NULL) lw_stemtable_free (stemtable); stemtable = NULL;
+
+    return NULL;
+}
+
+
+void
+lw_stemtable_free (LwStemTable *stemtable)
+{
+    //Sanity checks
+    if (stemtable == NULL) return;
+
+    if (stemtable->overlay != NULL) 
+    {
+      g_hash_table_unref (stemtable->overlay);
+      g_mutex_clear (&stemtable->mutex);
+    }
+    if (stemtable->mappedfile != NULL) g_mapped_file_unref (stemtable->mappedfile);
+    if (stemtable->path != NULL) g_free (stemtable->path);
+    if (stemtable->fingerprint != NULL) g_free (stemtable->fingerprint);
+
+    memset(stemtable, 0, sizeof(LwStemTable));
+
+    g_free (stemtable);
+}
+
+
+//!
+//! @brief Finds a word in the mapped file by binary search.  Needs no locking.
+//!
+static const gchar*
+_lw_stemtable_lookup_mapped (LwStemTable *stemtable,
+                             const gchar *WORD)
+{
+    //Declarations
+    guint32 low = 0;
+    guint32 high = stemtable->length;
+
+    while (low < high)
+    {
+      guint32 middle = low + (high - low) / 2;
+      const gchar *KEY = stemtable->pool + stemtable->entries[middle];
+      gint comparison = strcmp (WORD, KEY);
+
+      if (comparison == 0) return KEY + strlen(KEY) + 1;
+      else if (comparison < 0) high = middle;
+      else low = middle + 1;
+    }
+
+    return NULL;
+}
+
+
+//!
+//! @brief Looks up the memoized stem of a word
+//! @param stem Set to the stem or to NULL if the word has no stem different from itself
+//! @returns FALSE if the word hasn't been stemmed yet and Hunspell must be asked
+//!
+gboolean
+lw_stemtable_lookup (LwStemTable  *stemtable,
+                     const gchar  *WORD,
+                     const gchar **stem)
+{
+    //Sanity checks
+    g_return_val_if_fail (stemtable != NULL, FALSE);
+    g_return_val_if_fail (WORD != NULL, FALSE);
+    g_return_val_if_fail (stem != NULL, FALSE);
+
+    //Declarations
+    const gchar *STEM = NULL;
+
+    STEM = _lw_stemtable_lookup_mapped (stemtable, WORD);
+
+    if (STEM == NULL)
+    {
+      g_mutex_lock (&stemtable->mutex);
+      STEM = g_hash_table_lookup (stemtable->overlay, WORD);
+      g_mutex_unlock (&stemtable->mutex);
+    }
+
+    if (STEM == NULL) return FALSE;
+
+    *stem = (*STEM == '\0') ? NULL : STEM;
+
+    return TRUE;
+}
+
+
+//!
+//! @brief Remembers the Hunspell result for a word.  STEM may be NULL if there was none.
+//!
+void
+lw_stemtable_insert (LwStemTable *stemtable,
+                     const gchar *WORD,
+                     const gchar *STEM)
+{
+    //Sanity checks
+    g_return_if_fail (stemtable != NULL);
+    g_return_if_fail (WORD != NULL);
+
+    g_mutex_lock (&stemtable->mutex);
+    if (g_hash_table_lookup (stemtable->overlay, WORD) == NULL)
+    {
+      g_hash_table_insert (stemtable->overlay, g_strdup (WORD), g_strdup ((STEM != NULL) ? STEM : ""));
+      stemtable->dirty = TRUE;
+    }
+    g_mutex_unlock (&stemtable->mutex);
+}
+
+
+gboolean
+lw_stemtable_is_dirty (LwStemTable *stemtable)
+{
+    //Sanity checks
+    g_return_val_if_fail (stemtable != NULL, FALSE);
+
+    //Declarations
+    gboolean dirty = FALSE;
+
+    g_mutex_lock (&stemtable->mutex);
+    dirty = stemtable->dirty;
+    g_mutex_unlock (&stemtable->mutex);
+
+    return dirty;
+}
+
+
+static gint
+_lw_stemtable_compare_pairs (gconstpointer a,
+                             gconstpointer b)
+{
+    const LwStemTablePair *PAIR_A = a;
+    const LwStemTablePair *PAIR_B = b;
+
+    return strcmp (PAIR_A->WORD, PAIR_B->WORD);
+}
+
+
+//!
+//! @brief Merges the overlay with the mapped words and writes a new cache file.
+//!        The current mapping stays in use until the table is reopened, so
+//!        this is safe to call while other threads are looking up stems.
+//!
+gboolean
+lw_stemtable_save (LwStemTable  *stemtable,
+                   GError      **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (stemtable != NULL, FALSE);
+
+    //Declarations
+    GArray *pairs = NULL;
+    GArray *entries = NULL;
+    GHashTableIter iter;
+    gpointer key = NULL, value = NULL;
+    GString *strings = NULL;
+    GString *buffer = NULL;
+    LwStemTableHeader header;
+    guint32 i = 0;
+    gboolean success = TRUE;
+
+    //Misses only take this lock briefly, so it is held until the file is written
+    g_mutex_lock (&stemtable->mutex);
+    if (!stemtable->dirty) goto errored;
+
+    pairs = g_array_new (FALSE, FALSE, sizeof(LwStemTablePair));
+    entries = g_array_new (FALSE, FALSE, sizeof(guint32));
+    strings = g_string_new (NULL);
+    buffer = g_string_new (NULL);
+
+    //Collect every word.  The overlay only holds words missing from the mapping
+    for (i = 0; i < stemtable->length; i++)
+    {
+      LwStemTablePair pair;
+      pair.WORD = stemtable->pool + stemtable->entries[i];
+      pair.STEM = pair.WORD + strlen(pair.WORD) + 1;
+      g_array_append_val (pairs, pair);
+    }
+    g_hash_table_iter_init (&iter, stemtable->overlay);
+    while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      LwStemTablePair pair;
+      pair.WORD = key;
+      pair.STEM = value;
+      g_array_append_val (pairs, pair);
+    }
+    g_array_sort (pairs, _lw_stemtable_compare_pairs);
+
+    //Build the pool
+    for (i = 0; i < pairs->len; i++)
+    {
+      LwStemTablePair *pair = &g_array_index (pairs, LwStemTablePair, i);
+      guint32 entry = strings->len;
+      if (i > 0 && strcmp (pair->WORD, g_array_index (pairs, LwStemTablePair, i - 1).WORD) == 0) continue;
+
+      g_array_append_val (entries, entry);
+      g_string_append_len (strings, pair->WORD, strlen(pair->WORD) + 1);
+      g_string_append_len (strings, pair->STEM, strlen(pair->STEM) + 1);
+    }
+
+    //Header, padded fingerprint, entries then the pool
+    memset(&header, 0, sizeof(LwStemTableHeader));
+    strncpy (header.magic, LW_STEMTABLE_MAGIC, sizeof(header.magic));
+    header.fingerprint_length = ((strlen(stemtable->fingerprint) + 1) + 3) & ~3;
+    header.length = entries->len;
+
+    g_string_append_len (buffer, (const gchar*) &header, sizeof(LwStemTableHeader));
+    g_string_append_len (buffer, stemtable->fingerprint, strlen(stemtable->fingerprint) + 1);
+    while (buffer->len % 4 != 0) g_string_append_c (buffer, '\0');
+    g_string_append_len (buffer, (const gchar*) entries->data, entries->len * sizeof(guint32));
+    g_string_append_len (buffer, strings->str, strings->len);
+
+    success = g_file_set_contents (stemtable->path, buffer->str, buffer->len, error);
+    if (success) stemtable->dirty = FALSE;
+
+errored:
+
+    g_mutex_unlock (&stemtable->mutex);
+
+    if (pairs != NULL) g_array_free (pairs, TRUE); pairs = NULL;
+    if (entries != NULL) g_array_free (entries, TRUE); entries = NULL;
+    if (strings != NULL) g_string_free (strings, TRUE); strings = NULL;
+    if (buffer != NULL) g_string_free (buffer, TRUE); buffer = NULL;
+
+    return success;
+}
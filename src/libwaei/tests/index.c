@@ -11,6 +11,9 @@
   lw_index_get_data_offsets_length
   lw_index_search
   lw_index_data_is_valid
+  lw_index_get_fuzzy_keys
+  lw_index_exists
+  lw_index_has_positions
 */
 
 struct _IndexFixture {
@@ -134,6 +137,209 @@ index_index_file_test (IndexFixture *fixture, gconstpointer data)
 }
 
 
+void
+index_fuzzy_keys_test (IndexFixture *fixture, gconstpointer data)
+{
+    const gchar* PATH = "data/dictionaries/e/English";
+
+    fixture->data = lw_dictionarydata_new ();
+    lw_dictionarydata_create (fixture->data, PATH);
+
+    fixture->index = lw_index_new (fixture->engine); 
+    lw_index_create (fixture->index, fixture->data, NULL, NULL);
+
+    GList *matches = lw_index_get_fuzzy_keys (fixture->index, LW_INDEX_TABLE_RAW, "decimel", 1);
+
+    g_assert (matches != NULL);
+    {
+      LwIndexFuzzyMatch *match = matches->data;
+      g_assert_cmpstr (match->KEY, ==, "decimal");
+      g_assert_cmpint (match->cost, ==, LW_INDEX_FUZZY_EDIT_COST);
+    }
+
+    g_assert (lw_index_get_fuzzy_keys (fixture->index, LW_INDEX_TABLE_RAW, "decimel", 0) == NULL);
+
+    g_list_free_full (matches, g_free); matches = NULL;
+    lw_index_free (fixture->index); fixture->index = NULL;
+    lw_dictionarydata_free (fixture->data); fixture->data = NULL;
+}
+
+
+void
+index_query_test (IndexFixture *fixture, gconstpointer data)
+{
+    const gchar* PATH = "data/dictionaries/e/English";
+
+    //Plain queries and regex patterns are left to the other searches
+    g_assert (lw_indexquery_new ("decimal") == NULL);
+    g_assert (lw_indexquery_new ("deci.*") == NULL);
+    g_assert (lw_indexquery_new ("!decimal") == NULL);
+    g_assert (lw_indexquery_new ("decimal&") == NULL);
+
+    LwIndexQuery *query = lw_indexquery_new ("decimal | denary & !octal");
+    g_assert (query != NULL);
+    g_assert_cmpint (query->type, ==, LW_INDEXQUERY_OR);
+    g_assert_cmpint (g_list_length (query->children), ==, 2);
+    g_assert_cmpint (LW_INDEXQUERY (query->children->next->data)->type, ==, LW_INDEXQUERY_AND);
+
+    fixture->data = lw_dictionarydata_new ();
+    lw_dictionarydata_create (fixture->data, PATH);
+
+    fixture->index = lw_index_new (fixture->engine); 
+    lw_index_create (fixture->index, fixture->data, NULL, NULL);
+
+    {
+      gint i = 0;
+      gint length = 0;
+      LwOffset *offsets = lw_indexquery_get_matches (query, fixture->index, LW_INDEX_TABLE_RAW, &length);
+      gboolean found = FALSE;
+      const gchar *EXPECTED_STRING = "１０進 [じゅっしん] /(adj-na,adj-no) decimal/denary/deciam/";
+      for (i = 0; i < length; i++)
+      {
+        if (i > 0) g_assert (offsets[i - 1] < offsets[i]);
+        if (g_strcmp0 (lw_dictionarydata_get_string (fixture->data, offsets[i]), EXPECTED_STRING) == 0) found = TRUE;
+      }
+      g_assert (found);
+      g_free (offsets);
+    }
+
+    lw_indexquery_free (query); query = NULL;
+    lw_index_free (fixture->index); fixture->index = NULL;
+    lw_dictionarydata_free (fixture->data); fixture->data = NULL;
+}
+
+
+
+void
+index_phrase_query_test (IndexFixture *fixture, gconstpointer data)
+{
+    const gchar* PATH = "data/dictionaries/e/English";
+    const gchar *EXPECTED_STRING = "１０進 [じゅっしん] /(adj-na,adj-no) decimal/denary/deciam/";
+
+    g_assert (lw_indexquery_new ("\"decimal denary\"~") == NULL);
+
+    LwIndexQuery *phrase = lw_indexquery_new ("\"decimal denary\"");
+    LwIndexQuery *both = lw_indexquery_new ("decimal&denary");
+    LwIndexQuery *near = lw_indexquery_new ("\"decimal denary\"~3");
+    g_assert (phrase != NULL && both != NULL && near != NULL);
+    g_assert_cmpint (phrase->type, ==, LW_INDEXQUERY_PHRASE);
+    g_assert_cmpint (phrase->distance, ==, 0);
+    g_assert_cmpint (near->distance, ==, 3);
+
+    fixture->data = lw_dictionarydata_new ();
+    lw_dictionarydata_create (fixture->data, PATH);
+
+    fixture->index = lw_index_new (fixture->engine); 
+    lw_index_create (fixture->index, fixture->data, NULL, NULL);
+    g_assert (lw_index_has_positions (fixture->index, LW_INDEX_TABLE_RAW));
+
+    {
+      //The words are in the same line but in different glosses
+      LwIndexQuery *queries[] = { both, phrase, near };
+      gboolean expected[] = { TRUE, FALSE, FALSE };
+      gint i = 0;
+      gint j = 0;
+      for (i = 0; i < G_N_ELEMENTS (queries); i++)
+      {
+        gint length = 0;
+        LwOffset *offsets = lw_indexquery_get_matches (queries[i], fixture->index, LW_INDEX_TABLE_RAW, &length);
+        gboolean found = FALSE;
+        for (j = 0; j < length; j++)
+        {
+          if (g_strcmp0 (lw_dictionarydata_get_string (fixture->data, offsets[j]), EXPECTED_STRING) == 0) found = TRUE;
+        }
+        g_assert (found == expected[i]);
+        g_free (offsets);
+      }
+    }
+
+    lw_indexquery_free (phrase); phrase = NULL;
+    lw_indexquery_free (both); both = NULL;
+    lw_indexquery_free (near); near = NULL;
+    lw_index_free (fixture->index); fixture->index = NULL;
+    lw_dictionarydata_free (fixture->data); fixture->data = NULL;
+}
+
+//!
+//! @brief Checks that every morphology of TEXT points at its own word in TEXT
+//! @returns How many morphologies there were
+//!
+static gint
+index_assert_offsets_in_text (LwMorphologyEngine *engine, const gchar *TEXT)
+{
+    LwMorphologyList *morphologylist = lw_morphologyengine_analyze (engine, TEXT, FALSE);
+    GList *link = NULL;
+    gint total = 0;
+
+    for (link = morphologylist->list; link != NULL; link = link->next)
+    {
+      LwMorphology *morphology = LW_MORPHOLOGY (link->data);
+      g_assert_cmpint (morphology->start_offset, >=, 0);
+      g_assert_cmpint (morphology->end_offset, <=, strlen(TEXT));
+      g_assert_cmpint (morphology->end_offset - morphology->start_offset, ==, strlen(morphology->word));
+      g_assert (strncmp (TEXT + morphology->start_offset, morphology->word, strlen(morphology->word)) == 0);
+      total++;
+    }
+
+    lw_morphologylist_free (morphologylist);
+
+    return total;
+}
+
+
+void
+index_morphology_offsets_test (IndexFixture *fixture, gconstpointer data)
+{
+    //Words after parentheses that the english engine strips out
+    g_assert_cmpint (index_assert_offsets_in_text (fixture->engine, "/(n,adj-na,vs) (1) (sens) extramarital sex/affair/fooling around/(2) infidelity/"), >, 0);
+
+    //Kana runs and the words of kanji runs after the start of the line
+    index_assert_offsets_in_text (fixture->engine, "ばかを見る [ばかをみる] /(exp,v1) to feel like an idiot/");
+    index_assert_offsets_in_text (fixture->engine, "This is an english and 日本語のミックス。");
+}
+
+
+void
+index_phrase_offsets_test (IndexFixture *fixture, gconstpointer data)
+{
+    const gchar* PATH = "data/dictionaries/e/English";
+    const gchar *EXPECTED_STRING = "うわ気 [うわき] /(n,adj-na,vs) (1) (sens) extramarital sex/affair/fooling around/(2) infidelity/wantonness/unfaithfulness/inconstancy/fickleness/caprice/";
+
+    fixture->data = lw_dictionarydata_new ();
+    lw_dictionarydata_create (fixture->data, PATH);
+
+    fixture->index = lw_index_new (fixture->engine); 
+    lw_index_create (fixture->index, fixture->data, NULL, NULL);
+    g_assert (lw_index_has_positions (fixture->index, LW_INDEX_TABLE_RAW));
+
+    {
+      //Glosses after parenthesized notes still split into the right sections
+      const gchar *QUERIES[] = { "\"extramarital sex\"", "\"fooling around\"", "\"sex affair\"", "\"around infidelity\"" };
+      gboolean expected[] = { TRUE, TRUE, FALSE, FALSE };
+      gint i = 0;
+      gint j = 0;
+      for (i = 0; i < G_N_ELEMENTS (QUERIES); i++)
+      {
+        LwIndexQuery *query = lw_indexquery_new (QUERIES[i]);
+        gint length = 0;
+        LwOffset *offsets = NULL;
+        gboolean found = FALSE;
+        g_assert (query != NULL);
+        offsets = lw_indexquery_get_matches (query, fixture->index, LW_INDEX_TABLE_RAW, &length);
+        for (j = 0; j < length; j++)
+        {
+          if (g_strcmp0 (lw_dictionarydata_get_string (fixture->data, offsets[j]), EXPECTED_STRING) == 0) found = TRUE;
+        }
+        g_assert (found == expected[i]);
+        g_free (offsets);
+        lw_indexquery_free (query);
+      }
+    }
+
+    lw_index_free (fixture->index); fixture->index = NULL;
+    lw_dictionarydata_free (fixture->data); fixture->data = NULL;
+}
+
 void
 index_load_save_test (IndexFixture *fixture, gconstpointer data)
 {
@@ -165,6 +371,59 @@ index_load_save_test (IndexFixture *fixture, gconstpointer data)
 }
 
 
+void
+index_positions_header_test (IndexFixture *fixture, gconstpointer data)
+{
+    const gchar* PATH = "data/dictionaries/e/English";
+    LwProgress *progress = lw_progress_new (NULL, NULL, NULL);
+    gchar *directory = g_dir_make_tmp ("lwindex-XXXXXX", NULL);
+    gchar *path = g_build_filename (directory, "English", NULL);
+    gchar *positions = g_strjoin (".", path, lw_index_table_type_to_string (LW_INDEX_TABLE_RAW), "positions", NULL);
+    LwIndex *index = NULL;
+    LwIndexTableType type = 0;
+
+    fixture->data = lw_dictionarydata_new ();
+    lw_dictionarydata_create (fixture->data, PATH);
+
+    fixture->index = lw_index_new (fixture->engine); 
+    lw_index_create (fixture->index, fixture->data, progress);
+    lw_index_write (fixture->index, path, progress);
+
+    g_assert (lw_index_exists (path));
+    index = lw_index_new (fixture->engine);
+    lw_index_read (index, path, progress);
+    g_assert (lw_index_has_positions (index, LW_INDEX_TABLE_RAW));
+    lw_index_free (index); index = NULL;
+
+    //A positions file without the format header must not be read as offsets
+    g_file_set_contents (positions, fixture->index->checksum, strlen(fixture->index->checksum) + 1, NULL);
+
+    g_assert (!lw_index_exists (path));
+    index = lw_index_new (fixture->engine);
+    lw_index_read (index, path, progress);
+    g_assert (!lw_index_has_positions (index, LW_INDEX_TABLE_RAW));
+    lw_index_free (index); index = NULL;
+
+    for (type = 0; type < TOTAL_LW_INDEX_TABLES; type++)
+    {
+      gchar *filename = g_strjoin (".", path, lw_index_table_type_to_string (type), NULL);
+      gchar *positionsfilename = g_strjoin (".", filename, "positions", NULL);
+      g_remove (filename);
+      g_remove (positionsfilename);
+      g_free (filename);
+      g_free (positionsfilename);
+    }
+    g_rmdir (directory);
+
+    lw_index_free (fixture->index); fixture->index = NULL;
+    lw_dictionarydata_free (fixture->data); fixture->data = NULL;
+    lw_progress_free (progress);
+    g_free (positions);
+    g_free (path);
+    g_free (directory);
+}
+
+
 gint
 main (gint argc, gchar *argv[])
 {
@@ -176,6 +435,12 @@ main (gint argc, gchar *argv[])
     g_test_add ("/libwaei/index/parse_string", IndexFixture, NULL, index_test_setup, index_parse_string_test, index_test_teardown);
     g_test_add ("/libwaei/index/index_file", IndexFixture, NULL, index_test_setup, index_index_file_test, index_test_teardown);
     g_test_add ("/libwaei/index/load_save", IndexFixture, NULL, index_test_setup, index_load_save_test, index_test_teardown);
+    g_test_add ("/libwaei/index/fuzzy_keys", IndexFixture, NULL, index_test_setup, index_fuzzy_keys_test, index_test_teardown);
+    g_test_add ("/libwaei/index/query", IndexFixture, NULL, index_test_setup, index_query_test, index_test_teardown);
+    g_test_add ("/libwaei/index/phrase_query", IndexFixture, NULL, index_test_setup, index_phrase_query_test, index_test_teardown);
+    g_test_add ("/libwaei/index/morphology_offsets", IndexFixture, NULL, index_test_setup, index_morphology_offsets_test, index_test_teardown);
+    g_test_add ("/libwaei/index/phrase_offsets", IndexFixture, NULL, index_test_setup, index_phrase_offsets_test, index_test_teardown);
+    g_test_add ("/libwaei/index/positions_header", IndexFixture, NULL, index_test_setup, index_positions_header_test, index_test_teardown);
 
     return g_test_run();
 }
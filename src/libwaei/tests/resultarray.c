@@ -0,0 +1,225 @@
+#include <string.h>
+#include <glib.h>
+#include <libwaei/libwaei.h>
+
+/*
+  Methods tested
+
+  lw_resultarray_new_bounded
+  lw_resultarray_append
+  lw_resultarray_sort
+  lw_resultarray_is_truncated
+  lw_resultarray_merge_sorted
+*/
+
+struct _ResultArrayFixture {
+  LwResultArray *arrays[3];
+  LwResultArray *expected;
+  LwResultArray *actual;
+};
+typedef struct _ResultArrayFixture ResultArrayFixture;
+
+
+void
+resultarray_test_setup (ResultArrayFixture *fixture, gconstpointer data)
+{
+    memset(fixture, 0, sizeof(ResultArrayFixture));
+}
+
+
+void
+resultarray_test_teardown (ResultArrayFixture *fixture, gconstpointer data)
+{
+    gint i = 0;
+
+    for (i = 0; i < G_N_ELEMENTS (fixture->arrays); i++)
+    {
+      lw_resultarray_free (fixture->arrays[i]); fixture->arrays[i] = NULL;
+    }
+    lw_resultarray_free (fixture->expected); fixture->expected = NULL;
+    lw_resultarray_free (fixture->actual); fixture->actual = NULL;
+}
+
+
+static void
+resultarray_assert_equal (LwResultArray *expected, LwResultArray *actual)
+{
+    gint i = 0;
+
+    g_assert_cmpint (lw_resultarray_length (actual), ==, lw_resultarray_length (expected));
+    for (i = 0; i < lw_resultarray_length (expected); i++)
+    {
+      g_assert_cmpuint (lw_resultarray_index (actual, i)->offset, ==, lw_resultarray_index (expected, i)->offset);
+      g_assert_cmpint (lw_resultarray_index (actual, i)->score, ==, lw_resultarray_index (expected, i)->score);
+      g_assert_cmpint (lw_resultarray_index (actual, i)->cost, ==, lw_resultarray_index (expected, i)->cost);
+    }
+}
+
+
+void
+resultarray_test_bounded_keeps_best (ResultArrayFixture *fixture, gconstpointer data)
+{
+    gint i = 0;
+
+    fixture->actual = lw_resultarray_new_bounded (3);
+    for (i = 0; i < 10; i++) lw_resultarray_append (fixture->actual, i, i, 0);
+    //A fuzzy match is worse than any exact one no matter its score
+    lw_resultarray_append (fixture->actual, 100, 100, 1);
+    lw_resultarray_sort (fixture->actual);
+
+    g_assert_cmpint (lw_resultarray_length (fixture->actual), ==, 3);
+    g_assert_cmpint (fixture->actual->total, ==, 11);
+    g_assert (lw_resultarray_is_truncated (fixture->actual));
+    g_assert_cmpint (lw_resultarray_index (fixture->actual, 0)->score, ==, 9);
+    g_assert_cmpint (lw_resultarray_index (fixture->actual, 1)->score, ==, 8);
+    g_assert_cmpint (lw_resultarray_index (fixture->actual, 2)->score, ==, 7);
+}
+
+
+void
+resultarray_test_ties_keep_file_order (ResultArrayFixture *fixture, gconstpointer data)
+{
+    //Equal results come out in the order they are in the dictionary
+    fixture->actual = lw_resultarray_new (0);
+    lw_resultarray_append (fixture->actual, 10, 5, 0);
+    lw_resultarray_append (fixture->actual, 20, 5, 0);
+    lw_resultarray_sort (fixture->actual);
+
+    g_assert_cmpuint (lw_resultarray_index (fixture->actual, 0)->offset, ==, 10);
+    g_assert_cmpuint (lw_resultarray_index (fixture->actual, 1)->offset, ==, 20);
+
+    //And the bounded array keeps the earlier ones
+    lw_resultarray_free (fixture->actual);
+    fixture->actual = lw_resultarray_new_bounded (2);
+    lw_resultarray_append (fixture->actual, 10, 5, 0);
+    lw_resultarray_append (fixture->actual, 20, 5, 0);
+    lw_resultarray_append (fixture->actual, 30, 5, 0);
+    lw_resultarray_sort (fixture->actual);
+
+    g_assert_cmpint (lw_resultarray_length (fixture->actual), ==, 2);
+    g_assert_cmpuint (lw_resultarray_index (fixture->actual, 0)->offset, ==, 10);
+    g_assert_cmpuint (lw_resultarray_index (fixture->actual, 1)->offset, ==, 20);
+}
+
+
+void
+resultarray_test_bounded_unlimited (ResultArrayFixture *fixture, gconstpointer data)
+{
+    gint i = 0;
+
+    fixture->actual = lw_resultarray_new_bounded (0);
+    for (i = 0; i < 100; i++) lw_resultarray_append (fixture->actual, i, i % 7, 0);
+
+    g_assert_cmpint (lw_resultarray_length (fixture->actual), ==, 100);
+    g_assert (!lw_resultarray_is_truncated (fixture->actual));
+
+    //Not truncated until something is dropped
+    lw_resultarray_free (fixture->actual);
+    fixture->actual = lw_resultarray_new_bounded (5);
+    for (i = 0; i < 5; i++) lw_resultarray_append (fixture->actual, i, i, 0);
+    g_assert (!lw_resultarray_is_truncated (fixture->actual));
+}
+
+
+void
+resultarray_test_bounded_matches_sort (ResultArrayFixture *fixture, gconstpointer data)
+{
+    const gint MAX = 50;
+    guint32 seed = 1;
+    gint i = 0;
+
+    fixture->expected = lw_resultarray_new (0);
+    fixture->actual = lw_resultarray_new_bounded (MAX);
+
+    //Plenty of equal scores so the ties have to be broken the same way
+    for (i = 0; i < 5000; i++)
+    {
+      seed = seed * 1103515245 + 12345;
+      lw_resultarray_append (fixture->expected, i, (seed >> 16) % 20, (seed >> 8) % 3);
+      lw_resultarray_append (fixture->actual, i, (seed >> 16) % 20, (seed >> 8) % 3);
+    }
+
+    lw_resultarray_sort (fixture->expected);
+    lw_resultarray_truncate (fixture->expected, MAX);
+    lw_resultarray_sort (fixture->actual);
+
+    resultarray_assert_equal (fixture->expected, fixture->actual);
+    g_assert_cmpint (fixture->actual->total, ==, 5000);
+}
+
+
+void
+resultarray_test_merge_sorted (ResultArrayFixture *fixture, gconstpointer data)
+{
+    guint32 seed = 7;
+    gint i = 0;
+
+    fixture->expected = lw_resultarray_new (0);
+    fixture->arrays[0] = lw_resultarray_new (0);
+    fixture->arrays[2] = lw_resultarray_new (0);
+
+    //Distinct entries split between two of the arrays with one left NULL
+    for (i = 0; i < 300; i++)
+    {
+      seed = seed * 1103515245 + 12345;
+      lw_resultarray_append (fixture->expected, i, (seed >> 16) % 30, (seed >> 8) % 2);
+      lw_resultarray_append (fixture->arrays[(seed >> 4) % 2 * 2], i, (seed >> 16) % 30, (seed >> 8) % 2);
+    }
+
+    lw_resultarray_sort (fixture->expected);
+    lw_resultarray_sort (fixture->arrays[0]);
+    lw_resultarray_sort (fixture->arrays[2]);
+
+    fixture->actual = lw_resultarray_merge_sorted (fixture->arrays, G_N_ELEMENTS (fixture->arrays), 0);
+    resultarray_assert_equal (fixture->expected, fixture->actual);
+    g_assert_cmpint (fixture->actual->total, ==, 300);
+    g_assert (!lw_resultarray_is_truncated (fixture->actual));
+    lw_resultarray_free (fixture->actual);
+
+    fixture->actual = lw_resultarray_merge_sorted (fixture->arrays, G_N_ELEMENTS (fixture->arrays), 40);
+    lw_resultarray_truncate (fixture->expected, 40);
+    resultarray_assert_equal (fixture->expected, fixture->actual);
+    g_assert_cmpint (fixture->actual->total, ==, 300);
+    g_assert (lw_resultarray_is_truncated (fixture->actual));
+}
+
+
+void
+resultarray_test_merge_sorted_truncated (ResultArrayFixture *fixture, gconstpointer data)
+{
+    gint i = 0;
+
+    //What the bounded arrays dropped still counts
+    fixture->arrays[0] = lw_resultarray_new_bounded (2);
+    fixture->arrays[1] = lw_resultarray_new_bounded (2);
+    for (i = 0; i < 4; i++) lw_resultarray_append (fixture->arrays[0], i, i, 0);
+    for (i = 4; i < 8; i++) lw_resultarray_append (fixture->arrays[1], i, i, 0);
+    lw_resultarray_sort (fixture->arrays[0]);
+    lw_resultarray_sort (fixture->arrays[1]);
+
+    fixture->actual = lw_resultarray_merge_sorted (fixture->arrays, 2, 0);
+
+    g_assert_cmpint (lw_resultarray_length (fixture->actual), ==, 4);
+    g_assert_cmpint (fixture->actual->total, ==, 8);
+    g_assert (lw_resultarray_is_truncated (fixture->actual));
+    g_assert_cmpint (lw_resultarray_index (fixture->actual, 0)->score, ==, 7);
+    g_assert_cmpint (lw_resultarray_index (fixture->actual, 1)->score, ==, 6);
+    g_assert_cmpint (lw_resultarray_index (fixture->actual, 2)->score, ==, 3);
+    g_assert_cmpint (lw_resultarray_index (fixture->actual, 3)->score, ==, 2);
+}
+
+
+gint
+main (gint argc, gchar *argv[])
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add ("/libwaei/resultarray/bounded_keeps_best", ResultArrayFixture, NULL, resultarray_test_setup, resultarray_test_bounded_keeps_best, resultarray_test_teardown);
+    g_test_add ("/libwaei/resultarray/ties_keep_file_order", ResultArrayFixture, NULL, resultarray_test_setup, resultarray_test_ties_keep_file_order, resultarray_test_teardown);
+    g_test_add ("/libwaei/resultarray/bounded_unlimited", ResultArrayFixture, NULL, resultarray_test_setup, resultarray_test_bounded_unlimited, resultarray_test_teardown);
+    g_test_add ("/libwaei/resultarray/bounded_matches_sort", ResultArrayFixture, NULL, resultarray_test_setup, resultarray_test_bounded_matches_sort, resultarray_test_teardown);
+    g_test_add ("/libwaei/resultarray/merge_sorted", ResultArrayFixture, NULL, resultarray_test_setup, resultarray_test_merge_sorted, resultarray_test_teardown);
+    g_test_add ("/libwaei/resultarray/merge_sorted_truncated", ResultArrayFixture, NULL, resultarray_test_setup, resultarray_test_merge_sorted_truncated, resultarray_test_teardown);
+
+    return g_test_run();
+}
@@ -0,0 +1,226 @@
+#include <string.h>
+#include <glib.h>
+#include <libwaei/libwaei.h>
+
+/*
+  Methods tested
+
+  lw_resultcache_insert
+  lw_resultcache_lookup
+  lw_resultcache_lookup_refinable
+  lw_resultcache_get_size
+  lw_resultcache_clear
+*/
+
+struct _ResultCacheFixture {
+  LwResultCache *cache;
+  gsize entry_size;      //!< What one of the result tables below takes up in the cache
+};
+typedef struct _ResultCacheFixture ResultCacheFixture;
+
+
+static GHashTable*
+resultcache_new_resulttable (LwOffset offset)
+{
+    GHashTable *resulttable = NULL;
+    LwResultArray *array = NULL;
+
+    resulttable = g_hash_table_new_full (g_str_hash, g_str_equal, (GDestroyNotify) g_free, (GDestroyNotify) lw_resultarray_free);
+    array = lw_resultarray_new (0);
+    lw_resultarray_append (array, offset, 10, 0);
+    g_hash_table_insert (resulttable, g_strdup ("exact"), array);
+
+    return resulttable;
+}
+
+
+static LwOffset
+resultcache_get_offset (GHashTable *resulttable)
+{
+    LwResultArray *array = NULL;
+
+    g_assert (resulttable != NULL);
+    array = LW_RESULTARRAY (g_hash_table_lookup (resulttable, "exact"));
+    g_assert (array != NULL);
+    g_assert_cmpint (lw_resultarray_length (array), ==, 1);
+
+    return lw_resultarray_index (array, 0)->offset;
+}
+
+
+static void
+resultcache_insert (LwResultCache *cache, const gchar *KEY, LwOffset offset)
+{
+    GHashTable *resulttable = resultcache_new_resulttable (offset);
+    lw_resultcache_insert (cache, KEY, resulttable);
+    g_hash_table_unref (resulttable);
+}
+
+
+void
+resultcache_test_setup (ResultCacheFixture *fixture, gconstpointer data)
+{
+    memset(fixture, 0, sizeof(ResultCacheFixture));
+
+    //Measure one entry so the cache below holds exactly two of them
+    fixture->cache = lw_resultcache_new (G_MAXSIZE);
+    resultcache_insert (fixture->cache, "a", 1);
+    fixture->entry_size = lw_resultcache_get_size (fixture->cache);
+    lw_resultcache_free (fixture->cache);
+
+    fixture->cache = lw_resultcache_new (fixture->entry_size * 2 + fixture->entry_size / 2);
+}
+
+
+void
+resultcache_test_teardown (ResultCacheFixture *fixture, gconstpointer data)
+{
+    lw_resultcache_free (fixture->cache); fixture->cache = NULL;
+}
+
+
+void
+resultcache_test_eviction_order (ResultCacheFixture *fixture, gconstpointer data)
+{
+    GHashTable *resulttable = NULL;
+
+    resultcache_insert (fixture->cache, "a", 1);
+    resultcache_insert (fixture->cache, "b", 2);
+    g_assert_cmpuint (lw_resultcache_get_size (fixture->cache), ==, fixture->entry_size * 2);
+
+    //Looking up a makes b the least recently used
+    resulttable = lw_resultcache_lookup (fixture->cache, "a");
+    g_assert_cmpuint (resultcache_get_offset (resulttable), ==, 1);
+    g_hash_table_unref (resulttable); resulttable = NULL;
+
+    resultcache_insert (fixture->cache, "c", 3);
+    g_assert_cmpuint (lw_resultcache_get_size (fixture->cache), ==, fixture->entry_size * 2);
+
+    g_assert (lw_resultcache_lookup (fixture->cache, "b") == NULL);
+
+    resulttable = lw_resultcache_lookup (fixture->cache, "a");
+    g_assert_cmpuint (resultcache_get_offset (resulttable), ==, 1);
+    g_hash_table_unref (resulttable); resulttable = NULL;
+
+    resulttable = lw_resultcache_lookup (fixture->cache, "c");
+    g_assert_cmpuint (resultcache_get_offset (resulttable), ==, 3);
+    g_hash_table_unref (resulttable); resulttable = NULL;
+
+    //Now a is the oldest
+    resultcache_insert (fixture->cache, "d", 4);
+    g_assert (lw_resultcache_lookup (fixture->cache, "a") == NULL);
+
+    lw_resultcache_clear (fixture->cache);
+    g_assert_cmpuint (lw_resultcache_get_size (fixture->cache), ==, 0);
+    g_assert (lw_resultcache_lookup (fixture->cache, "c") == NULL);
+}
+
+
+void
+resultcache_test_hit_returns_copy (ResultCacheFixture *fixture, gconstpointer data)
+{
+    GHashTable *inserted = NULL;
+    GHashTable *first = NULL;
+    GHashTable *second = NULL;
+
+    //Changing the table after inserting it doesn't change the cache
+    inserted = resultcache_new_resulttable (1);
+    lw_resultcache_insert (fixture->cache, "a", inserted);
+    lw_resultarray_append (LW_RESULTARRAY (g_hash_table_lookup (inserted, "exact")), 2, 5, 0);
+    g_hash_table_unref (inserted); inserted = NULL;
+
+    first = lw_resultcache_lookup (fixture->cache, "a");
+    second = lw_resultcache_lookup (fixture->cache, "a");
+    g_assert (first != NULL && second != NULL);
+    g_assert (first != second);
+    g_assert (g_hash_table_lookup (first, "exact") != g_hash_table_lookup (second, "exact"));
+
+    //Neither does changing what a lookup returned
+    lw_resultarray_append (LW_RESULTARRAY (g_hash_table_lookup (first, "exact")), 2, 5, 0);
+    g_hash_table_unref (first); first = NULL;
+
+    g_assert_cmpuint (resultcache_get_offset (second), ==, 1);
+    g_hash_table_unref (second); second = NULL;
+
+    second = lw_resultcache_lookup (fixture->cache, "a");
+    g_assert_cmpuint (resultcache_get_offset (second), ==, 1);
+    g_hash_table_unref (second); second = NULL;
+}
+
+
+void
+resultcache_test_replace (ResultCacheFixture *fixture, gconstpointer data)
+{
+    GHashTable *resulttable = NULL;
+
+    resultcache_insert (fixture->cache, "a", 1);
+    resultcache_insert (fixture->cache, "b", 2);
+    resultcache_insert (fixture->cache, "a", 3);
+
+    //The old results are dropped rather than counted twice or pushing out b
+    g_assert_cmpuint (lw_resultcache_get_size (fixture->cache), ==, fixture->entry_size * 2);
+
+    resulttable = lw_resultcache_lookup (fixture->cache, "a");
+    g_assert_cmpuint (resultcache_get_offset (resulttable), ==, 3);
+    g_hash_table_unref (resulttable); resulttable = NULL;
+
+    resulttable = lw_resultcache_lookup (fixture->cache, "b");
+    g_assert_cmpuint (resultcache_get_offset (resulttable), ==, 2);
+    g_hash_table_unref (resulttable); resulttable = NULL;
+
+    //Replacing also makes it the most recently used
+    resultcache_insert (fixture->cache, "b", 4);
+    resultcache_insert (fixture->cache, "a", 5);
+    resultcache_insert (fixture->cache, "c", 6);
+    g_assert (lw_resultcache_lookup (fixture->cache, "b") == NULL);
+}
+
+
+void
+resultcache_test_too_big (ResultCacheFixture *fixture, gconstpointer data)
+{
+    LwResultCache *cache = NULL;
+
+    cache = lw_resultcache_new (fixture->entry_size - 1);
+    resultcache_insert (cache, "a", 1);
+    g_assert_cmpuint (lw_resultcache_get_size (cache), ==, 0);
+    g_assert (lw_resultcache_lookup (cache, "a") == NULL);
+    lw_resultcache_free (cache); cache = NULL;
+}
+
+
+void
+resultcache_test_refinable (ResultCacheFixture *fixture, gconstpointer data)
+{
+    GHashTable *resulttable = NULL;
+
+    resultcache_insert (fixture->cache, "E:ta", 1);
+    resultcache_insert (fixture->cache, "E:tabe", 2);
+
+    //The longest query the new one grew from
+    resulttable = lw_resultcache_lookup_refinable (fixture->cache, "E:taberu", 2);
+    g_assert_cmpuint (resultcache_get_offset (resulttable), ==, 2);
+    g_hash_table_unref (resulttable); resulttable = NULL;
+
+    //Not itself and not from a different prefix
+    resulttable = lw_resultcache_lookup_refinable (fixture->cache, "E:tabe", 2);
+    g_assert_cmpuint (resultcache_get_offset (resulttable), ==, 1);
+    g_hash_table_unref (resulttable); resulttable = NULL;
+
+    g_assert (lw_resultcache_lookup_refinable (fixture->cache, "J:taberu", 2) == NULL);
+}
+
+
+gint
+main (gint argc, gchar *argv[])
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add ("/libwaei/resultcache/eviction_order", ResultCacheFixture, NULL, resultcache_test_setup, resultcache_test_eviction_order, resultcache_test_teardown);
+    g_test_add ("/libwaei/resultcache/hit_returns_copy", ResultCacheFixture, NULL, resultcache_test_setup, resultcache_test_hit_returns_copy, resultcache_test_teardown);
+    g_test_add ("/libwaei/resultcache/replace", ResultCacheFixture, NULL, resultcache_test_setup, resultcache_test_replace, resultcache_test_teardown);
+    g_test_add ("/libwaei/resultcache/too_big", ResultCacheFixture, NULL, resultcache_test_setup, resultcache_test_too_big, resultcache_test_teardown);
+    g_test_add ("/libwaei/resultcache/refinable", ResultCacheFixture, NULL, resultcache_test_setup, resultcache_test_refinable, resultcache_test_teardown);
+
+    return g_test_run();
+}
@@ -0,0 +1,217 @@
+#include <string.h>
+#include <glib.h>
+#include <libwaei/libwaei.h>
+
+/*
+  Methods tested
+
+  lw_romaji_converter_feed
+  lw_romaji_converter_finish
+  lw_romaji_converter_get_kana
+  lw_romaji_to_kana
+  lw_romaji_get_readings
+*/
+
+struct _RomajiCase {
+  const gchar *ROMAJI;
+  const gchar *KANA;
+};
+typedef struct _RomajiCase RomajiCase;
+
+struct _RomajiFixture {
+  LwRomajiConverter converter;
+  gchar kana[LW_ROMAJI_BUFFER_SIZE];
+};
+typedef struct _RomajiFixture RomajiFixture;
+
+
+static const RomajiCase _long_vowels[] = {
+  { "toukyou", "とうきょう" },
+  { "okaasan", "おかあさん" },
+  { "oniisan", "おにいさん" },
+  { "ooki", "おおき" },
+  { "ra-men", "らーめん" },
+  { "su-pa-", "すーぱー" },
+  { NULL, NULL }
+};
+
+static const RomajiCase _small_tsu[] = {
+  { "kitte", "きって" },
+  { "zasshi", "ざっし" },
+  { "matcha", "まっちゃ" },
+  { "kocchi", "こっち" },
+  { "roppyaku", "ろっぴゃく" },
+  { "xtsu", "っ" },
+  { NULL, NULL }
+};
+
+static const RomajiCase _n[] = {
+  { "kan'i", "かんい" },
+  { "kani", "かに" },
+  { "hon'ya", "ほんや" },
+  { "honya", "ほにゃ" },
+  { "shinbun", "しんぶん" },
+  { "konnichiha", "こんにちは" },
+  { "onna", "おんな" },
+  { "hon", "ほん" },
+  { NULL, NULL }
+};
+
+static const RomajiCase _katakana[] = {
+  { "ko-hi-", "コーヒー" },
+  { "kitto", "キット" },
+  { "pan", "パン" },
+  { NULL, NULL }
+};
+
+static const gchar *_invalid[] = {
+  "q",
+  "kq",
+  "x",
+  "hello world",
+  "ka1",
+  "tsuq",
+  NULL
+};
+
+
+void
+romaji_test_setup (RomajiFixture *fixture, gconstpointer data)
+{
+    memset(fixture, 0, sizeof(RomajiFixture));
+}
+
+
+void
+romaji_test_teardown (RomajiFixture *fixture, gconstpointer data)
+{
+}
+
+
+static void
+romaji_assert_cases (RomajiFixture    *fixture,
+                     const RomajiCase *CASES,
+                     LwRomajiFlag      flags)
+{
+    const RomajiCase *c = NULL;
+
+    for (c = CASES; c->ROMAJI != NULL; c++)
+    {
+      g_assert (lw_romaji_to_kana (c->ROMAJI, flags, fixture->kana, LW_ROMAJI_BUFFER_SIZE));
+      g_assert_cmpstr (fixture->kana, ==, c->KANA);
+    }
+}
+
+
+void
+romaji_test_long_vowels (RomajiFixture *fixture, gconstpointer data)
+{
+    romaji_assert_cases (fixture, _long_vowels, 0);
+}
+
+
+void
+romaji_test_small_tsu (RomajiFixture *fixture, gconstpointer data)
+{
+    romaji_assert_cases (fixture, _small_tsu, 0);
+}
+
+
+void
+romaji_test_n (RomajiFixture *fixture, gconstpointer data)
+{
+    romaji_assert_cases (fixture, _n, 0);
+}
+
+
+void
+romaji_test_katakana (RomajiFixture *fixture, gconstpointer data)
+{
+    romaji_assert_cases (fixture, _katakana, LW_ROMAJI_FLAG_KATAKANA);
+}
+
+
+void
+romaji_test_invalid (RomajiFixture *fixture, gconstpointer data)
+{
+    const gchar **ROMAJI = NULL;
+
+    for (ROMAJI = _invalid; *ROMAJI != NULL; ROMAJI++)
+    {
+      g_assert (!lw_romaji_to_kana (*ROMAJI, 0, fixture->kana, LW_ROMAJI_BUFFER_SIZE));
+      g_assert (lw_romaji_get_readings (*ROMAJI, 0, LW_ROMAJI_MAX_READINGS) == NULL);
+    }
+
+    //A failed converter stays failed
+    lw_romaji_converter_init (&fixture->converter, 0, 0);
+    g_assert (!lw_romaji_converter_feed (&fixture->converter, "kaq", -1));
+    g_assert (!lw_romaji_converter_feed (&fixture->converter, "ka", -1));
+    g_assert (!lw_romaji_converter_finish (&fixture->converter));
+}
+
+
+void
+romaji_test_incremental (RomajiFixture *fixture, gconstpointer data)
+{
+    const RomajiCase *c = NULL;
+    gint i = 0;
+
+    //Fed a character at a time, as the user types
+    for (c = _small_tsu; c->ROMAJI != NULL; c++)
+    {
+      lw_romaji_converter_init (&fixture->converter, 0, 0);
+      for (i = 0; c->ROMAJI[i] != '\0'; i++)
+      {
+        g_assert (lw_romaji_converter_feed (&fixture->converter, c->ROMAJI + i, 1));
+      }
+      g_assert (lw_romaji_converter_finish (&fixture->converter));
+      g_assert_cmpstr (lw_romaji_converter_get_kana (&fixture->converter), ==, c->KANA);
+    }
+
+    //A trailing n waits to see what follows it
+    lw_romaji_converter_init (&fixture->converter, 0, 0);
+    g_assert (lw_romaji_converter_feed (&fixture->converter, "kan", -1));
+    g_assert_cmpstr (lw_romaji_converter_get_kana (&fixture->converter), ==, "か");
+    g_assert (lw_romaji_converter_feed (&fixture->converter, "a", -1));
+    g_assert (lw_romaji_converter_finish (&fixture->converter));
+    g_assert_cmpstr (lw_romaji_converter_get_kana (&fixture->converter), ==, "かな");
+}
+
+
+void
+romaji_test_readings (RomajiFixture *fixture, gconstpointer data)
+{
+    gchar **readings = NULL;
+
+    readings = lw_romaji_get_readings ("kinen", 0, LW_ROMAJI_MAX_READINGS);
+    g_assert (readings != NULL);
+    g_assert_cmpint (g_strv_length (readings), ==, 2);
+    g_assert_cmpstr (readings[0], ==, "きねん");
+    g_assert_cmpstr (readings[1], ==, "きんえん");
+    g_strfreev (readings); readings = NULL;
+
+    //Nothing before it to split from
+    readings = lw_romaji_get_readings ("nani", 0, LW_ROMAJI_MAX_READINGS);
+    g_assert (readings != NULL);
+    g_assert_cmpint (g_strv_length (readings), ==, 2);
+    g_assert_cmpstr (readings[0], ==, "なに");
+    g_assert_cmpstr (readings[1], ==, "なんい");
+    g_strfreev (readings); readings = NULL;
+}
+
+
+gint
+main (gint argc, gchar *argv[])
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add ("/libwaei/romaji/long_vowels", RomajiFixture, NULL, romaji_test_setup, romaji_test_long_vowels, romaji_test_teardown);
+    g_test_add ("/libwaei/romaji/small_tsu", RomajiFixture, NULL, romaji_test_setup, romaji_test_small_tsu, romaji_test_teardown);
+    g_test_add ("/libwaei/romaji/n", RomajiFixture, NULL, romaji_test_setup, romaji_test_n, romaji_test_teardown);
+    g_test_add ("/libwaei/romaji/katakana", RomajiFixture, NULL, romaji_test_setup, romaji_test_katakana, romaji_test_teardown);
+    g_test_add ("/libwaei/romaji/invalid", RomajiFixture, NULL, romaji_test_setup, romaji_test_invalid, romaji_test_teardown);
+    g_test_add ("/libwaei/romaji/incremental", RomajiFixture, NULL, romaji_test_setup, romaji_test_incremental, romaji_test_teardown);
+    g_test_add ("/libwaei/romaji/readings", RomajiFixture, NULL, romaji_test_setup, romaji_test_readings, romaji_test_teardown);
+
+    return g_test_run();
+}
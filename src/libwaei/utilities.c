@@ -468,483 +468,14 @@ lw_util_str_shift_kata_to_hira (char input[])
 }
 
 
-//!
-//! @brief Gets the next hiragana equivalent char pointer in a string
-//!
-//! This function returns the hiragana equivalent and skips the romanji equivalent
-//! forward in the string.  This function is used for romaji->hiragana conversions.
-//!
-//! @param input The string to jump around
-//! @return where the next hiragana equivalent character would start
-//!
-const char* 
-lw_util_next_hira_char_from_roma (const char *input)
-{
-    const char *input_ptr;
-    input_ptr = input;
-
-    int total_n = 0;
-
-    //Cautiously up a character
-    if (*input_ptr == 'n')
-      total_n++;
-    if (*input_ptr != '\0')
-      input_ptr++;
-    if (*input_ptr == '\0')
-      return input_ptr;
-
-    //Loop until we hit a hiragana character ending
-    while ( (
-            //General conditional for hiragana processing
-              *(input_ptr    ) != '\0' &&
-              *(input_ptr - 1) != 'a'  &&
-              *(input_ptr - 1) != 'i'  &&
-              *(input_ptr - 1) != 'u'  &&
-              *(input_ptr - 1) != 'e'  &&
-              *(input_ptr - 1) != 'o'  &&
-              *(input_ptr - 1) != *input_ptr  &&
-              *(input_ptr - 1) != '-'  &&
-              total_n < 3
-            ) ||
-            //Special conditional for symbolic n processing
-            (
-              *(input_ptr    ) != '\0' &&
-              *(input_ptr - 1) == 'n'  &&
-              *(input_ptr    ) == 'n'  &&
-              total_n < 3
-            )
-          )
-    {
-      //Update the n count
-      if (*(input_ptr - 1) == 'n')
-        total_n++;
-      else
-        total_n = 0;
-
-
-      if (*(input_ptr - 1) == 'n' &&
-              *(input_ptr) != 'a'  &&
-              *(input_ptr) != 'i'  &&
-              *(input_ptr) != 'u'  &&
-              *(input_ptr) != 'e'  &&
-              *(input_ptr) != 'o'  &&
-              *(input_ptr) != 'y'
-         )
-        break;
-
-      //Increment
-      input_ptr++;
-    }
-    if (*(input_ptr - 1) == 'n' &&
-            *(input_ptr) == 'n'
-       )
-      input_ptr++;
-
-
-    return input_ptr;
-}
-
-
-//!
-//! @brief Converts a romaji string to hiragana.
-//! @param input The source romaji string
-//! @param output The string to write the hiragana equivalent to
-//! @return Returns null on error/end
-//!
-gchar* 
-lw_util_roma_char_to_hira (const gchar *input, gchar *output)
-{
-    //Set up the input pointer
-    const char *input_ptr;
-    input_ptr = input;
-
-    //Make sure the output pointer is initialized
-    output[0] = '\0';
-    
-    //Set up the buffer variables
-    char buffer[] = "           ";
-    char *buffer_ptr = buffer;
-
-    //Copy the next hiragana char written in romaji to the buffer
-    while ( 
-            (
-              *input_ptr != '\0' &&
-              *input_ptr != 'a'  &&
-              *input_ptr != 'i'  &&
-              *input_ptr != 'u'  &&
-              *input_ptr != 'e'  &&
-              *input_ptr != 'o'  &&
-              *input_ptr != '-'  && 
-              *input_ptr != *(input_ptr + 1)  && 
-              *(buffer_ptr + 1) == ' '                
-            ) 
-          )
-    {
-      *buffer_ptr = *input_ptr;
-      input_ptr++;
-      buffer_ptr++;
-    }
-    *buffer_ptr = *input_ptr;
-    buffer_ptr++;
-    *buffer_ptr = '\0';
-
-    //HACK!!!!!!!!!!!!!!!!
-    if (buffer[0] == 'n' &&
-              buffer[1] != 'a'  &&
-              buffer[1] != 'i'  &&
-              buffer[1] != 'u'  &&
-              buffer[1] != 'e'  &&
-              buffer[1] != 'o'  &&
-              buffer[1] != 'y'
-       )
-    {
-       buffer[1] = '\0';
-    }
-    else if ( buffer[0] != 'a'  &&
-              buffer[0] != 'i'  &&
-              buffer[0] != 'u'  &&
-              buffer[0] != 'e'  &&
-              buffer[0] != 'o'  &&
-              buffer[0] != 'n'  &&
-              strlen(input) == 1
-            )
-    {
-       return NULL;
-    }
-    //HACK!!!!!!!!!!!!!!!!
-
-
-    //Reset the buffer pointer
-    buffer_ptr = buffer;
-
-
-    //
-    //Start main lookup for conversion
-    //
-
-    if (strcmp(buffer_ptr, "n") == 0)
-       strcpy(output, "ん");
-
-
-    else if (strlen(buffer_ptr) == 1 &&
-             buffer_ptr[0] != 'a'    &&
-             buffer_ptr[0] != 'i'    &&
-             buffer_ptr[0] != 'u'    &&
-             buffer_ptr[0] != 'e'    &&
-             buffer_ptr[0] != 'o'    &&
-             buffer_ptr[0] != '-'    &&
-             buffer_ptr[0] != 'y'    &&
-             input_ptr[1] != '\0'      )
-       strcpy(output, "っ");
-
-    else if (strcmp(buffer_ptr, "a") == 0)
-       strcpy(output, "あ");
-    else if (strcmp(buffer_ptr, "i") == 0)
-       strcpy(output, "い");
-    else if (strcmp(buffer_ptr, "u") == 0)
-       strcpy(output, "う");
-    else if (strcmp(buffer_ptr, "e") == 0)
-       strcpy(output, "え");
-    else if (strcmp(buffer_ptr, "o") == 0)
-       strcpy(output, "お");
-
-
-    else if (strcmp(buffer_ptr, "ka") == 0 || strcmp(buffer_ptr, "ca") == 0)
-       strcpy(output, "か");
-    else if (strcmp(buffer_ptr, "ki") == 0 || strcmp(buffer_ptr, "ci") == 0)
-       strcpy(output, "き");
-    else if (strcmp(buffer_ptr, "ku") == 0 || strcmp(buffer_ptr, "cu") == 0)
-       strcpy(output, "く");
-    else if (strcmp(buffer_ptr, "ke") == 0 || strcmp(buffer_ptr, "ce") == 0)
-       strcpy(output, "け");
-    else if (strcmp(buffer_ptr, "ko") == 0 || strcmp(buffer_ptr, "co") == 0)
-       strcpy(output, "こ");
-
-    else if (strcmp(buffer_ptr, "kya") == 0 || strcmp(buffer_ptr, "cya") == 0)
-       strcpy(output, "きゃ");
-    else if (strcmp(buffer_ptr, "kyu") == 0 || strcmp(buffer_ptr, "cyu") == 0)
-       strcpy(output, "きゅ");
-    else if (strcmp(buffer_ptr, "kyo") == 0 || strcmp(buffer_ptr, "cyo") == 0)
-       strcpy(output, "きょ");
-
-    else if (strcmp(buffer_ptr, "ga") == 0)
-       strcpy(output, "が");
-    else if (strcmp(buffer_ptr, "gi") == 0)
-       strcpy(output, "ぎ");
-    else if (strcmp(buffer_ptr, "gu") == 0)
-       strcpy(output, "ぐ");
-    else if (strcmp(buffer_ptr, "ge") == 0)
-       strcpy(output, "げ");
-    else if (strcmp(buffer_ptr, "go") == 0)
-       strcpy(output, "ご");
-
-    else if (strcmp(buffer_ptr, "gya") == 0)
-       strcpy(output, "ぎゃ");
-    else if (strcmp(buffer_ptr, "gyu") == 0)
-       strcpy(output, "ぎゅ");
-    else if (strcmp(buffer_ptr, "gyo") == 0)
-       strcpy(output, "ぎょ");
-
-
-    else if (strcmp(buffer_ptr, "sa") == 0)
-       strcpy(output, "さ");
-    else if (strcmp(buffer_ptr, "si") == 0 || strcmp(buffer_ptr, "shi") == 0)
-       strcpy(output, "し");
-    else if (strcmp(buffer_ptr, "su") == 0)
-       strcpy(output, "す");
-    else if (strcmp(buffer_ptr, "se") == 0)
-       strcpy(output, "せ");
-    else if (strcmp(buffer_ptr, "so") == 0)
-       strcpy(output, "そ");
-
-    else if (strcmp(buffer_ptr, "sya") == 0 || strcmp(buffer_ptr, "sha") == 0)
-       strcpy(output, "しゃ");
-    else if (strcmp(buffer_ptr, "syu") == 0 || strcmp(buffer_ptr, "shu") == 0)
-       strcpy(output, "しゅ");
-    else if (strcmp(buffer_ptr, "syo") == 0 || strcmp(buffer_ptr, "sho") == 0)
-       strcpy(output, "しょ");
-
-    else if (strcmp(buffer_ptr, "za") == 0)
-       strcpy(output, "ざ");
-    else if (strcmp(buffer_ptr, "zi") == 0 || strcmp(buffer_ptr, "ji") == 0)
-       strcpy(output, "じ");
-    else if (strcmp(buffer_ptr, "zu") == 0)
-       strcpy(output, "ず");
-    else if (strcmp(buffer_ptr, "ze") == 0)
-       strcpy(output, "ぜ");
-    else if (strcmp(buffer_ptr, "zo") == 0)
-       strcpy(output, "ぞ");
-
-    else if (strcmp(buffer_ptr, "zya") == 0 || strcmp(buffer_ptr, "jya") == 0
-                                            || strcmp(buffer_ptr, "ja" ) == 0 )
-       strcpy(output, "じゃ");
-    else if (strcmp(buffer_ptr, "zyu") == 0 || strcmp(buffer_ptr, "jyu") == 0
-                                            || strcmp(buffer_ptr, "ju" ) == 0 )
-       strcpy(output, "じゅ");
-    else if (strcmp(buffer_ptr, "zyo") == 0 || strcmp(buffer_ptr, "jyo") == 0
-                                            || strcmp(buffer_ptr, "jo" ) == 0 )
-       strcpy(output, "じょ");
-
-
-    else if (strcmp(buffer_ptr, "ta") == 0)
-       strcpy(output, "た");
-    else if (strcmp(buffer_ptr, "ti") == 0 || strcmp(buffer_ptr, "chi") == 0)
-       strcpy(output, "ち");
-    else if (strcmp(buffer_ptr, "tu") == 0 || strcmp(buffer_ptr, "tsu") == 0)
-       strcpy(output, "つ");
-    else if (strcmp(buffer_ptr, "te") == 0)
-       strcpy(output, "て");
-    else if (strcmp(buffer_ptr, "to") == 0)
-       strcpy(output, "と");
-
-    else if (strcmp(buffer_ptr, "tya") == 0 || strcmp(buffer_ptr, "cha") == 0)
-       strcpy(output, "ちゃ");
-    else if (strcmp(buffer_ptr, "tyu") == 0 || strcmp(buffer_ptr, "chu") == 0)
-       strcpy(output, "ちゅ");
-    else if (strcmp(buffer_ptr, "tyo") == 0 || strcmp(buffer_ptr, "cho") == 0)
-       strcpy(output, "ちょ");
-
-    else if (strcmp(buffer_ptr, "da") == 0)
-       strcpy(output, "だ");
-    else if (strcmp(buffer_ptr, "di") == 0)
-       strcpy(output, "ぢ");
-    else if (strcmp(buffer_ptr, "du") == 0 || strcmp(buffer_ptr, "dsu") == 0)
-       strcpy(output, "づ");
-    else if (strcmp(buffer_ptr, "de") == 0)
-       strcpy(output, "で");
-    else if (strcmp(buffer_ptr, "do") == 0)
-       strcpy(output, "ど");
-
-    else if (strcmp(buffer_ptr, "dya") == 0)
-       strcpy(output, "ぢゃ");
-    else if (strcmp(buffer_ptr, "dyu") == 0)
-       strcpy(output, "ぢゅ");
-    else if (strcmp(buffer_ptr, "dyo") == 0)
-       strcpy(output, "ぢょ");
-
-
-    else if (strcmp(buffer_ptr, "na") == 0)
-       strcpy(output, "な");
-    else if (strcmp(buffer_ptr, "ni") == 0)
-       strcpy(output, "に");
-    else if (strcmp(buffer_ptr, "nu") == 0)
-       strcpy(output, "ぬ");
-    else if (strcmp(buffer_ptr, "ne") == 0)
-       strcpy(output, "ね");
-    else if (strcmp(buffer_ptr, "no") == 0)
-       strcpy(output, "の");
-
-    else if (strcmp(buffer_ptr, "nya") == 0)
-       strcpy(output, "にゃ");
-    else if (strcmp(buffer_ptr, "nyu") == 0)
-       strcpy(output, "にゅ");
-    else if (strcmp(buffer_ptr, "nyo") == 0)
-       strcpy(output, "にょ");
-
-
-    else if (strcmp(buffer_ptr, "ha") == 0)
-       strcpy(output, "は");
-    else if (strcmp(buffer_ptr, "hi") == 0)
-       strcpy(output, "ひ");
-    else if (strcmp(buffer_ptr, "hu") == 0 || strcmp(buffer_ptr, "fu") == 0)
-       strcpy(output, "ふ");
-    else if (strcmp(buffer_ptr, "he") == 0)
-       strcpy(output, "へ");
-    else if (strcmp(buffer_ptr, "ho") == 0)
-       strcpy(output, "ほ");
-
-    else if (strcmp(buffer_ptr, "hya") == 0)
-       strcpy(output, "ひゃ");
-    else if (strcmp(buffer_ptr, "hyu") == 0)
-       strcpy(output, "ひゅ");
-    else if (strcmp(buffer_ptr, "hyo") == 0)
-       strcpy(output, "ひょ");
-   
-    else if (strcmp(buffer_ptr, "ba") == 0)
-       strcpy(output, "ば");
-    else if (strcmp(buffer_ptr, "bi") == 0)
-       strcpy(output, "び");
-    else if (strcmp(buffer_ptr, "bu") == 0)
-       strcpy(output, "ぶ");
-    else if (strcmp(buffer_ptr, "be") == 0)
-       strcpy(output, "べ");
-    else if (strcmp(buffer_ptr, "bo") == 0)
-       strcpy(output, "ぼ");
-
-    else if (strcmp(buffer_ptr, "bya") == 0)
-       strcpy(output, "びゃ");
-    else if (strcmp(buffer_ptr, "byu") == 0)
-       strcpy(output, "びゅ");
-    else if (strcmp(buffer_ptr, "byo") == 0)
-       strcpy(output, "びょ");
-
-    else if (strcmp(buffer_ptr, "pa") == 0)
-       strcpy(output, "ぱ");
-    else if (strcmp(buffer_ptr, "pi") == 0)
-       strcpy(output, "ぴ");
-    else if (strcmp(buffer_ptr, "pu") == 0)
-       strcpy(output, "ぷ");
-    else if (strcmp(buffer_ptr, "pe") == 0)
-       strcpy(output, "ぺ");
-    else if (strcmp(buffer_ptr, "po") == 0)
-       strcpy(output, "ぽ");
-
-    else if (strcmp(buffer_ptr, "pya") == 0)
-       strcpy(output, "ぴゃ");
-    else if (strcmp(buffer_ptr, "pyu") == 0)
-       strcpy(output, "ぴゅ");
-    else if (strcmp(buffer_ptr, "pyo") == 0)
-       strcpy(output, "ぴょ");
-
-
-    else if (strcmp(buffer_ptr, "ma") == 0)
-       strcpy(output, "ま");
-    else if (strcmp(buffer_ptr, "mi") == 0)
-       strcpy(output, "み");
-    else if (strcmp(buffer_ptr, "mu") == 0)
-       strcpy(output, "む");
-    else if (strcmp(buffer_ptr, "me") == 0)
-       strcpy(output, "め");
-    else if (strcmp(buffer_ptr, "mo") == 0)
-       strcpy(output, "も");
-
-    else if (strcmp(buffer_ptr, "mya") == 0)
-       strcpy(output, "みゃ");
-    else if (strcmp(buffer_ptr, "myu") == 0)
-       strcpy(output, "みゅ");
-    else if (strcmp(buffer_ptr, "myo") == 0)
-       strcpy(output, "みょ");
-
-
-    else if (strcmp(buffer_ptr, "ya") == 0)
-       strcpy(output, "や");
-    else if (strcmp(buffer_ptr, "yu") == 0)
-       strcpy(output, "ゆ");
-    else if (strcmp(buffer_ptr, "yo") == 0)
-       strcpy(output, "よ");
-
-
-    else if (strcmp(buffer_ptr, "ra") == 0 || strcmp(buffer_ptr, "la") == 0)
-       strcpy(output, "ら");
-    else if (strcmp(buffer_ptr, "ri") == 0 || strcmp(buffer_ptr, "li") == 0)
-       strcpy(output, "り");
-    else if (strcmp(buffer_ptr, "ru") == 0 || strcmp(buffer_ptr, "lu") == 0)
-       strcpy(output, "る");
-    else if (strcmp(buffer_ptr, "re") == 0 || strcmp(buffer_ptr, "le") == 0)
-       strcpy(output, "れ");
-    else if (strcmp(buffer_ptr, "ro") == 0 || strcmp(buffer_ptr, "lo") == 0)
-       strcpy(output, "ろ");
-
-    else if (strcmp(buffer_ptr, "rya") == 0 || strcmp(buffer_ptr, "lya") == 0)
-       strcpy(output, "りゃ");
-    else if (strcmp(buffer_ptr, "ryu") == 0 || strcmp(buffer_ptr, "lyu") == 0)
-       strcpy(output, "りゅ");
-    else if (strcmp(buffer_ptr, "ryo") == 0 || strcmp(buffer_ptr, "lyo") == 0)
-       strcpy(output, "りょ");
-
-
-    else if (strcmp(buffer_ptr, "wa") == 0)
-       strcpy(output, "わ");
-    else if (strcmp(buffer_ptr, "wi") == 0)
-       strcpy(output, "うぃ");
-    else if (strcmp(buffer_ptr, "we") == 0)
-       strcpy(output, "うぇ");
-    else if (strcmp(buffer_ptr, "wo") == 0)
-       strcpy(output, "を");
-
-    else if (strcmp(buffer_ptr, "va") == 0)
-       strcpy(output, "う゛ぁ");
-    else if (strcmp(buffer_ptr, "vi") == 0)
-       strcpy(output, "う゛ぃ");
-    else if (strcmp(buffer_ptr, "ve") == 0)
-       strcpy(output, "う゛ぇ");
-    else if (strcmp(buffer_ptr, "vo") == 0)
-       strcpy(output, "う゛ぉ");
-
-
-    else if (strcmp(buffer_ptr, "xa") == 0)
-       strcpy(output, "ぁ");
-    else if (strcmp(buffer_ptr, "xi") == 0)
-       strcpy(output, "ぃ");
-    else if (strcmp(buffer_ptr, "xu") == 0)
-       strcpy(output, "ぅ");
-    else if (strcmp(buffer_ptr, "xe") == 0)
-       strcpy(output, "ぇ");
-    else if (strcmp(buffer_ptr, "xo") == 0)
-       strcpy(output, "ぉ");
-
-
-    else if (strcmp(buffer_ptr, "fa") == 0)
-       strcpy(output, "ふぁ");
-    else if (strcmp(buffer_ptr, "fi") == 0)
-       strcpy(output, "ふぃ");
-    else if (strcmp(buffer_ptr, "fe") == 0)
-       strcpy(output, "ふぇ");
-    else if (strcmp(buffer_ptr, "fo") == 0)
-       strcpy(output, "ふぉ");
-   
-
-    else if (strcmp(buffer_ptr, "-") == 0)
-       strcpy(output, "ー");
-
-    else
-    {
-      input_ptr = NULL;
-      return NULL;
-    }
-
-    return output;
-}
-
-
 //!
 //! @brief Convenience function to convert romaji to hiragana
 //!
-//! @param input The string to shift.
+//! @param input The string to convert.
 //! @param output the string to output the changes to.
 //! @param max The max length of the string to output to.
-//! @see lw_util_shift_kana_chars_in_str_by ()
-//! @see lw_util_str_shift_hira_to_kata ()
+//! @returns TRUE if all of the input was romaji
+//! @see lw_romaji_to_kana ()
 //!
 gboolean 
 lw_util_str_roma_to_hira (const gchar* input, gchar* output, gint max)
@@ -953,31 +484,7 @@ lw_util_str_roma_to_hira (const gchar* input, gchar* output, gint max)
     g_return_val_if_fail (input != NULL, FALSE);
     g_return_val_if_fail (output != NULL, FALSE);
 
-    //Declarations
-    const gchar *input_ptr;
-    gchar *kana_ptr;
-    gint leftover;
-
-    //Initializations
-    input_ptr = input;
-    kana_ptr = output;
-    *kana_ptr = '\0';
-    leftover = max;
-
-    //Try converting to hiragana
-    while (leftover-- > 0)
-    {
-      kana_ptr = lw_util_roma_char_to_hira (input_ptr, kana_ptr);
-      if (kana_ptr == NULL || input_ptr == NULL)
-        break;
-      input_ptr = lw_util_next_hira_char_from_roma (input_ptr);
-      if (kana_ptr == NULL || input_ptr == NULL)
-        break;
-
-      kana_ptr = &kana_ptr[strlen(kana_ptr)];
-    }
-
-    return (input_ptr != NULL && strlen (input_ptr) == 0);
+    return lw_romaji_to_kana (input, 0, output, max);
 }
 
 
@@ -1026,22 +533,170 @@ lw_util_sanitize_string (gchar *buffer)
 
 
 //!
-//! @brief Will change a query into a & delimited set of tokens (logical and)
+//! @brief Katakana to hiragana folding for U+3040 to U+30FF.  Zero marks the characters
+//!        that NFKC would change (the combining and standalone voicing marks and the
+//!        ゟ and ヿ digraphs) or that are unassigned, so they take the slow path.  Small
+//!        っ and ッ fold to つ.
 //!
-gchar*
-lw_util_normalize_string (const gchar        *TEXT,
-                          gboolean            make_case_insensitive,
-                          gboolean            make_furigana_insensitive)
+static const guint16 _lw_util_kana_table[0x30FF - 0x3040 + 1] = {
+      0x0000, 0x3041, 0x3042, 0x3043, 0x3044, 0x3045, 0x3046, 0x3047,  //U+3040
+      0x3048, 0x3049, 0x304A, 0x304B, 0x304C, 0x304D, 0x304E, 0x304F,  //U+3048
+      0x3050, 0x3051, 0x3052, 0x3053, 0x3054, 0x3055, 0x3056, 0x3057,  //U+3050
+      0x3058, 0x3059, 0x305A, 0x305B, 0x305C, 0x305D, 0x305E, 0x305F,  //U+3058
+      0x3060, 0x3061, 0x3062, 0x3064, 0x3064, 0x3065, 0x3066, 0x3067,  //U+3060
+      0x3068, 0x3069, 0x306A, 0x306B, 0x306C, 0x306D, 0x306E, 0x306F,  //U+3068
+      0x3070, 0x3071, 0x3072, 0x3073, 0x3074, 0x3075, 0x3076, 0x3077,  //U+3070
+      0x3078, 0x3079, 0x307A, 0x307B, 0x307C, 0x307D, 0x307E, 0x307F,  //U+3078
+      0x3080, 0x3081, 0x3082, 0x3083, 0x3084, 0x3085, 0x3086, 0x3087,  //U+3080
+      0x3088, 0x3089, 0x308A, 0x308B, 0x308C, 0x308D, 0x308E, 0x308F,  //U+3088
+      0x3090, 0x3091, 0x3092, 0x3093, 0x3094, 0x3095, 0x3096, 0x0000,  //U+3090
+      0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x309D, 0x309E, 0x0000,  //U+3098
+      0x30A0, 0x3041, 0x3042, 0x3043, 0x3044, 0x3045, 0x3046, 0x3047,  //U+30A0
+      0x3048, 0x3049, 0x304A, 0x304B, 0x304C, 0x304D, 0x304E, 0x304F,  //U+30A8
+      0x3050, 0x3051, 0x3052, 0x3053, 0x3054, 0x3055, 0x3056, 0x3057,  //U+30B0
+      0x3058, 0x3059, 0x305A, 0x305B, 0x305C, 0x305D, 0x305E, 0x305F,  //U+30B8
+      0x3060, 0x3061, 0x3062, 0x3064, 0x3064, 0x3065, 0x3066, 0x3067,  //U+30C0
+      0x3068, 0x3069, 0x306A, 0x306B, 0x306C, 0x306D, 0x306E, 0x306F,  //U+30C8
+      0x3070, 0x3071, 0x3072, 0x3073, 0x3074, 0x3075, 0x3076, 0x3077,  //U+30D0
+      0x3078, 0x3079, 0x307A, 0x307B, 0x307C, 0x307D, 0x307E, 0x307F,  //U+30D8
+      0x3080, 0x3081, 0x3082, 0x3083, 0x3084, 0x3085, 0x3086, 0x3087,  //U+30E0
+      0x3088, 0x3089, 0x308A, 0x308B, 0x308C, 0x308D, 0x308E, 0x308F,  //U+30E8
+      0x3090, 0x3091, 0x3092, 0x3093, 0x3094, 0x3095, 0x3096, 0x30F7,  //U+30F0
+      0x30F8, 0x30F9, 0x30FA, 0x30FB, 0x30FC, 0x309D, 0x309E, 0x0000,  //U+30F8
+};
+
+
+//!
+//! @brief Returns the width folded character for the U+3000 and U+FF00 blocks or 0 when
+//!        the character needs the slow path.  Only fullwidth ASCII and the ideographic
+//!        space fold to a single character without composing.
+//!
+static inline gunichar
+_lw_util_widthfold (gunichar c)
 {
-    //Sanity checks
-    g_return_val_if_fail (TEXT != NULL, NULL);
+    if (c >= 0xFF01 && c <= 0xFF5E) return c - 0xFEE0;
+    if (c == 0x3000) return ' ';
+    return 0;
+}
+
+
+static inline void
+_lw_util_put_bmp_char (gunichar c, gchar *output)
+{
+    output[0] = 0xE0 | (c >> 12);
+    output[1] = 0x80 | ((c >> 6) & 0x3F);
+    output[2] = 0x80 | (c & 0x3F);
+}
 
+
+//!
+//! @brief Copies a pure ASCII string eight bytes at a time, lowercasing it if asked to.
+//!        NFKC leaves ASCII alone, so this is the whole normalization for it.
+//! @returns FALSE as soon as a non-ASCII byte is found
+//!
+static gboolean
+_lw_util_normalize_ascii (const gchar *TEXT,
+                          gint         length,
+                          gboolean     make_case_insensitive,
+                          gchar       *output)
+{
+    //Declarations
+    const guint64 HIGH_BITS = G_GUINT64_CONSTANT (0x8080808080808080);
+    const guint64 BELOW_A = G_GUINT64_CONSTANT (0x3F3F3F3F3F3F3F3F);
+    const guint64 ABOVE_Z = G_GUINT64_CONSTANT (0x2525252525252525);
+    guint64 word = 0;
+    guint64 upper = 0;
+    gint i = 0;
+
+    for (i = 0; i + (gint) sizeof(word) <= length; i += sizeof(word))
+    {
+      memcpy(&word, TEXT + i, sizeof(word));
+      if ((word & HIGH_BITS) != 0) return FALSE;
+      if (make_case_insensitive)
+      {
+        upper = (word + BELOW_A) & ~(word + ABOVE_Z) & HIGH_BITS;
+        word |= upper >> 2;
+      }
+      memcpy(output + i, &word, sizeof(word));
+    }
+
+    for (; i < length; i++)
+    {
+      if ((guchar) TEXT[i] & 0x80) return FALSE;
+      output[i] = (make_case_insensitive) ? g_ascii_tolower (TEXT[i]) : TEXT[i];
+    }
+    output[length] = '\0';
+
+    return TRUE;
+}
+
+
+//!
+//! @brief Normalizes strings made of ASCII, kana and fullwidth ASCII with table lookups.
+//!        The output is never longer than the input.
+//! @returns The length written to output or -1 if the string needs the slow path
+//!
+static gint
+_lw_util_normalize_kana (const gchar *TEXT,
+                         gint         length,
+                         gboolean     make_case_insensitive,
+                         gboolean     make_furigana_insensitive,
+                         gchar       *output)
+{
+    //Declarations
+    const guchar *ptr = (const guchar*) TEXT;
+    const guchar *end = ptr + length;
+    gchar *o = output;
+    gunichar c = 0;
+    gunichar folded = 0;
+
+    while (ptr < end)
+    {
+      if (*ptr < 0x80)
+      {
+        *(o++) = (make_case_insensitive) ? g_ascii_tolower (*ptr) : *ptr;
+        ptr++;
+        continue;
+      }
+
+      if (end - ptr < 3 || (ptr[0] != 0xE3 && ptr[0] != 0xEF)) return -1;
+      if ((ptr[1] & 0xC0) != 0x80 || (ptr[2] & 0xC0) != 0x80) return -1;
+      c = ((ptr[0] & 0x0F) << 12) | ((ptr[1] & 0x3F) << 6) | (ptr[2] & 0x3F);
+      ptr += 3;
+
+      if (c >= 0x3040 && c <= 0x30FF)
+      {
+        folded = _lw_util_kana_table[c - 0x3040];
+        if (folded == 0) return -1;
+        _lw_util_put_bmp_char ((make_furigana_insensitive) ? folded : c, o);
+        o += 3;
+      }
+      else if ((folded = _lw_util_widthfold (c)) != 0)
+      {
+        *(o++) = (make_case_insensitive) ? g_ascii_tolower (folded) : folded;
+      }
+      else
+      {
+        return -1;
+      }
+    }
+    *o = '\0';
+
+    return o - output;
+}
+
+
+static gchar*
+_lw_util_normalize_string_slow (const gchar *TEXT,
+                                gboolean     make_case_insensitive,
+                                gboolean     make_furigana_insensitive)
+{
     //Declarations
     gchar *buffer;
     gchar *temp;
     
     //Initializations
-    buffer = g_utf8_normalize (TEXT, -1, G_NORMALIZE_ALL);
+    buffer = g_utf8_normalize (TEXT, -1, G_NORMALIZE_ALL_COMPOSE);  //NFKC, the form the fast paths write
 
     if (make_case_insensitive && buffer != NULL)
     {
@@ -1051,127 +706,144 @@ lw_util_normalize_string (const gchar        *TEXT,
 
     if (make_furigana_insensitive && buffer != NULL)
     {
-      temp = lw_util_furiganafold (buffer); 
-      g_free (buffer); buffer = temp; temp = NULL;
+      lw_util_furiganafold_buffer (buffer); 
     }
 
     return buffer;
 }
 
 
-static GHashTable*
-_lw_util_get_furiganafold_hashtable ()
+//!
+//! @brief Normalizes TEXT into a caller supplied buffer.  ASCII, kana and fullwidth
+//!        ASCII are handled with lookup tables, everything else falls back to NFKC.
+//! @param TEXT The string to normalize
+//! @param make_case_insensitive Casefold the string
+//! @param make_furigana_insensitive Fold katakana to hiragana
+//! @param buffer Where to write the result
+//! @param size The size of the buffer in bytes
+//! @returns The length of the normalized string like snprintf().  If it is greater or equal to
+//!          size, the output was truncated.  Returns -1 if TEXT isn't valid UTF-8.
+//!
+gint
+lw_util_normalize_string_to_buffer (const gchar *TEXT,
+                                    gboolean     make_case_insensitive,
+                                    gboolean     make_furigana_insensitive,
+                                    gchar       *buffer,
+                                    gint         size)
 {
+    //Sanity checks
+    g_return_val_if_fail (TEXT != NULL, -1);
+    g_return_val_if_fail (buffer != NULL || size == 0, -1);
+
     //Declarations
-    GHashTable *table;
-    const gchar **ptr;
-    gunichar key;
-    gunichar value;
-    static const gchar* conversions[] = {
-      "ア", "あ",
-      "イ", "い",
-      "ウ", "う",
-      "エ", "え",
-      "オ", "お",
-
-      "ァ", "ぁ",
-      "ィ", "ぃ",
-      "ゥ", "ぅ",
-      "ェ", "ぇ",
-      "ォ", "ぉ",
-
-      "カ", "か",
-      "キ", "き",
-      "ク", "く",
-      "ケ", "け",
-      "コ", "こ",
-
-      "ガ", "が",
-      "ギ", "ぎ",
-      "グ", "ぐ",
-      "ゲ", "げ",
-      "ゴ", "ご",
-
-      "マ", "ま",
-      "ミ", "み",
-      "ム", "む",
-      "メ", "め",
-      "モ", "も",
-
-      "ナ", "な",
-      "二", "に",
-      "ヌ", "ぬ",
-      "ネ", "ね",
-      "ノ", "の",
-
-      "サ", "さ",
-      "シ", "し",
-      "ス", "す",
-      "セ", "せ",
-      "ソ", "そ",
-
-      "ザ", "ざ",
-      "ジ", "じ",
-      "ズ", "ず",
-      "ゼ", "ぜ",
-      "ゾ", "ぞ",
-
-      "タ", "た",
-      "チ", "ち",
-      "ツ", "つ",
-      "テ", "て",
-      "ト", "と",
-
-      "ダ", "だ",
-      "ヂ", "ぢ",
-      "ヅ", "づ",
-      "デ", "で",
-      "ド", "ど",
-
-      "ハ", "は",
-      "ヒ", "ひ",
-      "フ", "ふ",
-      "ヘ", "へ",
-      "ホ", "ほ",
-
-      "パ", "ぱ",
-      "ピ", "ぴ",
-      "プ", "ぷ",
-      "ぺ", "ぺ",
-      "ポ", "ぽ",
-
-      "バ", "ば",
-      "ビ", "び",
-      "ブ", "ぶ",
-      "ベ", "べ",
-      "ボ", "ぼ",
-
-      "ヤ", "や",
-      "ユ", "ゆ",
-      "ヨ", "よ",
-
-      "ャ", "ゃ",
-      "ュ", "ゅ",
-      "ョ", "ょ",
-
-      "っ", "つ",
-      "ッ", "つ",
-
-      NULL
-    };
-
-    table = g_hash_table_new (g_direct_hash, g_direct_equal);
-    if (table == NULL) return NULL;
-    ptr = conversions;
-
-    while (*ptr != NULL && *(ptr + 1) != NULL)
+    gint length = 0;
+    gint written = -1;
+    gchar *slow = NULL;
+
+    //Initializations
+    length = strlen(TEXT);
+
+    if (size > length)
     {
-      key = g_utf8_get_char (*(ptr++));
-      value = g_utf8_get_char (*(ptr++));
-      g_hash_table_insert (table, GUINT_TO_POINTER (key), GUINT_TO_POINTER (value));
+      if (_lw_util_normalize_ascii (TEXT, length, make_case_insensitive, buffer)) return length;
+      written = _lw_util_normalize_kana (TEXT, length, make_case_insensitive, make_furigana_insensitive, buffer);
+      if (written >= 0) return written;
     }
 
-    return table;    
+    slow = _lw_util_normalize_string_slow (TEXT, make_case_insensitive, make_furigana_insensitive);
+    if (slow == NULL) return -1;
+
+    written = strlen(slow);
+    if (size > 0) g_strlcpy (buffer, slow, size);
+
+    g_free (slow); slow = NULL;
+
+    return written;
+}
+
+
+//!
+//! @brief Returns a newly allocated normalized copy of TEXT.  See lw_util_normalize_string_to_buffer()
+//!
+gchar*
+lw_util_normalize_string (const gchar        *TEXT,
+                          gboolean            make_case_insensitive,
+                          gboolean            make_furigana_insensitive)
+{
+    //Sanity checks
+    g_return_val_if_fail (TEXT != NULL, NULL);
+
+    //Declarations
+    gint length = 0;
+    gchar *buffer = NULL;
+
+    //Initializations
+    length = strlen(TEXT);
+    buffer = g_malloc (length + 1);
+
+    if (_lw_util_normalize_ascii (TEXT, length, make_case_insensitive, buffer)) return buffer;
+    if (_lw_util_normalize_kana (TEXT, length, make_case_insensitive, make_furigana_insensitive, buffer) >= 0) return buffer;
+
+    g_free (buffer); buffer = NULL;
+
+    return _lw_util_normalize_string_slow (TEXT, make_case_insensitive, make_furigana_insensitive);
+}
+
+
+//!
+//! @brief Like lw_util_normalize_string() but returns NULL when normalizing TEXT
+//!        wouldn't change it.  The common case doesn't allocate anything.
+//!
+gchar*
+lw_util_normalize_string_if_changed (const gchar *TEXT,
+                                     gboolean     make_case_insensitive,
+                                     gboolean     make_furigana_insensitive)
+{
+    //Sanity checks
+    g_return_val_if_fail (TEXT != NULL, NULL);
+
+    //Declarations
+    gchar buffer[256];
+    gint length = 0;
+
+    //Initializations
+    length = lw_util_normalize_string_to_buffer (TEXT, make_case_insensitive, make_furigana_insensitive, buffer, sizeof(buffer));
+    if (length < 0) return NULL;
+    if (length >= (gint) sizeof(buffer)) return lw_util_normalize_string (TEXT, make_case_insensitive, make_furigana_insensitive);
+    if (strcmp(buffer, TEXT) == 0) return NULL;
+
+    return g_strndup (buffer, length);
+}
+
+
+//!
+//! @brief Folds katakana to hiragana in place.  The byte length never changes.
+//!
+void
+lw_util_furiganafold_buffer (gchar *buffer)
+{
+    //Sanity checks
+    g_return_if_fail (buffer != NULL);
+
+    //Declarations
+    guchar *ptr = (guchar*) buffer;
+    gunichar c = 0;
+    gunichar folded = 0;
+
+    while (*ptr != '\0')
+    {
+      if (ptr[0] == 0xE3 && ptr[1] >= 0x81 && ptr[1] <= 0x83 && (ptr[2] & 0xC0) == 0x80)
+      {
+        c = (0x3 << 12) | ((ptr[1] & 0x3F) << 6) | (ptr[2] & 0x3F);
+        folded = _lw_util_kana_table[c - 0x3040];
+        if (folded != 0 && folded != c) _lw_util_put_bmp_char (folded, (gchar*) ptr);
+        ptr += 3;
+      }
+      else
+      {
+        ptr++;
+      }
+    }
 }
 
 
@@ -1183,22 +855,12 @@ lw_util_furiganafold (const gchar *TEXT)
 
     //Declarations
     gchar *buffer;
-    gchar *ptr;
-    GHashTable *table;
-    gunichar c, replacement;
     
     //Initializations
     buffer = g_strdup (TEXT);
     if (buffer == NULL) goto errored;
-    table = _lw_util_get_furiganafold_hashtable ();
-    if (table == NULL) goto errored;
 
-    for (ptr = buffer; *ptr != '\0'; ptr = g_utf8_next_char (ptr))
-    {
-      c = g_utf8_get_char (ptr);
-      replacement = GPOINTER_TO_UINT (g_hash_table_lookup (table, GUINT_TO_POINTER (c)));
-      if (replacement) g_unichar_to_utf8 (replacement, ptr);
-    }
+    lw_util_furiganafold_buffer (buffer);
 
     if (!g_utf8_validate (buffer, -1, NULL)) 
     {
@@ -1207,8 +869,6 @@ lw_util_furiganafold (const gchar *TEXT)
 
 errored:
 
-    if (table != NULL) g_hash_table_unref (table); table = NULL;
-
     return buffer;
 }
 
@@ -95,6 +95,11 @@ w_application_finalize (GObject *object)
     if (priv->installable_dictionarylist != NULL) g_object_unref (priv->installable_dictionarylist); priv->installable_dictionarylist = NULL;
     if (priv->context != NULL) g_option_context_free (priv->context); priv->context = NULL;
     if (priv->arg_query_text_data != NULL) g_free(priv->arg_query_text_data); priv->arg_query_text_data = NULL;
+    if (priv->arg_batch_switch_data != NULL) g_free(priv->arg_batch_switch_data); priv->arg_batch_switch_data = NULL;
+    if (priv->arg_benchmark_switch_data != NULL) g_free(priv->arg_benchmark_switch_data); priv->arg_benchmark_switch_data = NULL;
+    if (priv->arg_socket_switch_data != NULL) g_free(priv->arg_socket_switch_data); priv->arg_socket_switch_data = NULL;
+    if (priv->arg_format_switch_data != NULL) g_free(priv->arg_format_switch_data); priv->arg_format_switch_data = NULL;
+    if (priv->writer != NULL) w_writer_free (priv->writer); priv->writer = NULL;
     if (priv->preferences != NULL) lw_preferences_free (priv->preferences); priv->preferences = NULL;
 
     lw_regex_free ();
@@ -137,6 +142,12 @@ w_application_parse_args (WApplication *application, int *argc, char** argv[])
     //Reset the switches to their default state
     if (priv->arg_dictionary_switch_data != NULL) g_free (priv->arg_dictionary_switch_data); priv->arg_dictionary_switch_data = NULL;
     if (priv->arg_query_text_data != NULL) g_free (priv->arg_query_text_data); priv->arg_query_text_data = NULL;
+    if (priv->arg_batch_switch_data != NULL) g_free (priv->arg_batch_switch_data); priv->arg_batch_switch_data = NULL;
+    if (priv->arg_benchmark_switch_data != NULL) g_free (priv->arg_benchmark_switch_data); priv->arg_benchmark_switch_data = NULL;
+    priv->arg_clients_switch_data = 0;
+    if (priv->arg_socket_switch_data != NULL) g_free (priv->arg_socket_switch_data); priv->arg_socket_switch_data = NULL;
+    if (priv->arg_format_switch_data != NULL) g_free (priv->arg_format_switch_data); priv->arg_format_switch_data = NULL;
+    priv->format = W_OUTPUT_FORMAT_TEXT;
     priv->arg_version_switch = FALSE;
     error = NULL;
     if (priv->context != NULL) g_option_context_free (priv->context); priv->context = NULL;
@@ -149,13 +160,19 @@ w_application_parse_args (WApplication *application, int *argc, char** argv[])
            "  waei English               Search for the english word English\n"
            "  waei \"cats&dogs\"           Search for results containing cats and dogs\n"
            "  waei \"cats|dogs\"           Search for results containing cats or dogs\n"
+           "  waei \"cats&!dogs\"          Search for results containing cats but not dogs\n"
+           "  waei '\"take off\"~3'        Search for results with take and off within 3 words\n"
            "  waei cats dogs             Search for results containing \"cats dogs\"\n"
            "  waei %s                Search for the Japanese word %s\n"
            "  waei -e %s               Search for %s and ignore similar results\n"
            "  waei %s                 When you don't know a kanji character\n"
            "  waei -d Kanji %s           Find a kanji character in the kanji dictionary\n"
            "  waei -d Names %s       Look up a name in the names dictionary\n"
-           "  waei -d Places %s       Look up a place in the places dictionary"
+           "  waei -d Places %s       Look up a place in the places dictionary\n"
+           "  waei --batch words.txt     Search for each line of words.txt in one go\n"
+           "  waei --serve               Answer JSON lookups from other programs on a socket\n"
+           "  waei --benchmark words.txt Time searching for each line of words.txt\n"
+           "  waei -f jsonl English      Print a JSON object for each result"
          )
          , "にほん", "にほん", "日本", "日本", "日.語", "魚", "Miyabe", "Tokyo"
     );
@@ -163,10 +180,16 @@ w_application_parse_args (WApplication *application, int *argc, char** argv[])
       { "exact", 'e', 0, G_OPTION_ARG_NONE, &(priv->arg_exact_switch), gettext("Do not display less relevant results"), NULL },
       { "quiet", 'q', 0, G_OPTION_ARG_NONE, &(priv->arg_quiet_switch), gettext("Display less information"), NULL },
       { "color", 'c', 0, G_OPTION_ARG_NONE, &(priv->arg_color_switch), gettext("Display results with color"), NULL },
+      { "format", 'f', 0, G_OPTION_ARG_STRING, &(priv->arg_format_switch_data), gettext("Print results as text, jsonl or tsv"), "FORMAT" },
       { "dictionary", 'd', 0, G_OPTION_ARG_STRING, &(priv->arg_dictionary_switch_data), gettext("Search using a chosen dictionary"), NULL },
       { "list", 'l', 0, G_OPTION_ARG_NONE, &(priv->arg_list_switch), gettext("Show available dictionaries for searches"), NULL },
       { "install", 'i', 0, G_OPTION_ARG_STRING, &(priv->arg_install_switch_data), gettext("Install dictionary"), NULL },
       { "uninstall", 'u', 0, G_OPTION_ARG_STRING, &(priv->arg_uninstall_switch_data), gettext("Uninstall dictionary"), NULL },
+      { "batch", 'b', 0, G_OPTION_ARG_FILENAME, &(priv->arg_batch_switch_data), gettext("Search for each line of FILE, or of stdin when FILE is -"), "FILE" },
+      { "serve", 0, 0, G_OPTION_ARG_NONE, &(priv->arg_serve_switch), gettext("Answer JSON lookup requests on a Unix socket"), NULL },
+      { "socket", 0, 0, G_OPTION_ARG_FILENAME, &(priv->arg_socket_switch_data), gettext("The socket to serve on instead of waei.socket in the runtime directory"), "PATH" },
+      { "benchmark", 0, 0, G_OPTION_ARG_FILENAME, &(priv->arg_benchmark_switch_data), gettext("Time searches for each line of FILE and print the measurements as JSON Lines"), "FILE" },
+      { "clients", 0, 0, G_OPTION_ARG_INT, &(priv->arg_clients_switch_data), gettext("How many searches the benchmark runs at once in its concurrent phases"), "N" },
       { "rebuild-index", 0, 0, G_OPTION_ARG_NONE, &(priv->arg_rebuild_index), gettext("Rebuild dictionary indexes"), NULL },
       { "version", 'v', 0, G_OPTION_ARG_NONE, &(priv->arg_version_switch), gettext("Check the waei version information"), NULL },
       { NULL }
@@ -187,6 +210,18 @@ w_application_parse_args (WApplication *application, int *argc, char** argv[])
     //Get the query after the flags have been parsed out
     priv->arg_query_text_data = lw_util_get_query_from_args (*argc, *argv);
 
+    if (priv->arg_format_switch_data == NULL || strcmp (priv->arg_format_switch_data, "text") == 0)
+      priv->format = W_OUTPUT_FORMAT_TEXT;
+    else if (strcmp (priv->arg_format_switch_data, "jsonl") == 0)
+      priv->format = W_OUTPUT_FORMAT_JSONL;
+    else if (strcmp (priv->arg_format_switch_data, "tsv") == 0)
+      priv->format = W_OUTPUT_FORMAT_TSV;
+    else
+    {
+      fprintf(stderr, gettext("ERROR: Unknown format \"%s\".  Use text, jsonl or tsv.\n"), priv->arg_format_switch_data);
+      exit(1);
+    }
+
     if (description_text != NULL) g_free (description_text); description_text = NULL;
 }
 
@@ -352,6 +387,18 @@ w_application_run (WApplication *application, int *argc, char **argv[])
     else if (priv->arg_uninstall_switch_data != NULL)
       resolution = w_console_uninstall_dictionary (application, progress);
 
+    //User wants to answer lookups from other programs
+    else if (priv->arg_serve_switch)
+      resolution = w_console_serve (application, progress);
+
+    //User wants to measure search performance
+    else if (priv->arg_benchmark_switch_data != NULL)
+      resolution = w_console_benchmark (application, progress);
+
+    //User wants to search for many queries at once
+    else if (priv->arg_batch_switch_data != NULL)
+      resolution = w_console_batch (application, progress);
+
     //User wants to do a search
     else if (priv->arg_query_text_data != NULL)
       resolution = w_console_search (application, progress);
@@ -368,6 +415,7 @@ w_application_run (WApplication *application, int *argc, char **argv[])
     }
 
     //Cleanup
+    if (priv->writer != NULL) w_writer_flush (priv->writer);
     w_application_handle_error (application, &progress->error);
 
     lw_progress_free (progress); progress = NULL;
@@ -456,3 +504,70 @@ w_application_get_query_text_data (WApplication *application)
   return priv->arg_query_text_data;
 }
 
+
+const gchar*
+w_application_get_batch_switch_data (WApplication *application)
+{
+  WApplicationPrivate *priv;
+  priv = application->priv;
+  return priv->arg_batch_switch_data;
+}
+
+
+const gchar*
+w_application_get_benchmark_switch_data (WApplication *application)
+{
+  WApplicationPrivate *priv;
+  priv = application->priv;
+  return priv->arg_benchmark_switch_data;
+}
+
+
+gint
+w_application_get_clients_switch_data (WApplication *application)
+{
+  WApplicationPrivate *priv;
+  priv = application->priv;
+  return priv->arg_clients_switch_data;
+}
+
+
+gboolean
+w_application_get_serve_switch (WApplication *application)
+{
+  WApplicationPrivate *priv;
+  priv = application->priv;
+  return priv->arg_serve_switch;
+}
+
+
+const gchar*
+w_application_get_socket_switch_data (WApplication *application)
+{
+  WApplicationPrivate *priv;
+  priv = application->priv;
+  return priv->arg_socket_switch_data;
+}
+
+
+WOutputFormat
+w_application_get_output_format (WApplication *application)
+{
+  WApplicationPrivate *priv;
+  priv = application->priv;
+  return priv->format;
+}
+
+
+//!
+//! @brief Gets the buffered writer for stdout that the machine readable
+//!        formats are printed through
+//!
+WWriter*
+w_application_get_writer (WApplication *application)
+{
+  WApplicationPrivate *priv;
+  priv = application->priv;
+  if (priv->writer == NULL) priv->writer = w_writer_new (stdout);
+  return priv->writer;
+}
@@ -0,0 +1,391 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file console-batch.c
+//!
+//! @brief Answers one query per line of a file or stdin in a single process
+//!
+//! The dictionary, its index and the morphology engine are loaded once.  The
+//! searches run on a pool of threads while the results are printed from the
+//! main thread in the same order as the queries came in.
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <waei/gettext.h>
+#include <waei/waei.h>
+
+
+static void
+w_batchquery_free (WBatchQuery *query)
+{
+    //Sanity checks
+    if (query == NULL) return;
+
+    if (query->search != NULL) lw_search_free (query->search); query->search = NULL;
+    if (query->progress != NULL) lw_progress_free (query->progress); query->progress = NULL;
+    if (query->text != NULL) g_free (query->text); query->text = NULL;
+
+    g_free (query);
+}
+
+
+//!
+//! @brief Runs on the threads of the pool.  The search is done synchronously
+//!        since the pool already gives each one its own thread.
+//!
+static void
+w_batch_search_func (WBatchQuery *query,
+                     WBatch      *batch)
+{
+    if (query->search != NULL)
+    {
+      lw_search_start (query->search, query->progress, FALSE);
+    }
+
+    g_mutex_lock (&batch->mutex);
+    query->finished = TRUE;
+    g_cond_broadcast (&batch->cond);
+    g_mutex_unlock (&batch->mutex);
+}
+
+
+//!
+//! @brief Loads the dictionary data and index before searches run on other
+//!        threads.  Searches load them lazily and that isn't safe to do from
+//!        many threads at once.
+//! @returns FALSE if the dictionary couldn't be loaded.  An index that
+//!          couldn't be loaded isn't an error, so check it with
+//!          lw_dictionary_index_is_loaded() before searching with it.
+//!
+gboolean
+w_batch_load_dictionary (LwDictionary *dictionary,
+                         LwSearchFlag  flags,
+                         LwProgress   *progress)
+{
+    //Sanity checks
+    g_return_val_if_fail (dictionary != NULL, FALSE);
+    g_return_val_if_fail (progress != NULL, FALSE);
+
+    if (lw_dictionary_get_buffer (dictionary) == NULL) return FALSE;
+
+    if (flags & LW_SEARCH_FLAG_USE_INDEX)
+    {
+      if (!lw_dictionary_index_exists (dictionary)) lw_dictionary_index_create (dictionary, progress);
+      if (lw_progress_should_abort (progress)) return FALSE;
+      lw_dictionary_index_load (dictionary, progress);
+      if (lw_progress_should_abort (progress)) return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+//!
+//! @brief Loads everything the searches share so the threads only read it
+//! @param application The WApplication the dictionaries and engine come from
+//! @param dictionary The LwDictionary every query is searched in
+//! @param flags The LwSearchFlags of every search
+//! @param progress Reports index creation and loading
+//! @returns A new WBatch that should be freed with w_batch_free() or NULL on error
+//!
+WBatch*
+w_batch_new (WApplication *application,
+             LwDictionary *dictionary,
+             LwSearchFlag  flags,
+             LwProgress   *progress)
+{
+    //Sanity checks
+    g_return_val_if_fail (application != NULL, NULL);
+    g_return_val_if_fail (dictionary != NULL, NULL);
+    g_return_val_if_fail (progress != NULL, NULL);
+
+    //Declarations
+    WBatch *batch = NULL;
+    gint threads = 0;
+
+    //Initializations
+    batch = g_new0 (WBatch, 1); if (batch == NULL) goto errored;
+    batch->application = application;
+    batch->dictionary = dictionary;
+    batch->morphologyengine = w_application_get_morphologyengine (application);
+    batch->flags = flags;
+    batch->pending = g_queue_new ();
+    g_mutex_init (&batch->mutex);
+    g_cond_init (&batch->cond);
+
+    if (!w_batch_load_dictionary (dictionary, flags, progress)) goto errored;
+
+    //Searching without a loaded index would load it lazily from every thread at once
+    if (!lw_dictionary_index_is_loaded (dictionary)) batch->flags &= ~LW_SEARCH_FLAG_USE_INDEX;
+
+    threads = MAX (g_get_num_processors (), 1);
+    batch->window = threads * W_BATCH_QUERIES_PER_THREAD;
+    batch->pool = g_thread_pool_new ((GFunc) w_batch_search_func, batch, threads, FALSE, &progress->error);
+    if (batch->pool == NULL) goto errored;
+
+    return batch;
+
+errored:
+
+    w_batch_free (batch);
+
+    return NULL;
+}
+
+
+//!
+//! @brief Waits for the searches that are still running and frees the batch
+//!        without printing anything else
+//!
+void
+w_batch_free (WBatch *batch)
+{
+    //Sanity checks
+    if (batch == NULL) return;
+
+    if (batch->pool != NULL) g_thread_pool_free (batch->pool, FALSE, TRUE); batch->pool = NULL;
+    if (batch->pending != NULL) g_queue_free_full (batch->pending, (GDestroyNotify) w_batchquery_free); batch->pending = NULL;
+
+    g_mutex_clear (&batch->mutex);
+    g_cond_clear (&batch->cond);
+
+    memset (batch, 0, sizeof(WBatch));
+    g_free (batch);
+}
+
+
+//!
+//! @brief Queues a query to be searched on the pool.  Empty queries are kept
+//!        so that the output still lines up with the input.
+//!
+void
+w_batch_push (WBatch      *batch,
+              const gchar *TEXT)
+{
+    //Sanity checks
+    g_return_if_fail (batch != NULL);
+    g_return_if_fail (TEXT != NULL);
+
+    //Declarations
+    WBatchQuery *query = NULL;
+
+    //Initializations
+    query = g_new0 (WBatchQuery, 1); if (query == NULL) return;
+    query->text = g_strdup (TEXT);
+
+    if (*TEXT != '\0')
+    {
+      query->progress = lw_progress_new (NULL, NULL, NULL);
+      query->search = lw_search_new (batch->dictionary, batch->morphologyengine, TEXT, batch->flags);
+      if (query->search != NULL) lw_search_set_max_results (query->search, batch->max);
+    }
+
+    g_queue_push_tail (batch->pending, query);
+
+    if (query->search != NULL)
+    {
+      g_thread_pool_push (batch->pool, query, NULL);
+    }
+    else
+    {
+      query->finished = TRUE;
+    }
+}
+
+
+//!
+//! @brief Hands the oldest queries to func in input order as soon as their
+//!        searches finish, until no more than remaining are left
+//! @param batch The WBatch to take the finished queries from
+//! @param remaining How many queries can be left running.  0 waits for all of them.
+//! @param func Called on the main thread with each query
+//! @param data Passed to func
+//!
+void
+w_batch_flush (WBatch              *batch,
+               guint                remaining,
+               WBatchQueryFunc      func,
+               gpointer             data)
+{
+    //Sanity checks
+    g_return_if_fail (batch != NULL);
+    g_return_if_fail (func != NULL);
+
+    //Declarations
+    WBatchQuery *query = NULL;
+
+    while (g_queue_get_length (batch->pending) > remaining)
+    {
+      query = g_queue_peek_head (batch->pending);
+
+      g_mutex_lock (&batch->mutex);
+      while (!query->finished) g_cond_wait (&batch->cond, &batch->mutex);
+      g_mutex_unlock (&batch->mutex);
+
+      g_queue_pop_head (batch->pending);
+      func (batch, query, data);
+      w_batchquery_free (query); query = NULL;
+    }
+}
+
+
+//!
+//! @brief Prints the results of a query after a delimiter line with the query
+//!
+static void
+w_console_batch_print_query (WBatch      *batch,
+                             WBatchQuery *query,
+                             gpointer     data)
+{
+    //Declarations
+    WApplication *application = batch->application;
+    LwSearchResultIterator *iterator = NULL;
+    gboolean quiet_switch = FALSE;
+    gboolean text = FALSE;
+    gint total_results = 0;
+
+    //Initializations
+    quiet_switch = w_application_get_quiet_switch (application);
+    text = (w_application_get_output_format (application) == W_OUTPUT_FORMAT_TEXT);
+
+    //The machine readable formats have the query in every record instead
+    if (text) printf(W_CONSOLE_BATCH_DELIMITER, query->text);
+
+    if (query->search != NULL)
+    {
+      iterator = lw_searchresultiterator_new (query->search);
+
+      while (lw_searchresultiterator_next (iterator))
+      {
+        w_console_append_result (application, iterator);
+      }
+
+      if (lw_searchresultiterator_empty (iterator))
+      {
+        w_console_no_result (application, iterator);
+      }
+      else if (!quiet_switch && text)
+      {
+        total_results = lw_searchresultiterator_count (iterator);
+        printf(ngettext("Found %d result", "Found %d results", total_results), total_results);
+        printf("\n");
+      }
+
+      lw_searchresultiterator_free (iterator); iterator = NULL;
+    }
+
+    if (query->progress != NULL && query->progress->error != NULL)
+    {
+      fprintf (stderr, "ERROR: %s\n", query->progress->error->message);
+    }
+}
+
+
+//!
+//! @brief Searches for every line of the batch file, or stdin when it is "-",
+//!        keeping the dictionary and engines loaded between queries
+//!
+gint
+w_console_batch (WApplication *application,
+                 LwProgress   *progress)
+{
+    //Sanity check
+    if (lw_progress_should_abort (progress)) return 1;
+
+    //Declarations
+    LwDictionaryList *dictionarylist = NULL;
+    LwPreferences *preferences = NULL;
+    LwDictionary *dictionary = NULL;
+    WBatch *batch = NULL;
+    GIOChannel *channel = NULL;
+    GIOStatus status = G_IO_STATUS_NORMAL;
+    const gchar *batch_switch_data = NULL;
+    const gchar *dictionary_switch_data = NULL;
+    gchar *line = NULL;
+    gsize terminator = 0;
+    LwSearchFlag flags = 0;
+    gint resolution = 0;
+
+    //Initializations
+    dictionarylist = w_application_get_installed_dictionarylist (application);
+    preferences = w_application_get_preferences (application);
+    batch_switch_data = w_application_get_batch_switch_data (application);
+    dictionary_switch_data = w_application_get_dictionary_switch_data (application);
+    flags = lw_search_get_flags_from_preferences (preferences);
+
+    if (w_application_get_exact_switch (application))
+    {
+      flags &= ~(LW_SEARCH_FLAG_INSENSITIVE | LW_SEARCH_FLAG_FUZZY);
+    }
+
+    dictionary = lw_dictionarylist_get_dictionary_fuzzy (dictionarylist, dictionary_switch_data);
+    if (dictionary == NULL)
+    {
+      fprintf (stderr, gettext("\"%s\" Dictionary was not found!\n"), dictionary_switch_data);
+      resolution = 1;
+      goto errored;
+    }
+
+    if (strcmp (batch_switch_data, "-") == 0)
+      channel = g_io_channel_unix_new (fileno (stdin));
+    else
+      channel = g_io_channel_new_file (batch_switch_data, "r", &progress->error);
+    if (channel == NULL) { resolution = 1; goto errored; }
+    g_io_channel_set_encoding (channel, NULL, NULL);
+
+    batch = w_batch_new (application, dictionary, flags, progress);
+    if (batch == NULL) { resolution = 1; goto errored; }
+    batch->max = 0; //The console prints every result
+
+    while ((status = g_io_channel_read_line (channel, &line, NULL, &terminator, &progress->error)) == G_IO_STATUS_NORMAL)
+    {
+      line[terminator] = '\0';
+      if (!g_utf8_validate (line, -1, NULL)) *line = '\0';
+      w_batch_push (batch, line);
+      g_free (line); line = NULL;
+
+      //Print what is ready so memory stays bounded however long the input is
+      w_batch_flush (batch, batch->window, w_console_batch_print_query, NULL);
+    }
+    if (status == G_IO_STATUS_ERROR) resolution = 1;
+
+    w_batch_flush (batch, 0, w_console_batch_print_query, NULL);
+
+errored:
+
+    if (line != NULL) g_free (line); line = NULL;
+    if (batch != NULL) w_batch_free (batch); batch = NULL;
+    if (channel != NULL) g_io_channel_unref (channel); channel = NULL;
+
+    fflush (stdout);
+
+    return resolution;
+}
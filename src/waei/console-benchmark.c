@@ -0,0 +1,466 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file console-benchmark.c
+//!
+//! @brief Measures searches over a query corpus so releases can be compared
+//!
+//! Each chosen dictionary is loaded and timed first.  The corpus is then
+//! searched through the index and through regexes, cold with the caches
+//! cleared before every query, warm with them filled, and from several
+//! clients at once.  Every step prints one JSON object per line:
+//!
+//!   {"dictionary":"English","phase":"load","data_microseconds":81000,
+//!    "index_create_microseconds":null,"index_load_microseconds":9000,...}
+//!   {"dictionary":"English","phase":"cold","path":"index","clients":1,
+//!    "searches":200,"results":5120,"errors":0,"seconds":0.42,
+//!    "searches_per_second":476.2,"p50_microseconds":1500,
+//!    "p95_microseconds":5200,"p99_microseconds":9100,"max_microseconds":12000,
+//!    "peak_rss_kilobytes":52000,"heap_bytes":31000000}
+//!
+//! The latencies include creating the search and walking all of its results
+//! like the console does, so no search stops at the default maximum.  Memory figures are null where the platform can't tell.
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef HAVE_SYS_RESOURCE_H
+#include <sys/resource.h>
+#endif
+#ifdef HAVE_MALLOC_H
+#include <malloc.h>
+#endif
+
+#include <glib.h>
+
+#include <waei/gettext.h>
+#include <waei/waei.h>
+
+
+static const WBenchmarkPhase _phases[] = {
+  { "cold", "index", TRUE, TRUE, FALSE },
+  { "warm", "index", TRUE, FALSE, FALSE },
+  { "concurrent", "index", TRUE, FALSE, TRUE },
+  { "cold", "regex", FALSE, TRUE, FALSE },
+  { "warm", "regex", FALSE, FALSE, FALSE },
+  { "concurrent", "regex", FALSE, FALSE, TRUE },
+  { NULL, NULL, FALSE, FALSE, FALSE }
+};
+
+
+//!
+//! @returns The peak resident set size of the process so far, in kilobytes, or -1
+//!
+static gint64
+w_benchmark_get_peak_rss (void)
+{
+#ifdef HAVE_GETRUSAGE
+    //Declarations
+    struct rusage usage;
+
+    if (getrusage (RUSAGE_SELF, &usage) == 0)
+    {
+#ifdef __APPLE__
+      return usage.ru_maxrss / 1024;
+#else
+      return usage.ru_maxrss;
+#endif
+    }
+#endif
+
+    return -1;
+}
+
+
+//!
+//! @returns The bytes allocated on the heap right now or -1
+//!
+static gint64
+w_benchmark_get_heap_bytes (void)
+{
+#ifdef HAVE_MALLINFO2
+    return (gint64) mallinfo2 ().uordblks;
+#else
+    return -1;
+#endif
+}
+
+
+static void
+w_benchmark_append_integer (GString     *json,
+                            const gchar *NAME,
+                            gint64       value)
+{
+    w_json_append_name (json, NAME);
+    if (value < 0) g_string_append (json, "null");
+    else g_string_append_printf (json, "%" G_GINT64_FORMAT, value);
+}
+
+
+static void
+w_benchmark_append_double (GString     *json,
+                           const gchar *NAME,
+                           gdouble      value)
+{
+    //Declarations
+    gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
+
+    w_json_append_name (json, NAME);
+    g_string_append (json, g_ascii_formatd (buffer, sizeof(buffer), "%.6g", value));
+}
+
+
+static gint
+w_benchmark_compare_latencies (gconstpointer a,
+                               gconstpointer b)
+{
+    //Declarations
+    gint64 latency_a = *((const gint64*) a);
+    gint64 latency_b = *((const gint64*) b);
+
+    return (latency_a > latency_b) - (latency_a < latency_b);
+}
+
+
+//!
+//! @brief Gets a percentile with the nearest rank method
+//! @param latencies Sorted latencies
+//!
+static gint64
+w_benchmark_get_percentile (gint64 *latencies,
+                            gint    length,
+                            gint    percentile)
+{
+    //Declarations
+    gint rank = 0;
+
+    if (length == 0) return -1;
+
+    rank = (length * percentile + 99) / 100;
+    rank = CLAMP (rank, 1, length);
+
+    return latencies[rank - 1];
+}
+
+
+//!
+//! @brief Reads the corpus file, one query per line.  Empty lines and lines
+//!        that aren't UTF-8 are skipped.
+//! @returns A GPtrArray of queries or NULL on error
+//!
+static GPtrArray*
+w_benchmark_read_queries (const gchar  *PATH,
+                          GError      **error)
+{
+    //Declarations
+    gchar *contents = NULL;
+    gchar **lines = NULL;
+    GPtrArray *queries = NULL;
+    gint i = 0;
+
+    //Initializations
+    if (!g_file_get_contents (PATH, &contents, NULL, error)) goto errored;
+    lines = g_strsplit (contents, "\n", -1);
+    queries = g_ptr_array_new_with_free_func (g_free);
+
+    for (i = 0; lines[i] != NULL; i++)
+    {
+      g_strchomp (lines[i]);
+      if (*lines[i] == '\0' || !g_utf8_validate (lines[i], -1, NULL)) continue;
+      g_ptr_array_add (queries, g_strdup (lines[i]));
+    }
+
+errored:
+
+    if (lines != NULL) g_strfreev (lines); lines = NULL;
+    if (contents != NULL) g_free (contents); contents = NULL;
+
+    return queries;
+}
+
+
+//!
+//! @brief Runs the search number i of the phase and records how long it took
+//!
+static void
+w_benchmark_search (WBenchmark *benchmark,
+                    gint        i)
+{
+    //Declarations
+    const gchar *QUERY = NULL;
+    LwSearch *search = NULL;
+    LwProgress *progress = NULL;
+    LwSearchResultIterator *iterator = NULL;
+    gint64 start_time = 0;
+    gint results = 0;
+
+    //Initializations
+    QUERY = g_ptr_array_index (benchmark->queries, i % benchmark->queries->len);
+
+    if (benchmark->cold)
+    {
+      lw_resultcache_clear (lw_dictionary_get_resultcache (benchmark->dictionary));
+      lw_morphologyengine_clear_cache (benchmark->morphologyengine);
+    }
+
+    start_time = g_get_monotonic_time ();
+
+    progress = lw_progress_new (NULL, NULL, NULL);
+    search = lw_search_new (benchmark->dictionary, benchmark->morphologyengine, QUERY, benchmark->flags);
+    if (search != NULL)
+    {
+      lw_search_set_max_results (search, 0); //Every result like the console so complete results reach the cache
+      lw_search_start (search, progress, FALSE);
+      iterator = lw_searchresultiterator_new (search);
+      while (lw_searchresultiterator_next (iterator)) results++;
+      lw_searchresultiterator_free (iterator); iterator = NULL;
+    }
+
+    benchmark->latencies[i] = g_get_monotonic_time () - start_time;
+
+    if (search == NULL || progress->error != NULL) g_atomic_int_inc (&benchmark->errors);
+    g_atomic_int_add (&benchmark->results, results);
+
+    if (search != NULL) lw_search_free (search); search = NULL;
+    lw_progress_free (progress); progress = NULL;
+}
+
+
+static gpointer
+w_benchmark_client_func (gpointer data)
+{
+    //Declarations
+    WBenchmark *benchmark = data;
+    gint i = 0;
+
+    while ((i = g_atomic_int_add (&benchmark->next, 1)) < benchmark->length)
+    {
+      w_benchmark_search (benchmark, i);
+    }
+
+    return NULL;
+}
+
+
+//!
+//! @brief Runs one phase over the corpus and prints its record
+//!
+static void
+w_benchmark_run_phase (WBenchmark            *benchmark,
+                       const WBenchmarkPhase *PHASE,
+                       LwSearchFlag           flags)
+{
+    //Declarations
+    GString *json = NULL;
+    GThread **threads = NULL;
+    gint clients = 0;
+    gint64 start_time = 0;
+    gdouble seconds = 0.0;
+    gint i = 0;
+
+    //Initializations
+    json = w_application_get_writer (benchmark->application)->buffer;
+    clients = (PHASE->concurrent) ? benchmark->clients : 1;
+    benchmark->flags = flags;
+    benchmark->cold = PHASE->cold;
+    benchmark->length = benchmark->queries->len * clients;
+    benchmark->latencies = g_new0 (gint64, benchmark->length);
+    benchmark->next = 0;
+    benchmark->results = 0;
+    benchmark->errors = 0;
+
+    start_time = g_get_monotonic_time ();
+
+    if (clients == 1)
+    {
+      w_benchmark_client_func (benchmark);
+    }
+    else
+    {
+      threads = g_new0 (GThread*, clients);
+      for (i = 0; i < clients; i++) threads[i] = g_thread_new ("benchmark", w_benchmark_client_func, benchmark);
+      for (i = 0; i < clients; i++) g_thread_join (threads[i]);
+      g_free (threads); threads = NULL;
+    }
+
+    seconds = (g_get_monotonic_time () - start_time) / (gdouble) G_USEC_PER_SEC;
+    qsort (benchmark->latencies, benchmark->length, sizeof(gint64), w_benchmark_compare_latencies);
+
+    g_string_append_c (json, '{');
+    w_json_append_member (json, "dictionary", lw_dictionary_get_name (benchmark->dictionary));
+    w_json_append_member (json, "phase", PHASE->name);
+    w_json_append_member (json, "path", PHASE->path);
+    w_benchmark_append_integer (json, "clients", clients);
+    w_benchmark_append_integer (json, "searches", benchmark->length);
+    w_benchmark_append_integer (json, "results", benchmark->results);
+    w_benchmark_append_integer (json, "errors", benchmark->errors);
+    w_benchmark_append_double (json, "seconds", seconds);
+    w_benchmark_append_double (json, "searches_per_second", (seconds > 0.0) ? benchmark->length / seconds : 0.0);
+    w_benchmark_append_integer (json, "p50_microseconds", w_benchmark_get_percentile (benchmark->latencies, benchmark->length, 50));
+    w_benchmark_append_integer (json, "p95_microseconds", w_benchmark_get_percentile (benchmark->latencies, benchmark->length, 95));
+    w_benchmark_append_integer (json, "p99_microseconds", w_benchmark_get_percentile (benchmark->latencies, benchmark->length, 99));
+    w_benchmark_append_integer (json, "max_microseconds", w_benchmark_get_percentile (benchmark->latencies, benchmark->length, 100));
+    w_benchmark_append_integer (json, "peak_rss_kilobytes", w_benchmark_get_peak_rss ());
+    w_benchmark_append_integer (json, "heap_bytes", w_benchmark_get_heap_bytes ());
+    g_string_append (json, "}\n");
+    w_writer_flush (w_application_get_writer (benchmark->application));
+
+    g_free (benchmark->latencies); benchmark->latencies = NULL;
+}
+
+
+//!
+//! @brief Times loading the dictionary and its index, which the searches
+//!        would otherwise do lazily on the first query, and prints the record
+//! @returns FALSE if the dictionary couldn't be loaded
+//!
+static gboolean
+w_benchmark_load (WBenchmark *benchmark,
+                  LwProgress *progress)
+{
+    //Declarations
+    LwDictionary *dictionary = benchmark->dictionary;
+    GString *json = NULL;
+    gint64 start_time = 0;
+    gint64 data_time = -1;
+    gint64 create_time = -1;
+    gint64 load_time = -1;
+
+    //Initializations
+    json = w_application_get_writer (benchmark->application)->buffer;
+
+    start_time = g_get_monotonic_time ();
+    if (lw_dictionary_get_buffer (dictionary) == NULL) return FALSE;
+    data_time = g_get_monotonic_time () - start_time;
+
+    if (!lw_dictionary_index_exists (dictionary))
+    {
+      start_time = g_get_monotonic_time ();
+      lw_dictionary_index_create (dictionary, progress);
+      create_time = g_get_monotonic_time () - start_time;
+      if (lw_progress_should_abort (progress)) return FALSE;
+    }
+
+    start_time = g_get_monotonic_time ();
+    lw_dictionary_index_load (dictionary, progress);
+    if (lw_progress_should_abort (progress)) return FALSE;
+    if (lw_dictionary_index_is_loaded (dictionary)) load_time = g_get_monotonic_time () - start_time;
+
+    g_string_append_c (json, '{');
+    w_json_append_member (json, "dictionary", lw_dictionary_get_name (dictionary));
+    w_json_append_member (json, "phase", "load");
+    w_benchmark_append_integer (json, "queries", benchmark->queries->len);
+    w_benchmark_append_integer (json, "data_microseconds", data_time);
+    w_benchmark_append_integer (json, "index_create_microseconds", create_time);
+    w_benchmark_append_integer (json, "index_load_microseconds", load_time);
+    w_benchmark_append_integer (json, "peak_rss_kilobytes", w_benchmark_get_peak_rss ());
+    w_benchmark_append_integer (json, "heap_bytes", w_benchmark_get_heap_bytes ());
+    g_string_append (json, "}\n");
+    w_writer_flush (w_application_get_writer (benchmark->application));
+
+    return TRUE;
+}
+
+
+//!
+//! @brief Runs the corpus of the benchmark file against each dictionary given
+//!        with --dictionary, separated by commas, and prints the measurements
+//!        as JSON Lines
+//!
+gint
+w_console_benchmark (WApplication *application,
+                     LwProgress   *progress)
+{
+    //Sanity check
+    if (lw_progress_should_abort (progress)) return 1;
+
+    //Declarations
+    LwDictionaryList *dictionarylist = NULL;
+    LwPreferences *preferences = NULL;
+    WBenchmark benchmark;
+    const WBenchmarkPhase *phase = NULL;
+    const gchar *dictionary_switch_data = NULL;
+    gchar **names = NULL;
+    LwSearchFlag flags = 0;
+    gint resolution = 0;
+    gint i = 0;
+
+    //Initializations
+    memset (&benchmark, 0, sizeof(WBenchmark));
+    dictionarylist = w_application_get_installed_dictionarylist (application);
+    preferences = w_application_get_preferences (application);
+    dictionary_switch_data = w_application_get_dictionary_switch_data (application);
+    flags = lw_search_get_flags_from_preferences (preferences);
+    benchmark.application = application;
+    benchmark.morphologyengine = w_application_get_morphologyengine (application);
+    benchmark.clients = w_application_get_clients_switch_data (application);
+    if (benchmark.clients <= 0) benchmark.clients = MAX (g_get_num_processors (), 1);
+
+    if (w_application_get_exact_switch (application))
+    {
+      flags &= ~(LW_SEARCH_FLAG_INSENSITIVE | LW_SEARCH_FLAG_FUZZY);
+    }
+
+    benchmark.queries = w_benchmark_read_queries (w_application_get_benchmark_switch_data (application), &progress->error);
+    if (benchmark.queries == NULL) { resolution = 1; goto errored; }
+    if (benchmark.queries->len == 0)
+    {
+      fprintf (stderr, gettext("The benchmark file has no queries\n"));
+      resolution = 1;
+      goto errored;
+    }
+
+    if (dictionary_switch_data != NULL) names = g_strsplit (dictionary_switch_data, ",", -1);
+    else names = g_new0 (gchar*, 2);
+
+    for (i = 0; i == 0 || names[i] != NULL; i++)
+    {
+      benchmark.dictionary = lw_dictionarylist_get_dictionary_fuzzy (dictionarylist, names[i]);
+      if (benchmark.dictionary == NULL)
+      {
+        fprintf (stderr, gettext("\"%s\" Dictionary was not found!\n"), names[i]);
+        resolution = 1;
+        goto errored;
+      }
+
+      if (!w_benchmark_load (&benchmark, progress)) { resolution = 1; goto errored; }
+
+      for (phase = _phases; phase->name != NULL; phase++)
+      {
+        if (phase->indexed && !lw_dictionary_index_is_loaded (benchmark.dictionary)) continue;
+        w_benchmark_run_phase (&benchmark, phase, (phase->indexed) ? (flags | LW_SEARCH_FLAG_USE_INDEX) : (flags & ~LW_SEARCH_FLAG_USE_INDEX));
+      }
+    }
+
+errored:
+
+    if (names != NULL) g_strfreev (names); names = NULL;
+    if (benchmark.queries != NULL) g_ptr_array_free (benchmark.queries, TRUE); benchmark.queries = NULL;
+
+    return resolution;
+}
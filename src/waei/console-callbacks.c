@@ -75,25 +75,30 @@ w_console_progress_cb (LwDictionary *dictionary,
 }
 
 
+//!
+//! @brief Search watch that prints whatever results are ready and quits the
+//!        loop once the search is done
+//!
 gboolean 
-w_console_append_result_timeout (gpointer data)
+w_console_append_result_cb (LwSearch *search, gpointer data)
 {
   //Sanity checks
+  g_return_val_if_fail (search != NULL, FALSE);
   g_return_val_if_fail (data != NULL, FALSE);
 
   //Declarations
   LwSearchResultIterator *iterator = NULL;
-  LwSearch *search = NULL;
-  LwSearchStatus status = 0;
   WSearchData *sdata = NULL;
-  gboolean keep_appending = TRUE;
 
   //Initializations
   iterator = LW_SEARCHRESULTITERATOR (data);
-  search = iterator->search;
-  status = lw_search_get_status (search);
   sdata = W_SEARCHDATA (lw_search_get_data (search));
 
+  while (lw_searchresultiterator_next (iterator))
+  {
+    w_console_append_result (sdata->application, iterator);
+  }
+
   if (lw_searchresultiterator_finished (iterator))
   {
     if (lw_searchresultiterator_empty (iterator))
@@ -101,17 +106,9 @@ w_console_append_result_timeout (gpointer data)
       w_console_no_result (sdata->application, iterator);
     }
     g_main_loop_quit (sdata->loop);
-    keep_appending = FALSE;
-  }
-  else
-  {
-    while (lw_searchresultiterator_next (iterator))
-    {
-      w_console_append_result (sdata->application, iterator);
-    }
-    keep_appending = TRUE;
+    return FALSE;
   }
 
-  return keep_appending;
+  return TRUE;
 }
 
@@ -47,6 +47,10 @@ static void w_console_append_examplesdict_result (WApplication*, LwSearchResultI
 static void w_console_append_unknowndict_result (WApplication*, LwSearchResultIterator*);
 
 
+//!
+//! @brief Colors the parts of TEXT the query matched using the highlighter the
+//!        search compiled once, then goes back to ORIGINAL_COLOR after each one
+//!
 static gchar*
 w_add_match_highlights (LwSearchResultIterator *iterator, 
                         const gchar            *TEXT, 
@@ -57,23 +61,18 @@ w_add_match_highlights (LwSearchResultIterator *iterator,
     g_return_val_if_fail (iterator != NULL, NULL);
 
     //Declarations
-    LwSearch *search = iterator->search;
-    gchar *pattern = NULL;
-    GRegex *regex = NULL;
+    LwHighlighter *highlighter = NULL;
+    gchar *close = NULL;
     gchar *output = NULL;
-    gchar *replacement = NULL;
 
     //Initializations
-    pattern = g_strconcat ("(", search->query, ")", NULL); if (pattern == NULL) goto errored;
-    replacement = g_strconcat ("[1;91m\\0[0m", ORIGINAL_COLOR, NULL); if (replacement == NULL) goto errored;
-    regex = g_regex_new (pattern, 0, 0, NULL); if (regex == NULL) goto errored;
-    output = g_regex_replace (regex, TEXT, -1, 0, replacement, 0, NULL); if (output == NULL) goto errored;
+    highlighter = lw_search_get_highlighter (iterator->search); if (highlighter == NULL) goto errored;
+    close = g_strconcat ("[0m", ORIGINAL_COLOR, NULL); if (close == NULL) goto errored;
+    output = lw_highlighter_highlight (highlighter, TEXT, "[1;91m", close);
     
 errored:
 
-    if (pattern != NULL) g_free (pattern); pattern = NULL;
-    if (replacement != NULL) g_free (replacement); replacement = NULL;
-    if (regex != NULL) g_regex_unref (regex); regex = NULL;
+    if (close != NULL) g_free (close); close = NULL;
     if (output == NULL) output = g_strdup (TEXT);
 
     return output;
@@ -101,6 +100,150 @@ errored:
 }
 
 
+//!
+//! @brief Appends a JSON member only when the field was found in the result
+//!
+static void
+w_console_append_json_field (GString     *json,
+                             const gchar *NAME,
+                             const gchar *VALUE)
+{
+    if (VALUE != NULL) w_json_append_member (json, NAME, VALUE);
+}
+
+
+//!
+//! @brief Writes the parsed fields of the current result as a JSON object
+//!        on one line
+//!
+static void
+w_console_append_jsonl_result (WApplication           *application,
+                               LwSearchResultIterator *iterator,
+                               LwResult               *result,
+                               gint                    score)
+{
+    //Declarations
+    GString *json = w_application_get_writer (application)->buffer;
+    gint i = 0;
+
+    g_string_append_c (json, '{');
+    w_json_append_member (json, "query", iterator->search->query);
+    w_json_append_member (json, "dictionary", lw_dictionary_get_name (iterator->search->dictionary));
+    w_json_append_name (json, "score");
+    g_string_append_printf (json, "%d", score);
+    w_console_append_json_field (json, "kanji", (result->kanji_start != NULL) ? result->kanji_start : result->kanji);
+    w_console_append_json_field (json, "furigana", result->furigana_start);
+    w_console_append_json_field (json, "classification", result->classification_start);
+    w_json_append_name (json, "important");
+    g_string_append (json, (result->important) ? "true" : "false");
+
+    w_json_append_name (json, "senses");
+    g_string_append_c (json, '[');
+    for (i = 0; i < result->def_total; i++)
+    {
+      if (i > 0) g_string_append_c (json, ',');
+      w_json_append_string (json, result->def_start[i]);
+    }
+    g_string_append_c (json, ']');
+
+    //Kanji dictionaries
+    w_console_append_json_field (json, "radicals", result->radicals);
+    w_console_append_json_field (json, "strokes", result->strokes);
+    w_console_append_json_field (json, "frequency", result->frequency);
+    w_console_append_json_field (json, "grade", result->grade);
+    w_console_append_json_field (json, "jlpt", result->jlpt);
+    w_console_append_json_field (json, "meanings", result->meanings);
+    if (result->readings[0] != NULL || result->readings[1] != NULL || result->readings[2] != NULL)
+    {
+      w_json_append_name (json, "readings");
+      g_string_append_c (json, '[');
+      for (i = 0; i < G_N_ELEMENTS (result->readings); i++)
+      {
+        if (i > 0) g_string_append_c (json, ',');
+        w_json_append_string (json, result->readings[i]);
+      }
+      g_string_append_c (json, ']');
+    }
+
+    //Dictionaries that couldn't be parsed
+    if (result->kanji_start == NULL && result->kanji == NULL && result->def_total == 0)
+    {
+      w_console_append_json_field (json, "text", result->text);
+    }
+
+    g_string_append (json, "}\n");
+}
+
+
+//!
+//! @brief Writes the current result as a line of query, dictionary, score,
+//!        kanji, furigana, classification, important flag and the senses
+//!        separated by " / "
+//!
+static void
+w_console_append_tsv_result (WApplication           *application,
+                             LwSearchResultIterator *iterator,
+                             LwResult               *result,
+                             gint                    score)
+{
+    //Declarations
+    WWriter *writer = w_application_get_writer (application);
+    GString *tsv = writer->buffer;
+    gint i = 0;
+
+    w_writer_append_tsv_field (writer, iterator->search->query, TRUE);
+    w_writer_append_tsv_field (writer, lw_dictionary_get_name (iterator->search->dictionary), FALSE);
+    g_string_append_printf (tsv, "\t%d", score);
+    w_writer_append_tsv_field (writer, (result->kanji_start != NULL) ? result->kanji_start : result->kanji, FALSE);
+    w_writer_append_tsv_field (writer, (result->furigana_start != NULL) ? result->furigana_start : result->readings[0], FALSE);
+    w_writer_append_tsv_field (writer, result->classification_start, FALSE);
+    w_writer_append_tsv_field (writer, (result->important) ? "1" : "0", FALSE);
+
+    if (result->def_total > 0)
+    {
+      for (i = 0; i < result->def_total; i++)
+      {
+        //Only the first sense starts a new field
+        if (i > 0) g_string_append (tsv, " / ");
+        w_writer_append_tsv_field (writer, result->def_start[i], (i > 0));
+      }
+    }
+    else
+    {
+      w_writer_append_tsv_field (writer, (result->meanings != NULL) ? result->meanings : result->text, FALSE);
+    }
+
+    g_string_append_c (tsv, '\n');
+}
+
+
+//!
+//! @brief Prints the current result in one of the machine readable formats
+//!        through the buffered writer of the application
+//!
+static void
+w_console_append_record (WApplication           *application,
+                         LwSearchResultIterator *iterator)
+{
+    //Declarations
+    LwResult *result = NULL;
+    LwResultArrayEntry *entry = NULL;
+
+    //Initializations
+    result = lw_searchresultiterator_get_result (iterator); if (result == NULL) return;
+    entry = lw_resultarray_index (iterator->array, iterator->index);
+
+    if (w_application_get_output_format (application) == W_OUTPUT_FORMAT_JSONL)
+      w_console_append_jsonl_result (application, iterator, result, entry->score);
+    else
+      w_console_append_tsv_result (application, iterator, result, entry->score);
+
+    w_writer_commit (w_application_get_writer (application));
+
+    lw_result_free (result);
+}
+
+
 void 
 w_console_append_result (WApplication           *application, 
                          LwSearchResultIterator *iterator)
@@ -118,7 +261,9 @@ w_console_append_result (WApplication           *application,
     dictionary = iterator->search->dictionary;
     type = G_OBJECT_TYPE (dictionary);
 
-    if (g_type_is_a (type, LW_TYPE_EDICTIONARY))
+    if (w_application_get_output_format (application) != W_OUTPUT_FORMAT_TEXT)
+      w_console_append_record (application, iterator);
+    else if (g_type_is_a (type, LW_TYPE_EDICTIONARY))
       w_console_append_edict_result (application, iterator);
     else if (g_type_is_a (type, LW_TYPE_KANJIDICTIONARY))
       w_console_append_kanjidict_result (application, iterator);
@@ -404,6 +549,7 @@ w_console_no_result (WApplication           *application,
     quiet_switch = w_application_get_quiet_switch (application);
 
     if (quiet_switch) return;
+    if (w_application_get_output_format (application) != W_OUTPUT_FORMAT_TEXT) return;
 
     if (color_switch)
       printf("%s\n\n", gettext("No results found!"));
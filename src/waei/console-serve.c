@@ -0,0 +1,644 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file console-serve.c
+//!
+//! @brief Lookup server on a Unix socket for local tools
+//!
+//! Every installed dictionary and its index are loaded once.  Each connection
+//! is handled on a thread of the service's pool and sends one JSON object per
+//! line.  Every request gets exactly one JSON object on a line back, in order.
+//!
+//! Search requests:
+//!   {"id": 1, "query": "日本", "dictionary": "English", "flags": "exact", "limit": 20}
+//!   Only query is required.  id is echoed back as a string.  dictionary is
+//!   matched like --dictionary.  flags is a comma separated list of
+//!   furigana-insensitive, case-insensitive, stem-insensitive,
+//!   romaji-to-furigana, index and fuzzy that replaces the preferences, or
+//!   exact for the preferences without the insensitive and fuzzy ones.
+//!   limit is how many results to send back or 0 for all of them.
+//! Search responses:
+//!   {"id":"1","query":"日本","dictionary":"English","total":3,"more":false,
+//!    "microseconds":180,"results":[{"text":"...","score":120},...]}
+//!   The results are in the same order waei prints them.  more is true when
+//!   there were more results than limit.
+//!
+//! Statistics requests:
+//!   {"command": "stats"}
+//! Statistics responses:
+//!   {"uptime":12,"connections":3,"active_connections":1,"requests":40,
+//!    "errors":0,"searches":38,"results":512,"average_microseconds":210,
+//!    "dictionaries":[{"name":"English","indexed":true},...]}
+//!
+//! Anything that can't be answered gets {"id":"1","error":"message"} and the
+//! connection stays open.
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+
+#ifdef G_OS_UNIX
+#include <glib-unix.h>
+#include <gio/gunixsocketaddress.h>
+#endif
+
+#include <waei/gettext.h>
+#include <waei/waei.h>
+
+
+#ifdef G_OS_UNIX
+
+static const struct {
+  const gchar *NAME;
+  LwSearchFlag flag;
+} w_server_flags[] = {
+  { "furigana-insensitive", LW_SEARCH_FLAG_FURIGANA_INSENSITIVE },
+  { "case-insensitive", LW_SEARCH_FLAG_CASE_INSENSITIVE },
+  { "stem-insensitive", LW_SEARCH_FLAG_STEM_INSENSITIVE },
+  { "romaji-to-furigana", LW_SEARCH_FLAG_ROMAJI_TO_FURIGANA },
+  { "index", LW_SEARCH_FLAG_USE_INDEX },
+  { "fuzzy", LW_SEARCH_FLAG_FUZZY },
+  { NULL, 0 }
+};
+
+
+//!
+//! @brief Reads the flags member of a request
+//! @returns FALSE if a flag is unknown
+//!
+static gboolean
+w_server_parse_flags (WServer      *server,
+                      const gchar  *FLAGS,
+                      LwSearchFlag *flags)
+{
+    //Declarations
+    gchar **names = NULL;
+    gint i = 0;
+    gint j = 0;
+    gboolean valid = TRUE;
+
+    //Initializations
+    names = g_strsplit (FLAGS, ",", -1);
+    *flags = LW_SEARCH_FLAG_RAW;
+
+    for (i = 0; names[i] != NULL && valid; i++)
+    {
+      g_strstrip (names[i]);
+      if (*names[i] == '\0') continue;
+
+      if (strcmp (names[i], "exact") == 0)
+      {
+        *flags |= server->flags & ~(LW_SEARCH_FLAG_INSENSITIVE | LW_SEARCH_FLAG_FUZZY);
+        continue;
+      }
+
+      for (j = 0; w_server_flags[j].NAME != NULL && strcmp (names[i], w_server_flags[j].NAME) != 0; j++);
+      if (w_server_flags[j].NAME != NULL) *flags |= w_server_flags[j].flag;
+      else valid = FALSE;
+    }
+
+    g_strfreev (names); names = NULL;
+
+    return valid;
+}
+
+
+static void
+w_server_append_stats (WServer *server,
+                       GString *response)
+{
+    //Declarations
+    GList *link = NULL;
+    LwDictionary *dictionary = NULL;
+
+    g_mutex_lock (&server->mutex);
+
+    g_string_append_printf (response,
+      "{\"uptime\":%" G_GINT64_FORMAT ",\"connections\":%" G_GINT64_FORMAT ",\"active_connections\":%" G_GINT64_FORMAT
+      ",\"requests\":%" G_GINT64_FORMAT ",\"errors\":%" G_GINT64_FORMAT ",\"searches\":%" G_GINT64_FORMAT ",\"results\":%" G_GINT64_FORMAT
+      ",\"average_microseconds\":%" G_GINT64_FORMAT,
+      (g_get_monotonic_time () - server->start_time) / G_USEC_PER_SEC,
+      server->connections,
+      server->active_connections,
+      server->requests,
+      server->errors,
+      server->searches,
+      server->results,
+      (server->searches > 0) ? server->microseconds / server->searches : 0
+    );
+
+    g_mutex_unlock (&server->mutex);
+
+    w_json_append_name (response, "dictionaries");
+    g_string_append_c (response, '[');
+    for (link = lw_dictionarylist_get_list (server->dictionarylist); link != NULL; link = link->next)
+    {
+      dictionary = LW_DICTIONARY (link->data);
+      if (link != lw_dictionarylist_get_list (server->dictionarylist)) g_string_append_c (response, ',');
+      g_string_append_c (response, '{');
+      w_json_append_member (response, "name", lw_dictionary_get_name (dictionary));
+      w_json_append_name (response, "indexed");
+      g_string_append (response, (lw_dictionary_index_is_loaded (dictionary)) ? "true" : "false");
+      g_string_append_c (response, '}');
+    }
+    g_string_append (response, "]}");
+}
+
+
+//!
+//! @brief Searches synchronously on the thread of the connection and writes
+//!        the members of the response
+//!
+static void
+w_server_search (WServer    *server,
+                 GHashTable *request,
+                 GString    *response,
+                 GError    **error)
+{
+    //Declarations
+    const gchar *ID = NULL;
+    const gchar *QUERY = NULL;
+    const gchar *DICTIONARY = NULL;
+    const gchar *FLAGS = NULL;
+    const gchar *LIMIT = NULL;
+    LwDictionary *dictionary = NULL;
+    LwSearch *search = NULL;
+    LwProgress *progress = NULL;
+    LwSearchResultIterator *iterator = NULL;
+    LwResultArrayEntry *entry = NULL;
+    LwSearchFlag flags = 0;
+    gint limit = W_SERVER_DEFAULT_LIMIT;
+    gint total = 0;
+    gint sent = 0;
+    gint64 start_time = 0;
+    gint64 microseconds = 0;
+
+    //Initializations
+    start_time = g_get_monotonic_time ();
+    ID = g_hash_table_lookup (request, "id");
+    QUERY = g_hash_table_lookup (request, "query");
+    DICTIONARY = g_hash_table_lookup (request, "dictionary");
+    FLAGS = g_hash_table_lookup (request, "flags");
+    LIMIT = g_hash_table_lookup (request, "limit");
+    flags = server->flags;
+
+    if (QUERY == NULL || *QUERY == '\0')
+    {
+      g_set_error (error, g_quark_from_string (W_JSON_ERROR), W_JSON_PARSE_ERROR, gettext("The request has no query"));
+      goto errored;
+    }
+    if (FLAGS != NULL && !w_server_parse_flags (server, FLAGS, &flags))
+    {
+      g_set_error (error, g_quark_from_string (W_JSON_ERROR), W_JSON_PARSE_ERROR, gettext("Unknown flags \"%s\""), FLAGS);
+      goto errored;
+    }
+    if (LIMIT != NULL) limit = MAX (atoi (LIMIT), 0);
+
+    dictionary = lw_dictionarylist_get_dictionary_fuzzy (server->dictionarylist, DICTIONARY);
+    if (dictionary == NULL)
+    {
+      g_set_error (error, g_quark_from_string (W_JSON_ERROR), W_JSON_PARSE_ERROR, gettext("\"%s\" Dictionary was not found!"), DICTIONARY);
+      goto errored;
+    }
+
+    //Only indexes loaded at startup are used since loading one here would race with the other connections
+    if (!lw_dictionary_index_is_loaded (dictionary)) flags &= ~LW_SEARCH_FLAG_USE_INDEX;
+
+    progress = lw_progress_new (NULL, NULL, NULL);
+    search = lw_search_new (dictionary, server->morphologyengine, QUERY, flags);
+    if (search == NULL)
+    {
+      g_set_error (error, g_quark_from_string (W_JSON_ERROR), W_JSON_PARSE_ERROR, gettext("The search couldn't be started"));
+      goto errored;
+    }
+    lw_search_set_max_results (search, limit);
+    lw_search_start (search, progress, FALSE);
+
+    iterator = lw_searchresultiterator_new (search);
+    w_json_append_member (response, "id", ID);
+    w_json_append_member (response, "query", QUERY);
+    w_json_append_member (response, "dictionary", lw_dictionary_get_name (dictionary));
+    w_json_append_name (response, "results");
+    g_string_append_c (response, '[');
+    while (lw_searchresultiterator_next (iterator))
+    {
+      total++;
+      if (limit > 0 && sent >= limit) continue;
+      entry = lw_resultarray_index (iterator->array, iterator->index);
+      if (sent > 0) g_string_append_c (response, ',');
+      g_string_append_c (response, '{');
+      w_json_append_member (response, "text", lw_dictionary_get_string (dictionary, entry->offset));
+      g_string_append_printf (response, ",\"score\":%d}", entry->score);
+      sent++;
+    }
+    g_string_append_c (response, ']');
+
+    microseconds = g_get_monotonic_time () - start_time;
+    g_string_append_printf (response, ",\"total\":%d,\"more\":%s,\"microseconds\":%" G_GINT64_FORMAT,
+      total,
+      (total > sent || lw_search_has_more (search)) ? "true" : "false",
+      microseconds
+    );
+
+    g_mutex_lock (&server->mutex);
+    server->searches++;
+    server->results += sent;
+    server->microseconds += microseconds;
+    g_mutex_unlock (&server->mutex);
+
+errored:
+
+    if (iterator != NULL) lw_searchresultiterator_free (iterator); iterator = NULL;
+    if (search != NULL) lw_search_free (search); search = NULL;
+    if (progress != NULL) lw_progress_free (progress); progress = NULL;
+}
+
+
+//!
+//! @brief Answers one line of a connection
+//! @param response Cleared and filled with the JSON to send back without the newline
+//!
+static void
+w_server_handle_request (WServer     *server,
+                         const gchar *LINE,
+                         GString     *response)
+{
+    //Declarations
+    GHashTable *request = NULL;
+    const gchar *COMMAND = NULL;
+    GError *error = NULL;
+
+    //Initializations
+    g_string_truncate (response, 0);
+    request = w_json_parse_object (LINE, &error); if (request == NULL) goto errored;
+    COMMAND = g_hash_table_lookup (request, "command");
+
+    g_mutex_lock (&server->mutex);
+    server->requests++;
+    g_mutex_unlock (&server->mutex);
+
+    if (COMMAND != NULL && strcmp (COMMAND, "stats") == 0)
+    {
+      w_server_append_stats (server, response);
+    }
+    else if (COMMAND == NULL || strcmp (COMMAND, "search") == 0)
+    {
+      g_string_append_c (response, '{');
+      w_server_search (server, request, response, &error);
+      g_string_append_c (response, '}');
+    }
+    else
+    {
+      g_set_error (&error, g_quark_from_string (W_JSON_ERROR), W_JSON_PARSE_ERROR, gettext("Unknown command \"%s\""), COMMAND);
+    }
+
+errored:
+
+    if (error != NULL)
+    {
+      g_string_truncate (response, 0);
+      g_string_append_c (response, '{');
+      if (request != NULL && g_hash_table_lookup (request, "id") != NULL) w_json_append_member (response, "id", g_hash_table_lookup (request, "id"));
+      w_json_append_member (response, "error", error->message);
+      g_string_append_c (response, '}');
+      g_error_free (error); error = NULL;
+
+      g_mutex_lock (&server->mutex);
+      server->errors++;
+      g_mutex_unlock (&server->mutex);
+    }
+
+    if (request != NULL) g_hash_table_unref (request); request = NULL;
+}
+
+
+//!
+//! @brief Reads a line of a connection without keeping more than max bytes of it
+//! @param cancellable Stops a read that is waiting on the client
+//! @param too_long Set to TRUE when the line had more than max bytes
+//! @returns The line without its newline or NULL at the end of the stream or
+//!          when it is too long.  Free it with g_free().
+//!
+static gchar*
+w_server_read_request (GBufferedInputStream *input,
+                       gsize                 max,
+                       GCancellable         *cancellable,
+                       gboolean             *too_long)
+{
+    //Declarations
+    GString *line = NULL;
+    const gchar *BUFFER = NULL;
+    const gchar *NEWLINE = NULL;
+    gsize available = 0;
+    gsize length = 0;
+
+    //Initializations
+    line = g_string_new (NULL);
+    *too_long = FALSE;
+
+    while (TRUE)
+    {
+      //The last request may not end in a newline
+      if (g_buffered_input_stream_get_available (input) == 0 && g_buffered_input_stream_fill (input, -1, cancellable, NULL) <= 0)
+      {
+        if (line->len > 0) break;
+        goto errored;
+      }
+
+      BUFFER = g_buffered_input_stream_peek_buffer (input, &available);
+      NEWLINE = memchr (BUFFER, '\n', available);
+      length = (NEWLINE != NULL) ? NEWLINE - BUFFER : available;
+
+      if (line->len + length > max)
+      {
+        *too_long = TRUE;
+        goto errored;
+      }
+
+      g_string_append_len (line, BUFFER, length);
+      if (g_input_stream_skip (G_INPUT_STREAM (input), (NEWLINE != NULL) ? length + 1 : length, cancellable, NULL) < 0) goto errored;
+      if (NEWLINE != NULL) break;
+    }
+
+    return g_string_free (line, FALSE);
+
+errored:
+
+    g_string_free (line, TRUE); line = NULL;
+
+    return NULL;
+}
+
+
+//!
+//! @brief Counts a connection in the main loop as it is accepted.  A connection
+//!        that is still waiting for a thread is already counted, so stopping the
+//!        server can't miss it.
+//!
+static gboolean
+w_server_incoming_cb (GSocketService    *service,
+                      GSocketConnection *connection,
+                      GObject           *source_object,
+                      WServer           *server)
+{
+    g_mutex_lock (&server->mutex);
+    server->connections++;
+    server->active_connections++;
+    g_mutex_unlock (&server->mutex);
+
+    //Let the threaded service hand it to w_server_run_cb()
+    return FALSE;
+}
+
+
+//!
+//! @brief Runs on a thread of the service for as long as a client stays connected
+//!
+static gboolean
+w_server_run_cb (GThreadedSocketService *service,
+                 GSocketConnection      *connection,
+                 GObject                *source_object,
+                 WServer                *server)
+{
+    //Declarations
+    GBufferedInputStream *input = NULL;
+    GOutputStream *output = NULL;
+    GString *response = NULL;
+    gchar *line = NULL;
+    gsize length = 0;
+    gboolean too_long = FALSE;
+
+    //Initializations
+    input = G_BUFFERED_INPUT_STREAM (g_buffered_input_stream_new (g_io_stream_get_input_stream (G_IO_STREAM (connection))));
+    output = g_io_stream_get_output_stream (G_IO_STREAM (connection));
+    response = g_string_sized_new (4096);
+
+    while ((line = w_server_read_request (input, W_SERVER_MAX_REQUEST_LENGTH, server->cancellable, &too_long)) != NULL)
+    {
+      length = strlen(line);
+      if (length > 0 && line[length - 1] == '\r') line[length - 1] = '\0';
+      if (*line != '\0')
+      {
+        w_server_handle_request (server, line, response);
+        g_string_append_c (response, '\n');
+        if (!g_output_stream_write_all (output, response->str, response->len, NULL, server->cancellable, NULL)) break;
+      }
+      g_free (line); line = NULL;
+    }
+
+    //There is no telling where the next request would start, so the connection is dropped after saying why
+    if (too_long)
+    {
+      g_string_truncate (response, 0);
+      g_string_append_c (response, '{');
+      w_json_append_member (response, "error", gettext("The request is too long"));
+      g_string_append (response, "}\n");
+      g_output_stream_write_all (output, response->str, response->len, NULL, server->cancellable, NULL);
+
+      g_mutex_lock (&server->mutex);
+      server->errors++;
+      g_mutex_unlock (&server->mutex);
+    }
+
+    if (line != NULL) g_free (line); line = NULL;
+    if (response != NULL) g_string_free (response, TRUE); response = NULL;
+    if (input != NULL) g_object_unref (input); input = NULL;
+
+    //The server may be freed as soon as this is unlocked
+    g_mutex_lock (&server->mutex);
+    server->active_connections--;
+    g_cond_signal (&server->cond);
+    g_mutex_unlock (&server->mutex);
+
+    return TRUE;
+}
+
+
+static gboolean
+w_server_quit_cb (WServer *server)
+{
+    g_main_loop_quit (server->loop);
+
+    return FALSE;
+}
+
+
+//!
+//! @brief Removes a socket left behind by a server that is gone
+//! @returns FALSE if a server is still answering on PATH
+//!
+static gboolean
+w_server_remove_stale_socket (const gchar *PATH)
+{
+    //Declarations
+    GSocketClient *client = NULL;
+    GSocketAddress *address = NULL;
+    GSocketConnection *connection = NULL;
+
+    if (!g_file_test (PATH, G_FILE_TEST_EXISTS)) return TRUE;
+
+    client = g_socket_client_new ();
+    address = g_unix_socket_address_new (PATH);
+    connection = g_socket_client_connect (client, G_SOCKET_CONNECTABLE (address), NULL, NULL);
+
+    if (connection == NULL) g_unlink (PATH);
+
+    if (connection != NULL) g_object_unref (connection); connection = NULL;
+    if (address != NULL) g_object_unref (address); address = NULL;
+    if (client != NULL) g_object_unref (client); client = NULL;
+
+    return !g_file_test (PATH, G_FILE_TEST_EXISTS);
+}
+
+
+//!
+//! @brief Loads every installed dictionary and answers requests on the socket
+//!        until waei is interrupted
+//!
+gint
+w_console_serve (WApplication *application,
+                 LwProgress   *progress)
+{
+    //Sanity check
+    if (lw_progress_should_abort (progress)) return 1;
+
+    //Declarations
+    WServer *server = NULL;
+    GSocketAddress *address = NULL;
+    const gchar *socket_switch_data = NULL;
+    GList *link = NULL;
+    gint resolution = 0;
+    mode_t mask = 0;
+    gboolean bound = FALSE;
+
+    //Initializations
+    server = g_new0 (WServer, 1);
+    g_mutex_init (&server->mutex);
+    g_cond_init (&server->cond);
+    server->cancellable = g_cancellable_new ();
+    server->application = application;
+    server->dictionarylist = w_application_get_installed_dictionarylist (application);
+    server->morphologyengine = w_application_get_morphologyengine (application);
+    server->flags = lw_search_get_flags_from_preferences (w_application_get_preferences (application));
+    if (w_application_get_exact_switch (application))
+    {
+      server->flags &= ~(LW_SEARCH_FLAG_INSENSITIVE | LW_SEARCH_FLAG_FUZZY);
+    }
+
+    socket_switch_data = w_application_get_socket_switch_data (application);
+    if (socket_switch_data != NULL) server->path = g_strdup (socket_switch_data);
+    else server->path = g_build_filename (g_get_user_runtime_dir (), W_SERVER_SOCKET_NAME, NULL);
+
+    //Warm every dictionary up so the connections only ever read them
+    for (link = lw_dictionarylist_get_list (server->dictionarylist); link != NULL; link = link->next)
+    {
+      if (!w_batch_load_dictionary (LW_DICTIONARY (link->data), server->flags, progress))
+      {
+        w_application_handle_error (application, &progress->error);
+      }
+    }
+
+    if (!w_server_remove_stale_socket (server->path))
+    {
+      fprintf (stderr, gettext("A server is already listening on %s\n"), server->path);
+      resolution = 1;
+      goto errored;
+    }
+
+    server->service = g_threaded_socket_service_new (MAX (g_get_num_processors (), 1) * W_SERVER_THREADS_PER_PROCESSOR);
+    address = g_unix_socket_address_new (server->path);
+
+    //Create the socket owner only rather than narrowing it after other users could already connect
+    mask = umask (0177);
+    bound = g_socket_listener_add_address (G_SOCKET_LISTENER (server->service), address, G_SOCKET_TYPE_STREAM, G_SOCKET_PROTOCOL_DEFAULT, NULL, NULL, &progress->error);
+    umask (mask);
+    if (!bound)
+    {
+      resolution = 1;
+      goto errored;
+    }
+
+    g_signal_connect (server->service, "incoming", G_CALLBACK (w_server_incoming_cb), server);
+    g_signal_connect (server->service, "run", G_CALLBACK (w_server_run_cb), server);
+    server->loop = g_main_loop_new (NULL, FALSE);
+    g_unix_signal_add (SIGINT, (GSourceFunc) w_server_quit_cb, server);
+    g_unix_signal_add (SIGTERM, (GSourceFunc) w_server_quit_cb, server);
+
+    server->start_time = g_get_monotonic_time ();
+    g_socket_service_start (server->service);
+    if (!w_application_get_quiet_switch (application))
+    {
+      fprintf (stderr, gettext("Listening on %s\n"), server->path);
+    }
+
+    g_main_loop_run (server->loop);
+
+    g_socket_service_stop (server->service);
+
+    //The connections use the dictionaries and the morphology engine the application frees after this returns
+    g_cancellable_cancel (server->cancellable);
+    g_mutex_lock (&server->mutex);
+    while (server->active_connections > 0) g_cond_wait (&server->cond, &server->mutex);
+    g_mutex_unlock (&server->mutex);
+
+    g_socket_listener_close (G_SOCKET_LISTENER (server->service));
+    g_unlink (server->path);
+
+errored:
+
+    if (address != NULL) g_object_unref (address); address = NULL;
+    if (server->service != NULL) g_object_unref (server->service); server->service = NULL;
+    if (server->loop != NULL) g_main_loop_unref (server->loop); server->loop = NULL;
+    if (server->path != NULL) g_free (server->path); server->path = NULL;
+    if (server->cancellable != NULL) g_object_unref (server->cancellable); server->cancellable = NULL;
+
+    g_cond_clear (&server->cond);
+    g_mutex_clear (&server->mutex);
+    g_free (server); server = NULL;
+
+    return resolution;
+}
+
+#else
+
+gint
+w_console_serve (WApplication *application,
+                 LwProgress   *progress)
+{
+    fprintf (stderr, "%s\n", gettext("Serving lookups needs Unix domain sockets"));
+
+    return 1;
+}
+
+#endif
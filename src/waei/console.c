@@ -310,12 +310,13 @@ w_console_search (WApplication *application,
     dictionary_switch_data = w_application_get_dictionary_switch_data (application);
     query_text_data = w_application_get_query_text_data (application);
     quiet_switch = w_application_get_quiet_switch (application);
+    quiet_switch |= (w_application_get_output_format (application) != W_OUTPUT_FORMAT_TEXT); //Only results go to stdout
     exact_switch = w_application_get_exact_switch (application);
     flags = lw_search_get_flags_from_preferences (preferences);
 
     if (exact_switch) 
     {
-      flags &= ~LW_SEARCH_FLAG_INSENSITIVE;
+      flags &= ~(LW_SEARCH_FLAG_INSENSITIVE | LW_SEARCH_FLAG_FUZZY);
     }
     resolution = 0;
 
@@ -328,7 +329,8 @@ w_console_search (WApplication *application,
     }
 
     search = lw_search_new (dictionary, w_application_get_morphologyengine (application), query_text_data, flags);
-    searchresultiterator = lw_searchresultiterator_new (search, "raw");
+    if (search != NULL) lw_search_set_max_results (search, 0); //The console prints every result
+    searchresultiterator = lw_searchresultiterator_new (search);
 
     if (search == NULL)
     {
@@ -350,10 +352,10 @@ w_console_search (WApplication *application,
     //Print the results
     lw_search_start (search, progress, FALSE);
 
-    g_timeout_add_full (
-        G_PRIORITY_LOW,
-        100,
-        (GSourceFunc) w_console_append_result_timeout,
+    lw_search_add_watch (
+        search,
+        NULL,
+        (LwSearchWatchFunc) w_console_append_result_cb,
         searchresultiterator,
         NULL
     );
@@ -11,6 +11,7 @@ struct _WApplicationPrivate {
   LwDictionaryList *installed_dictionarylist;
   LwDictionaryList *installable_dictionarylist;
   LwMorphologyEngine *morphologyengine;
+  WWriter *writer;
 
   gboolean arg_quiet_switch;
   gboolean arg_exact_switch;
@@ -18,11 +19,18 @@ struct _WApplicationPrivate {
   gboolean arg_version_switch;
   gboolean arg_color_switch;
   gboolean arg_rebuild_index;
+  gboolean arg_serve_switch;
 
   gchar* arg_dictionary_switch_data;
   gchar* arg_install_switch_data;
   gchar* arg_uninstall_switch_data;
   gchar* arg_query_text_data;
+  gchar* arg_batch_switch_data;
+  gchar* arg_benchmark_switch_data;
+  gint arg_clients_switch_data;
+  gchar* arg_socket_switch_data;
+  gchar* arg_format_switch_data;
+  WOutputFormat format;
 
   GOptionContext *context;
 };
@@ -3,6 +3,12 @@
 
 G_BEGIN_DECLS
 
+typedef enum {
+  W_OUTPUT_FORMAT_TEXT,   //!< Formatted for people with optional colors
+  W_OUTPUT_FORMAT_JSONL,  //!< A JSON object per result
+  W_OUTPUT_FORMAT_TSV     //!< A tab separated line per result
+} WOutputFormat;
+
 //Boilerplate
 typedef struct _WApplication WApplication;
 typedef struct _WApplicationClass WApplicationClass;
@@ -43,10 +49,17 @@ gboolean w_application_get_exact_switch (WApplication*);
 gboolean w_application_get_list_switch (WApplication*);
 gboolean w_application_get_version_switch (WApplication*);
 gboolean w_application_get_color_switch (WApplication*);
+gboolean w_application_get_serve_switch (WApplication*);
 const gchar* w_application_get_dictionary_switch_data (WApplication*);
 const gchar* w_application_get_install_switch_data (WApplication*);
 const gchar* w_application_get_uninstall_switch_data (WApplication*);
 const gchar* w_application_get_query_text_data (WApplication*);
+const gchar* w_application_get_batch_switch_data (WApplication*);
+const gchar* w_application_get_benchmark_switch_data (WApplication*);
+gint w_application_get_clients_switch_data (WApplication*);
+const gchar* w_application_get_socket_switch_data (WApplication*);
+WOutputFormat w_application_get_output_format (WApplication*);
+WWriter* w_application_get_writer (WApplication*);
 
 LwMorphologyEngine* w_application_get_morphologyengine (WApplication *application);
 
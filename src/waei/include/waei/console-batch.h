@@ -0,0 +1,49 @@
+#ifndef W_CONSOLE_BATCH_INCLUDED
+#define W_CONSOLE_BATCH_INCLUDED
+
+#define W_BATCH_QUERIES_PER_THREAD 16 //!< How far the searches can run ahead of the output
+#define W_CONSOLE_BATCH_DELIMITER "==> %s <==\n"
+
+//!
+//! @brief A query of a batch and the search answering it
+//!
+struct _WBatchQuery {
+  gchar *text;
+  LwSearch *search;       //!< NULL when the query was empty
+  LwProgress *progress;
+  gboolean finished;      //!< Set from the pool once the search is done.  Read it with the batch mutex held.
+};
+typedef struct _WBatchQuery WBatchQuery;
+
+
+//!
+//! @brief Runs many searches on a pool of threads against one dictionary that
+//!        stays loaded between them
+//!
+struct _WBatch {
+  WApplication *application;
+  LwDictionary *dictionary;
+  LwMorphologyEngine *morphologyengine;
+  LwSearchFlag flags;
+  gint max;               //!< The maximum results of each search or 0 for no limit
+
+  GThreadPool *pool;
+  GQueue *pending;        //!< The WBatchQuerys that were not handed out yet in input order
+  guint window;           //!< How many queries can be pending before the oldest are waited on
+  GMutex mutex;
+  GCond cond;
+};
+typedef struct _WBatch WBatch;
+
+typedef void (*WBatchQueryFunc) (WBatch *batch, WBatchQuery *query, gpointer data);
+
+gboolean w_batch_load_dictionary (LwDictionary *dictionary, LwSearchFlag flags, LwProgress *progress);
+
+WBatch* w_batch_new (WApplication *application, LwDictionary *dictionary, LwSearchFlag flags, LwProgress *progress);
+void w_batch_free (WBatch *batch);
+void w_batch_push (WBatch *batch, const gchar *TEXT);
+void w_batch_flush (WBatch *batch, guint remaining, WBatchQueryFunc func, gpointer data);
+
+gint w_console_batch (WApplication *application, LwProgress *progress);
+
+#endif
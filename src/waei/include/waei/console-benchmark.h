@@ -0,0 +1,40 @@
+#ifndef W_CONSOLE_BENCHMARK_INCLUDED
+#define W_CONSOLE_BENCHMARK_INCLUDED
+
+//!
+//! @brief How one pass over the query corpus is run
+//!
+struct _WBenchmarkPhase {
+  const gchar *name;      //!< cold, warm or concurrent
+  const gchar *path;      //!< index or regex
+  gboolean indexed;
+  gboolean cold;          //!< The result and analysis caches are cleared before every query
+  gboolean concurrent;    //!< Every client runs the whole corpus at the same time
+};
+typedef struct _WBenchmarkPhase WBenchmarkPhase;
+
+
+//!
+//! @brief Runs a query corpus against a dictionary and collects the latency of
+//!        every search
+//!
+struct _WBenchmark {
+  WApplication *application;
+  LwDictionary *dictionary;
+  LwMorphologyEngine *morphologyengine;
+  GPtrArray *queries;     //!< The lines of the corpus that aren't empty
+  gint clients;           //!< Threads of the concurrent phases
+
+  LwSearchFlag flags;     //!< The flags of the phase being run
+  gboolean cold;
+  gint64 *latencies;      //!< Microseconds of each search of the phase
+  gint length;            //!< Searches the phase runs
+  gint next;              //!< The next search to hand out.  Changed atomically.
+  gint results;           //!< Changed atomically
+  gint errors;            //!< Changed atomically
+};
+typedef struct _WBenchmark WBenchmark;
+
+gint w_console_benchmark (WApplication *application, LwProgress *progress);
+
+#endif
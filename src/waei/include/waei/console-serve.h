@@ -0,0 +1,38 @@
+#ifndef W_CONSOLE_SERVE_INCLUDED
+#define W_CONSOLE_SERVE_INCLUDED
+
+#define W_SERVER_SOCKET_NAME "waei.socket"  //!< Made in the user runtime directory when --socket isn't given
+#define W_SERVER_DEFAULT_LIMIT 50           //!< Results sent back when a request has no limit
+#define W_SERVER_THREADS_PER_PROCESSOR 2    //!< Connections mostly wait on their clients
+#define W_SERVER_MAX_REQUEST_LENGTH 65536  //!< Longer request lines get an error and the connection is closed
+
+//!
+//! @brief Answers newline delimited JSON requests on a Unix socket from
+//!        dictionaries and indexes that stay loaded
+//!
+struct _WServer {
+  WApplication *application;
+  LwDictionaryList *dictionarylist;
+  LwMorphologyEngine *morphologyengine;
+  LwSearchFlag flags;            //!< The flags of requests that don't give their own
+  gchar *path;
+  GSocketService *service;
+  GMainLoop *loop;
+  GCancellable *cancellable;     //!< Cancelled when the server stops so idle connections finish
+  gint64 start_time;
+
+  GMutex mutex;                  //!< Guards the statistics below
+  GCond cond;                    //!< Signalled when a connection finishes
+  gint64 connections;
+  gint64 active_connections;
+  gint64 requests;
+  gint64 errors;
+  gint64 searches;
+  gint64 results;
+  gint64 microseconds;           //!< Spent answering searches
+};
+typedef struct _WServer WServer;
+
+gint w_console_serve (WApplication *application, LwProgress *progress);
+
+#endif
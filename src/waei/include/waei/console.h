@@ -12,6 +12,9 @@ int w_console_uninstall_dictionary (WApplication*, LwProgress*);
 int w_console_search (WApplication*, LwProgress*);
 
 #include "console-output.h"
+#include "console-batch.h"
+#include "console-benchmark.h"
+#include "console-serve.h"
 #include "console-callbacks.h"
 
 #endif
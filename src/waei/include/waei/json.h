@@ -0,0 +1,15 @@
+#ifndef W_JSON_INCLUDED
+#define W_JSON_INCLUDED
+
+#define W_JSON_ERROR "waei json error"
+
+typedef enum {
+  W_JSON_PARSE_ERROR
+} WJsonError;
+
+GHashTable* w_json_parse_object (const gchar *TEXT, GError **error);
+void w_json_append_string (GString *json, const gchar *TEXT);
+void w_json_append_name (GString *json, const gchar *NAME);
+void w_json_append_member (GString *json, const gchar *NAME, const gchar *VALUE);
+
+#endif
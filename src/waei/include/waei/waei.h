@@ -2,8 +2,10 @@
 #define GW_WAEI_INCLUDED
 
 #include <libwaei/libwaei.h>
+#include <waei/writer.h>
 #include <waei/application.h>
 #include <waei/search-data.h>
+#include <waei/json.h>
 #include <waei/console.h>
 
 #endif
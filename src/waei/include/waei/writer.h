@@ -0,0 +1,24 @@
+#ifndef W_WRITER_INCLUDED
+#define W_WRITER_INCLUDED
+
+#define W_WRITER_BLOCK_SIZE (64 * 1024) //!< Output is written in blocks of at least this size
+
+//!
+//! @brief Collects output in memory so it reaches the stream in large blocks
+//!        instead of a write for every field
+//!
+struct _WWriter {
+  FILE *stream;
+  GString *buffer;  //!< Append to it directly then call w_writer_commit()
+};
+typedef struct _WWriter WWriter;
+
+WWriter* w_writer_new (FILE *stream);
+void w_writer_free (WWriter *writer);
+
+void w_writer_commit (WWriter *writer);
+void w_writer_flush (WWriter *writer);
+
+void w_writer_append_tsv_field (WWriter *writer, const gchar *TEXT, gboolean first);
+
+#endif
@@ -0,0 +1,319 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file json.c
+//!
+//! @brief Just enough JSON for the machine readable interfaces of waei
+//!
+//! Requests are flat objects of strings, numbers and booleans so they are read
+//! into a hash table of strings instead of pulling in a JSON library.
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <waei/gettext.h>
+#include <waei/waei.h>
+
+
+static void
+w_json_skip_spaces (const gchar **ptr)
+{
+    while (**ptr == ' ' || **ptr == '\t' || **ptr == '\r' || **ptr == '\n') (*ptr)++;
+}
+
+
+static gint
+w_json_read_hex4 (const gchar *TEXT)
+{
+    //Declarations
+    gint value = 0;
+    gint i = 0;
+
+    for (i = 0; i < 4; i++)
+    {
+      if (!g_ascii_isxdigit (TEXT[i])) return -1;
+      value = (value << 4) | g_ascii_xdigit_value (TEXT[i]);
+    }
+
+    return value;
+}
+
+
+//!
+//! @brief Reads a quoted string and moves ptr past it
+//! @returns The unescaped string or NULL if it is malformed
+//!
+static gchar*
+w_json_read_string (const gchar **ptr)
+{
+    //Sanity checks
+    if (**ptr != '"') return NULL;
+
+    //Declarations
+    GString *text = NULL;
+    gunichar c = 0;
+    gint low = 0;
+
+    //Initializations
+    text = g_string_new (NULL);
+    (*ptr)++;
+
+    while (**ptr != '"')
+    {
+      if ((guchar) **ptr < 0x20) goto errored;
+      if (**ptr != '\\')
+      {
+        g_string_append_c (text, **ptr);
+        (*ptr)++;
+        continue;
+      }
+
+      (*ptr)++;
+      switch (**ptr)
+      {
+        case '"': case '\\': case '/': g_string_append_c (text, **ptr); break;
+        case 'b': g_string_append_c (text, '\b'); break;
+        case 'f': g_string_append_c (text, '\f'); break;
+        case 'n': g_string_append_c (text, '\n'); break;
+        case 'r': g_string_append_c (text, '\r'); break;
+        case 't': g_string_append_c (text, '\t'); break;
+        case 'u':
+          c = w_json_read_hex4 (*ptr + 1); if ((gint) c < 0) goto errored;
+          *ptr += 4;
+          //Characters outside of the BMP come as a surrogate pair
+          if (c >= 0xD800 && c <= 0xDBFF)
+          {
+            if ((*ptr)[1] != '\\' || (*ptr)[2] != 'u') goto errored;
+            low = w_json_read_hex4 (*ptr + 3); if (low < 0xDC00 || low > 0xDFFF) goto errored;
+            c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+            *ptr += 6;
+          }
+          if (!g_unichar_validate (c)) goto errored;
+          g_string_append_unichar (text, c);
+          break;
+        default:
+          goto errored;
+      }
+      (*ptr)++;
+    }
+    (*ptr)++;
+
+    if (!g_utf8_validate (text->str, text->len, NULL)) goto errored;
+
+    return g_string_free (text, FALSE);
+
+errored:
+
+    g_string_free (text, TRUE); text = NULL;
+
+    return NULL;
+}
+
+
+//!
+//! @brief Reads a number, true or false as the text it was written as
+//!
+static gchar*
+w_json_read_literal (const gchar **ptr)
+{
+    //Declarations
+    const gchar *start = *ptr;
+
+    if (strncmp (*ptr, "true", 4) == 0) *ptr += 4;
+    else if (strncmp (*ptr, "false", 5) == 0) *ptr += 5;
+    else while (g_ascii_isdigit (**ptr) || (**ptr != '\0' && strchr ("+-.eE", **ptr) != NULL)) (*ptr)++;
+
+    if (*ptr == start) return NULL;
+
+    return g_strndup (start, *ptr - start);
+}
+
+
+//!
+//! @brief Parses an object whose values are strings, numbers, booleans or
+//!        null.  Nested objects and arrays are not supported.
+//! @param TEXT The JSON text of the object
+//! @param error A GError to place errors into or NULL
+//! @returns A hash table from member names to their values as strings that
+//!          should be freed with g_hash_table_unref().  Null members are left out.
+//!
+GHashTable*
+w_json_parse_object (const gchar  *TEXT,
+                     GError      **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (TEXT != NULL, NULL);
+
+    //Declarations
+    GHashTable *object = NULL;
+    const gchar *ptr = TEXT;
+    gchar *name = NULL;
+    gchar *value = NULL;
+
+    //Initializations
+    object = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+    w_json_skip_spaces (&ptr);
+    if (*ptr != '{') goto errored;
+    ptr++;
+    w_json_skip_spaces (&ptr);
+
+    while (*ptr != '}')
+    {
+      name = w_json_read_string (&ptr); if (name == NULL) goto errored;
+      w_json_skip_spaces (&ptr);
+      if (*ptr != ':') goto errored;
+      ptr++;
+      w_json_skip_spaces (&ptr);
+
+      if (*ptr == '"')
+      {
+        value = w_json_read_string (&ptr); if (value == NULL) goto errored;
+      }
+      else if (strncmp (ptr, "null", 4) == 0)
+      {
+        ptr += 4;
+      }
+      else
+      {
+        value = w_json_read_literal (&ptr); if (value == NULL) goto errored;
+      }
+
+      if (value != NULL) g_hash_table_replace (object, name, value);
+      else g_free (name);
+      name = NULL;
+      value = NULL;
+
+      w_json_skip_spaces (&ptr);
+      if (*ptr == ',')
+      {
+        ptr++;
+        w_json_skip_spaces (&ptr);
+        if (*ptr != '"') goto errored;
+      }
+      else if (*ptr != '}')
+      {
+        goto errored;
+      }
+    }
+    ptr++;
+
+    w_json_skip_spaces (&ptr);
+    if (*ptr != '\0') goto errored;
+
+    return object;
+
+errored:
+
+    g_set_error (error, g_quark_from_string (W_JSON_ERROR), W_JSON_PARSE_ERROR, gettext("Malformed JSON near \"%.16s\""), ptr);
+
+    if (name != NULL) g_free (name); name = NULL;
+    if (value != NULL) g_free (value); value = NULL;
+    if (object != NULL) g_hash_table_unref (object); object = NULL;
+
+    return NULL;
+}
+
+
+//!
+//! @brief Appends TEXT as a quoted and escaped JSON string
+//!
+void
+w_json_append_string (GString     *json,
+                      const gchar *TEXT)
+{
+    //Sanity checks
+    g_return_if_fail (json != NULL);
+
+    //Declarations
+    const gchar *ptr = TEXT;
+    const gchar *start = TEXT;
+
+    if (TEXT == NULL)
+    {
+      g_string_append (json, "null");
+      return;
+    }
+
+    g_string_append_c (json, '"');
+
+    //Copy the runs that don't need escaping in one go
+    for (ptr = TEXT; *ptr != '\0'; ptr++)
+    {
+      if (*ptr != '"' && *ptr != '\\' && (guchar) *ptr >= 0x20) continue;
+
+      g_string_append_len (json, start, ptr - start);
+      switch (*ptr)
+      {
+        case '"': g_string_append (json, "\\\""); break;
+        case '\\': g_string_append (json, "\\\\"); break;
+        case '\n': g_string_append (json, "\\n"); break;
+        case '\r': g_string_append (json, "\\r"); break;
+        case '\t': g_string_append (json, "\\t"); break;
+        default: g_string_append_printf (json, "\\u%04x", (guchar) *ptr); break;
+      }
+      start = ptr + 1;
+    }
+    g_string_append_len (json, start, ptr - start);
+
+    g_string_append_c (json, '"');
+}
+
+
+//!
+//! @brief Starts a member of an object that is being written by appending
+//!        "NAME": and a comma before it unless it is the first member.  The
+//!        caller appends the value.
+//!
+void
+w_json_append_name (GString     *json,
+                    const gchar *NAME)
+{
+    //Sanity checks
+    g_return_if_fail (json != NULL);
+    g_return_if_fail (NAME != NULL);
+
+    if (json->len > 0 && json->str[json->len - 1] != '{' && json->str[json->len - 1] != '[') g_string_append_c (json, ',');
+
+    w_json_append_string (json, NAME);
+    g_string_append_c (json, ':');
+}
+
+
+//!
+//! @brief Appends "NAME":"VALUE" to an object that is being written
+//!
+void
+w_json_append_member (GString     *json,
+                      const gchar *NAME,
+                      const gchar *VALUE)
+{
+    w_json_append_name (json, NAME);
+    w_json_append_string (json, VALUE);
+}
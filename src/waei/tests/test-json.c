@@ -0,0 +1,190 @@
+#include <string.h>
+#include <glib.h>
+#include <waei/waei.h>
+
+/*
+  Methods tested
+
+  w_json_parse_object
+  w_json_append_string
+  w_json_append_name
+  w_json_append_member
+*/
+
+struct _JsonFixture {
+  GHashTable *object;
+  GString *json;
+  GError *error;
+};
+typedef struct _JsonFixture JsonFixture;
+
+
+void
+json_test_setup (JsonFixture *fixture, gconstpointer data)
+{
+    memset(fixture, 0, sizeof(JsonFixture));
+    fixture->json = g_string_new (NULL);
+}
+
+
+void
+json_test_teardown (JsonFixture *fixture, gconstpointer data)
+{
+    if (fixture->object != NULL) g_hash_table_unref (fixture->object); fixture->object = NULL;
+    g_string_free (fixture->json, TRUE); fixture->json = NULL;
+    g_clear_error (&fixture->error);
+}
+
+
+void
+json_test_parse_values (JsonFixture *fixture, gconstpointer data)
+{
+    fixture->object = w_json_parse_object (" { \"query\" : \"taberu\",\"limit\":20, \"exact\":true,\"score\":-1.5e2, \"dictionary\":null }\r\n", &fixture->error);
+
+    g_assert_no_error (fixture->error);
+    g_assert (fixture->object != NULL);
+    g_assert_cmpint (g_hash_table_size (fixture->object), ==, 4);
+    g_assert_cmpstr (g_hash_table_lookup (fixture->object, "query"), ==, "taberu");
+    g_assert_cmpstr (g_hash_table_lookup (fixture->object, "limit"), ==, "20");
+    g_assert_cmpstr (g_hash_table_lookup (fixture->object, "exact"), ==, "true");
+    g_assert_cmpstr (g_hash_table_lookup (fixture->object, "score"), ==, "-1.5e2");
+    //Null members are left out
+    g_assert (!g_hash_table_contains (fixture->object, "dictionary"));
+    g_hash_table_unref (fixture->object);
+
+    fixture->object = w_json_parse_object ("{}", &fixture->error);
+    g_assert_no_error (fixture->error);
+    g_assert_cmpint (g_hash_table_size (fixture->object), ==, 0);
+    g_hash_table_unref (fixture->object);
+
+    //The last of a repeated member wins
+    fixture->object = w_json_parse_object ("{\"query\":\"a\",\"query\":\"b\"}", &fixture->error);
+    g_assert_no_error (fixture->error);
+    g_assert_cmpstr (g_hash_table_lookup (fixture->object, "query"), ==, "b");
+}
+
+
+void
+json_test_parse_escapes (JsonFixture *fixture, gconstpointer data)
+{
+    fixture->object = w_json_parse_object ("{\"a\":\"\\\"\\\\\\/\\b\\f\\n\\r\\t\",\"b\":\"\\u98df\\u3079\\u308b\",\"c\":\"\\ud842\\udfb7\",\"d\":\"食べる𠮷\"}", &fixture->error);
+
+    g_assert_no_error (fixture->error);
+    g_assert_cmpstr (g_hash_table_lookup (fixture->object, "a"), ==, "\"\\/\b\f\n\r\t");
+    g_assert_cmpstr (g_hash_table_lookup (fixture->object, "b"), ==, "食べる");
+    //A surrogate pair is one character outside of the BMP
+    g_assert_cmpstr (g_hash_table_lookup (fixture->object, "c"), ==, "𠮷");
+    g_assert_cmpstr (g_hash_table_lookup (fixture->object, "d"), ==, "食べる𠮷");
+}
+
+
+void
+json_test_parse_errors (JsonFixture *fixture, gconstpointer data)
+{
+    const gchar *MALFORMED[] = {
+      "",
+      "[]",
+      "{",
+      "{\"query\"}",
+      "{\"query\":}",
+      "{\"query\":\"taberu\"",
+      "{\"query\":\"taberu\",}",
+      "{\"query\":\"taberu\" \"limit\":1}",
+      "{\"query\":\"taberu\"} trailing",
+      "{query:\"taberu\"}",
+      "{\"query\":\"tab\teru\"}",
+      "{\"query\":\"\\x\"}",
+      "{\"query\":\"\\u12\"}",
+      "{\"query\":\"\\ud842\"}",
+      "{\"query\":\"\\ud842\\u0041\"}",
+      "{\"query\":{\"nested\":1}}",
+      "{\"query\":[1]}",
+      "{\"query\":\"\xff\"}",
+      NULL
+    };
+    gint i = 0;
+
+    for (i = 0; MALFORMED[i] != NULL; i++)
+    {
+      fixture->object = w_json_parse_object (MALFORMED[i], &fixture->error);
+      if (fixture->object != NULL) g_error ("Parsed malformed JSON: %s", MALFORMED[i]);
+      g_assert_error (fixture->error, g_quark_from_string (W_JSON_ERROR), W_JSON_PARSE_ERROR);
+      g_clear_error (&fixture->error);
+    }
+}
+
+
+void
+json_test_append_string (JsonFixture *fixture, gconstpointer data)
+{
+    w_json_append_string (fixture->json, "a\"b\\c\nd\re\tf\001g𠮷食");
+    g_assert_cmpstr (fixture->json->str, ==, "\"a\\\"b\\\\c\\nd\\re\\tf\\u0001g𠮷食\"");
+
+    g_string_truncate (fixture->json, 0);
+    w_json_append_string (fixture->json, NULL);
+    g_assert_cmpstr (fixture->json->str, ==, "null");
+
+    g_string_truncate (fixture->json, 0);
+    w_json_append_string (fixture->json, "");
+    g_assert_cmpstr (fixture->json->str, ==, "\"\"");
+}
+
+
+void
+json_test_append_member (JsonFixture *fixture, gconstpointer data)
+{
+    g_string_append_c (fixture->json, '{');
+    w_json_append_member (fixture->json, "query", "taberu");
+    w_json_append_name (fixture->json, "results");
+    g_string_append_c (fixture->json, '[');
+    g_string_append_c (fixture->json, '{');
+    w_json_append_member (fixture->json, "kanji", "食べる");
+    w_json_append_member (fixture->json, "furigana", NULL);
+    g_string_append (fixture->json, "}]}");
+
+    g_assert_cmpstr (fixture->json->str, ==, "{\"query\":\"taberu\",\"results\":[{\"kanji\":\"食べる\",\"furigana\":null}]}");
+}
+
+
+void
+json_test_round_trip (JsonFixture *fixture, gconstpointer data)
+{
+    const gchar *VALUES[] = { "plain", "", "tab\there", "line\nbreak\r\n", "\"quoted\" \\slash\\", "\001\037", "𠮷野家", NULL };
+    gchar *name = NULL;
+    gint i = 0;
+
+    g_string_append_c (fixture->json, '{');
+    for (i = 0; VALUES[i] != NULL; i++)
+    {
+      name = g_strdup_printf ("v%d", i);
+      w_json_append_member (fixture->json, name, VALUES[i]);
+      g_free (name); name = NULL;
+    }
+    g_string_append_c (fixture->json, '}');
+
+    fixture->object = w_json_parse_object (fixture->json->str, &fixture->error);
+    g_assert_no_error (fixture->error);
+
+    for (i = 0; VALUES[i] != NULL; i++)
+    {
+      name = g_strdup_printf ("v%d", i);
+      g_assert_cmpstr (g_hash_table_lookup (fixture->object, name), ==, VALUES[i]);
+      g_free (name); name = NULL;
+    }
+}
+
+
+gint
+main (gint argc, gchar *argv[])
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add ("/waei/json/parse_values", JsonFixture, NULL, json_test_setup, json_test_parse_values, json_test_teardown);
+    g_test_add ("/waei/json/parse_escapes", JsonFixture, NULL, json_test_setup, json_test_parse_escapes, json_test_teardown);
+    g_test_add ("/waei/json/parse_errors", JsonFixture, NULL, json_test_setup, json_test_parse_errors, json_test_teardown);
+    g_test_add ("/waei/json/append_string", JsonFixture, NULL, json_test_setup, json_test_append_string, json_test_teardown);
+    g_test_add ("/waei/json/append_member", JsonFixture, NULL, json_test_setup, json_test_append_member, json_test_teardown);
+    g_test_add ("/waei/json/round_trip", JsonFixture, NULL, json_test_setup, json_test_round_trip, json_test_teardown);
+
+    return g_test_run();
+}
@@ -0,0 +1,173 @@
+#include <string.h>
+#include <stdio.h>
+#include <glib.h>
+#include <waei/waei.h>
+
+/*
+  Methods tested
+
+  w_writer_new
+  w_writer_commit
+  w_writer_flush
+  w_writer_free
+  w_writer_append_tsv_field
+  w_json_append_member (as written into JSON Lines records)
+*/
+
+struct _WriterFixture {
+  FILE *stream;
+  WWriter *writer;
+};
+typedef struct _WriterFixture WriterFixture;
+
+
+void
+writer_test_setup (WriterFixture *fixture, gconstpointer data)
+{
+    memset(fixture, 0, sizeof(WriterFixture));
+    fixture->stream = tmpfile ();
+    g_assert (fixture->stream != NULL);
+    fixture->writer = w_writer_new (fixture->stream);
+}
+
+
+void
+writer_test_teardown (WriterFixture *fixture, gconstpointer data)
+{
+    if (fixture->writer != NULL) w_writer_free (fixture->writer); fixture->writer = NULL;
+    fclose (fixture->stream); fixture->stream = NULL;
+}
+
+
+//!
+//! @brief Returns everything written to the stream so far
+//!
+static gchar*
+writer_read_stream (FILE *stream)
+{
+    GString *text = NULL;
+    gchar buffer[4096];
+    gsize length = 0;
+
+    text = g_string_new (NULL);
+    rewind (stream);
+    while ((length = fread (buffer, sizeof(gchar), sizeof(buffer), stream)) > 0)
+    {
+      g_string_append_len (text, buffer, length);
+    }
+    fseek (stream, 0, SEEK_END);
+
+    return g_string_free (text, FALSE);
+}
+
+
+void
+writer_test_commit_blocks (WriterFixture *fixture, gconstpointer data)
+{
+    gchar *text = NULL;
+    gsize written = 0;
+
+    //Records stay in memory until a whole block has collected
+    g_string_append (fixture->writer->buffer, "first\n");
+    w_writer_commit (fixture->writer);
+    text = writer_read_stream (fixture->stream);
+    g_assert_cmpstr (text, ==, "");
+    g_free (text); text = NULL;
+
+    while (fixture->writer->buffer->len < W_WRITER_BLOCK_SIZE)
+    {
+      g_string_append (fixture->writer->buffer, "record\n");
+    }
+    written = fixture->writer->buffer->len;
+    w_writer_commit (fixture->writer);
+    g_assert_cmpuint (fixture->writer->buffer->len, ==, 0);
+    text = writer_read_stream (fixture->stream);
+    g_assert_cmpuint (strlen(text), ==, written);
+    g_assert (g_str_has_prefix (text, "first\nrecord\n"));
+    g_free (text); text = NULL;
+
+    //Freeing writes out the rest
+    g_string_append (fixture->writer->buffer, "last\n");
+    w_writer_free (fixture->writer); fixture->writer = NULL;
+    text = writer_read_stream (fixture->stream);
+    g_assert_cmpuint (strlen(text), ==, written + strlen("last\n"));
+    g_assert (g_str_has_suffix (text, "record\nlast\n"));
+    g_free (text); text = NULL;
+}
+
+
+void
+writer_test_tsv_escaping (WriterFixture *fixture, gconstpointer data)
+{
+    gchar *text = NULL;
+
+    w_writer_append_tsv_field (fixture->writer, "tab\there", TRUE);
+    w_writer_append_tsv_field (fixture->writer, "line\nbreak\r\n", FALSE);
+    w_writer_append_tsv_field (fixture->writer, NULL, FALSE);
+    w_writer_append_tsv_field (fixture->writer, "\"quoted\" \\", FALSE);
+    w_writer_append_tsv_field (fixture->writer, "𠮷野家", FALSE);
+    g_string_append_c (fixture->writer->buffer, '\n');
+    w_writer_flush (fixture->writer);
+
+    //Tabs only separate fields and newlines only end records
+    text = writer_read_stream (fixture->stream);
+    g_assert_cmpstr (text, ==, "tab here\tline break  \t\t\"quoted\" \\\t𠮷野家\n");
+    g_free (text); text = NULL;
+}
+
+
+void
+writer_test_jsonl_escaping (WriterFixture *fixture, gconstpointer data)
+{
+    const gchar *VALUES[] = { "tab\there", "line\nbreak\r\n", "\"quoted\" \\", "𠮷野家", NULL };
+    GHashTable *object = NULL;
+    GError *error = NULL;
+    gchar **records = NULL;
+    gchar *text = NULL;
+    gint i = 0;
+
+    for (i = 0; VALUES[i] != NULL; i++)
+    {
+      g_string_append_c (fixture->writer->buffer, '{');
+      w_json_append_member (fixture->writer->buffer, "text", VALUES[i]);
+      g_string_append (fixture->writer->buffer, "}\n");
+      w_writer_commit (fixture->writer);
+    }
+    w_writer_flush (fixture->writer);
+
+    text = writer_read_stream (fixture->stream);
+    g_assert_cmpstr (text, ==,
+      "{\"text\":\"tab\\there\"}\n"
+      "{\"text\":\"line\\nbreak\\r\\n\"}\n"
+      "{\"text\":\"\\\"quoted\\\" \\\\\"}\n"
+      "{\"text\":\"𠮷野家\"}\n"
+    );
+
+    //Each line reads back as the record that was written
+    records = g_strsplit (text, "\n", -1);
+    for (i = 0; VALUES[i] != NULL; i++)
+    {
+      object = w_json_parse_object (records[i], &error);
+      g_assert_no_error (error);
+      g_assert_cmpstr (g_hash_table_lookup (object, "text"), ==, VALUES[i]);
+      g_hash_table_unref (object); object = NULL;
+    }
+    g_assert_cmpstr (records[i], ==, "");
+    g_assert (records[i + 1] == NULL);
+
+    g_strfreev (records); records = NULL;
+    g_free (text); text = NULL;
+}
+
+
+gint
+main (gint argc, gchar *argv[])
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add ("/waei/writer/commit_blocks", WriterFixture, NULL, writer_test_setup, writer_test_commit_blocks, writer_test_teardown);
+    g_test_add ("/waei/writer/tsv_escaping", WriterFixture, NULL, writer_test_setup, writer_test_tsv_escaping, writer_test_teardown);
+    g_test_add ("/waei/writer/jsonl_escaping", WriterFixture, NULL, writer_test_setup, writer_test_jsonl_escaping, writer_test_teardown);
+
+    return g_test_run();
+}
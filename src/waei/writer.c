@@ -0,0 +1,134 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file writer.c
+//!
+//! @brief Buffered output for the machine readable formats
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <waei/gettext.h>
+#include <waei/waei.h>
+
+
+WWriter*
+w_writer_new (FILE *stream)
+{
+    //Sanity checks
+    g_return_val_if_fail (stream != NULL, NULL);
+
+    //Declarations
+    WWriter *writer = NULL;
+
+    //Initializations
+    writer = g_new0 (WWriter, 1); if (writer == NULL) goto errored;
+    writer->stream = stream;
+    writer->buffer = g_string_sized_new (W_WRITER_BLOCK_SIZE * 2);
+
+errored:
+
+    return writer;
+}
+
+
+//!
+//! @brief Writes out whatever is left and frees the writer.  The stream is not closed.
+//!
+void
+w_writer_free (WWriter *writer)
+{
+    //Sanity checks
+    if (writer == NULL) return;
+
+    w_writer_flush (writer);
+    if (writer->buffer != NULL) g_string_free (writer->buffer, TRUE); writer->buffer = NULL;
+
+    g_free (writer);
+}
+
+
+//!
+//! @brief Marks the end of a record.  The buffer is only written once a whole
+//!        block has collected so records never reach the stream split in two.
+//!
+void
+w_writer_commit (WWriter *writer)
+{
+    //Sanity checks
+    g_return_if_fail (writer != NULL);
+
+    if (writer->buffer->len >= W_WRITER_BLOCK_SIZE) w_writer_flush (writer);
+}
+
+
+//!
+//! @brief Writes everything in the buffer to the stream
+//!
+void
+w_writer_flush (WWriter *writer)
+{
+    //Sanity checks
+    g_return_if_fail (writer != NULL);
+
+    if (writer->buffer->len > 0)
+    {
+      fwrite (writer->buffer->str, sizeof(gchar), writer->buffer->len, writer->stream);
+      g_string_truncate (writer->buffer, 0);
+    }
+
+    fflush (writer->stream);
+}
+
+
+//!
+//! @brief Appends a TSV field with the tabs and newlines in it turned into
+//!        spaces so it can't break the columns or the records apart
+//! @param first Whether the field starts the record and so takes no tab before it
+//!
+void
+w_writer_append_tsv_field (WWriter     *writer,
+                           const gchar *TEXT,
+                           gboolean     first)
+{
+    //Sanity checks
+    g_return_if_fail (writer != NULL);
+
+    //Declarations
+    const gchar *ptr = NULL;
+
+    if (!first) g_string_append_c (writer->buffer, '\t');
+    if (TEXT == NULL) return;
+
+    for (ptr = TEXT; *ptr != '\0'; ptr++)
+    {
+      g_string_append_c (writer->buffer, (*ptr == '\t' || *ptr == '\n' || *ptr == '\r') ? ' ' : *ptr);
+    }
+}